@@ -97,6 +97,7 @@
         @}
         @defgroup core_lowlevel_api Low-level API for external libraries / plugins
     @}
+    @defgroup core_parallel_backend Parallel backends API
 @}
  */
 
@@ -1889,6 +1890,32 @@ stores the indices of sorted elements in the output array. For example:
 */
 CV_EXPORTS_W void sortIdx(InputArray src, OutputArray dst, int flags);
 
+/** @brief Finds the k largest (or smallest) elements in each row or each column of a matrix.
+
+The function cv::topK returns the same elements as the first k columns (rows) of the cv::sortIdx
+output, i.e. they are sorted, starting from the largest one when largest is true and from the
+smallest one otherwise; equal elements come in the order of their indices. Unlike the full sort,
+the cost grows as N*log(k) for a line of N elements, so it is much faster for small k.
+@code
+    Mat scores(1, 1000, CV_32F), best, bestIdx;
+    randu(scores, 0, 1);
+    topK(scores, 5, 1, best, bestIdx); // the 5 highest scores and their positions
+@endcode
+@param src input single-channel 2D array.
+@param k number of the elements to find, 0 < k <= src.cols (src.rows when dim is 0).
+@param dim dimension along which the elements are selected: 1 means that each row is
+processed and the output has k columns, 0 means that each column is processed and the output
+has k rows.
+@param values output array of the same type as src with the selected elements; it may be
+omitted (noArray()).
+@param indices output CV_32S array with the indices of the selected elements within their row
+(column); it may be omitted (noArray()).
+@param largest whether the largest or the smallest elements are selected.
+@sa sortIdx, sort
+*/
+CV_EXPORTS_W void topK(InputArray src, int k, int dim, OutputArray values, OutputArray indices,
+                       bool largest = true);
+
 /** @brief Finds the real roots of a cubic equation.
 
 The function solveCubic finds the real roots of a cubic equation:
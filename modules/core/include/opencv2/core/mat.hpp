@@ -2096,6 +2096,13 @@ public:
     MatAllocator* allocator;
     //! and the standard allocator
     static MatAllocator* getStdAllocator();
+    /** @brief Returns the allocator that keeps released buffers in per-thread size-class free lists.
+
+    Amount of reserved memory is controlled by getBufferPoolController() of the returned allocator
+    (OPENCV_CPU_BUFFERPOOL_LIMIT, 128Mb by default). Use setDefaultAllocator() to enable it,
+    or set OPENCV_CPU_BUFFERPOOL=1 to make it default allocator on startup.
+    */
+    static MatAllocator* getPooledAllocator();
     static MatAllocator* getDefaultAllocator();
     static void setDefaultAllocator(MatAllocator* allocator);
 
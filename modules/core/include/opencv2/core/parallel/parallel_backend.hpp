@@ -0,0 +1,80 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_CORE_PARALLEL_BACKEND_HPP
+#define OPENCV_CORE_PARALLEL_BACKEND_HPP
+
+#include "opencv2/core/cvdef.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cv { namespace parallel {
+
+//! @addtogroup core_parallel_backend
+//! @{
+
+/** @brief Interface of the backend which runs parallel_for_() loops
+
+Applications with their own task scheduler implement this interface and route the loops into it
+via setParallelForBackend() to avoid oversubscription of the CPU cores.
+
+Backends are also used by cv::getNumThreads(), cv::setNumThreads() and cv::getThreadNum().
+*/
+class CV_EXPORTS ParallelForAPI
+{
+public:
+    virtual ~ParallelForAPI();
+
+    typedef void (FN_parallel_for_body_cb_t)(int start, int end, void* data);
+
+    /** @brief Runs the loop
+
+    The callback must be called for non-overlapping subranges which cover [0, tasks) before the return.
+    Calls may be executed by any threads. Exceptions are handled by the callback.
+    The method may be called by several threads at the same time and from the callback itself (nested loops).
+    */
+    virtual void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) = 0;
+
+    /** @brief Returns index of the current thread in the backend thread pool (0 for external threads) */
+    virtual int getThreadNum() const = 0;
+
+    /** @brief Returns the number of threads used by the loops */
+    virtual int getNumThreads() const = 0;
+
+    /** @brief Sets the number of threads, returns the previous value */
+    virtual int setNumThreads(int nThreads) = 0;
+
+    /** @brief Returns the backend name */
+    virtual const char* getName() const = 0;
+};
+
+/** @brief Replaces the backend of parallel_for_() loops
+
+@param api the new backend. Empty pointer restores the built-in parallel framework.
+@param propagateNumThreads pass the number of threads set by cv::setNumThreads() to the new backend
+
+The backend should be changed when there are no running parallel loops (e.g. during application initialization).
+*/
+CV_EXPORTS void setParallelForBackend(const std::shared_ptr<ParallelForAPI>& api, bool propagateNumThreads = true);
+
+/** @brief Selects one of the built-in backends by name (see getParallelForBackendNames())
+
+@return false if there is no backend with such name
+*/
+CV_EXPORTS bool setParallelForBackend(const std::string& backendName, bool propagateNumThreads = true);
+
+/** @brief Returns the active backend */
+CV_EXPORTS std::shared_ptr<ParallelForAPI> getParallelForBackend();
+
+/** @brief Returns names of the built-in backends
+
+The list contains the parallel framework OpenCV is built with (if any) and "sequential".
+*/
+CV_EXPORTS std::vector<std::string> getParallelForBackendNames();
+
+//! @}
+}} // namespace
+
+#endif // OPENCV_CORE_PARALLEL_BACKEND_HPP
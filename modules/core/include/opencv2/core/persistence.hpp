@@ -296,6 +296,7 @@ A complete example using the FileStorage interface
 
 class CV_EXPORTS FileNode;
 class CV_EXPORTS FileNodeIterator;
+class CV_EXPORTS FileNodeHandler;
 
 /** @brief XML/YAML/JSON file storage class that encapsulates all the information necessary for writing or
 reading data to/from a file.
@@ -316,6 +317,7 @@ public:
         FORMAT_XML  = (1<<3), //!< flag, XML format
         FORMAT_YAML = (2<<3), //!< flag, YAML format
         FORMAT_JSON = (3<<3), //!< flag, JSON format
+        FORMAT_BINARY = (4<<3), //!< flag, binary format with raw data that is mapped into memory when reading
 
         BASE64      = 64,     //!< flag, write rawdata in Base64 by default. (consider using WRITE_BASE64)
         WRITE_BASE64 = BASE64 | WRITE, //!< flag, enable both WRITE and BASE64
@@ -348,8 +350,8 @@ public:
      See description of parameters in FileStorage::FileStorage. The method calls FileStorage::release
      before opening the file.
      @param filename Name of the file to open or the text string to read the data from.
-     Extension of the file (.xml, .yml/.yaml or .json) determines its format (XML, YAML or JSON
-     respectively). Also you can append .gz to work with compressed files, for example myHugeMatrix.xml.gz. If both
+     Extension of the file (.xml, .yml/.yaml, .json or .cvbin) determines its format (XML, YAML, JSON or
+     binary respectively). Also you can append .gz to work with compressed files, for example myHugeMatrix.xml.gz. If both
      FileStorage::WRITE and FileStorage::MEMORY flags are specified, source is used just to specify
      the output file format (e.g. mydata.xml, .yml etc.). A file name can also contain parameters.
      You can use this format, "*?base64" (e.g. "file.json?base64" (case sensitive)), as an alternative to
@@ -357,9 +359,30 @@ public:
      @param flags Mode of operation. One of FileStorage::Mode
      @param encoding Encoding of the file. Note that UTF-16 XML encoding is not supported currently and
      you should use 8-bit encoding instead of it.
+
+     The binary format (FileStorage::FORMAT_BINARY) keeps data written by FileStorage::writeRaw (e.g.
+     matrix elements) as raw aligned arrays. When such a file is read, it is mapped into memory (if it
+     is not compressed) and matrices read from it refer to the mapped data instead of copies, so
+     modifications of such matrices are visible to the subsequent reads from the same storage (but
+     never written to the file). Appending to binary files is not supported.
      */
     CV_WRAP virtual bool open(const String& filename, int flags, const String& encoding=String());
 
+    /** @brief Parses a file incrementally, reporting the nodes to the handler.
+
+     Unlike FileStorage::open, the whole document is not kept in memory: each node is released
+     after FileNodeHandler::endNode is called for it, and subtrees may be skipped by
+     FileNodeHandler::startNode. The method calls FileStorage::release before and after parsing.
+     @param filename Name of the file to parse (XML, YAML or JSON, optionally compressed with .gz) or
+     the text string to read the data from (with FileStorage::MEMORY flag). Binary files are loaded
+     as a whole, and collections visited in them are reported with their elements.
+     @param handler Receiver of the parsed nodes.
+     @param flags FileStorage::READ, optionally combined with FileStorage::MEMORY.
+     @returns true if the whole document is parsed, false if the file can't be opened or parsing
+     is stopped by the handler.
+     */
+    bool parse(const String& filename, FileNodeHandler& handler, int flags=READ);
+
     /** @brief Checks whether the file is opened.
 
      @returns true if the object is associated with the current file and false otherwise. It is a
@@ -487,7 +510,8 @@ public:
 
         FLOW      = 8,  //!< compact representation of a sequence or mapping. Used only by YAML writer
         UNIFORM   = 8,  //!< if set, means that all the collection elements are numbers of the same type (real's or int's).
-        //!< UNIFORM is used only when reading FileStorage; FLOW is used only when writing. So they share the same bit
+        //!< UNIFORM is used only when reading FileStorage; FLOW is used only when writing. So they share the same bit.
+        //!< Uniform sequences keep raw data of binary storages (see FileStorage::FORMAT_BINARY)
         EMPTY     = 16, //!< empty structure (sequence or mapping)
         NAMED     = 32  //!< the node has a name (i.e. it is element of a mapping).
     };
@@ -679,6 +703,42 @@ protected:
     size_t idx;
 };
 
+/** @brief Receives nodes of a file storage while it is parsed by FileStorage::parse.
+
+ Nodes are reported in the document order. Names and nesting levels are reported by startNode
+ before the node value is parsed, complete nodes are reported by endNode.
+ */
+class CV_EXPORTS FileNodeHandler
+{
+public:
+    //! action for the node returned by startNode()
+    enum Action
+    {
+        SKIP  = 0, //!< parse the node, but don't report it and its elements
+        VISIT = 1, //!< report elements of the collection one by one, then report the collection without elements
+        LOAD  = 2  //!< report the node with all its elements loaded
+    };
+
+    virtual ~FileNodeHandler();
+
+    /** @brief Called when a node is found.
+     @param name Name of the node, empty for sequence elements.
+     @param depth Nesting level, 0 for elements of the top-level collection.
+     @returns FileNodeHandler::Action for the node. The default implementation returns VISIT.
+     Scalar nodes are reported by endNode for both VISIT and LOAD actions.
+     */
+    virtual int startNode(const String& name, int depth);
+
+    /** @brief Called when a node is parsed.
+     The node and its elements are released after the call, so the node (and nodes obtained from it)
+     must not be used after that.
+     @param node The parsed node.
+     @param depth Nesting level of the node.
+     @returns false to stop parsing.
+     */
+    virtual bool endNode(const FileNode& node, int depth) = 0;
+};
+
 //! @} core_xml
 
 /////////////////// XML & YAML I/O implementation //////////////////
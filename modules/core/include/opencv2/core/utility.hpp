@@ -611,6 +611,75 @@ inline void parallel_for_(const Range& range, std::function<void(const Range&)>
     parallel_for_(range, ParallelLoopBodyLambdaWrapper(functor), nstripes);
 }
 
+namespace parallel {
+
+/** @brief Scoped parallelism limits for parallel_for_() calls of the current thread
+
+The context is active from its construction till destruction, so it is created as a local variable
+of the code which needs the limits. cv::setNumThreads() changes the number of threads for the whole process,
+while the context allows different parallelism for different tasks of the same process
+(e.g. a latency critical request and a background batch processing):
+@code
+    {
+        cv::parallel::ExecutionContext ctx(2);  // no more than 2 threads for the background processing
+        cv::resize(src, dst, Size(), 0.5, 0.5);
+    }
+@endcode
+Contexts can be nested, the limits of outer contexts are not exceeded. Loop bodies see the context
+of the thread which has called parallel_for_(), so nested parallel_for_() calls follow the same limits.
+cv::getNumThreads() takes the thread limit of the context into account.
+
+The context must be destroyed by the thread which has created it.
+*/
+class CV_EXPORTS ExecutionContext
+{
+public:
+    /** @brief Function which runs parallel_for_() loops instead of the parallel framework.
+
+    It receives the range of stripes, the body and the number of stripes. The body must be called for
+    non-overlapping subranges which cover the whole range before the return (from any threads).
+    Exceptions of the body are handled by the caller of the executor.
+    */
+    typedef std::function<void(const Range& range, const ParallelLoopBody& body, double nstripes)> Executor;
+
+    /** @brief Activates the context for the current thread
+
+    @param maxThreads the maximal number of threads which process a loop. 0 means no limit (see cv::getNumThreads),
+    1 means sequential processing.
+    @param grainSize the minimal number of range elements which are processed by one call of the loop body.
+    0 means no limit.
+    @param executor the function which runs the loops instead of the parallel framework. The executor of the
+    nearest outer context is used if it is empty.
+    */
+    explicit ExecutionContext(int maxThreads, int grainSize = 0, const Executor& executor = Executor());
+
+    /** @brief Restores the previous context of the current thread */
+    ~ExecutionContext();
+
+    /** @brief Returns the maximal number of threads of loops including limits of the outer contexts (0 - no limit) */
+    int getMaxThreads() const { return maxThreads_; }
+
+    /** @brief Returns the minimal number of range elements per body call including limits of the outer contexts */
+    int getGrainSize() const { return grainSize_; }
+
+    /** @brief Returns the function which runs the loops, it is empty if the parallel framework is used */
+    const Executor& getExecutor() const { return executor_; }
+
+    /** @brief Returns the active context of the current thread or NULL */
+    static const ExecutionContext* getCurrent();
+
+private:
+    int maxThreads_;
+    int grainSize_;
+    Executor executor_;
+    const ExecutionContext* previous_;
+
+    ExecutionContext(const ExecutionContext&); // disabled
+    ExecutionContext& operator=(const ExecutionContext&); // disabled
+};
+
+} // namespace parallel
+
 /////////////////////////////// forEach method of cv::Mat ////////////////////////////
 template<typename _Tp, typename Functor> inline
 void Mat::forEach_impl(const Functor& operation) {
@@ -7,6 +7,9 @@
 
 #include "../cvdef.h"
 
+#include <string>
+#include <vector>
+
 namespace cv { namespace utils {
 
 class AllocatorStatisticsInterface
@@ -24,6 +27,43 @@ public:
     virtual void resetPeakUsage() = 0;
 };
 
+/** @brief Allocation statistics of a code region
+
+fastMalloc() allocations (buffers of Mat and internal buffers) are attributed to the innermost
+CV_TRACE_FUNCTION() region of the calling thread. Allocations from parallel_for_() bodies are attributed
+to the region of the parallel_for_() caller.
+*/
+struct AllocatorRegionStatistics
+{
+    const char* name;       //!< function name, "<unknown>" for allocations outside of traced functions
+    const char* filename;   //!< source file, may be NULL
+    int line;
+    uint64_t currentUsage;  //!< allocated and not released yet
+    uint64_t totalUsage;
+    uint64_t numberOfAllocations;
+    uint64_t peakUsage;
+};
+
+/** @brief Enables collection of allocation statistics per code region
+
+Initial value is taken from OPENCV_ALLOC_REGION_STATISTICS configuration parameter (disabled by default).
+Only allocations made while collection is enabled are accounted.
+Collection requires OpenCV built with tracing support (OPENCV_TRACE), but tracing itself may be inactive.
+*/
+CV_EXPORTS void setAllocatorRegionStatisticsEnabled(bool enabled);
+CV_EXPORTS bool isAllocatorRegionStatisticsEnabled();
+
+/** @brief Returns allocation statistics of code regions, sorted by total usage (descending) */
+CV_EXPORTS std::vector<AllocatorRegionStatistics> getAllocatorRegionStatistics();
+
+/** @brief Resets total usage and number of allocations of all regions, sets peak usage = current usage */
+CV_EXPORTS void resetAllocatorRegionStatistics();
+
+/** @brief Returns text report of allocation statistics
+@param maxRegions limit of reported regions (the most allocating ones), 0 means no limit
+*/
+CV_EXPORTS std::string dumpAllocatorRegionStatistics(size_t maxRegions = 20);
+
 }} // namespace
 
 #endif // OPENCV_CORE_ALLOCATOR_STATS_HPP
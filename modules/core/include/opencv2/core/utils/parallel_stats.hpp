@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_CORE_UTILS_PARALLEL_STATS_HPP
+#define OPENCV_CORE_UTILS_PARALLEL_STATS_HPP
+
+#include "opencv2/core/cvdef.h"
+#include <string>
+#include <vector>
+
+namespace cv { namespace utils {
+
+//! @addtogroup core_utils
+//! @{
+
+/** @brief Activity of one thread of the parallel_for_() thread pool */
+struct CV_EXPORTS ParallelThreadStats
+{
+    ParallelThreadStats() : id(-1), busyTime(0), idleTime(0), tasks(0), stripes(0) {}
+
+    int id;              //!< worker index, -1 for the threads outside of the pool (callers of parallel_for_())
+    double busyTime;     //!< time of loop bodies execution (seconds)
+    double idleTime;     //!< time without loop bodies execution since creation or reset (seconds), 0 for id == -1
+    uint64 tasks;        //!< number of executed tasks (body calls)
+    uint64 stripes;      //!< number of processed stripes
+};
+
+/** @brief Statistics of parallel_for_() loops since the process start or the last resetParallelStats() call
+
+Collected by the built-in thread pool of OpenCV (pthreads parallel framework), other backends report
+only the backend name and the number of threads.
+*/
+struct CV_EXPORTS ParallelStats
+{
+    ParallelStats() : numThreads(0), jobs(0), stripes(0), avgStartLatency(0), maxStartLatency(0), avgImbalance(0), maxImbalance(0) {}
+
+    std::string backend;       //!< name of the parallel_for_() backend
+    int numThreads;            //!< cv::getNumThreads()
+
+    uint64 jobs;               //!< number of loops processed by the thread pool
+    uint64 stripes;            //!< total number of stripes of these loops
+
+    double avgStartLatency;    //!< average time from the loop submission till the start of its first task by another thread (seconds)
+    double maxStartLatency;    //!< maximal start latency (seconds)
+
+    /** average ratio of the loop duration to the average busy time of the threads which have processed the loop.
+        1 means the work is evenly distributed, larger values show waiting for the slowest thread. */
+    double avgImbalance;
+    double maxImbalance;       //!< maximal imbalance of a loop
+
+    std::vector<ParallelThreadStats> threads;
+};
+
+/** @brief Returns statistics of parallel_for_() loops */
+CV_EXPORTS ParallelStats getParallelStats();
+
+/** @brief Resets statistics of parallel_for_() loops */
+CV_EXPORTS void resetParallelStats();
+
+//! @}
+
+}} // namespace
+
+#endif // OPENCV_CORE_UTILS_PARALLEL_STATS_HPP
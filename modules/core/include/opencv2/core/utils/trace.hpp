@@ -32,6 +32,18 @@ namespace trace {
 //! Macro to trace argument value (expanded version)
 #define CV_TRACE_ARG_VALUE(arg_id, arg_name, value)
 
+/** @brief Writes completed trace regions in Chrome Trace Event format (JSON)
+
+The file can be opened in chrome://tracing or Perfetto UI (https://ui.perfetto.dev), each OpenCV thread is shown as a separate lane.
+Regions are collected into per-thread ring buffers (OPENCV_TRACE_BUFFER_SIZE events per thread) if trace is enabled
+with OPENCV_TRACE=1 and OPENCV_TRACE_FORMAT=chrome. In this mode trace is also written into OPENCV_TRACE_LOCATION + ".json" on exit.
+Use OPENCV_TRACE_DEPTH_OPENCV=0 to include nested OpenCV functions and parallel_for_() stripes.
+
+@param filename output file
+@return false if trace events are not collected or the file can't be written
+*/
+CV_EXPORTS bool writeChromeTrace(const char* filename);
+
 //! @cond IGNORED
 #define CV_TRACE_NS cv::utils::trace
 
@@ -15,8 +15,10 @@
 
 //! @cond IGNORED
 
+#include <atomic>
 #include <deque>
 #include <ostream>
+#include <vector>
 
 #define INTEL_ITTNOTIFY_API_PRIVATE 1
 #ifdef OPENCV_WITH_ITT
@@ -53,6 +55,7 @@ namespace details {
 enum RegionFlag {
     REGION_FLAG__NEED_STACK_POP = (1 << 0),
     REGION_FLAG__ACTIVE = (1 << 1),
+    REGION_FLAG__ALLOCATION_STATS = (1 << 2),  // region is pushed to the stack of allocator statistics regions
 
     ENUM_REGION_FLAG_IMPL_FORCE_INT = INT_MAX
 };
@@ -231,6 +234,46 @@ std::ostream& operator<<(std::ostream& out, const RegionStatisticsStatus& s)
     return out;
 }
 
+//! Completed region (OPENCV_TRACE_FORMAT=chrome)
+struct TraceEvent
+{
+    const Region::LocationStaticStorage* location;
+    int64 beginTimestamp;
+    int64 duration;
+};
+
+/** @brief Ring buffer of completed regions of a thread
+ *
+ * Single writer (owner thread) never waits for readers.
+ * Readers drop events which may be overwritten while they are copied.
+ */
+class TraceEventBuffer
+{
+public:
+    explicit TraceEventBuffer(size_t capacity) :
+        events_(std::max(capacity, (size_t)1))
+    {
+        head_.store(0, std::memory_order_relaxed);
+    }
+
+    //! returns NULL if event buffers are not used
+    static TraceEventBuffer* create();
+
+    inline void put(const TraceEvent& event)
+    {
+        uint64 head = head_.load(std::memory_order_relaxed);
+        events_[head % events_.size()] = event;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    //! appends available events to the result, 'dropped' is the number of overwritten events
+    void read(std::vector<TraceEvent>& result, uint64& dropped) const;
+
+protected:
+    std::vector<TraceEvent> events_;
+    std::atomic<uint64> head_;  // number of written events
+};
+
 //! TraceManager for local thread
 struct TraceManagerThreadLocal
 {
@@ -267,13 +310,16 @@ struct TraceManagerThreadLocal
 
     mutable cv::Ptr<TraceStorage> storage;
 
+    const cv::Ptr<TraceEventBuffer> eventBuffer;  // OPENCV_TRACE_FORMAT=chrome
+
     TraceManagerThreadLocal() :
         threadID(cv::utils::getThreadID()),
         region_counter(0), totalSkippedEvents(0),
         currentActiveRegion(NULL),
         regionDepth(0),
         regionDepthOpenCV(0),
-        parallel_for_stack_size(0)
+        parallel_for_stack_size(0),
+        eventBuffer(TraceEventBuffer::create())
     {
     }
 
@@ -400,4 +400,18 @@ INSTANTIATE_TEST_CASE_P(/*nothing*/ , BinaryOpTest,
     )
 );
 
+INSTANTIATE_TEST_CASE_P(Large, BinaryOpTest,
+    testing::Combine(
+        testing::Values(sz2160p, sz4320p),
+        testing::Values(CV_8UC1, CV_8UC3, CV_32FC1)
+    )
+);
+
+INSTANTIATE_TEST_CASE_P(FP16, BinaryOpTest,
+    testing::Combine(
+        testing::Values(szVGA, sz720p, sz1080p),
+        testing::Values(CV_16FC1, CV_16FC3)
+    )
+);
+
 } // namespace
@@ -157,6 +157,32 @@ INSTANTIATE_TEST_CASE_P(/*nothing*/ , KMeans,
     )
 );
 
+CV_ENUM(GemmFlag, 0, GEMM_1_T, GEMM_2_T, GEMM_1_T|GEMM_2_T)
+
+typedef perf::TestBaseWithParam< testing::tuple<int, GemmFlag, MatType> > Gemm;
+
+PERF_TEST_P_(Gemm, square)
+{
+    const int n = testing::get<0>(GetParam());
+    const int flags = testing::get<1>(GetParam());
+    const int type = testing::get<2>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), d(n, n, type);
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+
+    TEST_CYCLE() cv::gemm(a, b, 1.0, c, 0.5, d, flags);
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/*nothing*/ , Gemm,
+    testing::Combine(
+        testing::Values(64, 256, 1024),
+        GemmFlag::all(),
+        testing::Values(CV_32FC1, CV_64FC1)
+    )
+);
+
 }
 
 } // namespace
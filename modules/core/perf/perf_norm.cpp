@@ -103,6 +103,51 @@ PERF_TEST_P(Size_MatType_NormType, norm2_mask,
     SANITY_CHECK(n, 1e-5, ERROR_RELATIVE);
 }
 
+PERF_TEST_P(Size_MatType_NormType, norm_large,
+            testing::Combine(
+                testing::Values(sz2160p, sz4320p),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::Values((int)NORM_INF, (int)NORM_L1, (int)NORM_L2)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int normType = get<2>(GetParam());
+
+    Mat src(sz, matType);
+    double n;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() n = cv::norm(src, normType);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_MatType_NormType, norm2_large,
+            testing::Combine(
+                testing::Values(sz2160p, sz4320p),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::Values((int)NORM_INF, (int)NORM_L1, (int)NORM_L2)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int normType = get<2>(GetParam());
+
+    Mat src1(sz, matType);
+    Mat src2(sz, matType);
+    double n;
+
+    declare.in(src1, src2, WARMUP_RNG);
+
+    TEST_CYCLE() n = cv::norm(src1, src2, normType);
+
+    SANITY_CHECK_NOTHING();
+}
+
 namespace {
 typedef tuple<NormType, MatType, Size> PerfHamming_t;
 typedef perf::TestBaseWithParam<PerfHamming_t> PerfHamming;
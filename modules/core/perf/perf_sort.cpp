@@ -47,4 +47,49 @@ PERF_TEST_P(sortIdxFixture, sorIdx, TYPICAL_MATS_SORT)
     SANITY_CHECK_NOTHING();
 }
 
+typedef sortFixture sortLargeFixture;
+
+PERF_TEST_P(sortLargeFixture, sort_large,
+            testing::Combine(testing::Values(Size(1 << 20, 1), Size(4096, 256)),
+                             testing::Values(CV_8UC1, CV_32SC1, CV_32FC1, CV_64FC1),
+                             testing::Values(SORT_EVERY_ROW | SORT_ASCENDING, SORT_EVERY_ROW | SORT_DESCENDING)))
+{
+    const sortParams params = GetParam();
+    const Size sz = get<0>(params);
+    const int type = get<1>(params), flags = get<2>(params);
+
+    cv::Mat a(sz, type), b(sz, type), idx(sz, CV_32SC1);
+
+    declare.in(a, WARMUP_RNG).out(b, idx);
+
+    TEST_CYCLE()
+    {
+        cv::sort(a, b, flags);
+        cv::sortIdx(a, idx, flags);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple<Size, MatType, int> topKParams;
+typedef TestBaseWithParam<topKParams> topKFixture;
+
+PERF_TEST_P(topKFixture, topK,
+            testing::Combine(testing::Values(Size(1 << 20, 1), Size(4096, 256)),
+                             testing::Values(CV_8UC1, CV_32SC1, CV_32FC1),
+                             testing::Values(1, 10, 100)))
+{
+    const topKParams params = GetParam();
+    const Size sz = get<0>(params);
+    const int type = get<1>(params), k = get<2>(params);
+
+    cv::Mat a(sz, type), values, indices;
+
+    declare.in(a, WARMUP_RNG);
+
+    TEST_CYCLE() cv::topK(a, k, 1, values, indices);
+
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
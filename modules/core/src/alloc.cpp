@@ -52,6 +52,8 @@
 #include "opencv2/core/utils/allocator_stats.impl.hpp"
 #undef CV__ALLOCATOR_STATS_LOG
 
+#include <sstream>
+
 //#define OPENCV_ALLOC_ENABLE_STATISTICS
 #define OPENCV_ALLOC_STATISTICS_LIMIT 4096  // don't track buffers less than N bytes
 
@@ -62,8 +64,28 @@
 #include <malloc.h>
 #endif
 
-#ifdef OPENCV_ALLOC_ENABLE_STATISTICS
+#ifdef OPENCV_TRACE
+#define CV_ALLOC_REGION_STATISTICS 1  // see cv::utils::setAllocatorRegionStatisticsEnabled()
+#endif
+
+#if defined OPENCV_ALLOC_ENABLE_STATISTICS || defined CV_ALLOC_REGION_STATISTICS
+#include <map>
+#include <atomic>
+#endif
+
+#if defined(__linux__) && !defined(__ANDROID__) \
+    && !defined(CV_STATIC_ANALYSIS) \
+    && !defined(OPENCV_ENABLE_MEMORY_SANITIZER) \
+    && !defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
+#define CV_ALLOC_LARGE_BUFFER_POLICY 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <atomic>
+#include <fstream>
 #include <map>
+#include "parallel_impl.hpp"
 #endif
 
 namespace cv {
@@ -121,13 +143,233 @@ static const bool g_force_initialization_memalign_flag
 
 #endif
 
-#ifdef OPENCV_ALLOC_ENABLE_STATISTICS
+#ifdef CV_ALLOC_LARGE_BUFFER_POLICY
+
+/* Placement of large buffers (OPENCV_ALLOC_LARGE_THRESHOLD bytes and more, 4Mb by default).
+   These buffers are mapped directly from OS (mmap()) if any of the policies is enabled:
+   - OPENCV_ALLOC_HUGE_PAGES=none|thp|hugetlb
+       thp: buffers are aligned to the huge page size and marked for transparent huge pages via madvise(MADV_HUGEPAGE)
+       hugetlb: buffers are mapped from the reserved pool of huge pages (MAP_HUGETLB), 'thp' is used if the pool is exhausted
+   - OPENCV_ALLOC_NUMA=default|first_touch|interleave
+       first_touch: pages are touched by parallel_for_() threads, so they are placed on the NUMA nodes of these threads
+                    (see also OPENCV_THREAD_POOL_AFFINITY)
+       interleave: pages are distributed over all NUMA nodes (mbind(MPOL_INTERLEAVE))
+*/
+
+enum { ALLOC_HUGE_PAGES_NONE = 0, ALLOC_HUGE_PAGES_THP, ALLOC_HUGE_PAGES_HUGETLB };
+enum { ALLOC_NUMA_DEFAULT = 0, ALLOC_NUMA_FIRST_TOUCH, ALLOC_NUMA_INTERLEAVE };
+
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+#define CV_MPOL_INTERLEAVE 3  // linux/mempolicy.h
+
+struct LargeBufferPolicy
+{
+    size_t threshold;  // (size_t)-1 if large buffers are allocated as regular ones
+    int hugePages;
+    int numa;
+    size_t pageSize;
+    size_t hugePageSize;
+    std::vector<unsigned long> nodeMask;  // for ALLOC_NUMA_INTERLEAVE
+
+    LargeBufferPolicy() :
+        threshold((size_t)-1),
+        hugePages(ALLOC_HUGE_PAGES_NONE),
+        numa(ALLOC_NUMA_DEFAULT),
+        pageSize(4096),
+        hugePageSize((size_t)2 << 20)
+    {
+        std::string value = cv::utils::getConfigurationParameterString("OPENCV_ALLOC_HUGE_PAGES", "none");
+        if (value == "thp")
+            hugePages = ALLOC_HUGE_PAGES_THP;
+        else if (value == "hugetlb")
+            hugePages = ALLOC_HUGE_PAGES_HUGETLB;
+        else if (value != "none" && !value.empty())
+            CV_LOG_WARNING(NULL, "Unknown OPENCV_ALLOC_HUGE_PAGES value: " << value << " (supported: none, thp, hugetlb)");
+
+        value = cv::utils::getConfigurationParameterString("OPENCV_ALLOC_NUMA", "default");
+        if (value == "first_touch")
+            numa = ALLOC_NUMA_FIRST_TOUCH;
+        else if (value == "interleave")
+            numa = ALLOC_NUMA_INTERLEAVE;
+        else if (value != "default" && !value.empty())
+            CV_LOG_WARNING(NULL, "Unknown OPENCV_ALLOC_NUMA value: " << value << " (supported: default, first_touch, interleave)");
+
+        if (numa == ALLOC_NUMA_INTERLEAVE)
+        {
+            std::vector<int> nodes = getNUMANodes();
+            const int bits = (int)(sizeof(unsigned long) * 8);
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i] < 0)
+                    continue;
+                if (nodeMask.size() <= (size_t)(nodes[i] / bits))
+                    nodeMask.resize(nodes[i] / bits + 1, 0);
+                nodeMask[nodes[i] / bits] |= 1UL << (nodes[i] % bits);
+            }
+            if (nodes.size() < 2)
+                numa = ALLOC_NUMA_DEFAULT;  // nothing to interleave
+        }
+
+        if (hugePages == ALLOC_HUGE_PAGES_NONE && numa == ALLOC_NUMA_DEFAULT)
+            return;
+        threshold = cv::utils::getConfigurationParameterSizeT("OPENCV_ALLOC_LARGE_THRESHOLD", (size_t)4 << 20);
+
+        long sz = sysconf(_SC_PAGESIZE);
+        if (sz > 0)
+            pageSize = (size_t)sz;
+        std::ifstream meminfo("/proc/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line))
+        {
+            size_t kb = 0;
+            if (sscanf(line.c_str(), "Hugepagesize: %zu kB", &kb) == 1 && kb > 0)
+            {
+                hugePageSize = kb << 10;
+                break;
+            }
+        }
+    }
+};
+
+static const LargeBufferPolicy& getLargeBufferPolicy()
+{
+    static LargeBufferPolicy* policy = allocSingletonNew<LargeBufferPolicy>();  // should not call fastMalloc() internally
+    return *policy;
+}
+
+static std::atomic<int> g_mappedBuffersCount(0);
+
+static Mutex& getMappedBuffersMutex()
+{
+    static Mutex* p_mutex = allocSingletonNew<Mutex>();
+    return *p_mutex;
+}
+
+static std::map<void*, size_t>& getMappedBuffers()  // guarded by getMappedBuffersMutex()
+{
+    static std::map<void*, size_t>* p_buffers = allocSingletonNew<std::map<void*, size_t> >();
+    return *p_buffers;
+}
+
+class TouchPagesBody : public ParallelLoopBody
+{
+public:
+    TouchPagesBody(uchar* data_, size_t size_, size_t chunkSize_, size_t pageSize_) :
+        data(data_), size(size_), chunkSize(chunkSize_), pageSize(pageSize_)
+    {}
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        size_t end = std::min((size_t)range.end * chunkSize, size);
+        for (size_t ofs = (size_t)range.start * chunkSize; ofs < end; ofs += pageSize)
+            data[ofs] = 0;
+    }
+protected:
+    uchar* data;
+    size_t size;
+    size_t chunkSize;
+    size_t pageSize;
+};
+
+static void* mapLargeBuffer(const LargeBufferPolicy& policy, size_t size)
+{
+    const size_t mappedSize = alignSize(size, (int)policy.pageSize);
+    void* ptr = NULL;
+    size_t chunkSize = policy.pageSize;
+    if (policy.hugePages == ALLOC_HUGE_PAGES_HUGETLB)
+    {
+        size_t hugeSize = alignSize(size, (int)policy.hugePageSize);
+        ptr = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr == MAP_FAILED)
+        {
+            CV_LOG_VERBOSE(NULL, 0, "alloc.cpp: can't allocate " << size << " bytes from hugetlb pool, errno=" << errno);
+            ptr = NULL;
+        }
+        else
+        {
+            AutoLock lock(getMappedBuffersMutex());
+            getMappedBuffers()[ptr] = hugeSize;
+            chunkSize = policy.hugePageSize;
+        }
+    }
+    if (!ptr)
+    {
+        size_t alignment = policy.hugePages != ALLOC_HUGE_PAGES_NONE ? policy.hugePageSize : policy.pageSize;
+        size_t reserved = mappedSize + alignment - policy.pageSize;
+        uchar* base = (uchar*)mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ((void*)base == MAP_FAILED)
+            return NULL;
+        uchar* aligned = alignPtr(base, (int)alignment);
+        if (aligned != base)
+            munmap(base, aligned - base);
+        if (base + reserved != aligned + mappedSize)
+            munmap(aligned + mappedSize, (base + reserved) - (aligned + mappedSize));
+        ptr = aligned;
+        if (policy.hugePages != ALLOC_HUGE_PAGES_NONE)
+        {
+            if (madvise(ptr, mappedSize, MADV_HUGEPAGE) == 0)
+                chunkSize = policy.hugePageSize;
+        }
+        AutoLock lock(getMappedBuffersMutex());
+        getMappedBuffers()[ptr] = mappedSize;
+    }
+    g_mappedBuffersCount++;
+
+    if (policy.numa == ALLOC_NUMA_INTERLEAVE)
+    {
+        const unsigned long maxnode = (unsigned long)(policy.nodeMask.size() * sizeof(unsigned long) * 8 + 1);
+        if (syscall(SYS_mbind, ptr, mappedSize, CV_MPOL_INTERLEAVE, &policy.nodeMask[0], maxnode, 0) != 0)
+            CV_LOG_VERBOSE(NULL, 0, "alloc.cpp: mbind(MPOL_INTERLEAVE) failed, errno=" << errno);
+    }
+    else if (policy.numa == ALLOC_NUMA_FIRST_TOUCH)
+    {
+        int chunks = (int)((size + chunkSize - 1) / chunkSize);
+        parallel_for_(Range(0, chunks), TouchPagesBody((uchar*)ptr, size, chunkSize, policy.pageSize));
+    }
+    return ptr;
+}
+
+// returns false if buffer is not allocated by mapLargeBuffer()
+static bool unmapLargeBuffer(void* ptr)
+{
+    size_t mappedSize = 0;
+    {
+        AutoLock lock(getMappedBuffersMutex());
+        std::map<void*, size_t>& buffers = getMappedBuffers();
+        std::map<void*, size_t>::iterator i = buffers.find(ptr);
+        if (i == buffers.end())
+            return false;
+        mappedSize = i->second;
+        buffers.erase(i);
+    }
+    g_mappedBuffersCount--;
+    munmap(ptr, mappedSize);
+    return true;
+}
+
+#endif // CV_ALLOC_LARGE_BUFFER_POLICY
+
+#if defined OPENCV_ALLOC_ENABLE_STATISTICS || defined CV_ALLOC_REGION_STATISTICS
 static inline
 void* fastMalloc_(size_t size)
 #else
 void* fastMalloc(size_t size)
 #endif
 {
+#ifdef CV_ALLOC_LARGE_BUFFER_POLICY
+    const LargeBufferPolicy& policy = getLargeBufferPolicy();
+    if (size >= policy.threshold)
+    {
+        void* ptr = mapLargeBuffer(policy, size);
+        if(!ptr)
+            return OutOfMemoryError(size);
+        return ptr;
+    }
+#endif
 #ifdef HAVE_POSIX_MEMALIGN
     if (isAlignedAllocationEnabled())
     {
@@ -155,13 +397,21 @@ void* fastMalloc(size_t size)
     return adata;
 }
 
-#ifdef OPENCV_ALLOC_ENABLE_STATISTICS
+#if defined OPENCV_ALLOC_ENABLE_STATISTICS || defined CV_ALLOC_REGION_STATISTICS
 static inline
 void fastFree_(void* ptr)
 #else
 void fastFree(void* ptr)
 #endif
 {
+#ifdef CV_ALLOC_LARGE_BUFFER_POLICY
+    // mapped buffers are page aligned, regular ones are checked only if they are page aligned by chance
+    if (g_mappedBuffersCount > 0 && ptr && ((size_t)ptr & (getLargeBufferPolicy().pageSize - 1)) == 0)
+    {
+        if (unmapLargeBuffer(ptr))
+            return;
+    }
+#endif
 #if defined HAVE_POSIX_MEMALIGN || defined HAVE_MEMALIGN
     if (isAlignedAllocationEnabled())
     {
@@ -190,20 +440,93 @@ Mutex& getAllocationStatisticsMutex()
 
 static std::map<void*, size_t> allocated_buffers;  // guarded by getAllocationStatisticsMutex()
 
+#endif // OPENCV_ALLOC_ENABLE_STATISTICS
+
+#ifdef CV_ALLOC_REGION_STATISTICS
+
+typedef utils::trace::details::Region::LocationStaticStorage TraceLocation;
+
+struct RegionAllocationStatistics
+{
+    RegionAllocationStatistics() : curr(0), total(0), total_allocs(0), peak(0) {}
+    uint64_t curr, total, total_allocs, peak;
+};
+
+struct RegionAllocatedBuffer
+{
+    size_t size;
+    const TraceLocation* location;
+};
+
+struct RegionStatisticsStorage
+{
+    Mutex mutex;
+    std::map<const TraceLocation*, RegionAllocationStatistics> regions;  // NULL - allocations outside of traced regions
+    std::map<void*, RegionAllocatedBuffer> buffers;
+};
+
+static RegionStatisticsStorage& getRegionStatisticsStorage()
+{
+    static RegionStatisticsStorage* storage = allocSingletonNew<RegionStatisticsStorage>();
+    return *storage;
+}
+
+static std::atomic<bool> g_regionStatisticsEnabled(utils::getConfigurationParameterBool("OPENCV_ALLOC_REGION_STATISTICS", false));
+static std::atomic<int> g_regionBuffersCount(0);  // to skip lookups in fastFree() if there are no tracked buffers
+
+static void onRegionAllocate(void* ptr, size_t size)
+{
+    const TraceLocation* location = getCoreTlsData().getAllocationRegion();
+    RegionStatisticsStorage& storage = getRegionStatisticsStorage();
+    cv::AutoLock lock(storage.mutex);
+    RegionAllocatedBuffer& buffer = storage.buffers[ptr];
+    buffer.size = size;
+    buffer.location = location;
+    RegionAllocationStatistics& stat = storage.regions[location];
+    stat.curr += size;
+    stat.peak = std::max(stat.peak, stat.curr);
+    stat.total += size;
+    stat.total_allocs++;
+    g_regionBuffersCount++;
+}
+
+static void onRegionFree(void* ptr)
+{
+    RegionStatisticsStorage& storage = getRegionStatisticsStorage();
+    cv::AutoLock lock(storage.mutex);
+    std::map<void*, RegionAllocatedBuffer>::iterator i = storage.buffers.find(ptr);
+    if (i == storage.buffers.end())
+        return;
+    storage.regions[i->second.location].curr -= i->second.size;
+    storage.buffers.erase(i);
+    g_regionBuffersCount--;
+}
+
+#endif // CV_ALLOC_REGION_STATISTICS
+
+#if defined OPENCV_ALLOC_ENABLE_STATISTICS || defined CV_ALLOC_REGION_STATISTICS
+
 void* fastMalloc(size_t size)
 {
     void* res = fastMalloc_(size);
+#ifdef OPENCV_ALLOC_ENABLE_STATISTICS
     if (res && size >= OPENCV_ALLOC_STATISTICS_LIMIT)
     {
         cv::AutoLock lock(getAllocationStatisticsMutex());
         allocated_buffers.insert(std::make_pair(res, size));
         allocator_stats.onAllocate(size);
     }
+#endif
+#ifdef CV_ALLOC_REGION_STATISTICS
+    if (res && g_regionStatisticsEnabled.load(std::memory_order_relaxed))
+        onRegionAllocate(res, size);
+#endif
     return res;
 }
 
 void fastFree(void* ptr)
 {
+#ifdef OPENCV_ALLOC_ENABLE_STATISTICS
     {
         cv::AutoLock lock(getAllocationStatisticsMutex());
         std::map<void*, size_t>::iterator i = allocated_buffers.find(ptr);
@@ -214,10 +537,117 @@ void fastFree(void* ptr)
             allocated_buffers.erase(i);
         }
     }
+#endif
+#ifdef CV_ALLOC_REGION_STATISTICS
+    if (ptr && g_regionBuffersCount.load(std::memory_order_relaxed) > 0)
+        onRegionFree(ptr);
+#endif
     fastFree_(ptr);
 }
 
-#endif // OPENCV_ALLOC_ENABLE_STATISTICS
+#endif
+
+namespace utils {
+
+void setAllocatorRegionStatisticsEnabled(bool enabled)
+{
+#ifdef CV_ALLOC_REGION_STATISTICS
+    g_regionStatisticsEnabled = enabled;
+#else
+    if (enabled)
+        CV_LOG_WARNING(NULL, "Allocator region statistics are not available: OpenCV is built without tracing support");
+#endif
+}
+
+bool isAllocatorRegionStatisticsEnabled()
+{
+#ifdef CV_ALLOC_REGION_STATISTICS
+    return g_regionStatisticsEnabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+#ifdef CV_ALLOC_REGION_STATISTICS
+static bool compareRegionsByTotalUsage(const AllocatorRegionStatistics& a, const AllocatorRegionStatistics& b)
+{
+    return a.totalUsage > b.totalUsage;
+}
+#endif
+
+std::vector<AllocatorRegionStatistics> getAllocatorRegionStatistics()
+{
+    std::vector<AllocatorRegionStatistics> result;
+#ifdef CV_ALLOC_REGION_STATISTICS
+    RegionStatisticsStorage& storage = getRegionStatisticsStorage();
+    {
+        cv::AutoLock lock(storage.mutex);
+        result.reserve(storage.regions.size());
+        std::map<const TraceLocation*, RegionAllocationStatistics>::const_iterator i = storage.regions.begin();
+        for (; i != storage.regions.end(); ++i)
+        {
+            const TraceLocation* location = i->first;
+            const RegionAllocationStatistics& stat = i->second;
+            AllocatorRegionStatistics r;
+            r.name = location ? location->name : "<unknown>";
+            r.filename = location ? location->filename : NULL;
+            r.line = location ? location->line : 0;
+            r.currentUsage = stat.curr;
+            r.totalUsage = stat.total;
+            r.numberOfAllocations = stat.total_allocs;
+            r.peakUsage = stat.peak;
+            result.push_back(r);
+        }
+    }
+    std::sort(result.begin(), result.end(), compareRegionsByTotalUsage);
+#endif
+    return result;
+}
+
+void resetAllocatorRegionStatistics()
+{
+#ifdef CV_ALLOC_REGION_STATISTICS
+    RegionStatisticsStorage& storage = getRegionStatisticsStorage();
+    cv::AutoLock lock(storage.mutex);
+    std::map<const TraceLocation*, RegionAllocationStatistics>::iterator i = storage.regions.begin();
+    while (i != storage.regions.end())
+    {
+        RegionAllocationStatistics& stat = i->second;
+        if (stat.curr == 0)
+        {
+            storage.regions.erase(i++);
+            continue;
+        }
+        stat.total = 0;
+        stat.total_allocs = 0;
+        stat.peak = stat.curr;
+        ++i;
+    }
+#endif
+}
+
+std::string dumpAllocatorRegionStatistics(size_t maxRegions)
+{
+    std::vector<AllocatorRegionStatistics> stats = getAllocatorRegionStatistics();
+    std::ostringstream out;
+    out << "Allocations by region (" << stats.size() << " regions):" << std::endl;
+    out << cv::format("%14s %10s %14s %14s  %s", "total", "count", "peak", "current", "region") << std::endl;
+    size_t n = maxRegions > 0 ? std::min(maxRegions, stats.size()) : stats.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        const AllocatorRegionStatistics& r = stats[i];
+        out << cv::format("%14llu %10llu %14llu %14llu  ",
+                (unsigned long long)r.totalUsage, (unsigned long long)r.numberOfAllocations,
+                (unsigned long long)r.peakUsage, (unsigned long long)r.currentUsage)
+            << r.name;
+        if (r.filename)
+            out << " (" << r.filename << ":" << r.line << ")";
+        out << std::endl;
+    }
+    return out.str();
+}
+
+} // namespace utils
 
 } // namespace
 
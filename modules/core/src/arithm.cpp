@@ -49,6 +49,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include <opencv2/core/utils/configuration.private.hpp>
 
 namespace cv
 {
@@ -77,6 +78,94 @@ void convertAndUnrollScalar( const Mat& sc, int buftype, uchar* scbuf, size_t bl
 }
 
 
+/****************************************************************************************\
+*                         parallel execution of element-wise kernels                     *
+\****************************************************************************************/
+
+// element-wise operations are memory bound, so the arrays are split between threads only when
+// they are large enough to amortize the thread wake-up (sizes are in bytes of the largest operand)
+static size_t CV_ARITHM_PARALLEL_THRESHOLD = utils::getConfigurationParameterSizeT("OPENCV_ARITHM_PARALLEL_THRESHOLD", 1 << 20);
+static size_t CV_ARITHM_PARALLEL_GRANULARITY = utils::getConfigurationParameterSizeT("OPENCV_ARITHM_PARALLEL_GRANULARITY", 1 << 18);
+
+// Runs a BinaryFuncC kernel over horizontal stripes of the image (when height > 1)
+// or over runs of blockWidth elements of a single continuous row (when height == 1).
+// In the latter case src2 may be an unrolled scalar of blockWidth elements,
+// which is then passed to every run.
+class ArithmStripeInvoker : public ParallelLoopBody
+{
+public:
+    ArithmStripeInvoker(BinaryFuncC _func, const uchar* _src1, size_t _step1, size_t _esz1,
+                        const uchar* _src2, size_t _step2, size_t _esz2,
+                        uchar* _dst, size_t _step, size_t _dsz,
+                        Size _sz, int _blockWidth, void* _usrdata,
+                        bool _scalar2 = false, bool _swapped12 = false )
+        : func(_func), src1(_src1), src2(_src2), dst(_dst), step1(_step1), step2(_step2), step(_step),
+          esz1(_esz1), esz2(_esz2), dsz(_dsz), sz(_sz), blockWidth(_blockWidth), usrdata(_usrdata),
+          scalar2(_scalar2), swapped12(_swapped12)
+    {
+        CV_Assert( sz.height == 1 || !scalar2 );
+    }
+
+    int blocks() const
+    {
+        return sz.height > 1 ? sz.height : (sz.width + blockWidth - 1)/blockWidth;
+    }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        if( sz.height > 1 )
+        {
+            func( src1 + step1*range.start, step1, src2 + step2*range.start, step2,
+                  dst + step*range.start, step, sz.width, range.end - range.start, usrdata );
+            return;
+        }
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int x = i*blockWidth, w = std::min(sz.width - x, blockWidth);
+            const uchar* sptr1 = src1 + esz1*x;
+            const uchar* sptr2 = scalar2 ? src2 : src2 + esz2*x;
+            if( swapped12 )
+                std::swap(sptr1, sptr2);
+            func( sptr1, step1, sptr2, step2, dst + dsz*x, step, w, 1, usrdata );
+        }
+    }
+
+    void run() const
+    {
+        Range all(0, blocks());
+        size_t total = (size_t)sz.width*sz.height*std::max(std::max(esz1, esz2), dsz);
+        if( total >= CV_ARITHM_PARALLEL_THRESHOLD && all.end > 1 )
+            parallel_for_(all, *this, (double)divUp(total, CV_ARITHM_PARALLEL_GRANULARITY));
+        else
+            (*this)(all);
+    }
+
+private:
+    BinaryFuncC func;
+    const uchar *src1, *src2;
+    uchar* dst;
+    size_t step1, step2, step;
+    size_t esz1, esz2, dsz;
+    Size sz;
+    int blockWidth;
+    void* usrdata;
+    bool scalar2, swapped12;
+};
+
+// continuous rows are processed in runs of this many bytes, it sets the finest split of such rows
+enum { ARITHM_STRIPE_BLOCK_SIZE = 1 << 16 };
+
+static void runArithmKernel( BinaryFuncC func, const Mat& src1, const Mat& src2, Mat& dst,
+                             Size sz, size_t esz1, size_t dsz, void* usrdata )
+{
+    ArithmStripeInvoker invoker(func, src1.ptr(), src1.step, esz1, src2.ptr(), src2.step, esz1,
+                                dst.ptr(), dst.step, dsz, sz,
+                                (int)std::max((size_t)1, ARITHM_STRIPE_BLOCK_SIZE/std::max(esz1, dsz)),
+                                usrdata);
+    invoker.run();
+}
+
 enum { OCL_OP_ADD=0, OCL_OP_SUB=1, OCL_OP_RSUB=2, OCL_OP_ABSDIFF=3, OCL_OP_MUL=4,
        OCL_OP_MUL_SCALE=5, OCL_OP_DIV_SCALE=6, OCL_OP_RECIP_SCALE=7, OCL_OP_ADDW=8,
        OCL_OP_AND=9, OCL_OP_OR=10, OCL_OP_XOR=11, OCL_OP_NOT=12, OCL_OP_MIN=13, OCL_OP_MAX=14,
@@ -209,7 +298,8 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
         if (len < INT_MAX)  // FIXIT similar code below doesn't have that check
         {
             sz.width = (int)len;
-            func(src1.ptr(), src1.step, src2.ptr(), src2.step, dst.ptr(), dst.step, sz.width, sz.height, 0);
+            size_t esz1 = CV_ELEM_SIZE(type1)/cn;
+            runArithmKernel(func, src1, src2, dst, sz, esz1, esz1, 0);
             return;
         }
     }
@@ -327,6 +417,16 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
 
         convertAndUnrollScalar( src2, src1.type(), scbuf, blocksize);
 
+        if( !haveMask && it.nplanes == 1 && total*cn < INT_MAX )
+        {
+            // the unrolled scalar is read-only here, so the threads can share it
+            size_t esz1 = esz/cn;
+            ArithmStripeInvoker invoker(func, ptrs[0], 0, esz1, scbuf, 0, esz1, ptrs[1], 0, esz1,
+                                        Size((int)(total*cn), 1), (int)(blocksize*cn), 0, true);
+            invoker.run();
+            return;
+        }
+
         for( size_t i = 0; i < it.nplanes; i++, ++it )
         {
             for( size_t j = 0; j < total; j += blocksize )
@@ -355,7 +455,7 @@ static BinaryFuncC* getMaxTab()
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::max16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::max16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::max32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::max32f), (BinaryFuncC)cv::hal::max64f,
-        0
+        (BinaryFuncC)cv::hal::max16f
     };
 
     return maxTab;
@@ -369,7 +469,7 @@ static BinaryFuncC* getMinTab()
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::min16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::min16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::min32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::min32f), (BinaryFuncC)cv::hal::min64f,
-        0
+        (BinaryFuncC)cv::hal::min16f
     };
 
     return minTab;
@@ -637,7 +737,8 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
         Mat src1 = psrc1->getMat(), src2 = psrc2->getMat(), dst = _dst.getMat();
         Size sz = getContinuousSize2D(src1, src2, dst, src1.channels());
-        tab[depth1](src1.ptr(), src1.step, src2.ptr(), src2.step, dst.ptr(), dst.step, sz.width, sz.height, usrdata);
+        size_t esz1 = CV_ELEM_SIZE1(type1);
+        runArithmKernel(tab[depth1], src1, src2, dst, sz, esz1, esz1, usrdata);
         return;
     }
 
@@ -676,6 +777,8 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
             depth2 = actualScalarDepth(sc.ptr<double>(), sz2 == Size(1, 1) ? cn2 : cn);
             if( depth2 == CV_64F && (depth1 < CV_32S || depth1 == CV_32F) )
                 depth2 = CV_32F;
+            if( depth1 == CV_16F )
+                depth2 = CV_16F;
         }
         else
             depth2 = CV_64F;
@@ -696,24 +799,29 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
     }
     dtype = CV_MAT_DEPTH(dtype);
 
+    // half precision data is processed in single precision when it's mixed with other types
+    int wdepth1 = depth1 == CV_16F ? CV_32F : depth1;
+    int wdepth2 = depth2 == CV_16F ? CV_32F : depth2;
+    int wdtype = dtype == CV_16F ? CV_32F : dtype;
+
     if( depth1 == depth2 && dtype == depth1 )
         wtype = dtype;
     else if( !muldiv )
     {
-        wtype = depth1 <= CV_8S && depth2 <= CV_8S ? CV_16S :
-                depth1 <= CV_32S && depth2 <= CV_32S ? CV_32S : std::max(depth1, depth2);
-        wtype = std::max(wtype, dtype);
+        wtype = wdepth1 <= CV_8S && wdepth2 <= CV_8S ? CV_16S :
+                wdepth1 <= CV_32S && wdepth2 <= CV_32S ? CV_32S : std::max(wdepth1, wdepth2);
+        wtype = std::max(wtype, wdtype);
 
         // when the result of addition should be converted to an integer type,
         // and just one of the input arrays is floating-point, it makes sense to convert that input to integer type before the operation,
         // instead of converting the other input to floating-point and then converting the operation result back to integers.
-        if( dtype < CV_32F && (depth1 < CV_32F || depth2 < CV_32F) )
+        if( wdtype < CV_32F && (wdepth1 < CV_32F || wdepth2 < CV_32F) )
             wtype = CV_32S;
     }
     else
     {
-        wtype = std::max(depth1, std::max(depth2, CV_32F));
-        wtype = std::max(wtype, dtype);
+        wtype = std::max(wdepth1, std::max(wdepth2, CV_32F));
+        wtype = std::max(wtype, wdtype);
     }
 
     dtype = CV_MAKETYPE(dtype, cn);
@@ -841,6 +949,15 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
         convertAndUnrollScalar( src2, wtype, buf2, blocksize);
 
+        if( !haveMask && !cvtsrc1 && !cvtdst && it.nplanes == 1 && total*cn < INT_MAX )
+        {
+            // the unrolled scalar is read-only here, so the threads can share it
+            ArithmStripeInvoker invoker(func, ptrs[0], 1, esz1/cn, buf2, 1, wsz/cn, ptrs[1], 1, dsz/cn,
+                                        Size((int)(total*cn), 1), (int)(blocksize*cn), usrdata, true, swapped12);
+            invoker.run();
+            return;
+        }
+
         for( size_t i = 0; i < it.nplanes; i++, ++it )
         {
             for( size_t j = 0; j < total; j += blocksize )
@@ -893,7 +1010,7 @@ static BinaryFuncC* getAddTab()
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::add16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::add16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::add32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::add32f), (BinaryFuncC)cv::hal::add64f,
-        0
+        (BinaryFuncC)cv::hal::add16f
     };
 
     return addTab;
@@ -907,7 +1024,7 @@ static BinaryFuncC* getSubTab()
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::sub16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::sub16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::sub32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::sub32f), (BinaryFuncC)cv::hal::sub64f,
-        0
+        (BinaryFuncC)cv::hal::sub16f
     };
 
     return subTab;
@@ -921,7 +1038,7 @@ static BinaryFuncC* getAbsDiffTab()
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::absdiff16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::absdiff16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::absdiff32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::absdiff32f), (BinaryFuncC)cv::hal::absdiff64f,
-        0
+        (BinaryFuncC)cv::hal::absdiff16f
     };
 
     return absDiffTab;
@@ -972,7 +1089,7 @@ static BinaryFuncC* getMulTab()
     {
         (BinaryFuncC)cv::hal::mul8u, (BinaryFuncC)cv::hal::mul8s, (BinaryFuncC)cv::hal::mul16u,
         (BinaryFuncC)cv::hal::mul16s, (BinaryFuncC)cv::hal::mul32s, (BinaryFuncC)cv::hal::mul32f,
-        (BinaryFuncC)cv::hal::mul64f, 0
+        (BinaryFuncC)cv::hal::mul64f, (BinaryFuncC)cv::hal::mul16f
     };
 
     return mulTab;
@@ -984,7 +1101,7 @@ static BinaryFuncC* getDivTab()
     {
         (BinaryFuncC)cv::hal::div8u, (BinaryFuncC)cv::hal::div8s, (BinaryFuncC)cv::hal::div16u,
         (BinaryFuncC)cv::hal::div16s, (BinaryFuncC)cv::hal::div32s, (BinaryFuncC)cv::hal::div32f,
-        (BinaryFuncC)cv::hal::div64f, 0
+        (BinaryFuncC)cv::hal::div64f, (BinaryFuncC)cv::hal::div16f
     };
 
     return divTab;
@@ -996,7 +1113,7 @@ static BinaryFuncC* getRecipTab()
     {
         (BinaryFuncC)cv::hal::recip8u, (BinaryFuncC)cv::hal::recip8s, (BinaryFuncC)cv::hal::recip16u,
         (BinaryFuncC)cv::hal::recip16s, (BinaryFuncC)cv::hal::recip32s, (BinaryFuncC)cv::hal::recip32f,
-        (BinaryFuncC)cv::hal::recip64f, 0
+        (BinaryFuncC)cv::hal::recip64f, (BinaryFuncC)cv::hal::recip16f
     };
 
     return recipTab;
@@ -1042,7 +1159,7 @@ static BinaryFuncC* getAddWeightedTab()
     {
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::addWeighted8u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::addWeighted8s), (BinaryFuncC)GET_OPTIMIZED(cv::hal::addWeighted16u),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::addWeighted16s), (BinaryFuncC)GET_OPTIMIZED(cv::hal::addWeighted32s), (BinaryFuncC)cv::hal::addWeighted32f,
-        (BinaryFuncC)cv::hal::addWeighted64f, 0
+        (BinaryFuncC)cv::hal::addWeighted64f, (BinaryFuncC)cv::hal::addWeighted16f
     };
 
     return addWeightedTab;
@@ -1075,7 +1192,7 @@ static BinaryFuncC getCmpFunc(int depth)
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::cmp16u), (BinaryFuncC)GET_OPTIMIZED(cv::hal::cmp16s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::cmp32s),
         (BinaryFuncC)GET_OPTIMIZED(cv::hal::cmp32f), (BinaryFuncC)cv::hal::cmp64f,
-        0
+        (BinaryFuncC)cv::hal::cmp16f
     };
 
     return cmpTab[depth];
@@ -1236,8 +1353,6 @@ void cv::compare(InputArray _src1, InputArray _src2, OutputArray _dst, int op)
     Mat src1 = _src1.getMat(), src2 = _src2.getMat();
 
     int depth1 = src1.depth(), depth2 = src2.depth();
-    if (depth1 == CV_16F || depth2 == CV_16F)
-        CV_Error(Error::StsNotImplemented, "Unsupported depth value CV_16F");
 
     if( kind1 == kind2 && src1.dims <= 2 && src2.dims <= 2 && src1.size() == src2.size() && src1.type() == src2.type() )
     {
@@ -1247,7 +1362,7 @@ void cv::compare(InputArray _src1, InputArray _src2, OutputArray _dst, int op)
         Size sz = getContinuousSize2D(src1, src2, dst, src1.channels());
         BinaryFuncC cmpFn = getCmpFunc(depth1);
         CV_Assert(cmpFn);
-        cmpFn(src1.ptr(), src1.step, src2.ptr(), src2.step, dst.ptr(), dst.step, sz.width, sz.height, &op);
+        runArithmKernel(cmpFn, src1, src2, dst, sz, src1.elemSize1(), 1, &op);
         return;
     }
 
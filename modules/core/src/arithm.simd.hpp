@@ -1902,6 +1902,239 @@ void recip_loop<double, v_float64>(const double* src1, size_t step1, double* dst
 
 DEFINE_SIMD_ALL(recip, recip_loop)
 
+//=======================================
+// Half precision
+//=======================================
+
+#ifdef ARITHM_DEFINITIONS_ONLY
+
+// CV_16F data is processed by the single precision operations above:
+// the vectors are expanded to v_float32 right after loading and packed back
+// before storing, so no intermediate buffers are needed
+
+//////////////////////////// Loops /////////////////////////////////
+
+template<template<typename T1, typename Tvec> class OP>
+static void bin_loop16f(BIN_ARGS(float16_t))
+{
+    typedef OP<float, v_float32> op;
+
+    step1 /= sizeof(float16_t);
+    step2 /= sizeof(float16_t);
+    step  /= sizeof(float16_t);
+
+    for (; height--; src1 += step1, src2 += step2, dst += step)
+    {
+        int x = 0;
+
+    #if CV_SIMD
+        for (; x <= width - v_float32::nlanes; x += v_float32::nlanes)
+            v_pack_store(dst + x, op::r(vx_load_expand(src1 + x), vx_load_expand(src2 + x)));
+    #endif // CV_SIMD
+
+        for (; x < width; x++)
+            dst[x] = float16_t(op::r((float)src1[x], (float)src2[x]));
+    }
+
+    vx_cleanup();
+}
+
+template<template<typename T1, typename Tvec> class OP>
+static void cmp_loop16f(CMP_ARGS(float16_t))
+{
+    typedef OP<float, v_float32> op;
+
+    step1 /= sizeof(float16_t);
+    step2 /= sizeof(float16_t);
+
+    for (; height--; src1 += step1, src2 += step2, dst += step)
+    {
+        int x = 0;
+
+    #if CV_SIMD
+        for (; x <= width - v_int16::nlanes; x += v_int16::nlanes)
+        {
+            v_float32 a = op::r(vx_load_expand(src1 + x), vx_load_expand(src2 + x));
+            v_float32 b = op::r(vx_load_expand(src1 + x + v_float32::nlanes),
+                                vx_load_expand(src2 + x + v_float32::nlanes));
+            v_pack_store((schar*)(dst + x), v_pack(v_reinterpret_as_s32(a), v_reinterpret_as_s32(b)));
+        }
+    #endif // CV_SIMD
+
+        for (; x < width; x++)
+            dst[x] = op::r((float)src1[x], (float)src2[x]);
+    }
+
+    vx_cleanup();
+}
+
+static void cmp_loop16f(CMP_ARGS(float16_t), int cmpop)
+{
+    switch(cmpop)
+    {
+    case CMP_LT:
+        cmp_loop16f<op_cmplt>(src1, step1, src2, step2, dst, step, width, height);
+        break;
+    case CMP_GT:
+        cmp_loop16f<op_cmplt>(src2, step2, src1, step1, dst, step, width, height);
+        break;
+    case CMP_LE:
+        cmp_loop16f<op_cmple>(src1, step1, src2, step2, dst, step, width, height);
+        break;
+    case CMP_GE:
+        cmp_loop16f<op_cmple>(src2, step2, src1, step1, dst, step, width, height);
+        break;
+    case CMP_EQ:
+        cmp_loop16f<op_cmpeq>(src1, step1, src2, step2, dst, step, width, height);
+        break;
+    default:
+        CV_Assert(cmpop == CMP_NE);
+        cmp_loop16f<op_cmpne>(src1, step1, src2, step2, dst, step, width, height);
+        break;
+    }
+}
+
+template<template<typename T1, typename T2, typename Tvec> class OP>
+static void scalar_loop16f(BIN_ARGS(float16_t), const float* scalar)
+{
+    typedef OP<float, float, v_float32> op;
+
+    step1 /= sizeof(float16_t);
+    step2 /= sizeof(float16_t);
+    step  /= sizeof(float16_t);
+
+    for (; height--; src1 += step1, src2 += step2, dst += step)
+    {
+        int x = 0;
+
+    #if CV_SIMD
+        for (; x <= width - v_float32::nlanes; x += v_float32::nlanes)
+            v_pack_store(dst + x, op::r(vx_load_expand(src1 + x), vx_load_expand(src2 + x), scalar));
+    #endif // CV_SIMD
+
+        for (; x < width; x++)
+            dst[x] = float16_t(op::r((float)src1[x], (float)src2[x], scalar));
+    }
+
+    vx_cleanup();
+}
+
+// single source
+template<template<typename T1, typename T2, typename Tvec> class OP>
+static void scalar_loop16f(const float16_t* src1, size_t step1, float16_t* dst, size_t step,
+                           int width, int height, const float* scalar)
+{
+    typedef OP<float, float, v_float32> op;
+
+    step1 /= sizeof(float16_t);
+    step  /= sizeof(float16_t);
+
+    for (; height--; src1 += step1, dst += step)
+    {
+        int x = 0;
+
+    #if CV_SIMD
+        for (; x <= width - v_float32::nlanes; x += v_float32::nlanes)
+            v_pack_store(dst + x, op::r(vx_load_expand(src1 + x), scalar));
+    #endif // CV_SIMD
+
+        for (; x < width; x++)
+            dst[x] = float16_t(op::r((float)src1[x], scalar));
+    }
+
+    vx_cleanup();
+}
+
+static void mul_loop16f(BIN_ARGS(float16_t), const double* scalar)
+{
+    float fscalar = (float)*scalar;
+    if (std::fabs(fscalar - 1.0f) <= FLT_EPSILON)
+        bin_loop16f<op_mul>(BIN_ARGS_PASS);
+    else
+        scalar_loop16f<op_mul_scale>(BIN_ARGS_PASS, &fscalar);
+}
+
+static void div_loop16f(BIN_ARGS(float16_t), const double* scalar)
+{
+    float fscalar = (float)*scalar;
+    if (std::fabs(fscalar - 1.0f) <= FLT_EPSILON)
+        bin_loop16f<op_div_f>(BIN_ARGS_PASS);
+    else
+        scalar_loop16f<op_div_scale>(BIN_ARGS_PASS, &fscalar);
+}
+
+static void add_weighted_loop16f(BIN_ARGS(float16_t), const double* scalars)
+{
+    float fscalars[] = {(float)scalars[0], (float)scalars[1], (float)scalars[2]};
+    if (fscalars[1] == 1.0f && fscalars[2] == 0.0f)
+        scalar_loop16f<op_add_scale>(BIN_ARGS_PASS, fscalars);
+    else
+        scalar_loop16f<op_add_weighted>(BIN_ARGS_PASS, fscalars);
+}
+
+static void recip_loop16f(const float16_t* src1, size_t step1, float16_t* dst, size_t step,
+                          int width, int height, const double* scalar)
+{
+    float fscalar = (float)*scalar;
+    scalar_loop16f<op_recip>(src1, step1, dst, step, width, height, &fscalar);
+}
+
+#endif // ARITHM_DEFINITIONS_ONLY
+
+//////////////////////////////////////////////////////////////////////////
+
+// there are no HAL or IPP entries for CV_16F, so the dispatchers call the kernels directly
+
+#undef DEFINE_F16_FUN
+#if defined(ARITHM_DISPATCHING_ONLY)
+    #define DEFINE_F16_FUN(fun, args, pass, dispatch_args, body)         \
+        void fun dispatch_args                                           \
+        {                                                                \
+            CV_INSTRUMENT_REGION();                                      \
+            CV_CPU_DISPATCH(fun, pass, CV_CPU_DISPATCH_MODES_ALL);       \
+        }
+#elif defined(ARITHM_DEFINITIONS_ONLY)
+    #define DEFINE_F16_FUN(fun, args, pass, dispatch_args, body) \
+        void fun args;                                           \
+        void fun args                                            \
+        {                                                        \
+            CV_INSTRUMENT_REGION();                              \
+            body;                                                \
+        }
+#else
+    #define DEFINE_F16_FUN(fun, args, pass, dispatch_args, body) \
+        void fun args;
+#endif
+
+#undef DEFINE_F16_BIN
+#define DEFINE_F16_BIN(fun, OP)                                          \
+    DEFINE_F16_FUN(fun, (BIN_ARGS(float16_t)), (BIN_ARGS_PASS),          \
+        (BIN_ARGS(float16_t), void*), bin_loop16f<OP>(BIN_ARGS_PASS))
+
+#undef DEFINE_F16_SCALAR
+#define DEFINE_F16_SCALAR(fun, loop)                                     \
+    DEFINE_F16_FUN(fun, (BIN_ARGS(float16_t), const double* scalar),     \
+        (BIN_ARGS_PASS, (const double*)scalar),                          \
+        (BIN_ARGS(float16_t), void* scalar), loop(BIN_ARGS_PASS, scalar))
+
+DEFINE_F16_BIN(add16f, op_add)
+DEFINE_F16_BIN(sub16f, op_sub)
+DEFINE_F16_BIN(max16f, op_max)
+DEFINE_F16_BIN(min16f, op_min)
+DEFINE_F16_BIN(absdiff16f, op_absdiff)
+
+DEFINE_F16_FUN(cmp16f, (CMP_ARGS(float16_t), int cmpop), (CMP_ARGS_PASS, *(int*)_cmpop),
+    (CMP_ARGS(float16_t), void* _cmpop), cmp_loop16f(CMP_ARGS_PASS, cmpop))
+
+DEFINE_F16_SCALAR(mul16f, mul_loop16f)
+DEFINE_F16_SCALAR(div16f, div_loop16f)
+DEFINE_F16_SCALAR(addWeighted16f, add_weighted_loop16f)
+
+DEFINE_F16_FUN(recip16f, (SCALAR_ARGS(float16_t), const double* scalar),
+    (SCALAR_ARGS_PASS, (const double*)scalar),
+    (const float16_t*, size_t, SCALAR_ARGS(float16_t), void* scalar),
+    recip_loop16f(SCALAR_ARGS_PASS, scalar))
+
 #ifndef ARITHM_DISPATCHING_ONLY
     CV_CPU_OPTIMIZATION_NAMESPACE_END
 #endif
@@ -628,7 +628,7 @@ void scaleAdd(InputArray _src1, double alpha, InputArray _src2, OutputArray _dst
     CV_OCL_RUN(_src1.dims() <= 2 && _src2.dims() <= 2 && _dst.isUMat(),
             ocl_scaleAdd(_src1, alpha, _src2, _dst, type))
 
-    if( depth < CV_32F )
+    if( depth < CV_32F || depth == CV_16F )
     {
         addWeighted(_src1, alpha, _src2, 1, 0, _dst, depth);
         return;
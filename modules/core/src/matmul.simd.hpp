@@ -741,6 +741,244 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/****************************************************************************************\
+*                         Packed GEMM for single-channel matrices                        *
+\****************************************************************************************/
+
+#if CV_SIMD
+
+// op(A) is copied into panels of GEMM_MR rows and op(B) into panels of GEMM_NR columns,
+// so that every k-slice of a panel is contiguous. The micro-kernel keeps a GEMM_MR x GEMM_NR
+// tile of D in vector registers while walking GEMM_KC-long slices of both panels,
+// the macro-tiles of GEMM_MC x GEMM_NC elements of D are distributed between threads.
+
+template<typename T> struct GemmPackedVec {};
+
+template<> struct GemmPackedVec<float>
+{
+    typedef v_float32 vec;
+    static inline vec setall(float v) { return vx_setall_f32(v); }
+    static inline vec zero() { return vx_setzero_f32(); }
+};
+
+#if CV_SIMD_64F
+template<> struct GemmPackedVec<double>
+{
+    typedef v_float64 vec;
+    static inline vec setall(double v) { return vx_setall_f64(v); }
+    static inline vec zero() { return vx_setzero_f64(); }
+};
+#endif
+
+enum { GEMM_MR = 4, GEMM_KC = 256, GEMM_MC = 64, GEMM_NC = 128 };
+
+// the number of multiply-adds below which the blocked loops of gemmImpl() are used
+static const double GEMM_PACKED_MIN_OPS = 32*32*32;
+
+template<typename T> static inline int gemmPackedNR()
+{
+    return GemmPackedVec<T>::vec::nlanes*2;
+}
+
+// packs rows [range.start*panel, range.end*panel) of a rows x len matrix,
+// the element (i, k) is located at src + i*step0 + k*step1
+template<typename T> class GemmPackInvoker : public ParallelLoopBody
+{
+public:
+    GemmPackInvoker( const uchar* _src, size_t _step0, size_t _step1, int _rows, int _len, int _panel, T* _dst )
+        : src(_src), step0(_step0), step1(_step1), rows(_rows), len(_len), panel(_panel), dst(_dst)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int p = range.start; p < range.end; p++ )
+        {
+            T* d = dst + (size_t)p*len*panel;
+            int i0 = p*panel, n = std::min(panel, rows - i0);
+            for( int t = 0; t < n; t++ )
+            {
+                const uchar* s = src + (size_t)(i0 + t)*step0;
+                for( int k = 0; k < len; k++ )
+                    d[k*panel + t] = *(const T*)(s + k*step1);
+            }
+            for( int t = n; t < panel; t++ )
+                for( int k = 0; k < len; k++ )
+                    d[k*panel + t] = 0;
+        }
+    }
+
+private:
+    const uchar* src;
+    size_t step0, step1;
+    int rows, len, panel;
+    T* dst;
+};
+
+// tile[GEMM_MR][2*nlanes] = a[kc][GEMM_MR]^T * b[kc][2*nlanes]
+template<typename T> static inline void
+gemmMicroKernel( const T* a, const T* b, int kc, T* tile )
+{
+    typedef GemmPackedVec<T> VT;
+    typedef typename VT::vec vec;
+    const int nl = vec::nlanes;
+    vec c00 = VT::zero(), c01 = VT::zero(), c10 = VT::zero(), c11 = VT::zero();
+    vec c20 = VT::zero(), c21 = VT::zero(), c30 = VT::zero(), c31 = VT::zero();
+
+    for( int k = 0; k < kc; k++, a += GEMM_MR, b += nl*2 )
+    {
+        vec b0 = vx_load(b), b1 = vx_load(b + nl);
+        vec a0 = VT::setall(a[0]);
+        c00 = v_fma(a0, b0, c00); c01 = v_fma(a0, b1, c01);
+        a0 = VT::setall(a[1]);
+        c10 = v_fma(a0, b0, c10); c11 = v_fma(a0, b1, c11);
+        a0 = VT::setall(a[2]);
+        c20 = v_fma(a0, b0, c20); c21 = v_fma(a0, b1, c21);
+        a0 = VT::setall(a[3]);
+        c30 = v_fma(a0, b0, c30); c31 = v_fma(a0, b1, c31);
+    }
+
+    v_store(tile, c00); v_store(tile + nl, c01);
+    v_store(tile + nl*2, c10); v_store(tile + nl*3, c11);
+    v_store(tile + nl*4, c20); v_store(tile + nl*5, c21);
+    v_store(tile + nl*6, c30); v_store(tile + nl*7, c31);
+}
+
+template<typename T> class GemmPackedInvoker : public ParallelLoopBody
+{
+public:
+    GemmPackedInvoker( const T* _apack, const T* _bpack, const uchar* _c, size_t _c_step0, size_t _c_step1,
+                       uchar* _d, size_t _d_step, Size _d_size, int _len, T _alpha, T _beta )
+        : apack(_apack), bpack(_bpack), c(_c), c_step0(_c_step0), c_step1(_c_step1),
+          d(_d), d_step(_d_step), d_size(_d_size), len(_len), alpha(_alpha), beta(_beta)
+    {}
+
+    int tilesX() const { return (d_size.width + GEMM_NC - 1)/GEMM_NC; }
+    int tiles() const { return tilesX()*((d_size.height + GEMM_MC - 1)/GEMM_MC); }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        const int nr = gemmPackedNR<T>();
+        T CV_DECL_ALIGNED(CV_SIMD_WIDTH) tile[GEMM_MR*CV_SIMD_WIDTH*2/sizeof(T)];
+        int ntx = tilesX();
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int i0 = (t / ntx)*GEMM_MC, i1 = std::min(i0 + GEMM_MC, d_size.height);
+            int j0 = (t % ntx)*GEMM_NC, j1 = std::min(j0 + GEMM_NC, d_size.width);
+
+            for( int k0 = 0; k0 < len; k0 += GEMM_KC )
+            {
+                int kc = std::min((int)GEMM_KC, len - k0);
+                for( int j = j0; j < j1; j += nr )
+                {
+                    const T* b = bpack + (size_t)(j/nr)*len*nr + (size_t)k0*nr;
+                    int n = std::min(nr, j1 - j);
+                    for( int i = i0; i < i1; i += GEMM_MR )
+                    {
+                        const T* a = apack + (size_t)(i/GEMM_MR)*len*GEMM_MR + (size_t)k0*GEMM_MR;
+                        int m = std::min((int)GEMM_MR, i1 - i);
+                        gemmMicroKernel(a, b, kc, tile);
+                        store(tile, i, j, m, n, k0 == 0);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    void store( const T* tile, int i0, int j0, int m, int n, bool first ) const
+    {
+        const int nr = gemmPackedNR<T>();
+        for( int i = 0; i < m; i++ )
+        {
+            const T* t = tile + i*nr;
+            T* drow = (T*)(d + (i0 + i)*d_step) + j0;
+            if( !first )
+                for( int j = 0; j < n; j++ )
+                    drow[j] += alpha*t[j];
+            else if( !c )
+                for( int j = 0; j < n; j++ )
+                    drow[j] = alpha*t[j];
+            else
+            {
+                const uchar* crow = c + (i0 + i)*c_step0 + j0*c_step1;
+                for( int j = 0; j < n; j++ )
+                    drow[j] = alpha*t[j] + beta*(*(const T*)(crow + j*c_step1));
+            }
+        }
+    }
+
+    const T *apack, *bpack;
+    const uchar* c;
+    size_t c_step0, c_step1;
+    uchar* d;
+    size_t d_step;
+    Size d_size;
+    int len;
+    T alpha, beta;
+};
+
+template<typename T> static void
+gemmPacked_( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta,
+             Mat& D, Size d_size, int len, int flags )
+{
+    const int nr = gemmPackedNR<T>();
+    size_t esz = sizeof(T);
+    int mpanels = (d_size.height + GEMM_MR - 1)/GEMM_MR;
+    int npanels = (d_size.width + nr - 1)/nr;
+    AutoBuffer<T> abuf((size_t)mpanels*GEMM_MR*len), bbuf((size_t)npanels*nr*len);
+
+    size_t a_step0 = A.step, a_step1 = esz, b_step0 = esz, b_step1 = B.step;
+    if( flags & GEMM_1_T )
+        std::swap(a_step0, a_step1);
+    if( flags & GEMM_2_T )
+        std::swap(b_step0, b_step1);
+    parallel_for_(Range(0, mpanels), GemmPackInvoker<T>(A.ptr(), a_step0, a_step1, d_size.height, len, GEMM_MR, abuf.data()));
+    parallel_for_(Range(0, npanels), GemmPackInvoker<T>(B.ptr(), b_step0, b_step1, d_size.width, len, nr, bbuf.data()));
+
+    size_t c_step0 = 0, c_step1 = 0;
+    if( C.data )
+    {
+        c_step0 = C.step, c_step1 = esz;
+        if( flags & GEMM_3_T )
+            std::swap(c_step0, c_step1);
+    }
+
+    GemmPackedInvoker<T> invoker(abuf.data(), bbuf.data(), C.data, c_step0, c_step1,
+                                 D.ptr(), D.step, d_size, len, (T)alpha, (T)beta);
+    parallel_for_(Range(0, invoker.tiles()), invoker);
+}
+
+#endif // CV_SIMD
+
+static bool gemmPacked( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta,
+                        Mat& D, Size d_size, int len, int flags )
+{
+#if CV_SIMD
+    if( (double)d_size.width*d_size.height*len < GEMM_PACKED_MIN_OPS ||
+        d_size.height < GEMM_MR || d_size.width < gemmPackedNR<float>()/2 )
+        return false;
+
+    int type = A.type();
+    if( type == CV_32FC1 )
+    {
+        gemmPacked_<float>(A, B, alpha, C, beta, D, d_size, len, flags);
+        return true;
+    }
+#if CV_SIMD_64F
+    if( type == CV_64FC1 )
+    {
+        gemmPacked_<double>(A, B, alpha, C, beta, D, d_size, len, flags);
+        return true;
+    }
+#endif
+#else
+    CV_UNUSED(A); CV_UNUSED(B); CV_UNUSED(alpha); CV_UNUSED(C); CV_UNUSED(beta);
+    CV_UNUSED(D); CV_UNUSED(d_size); CV_UNUSED(len); CV_UNUSED(flags);
+#endif
+    return false;
+}
+
 static void gemmImpl( Mat A, Mat B, double alpha,
            Mat C, double beta, Mat D, int flags )
 {
@@ -1033,6 +1271,9 @@ static void gemmImpl( Mat A, Mat B, double alpha,
         }
     }
 
+    if( gemmPacked(A, B, alpha, C, beta, D, d_size, len, flags) )
+        return;
+
     {
     size_t b_step = B.step;
     GEMMSingleMulFunc singleMulFunc;
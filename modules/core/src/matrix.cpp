@@ -4,6 +4,7 @@
 
 #include "precomp.hpp"
 #include "bufferpool.impl.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
 
 namespace cv {
 
@@ -188,7 +189,8 @@ MatAllocator* Mat::getDefaultAllocator()
         cv::AutoLock lock(cv::getInitializationMutex());
         if (g_matAllocator == NULL)
         {
-            g_matAllocator = getStdAllocator();
+            static bool param_useBufferPool = utils::getConfigurationParameterBool("OPENCV_CPU_BUFFERPOOL", false);
+            g_matAllocator = param_useBufferPool ? getPooledAllocator() : getStdAllocator();
         }
     }
     return g_matAllocator;
@@ -1127,53 +1127,504 @@ void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
 namespace cv
 {
 
-template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
+// The values are mapped to the unsigned keys of the same size that are ordered the same way:
+// signed integers get the sign bit flipped, floating-point numbers get all the bits flipped
+// when negative and only the sign bit otherwise.
+template<typename T> struct SortKey {};
+
+template<> struct SortKey<uchar>
 {
-    AutoBuffer<T> buf;
-    int n, len;
-    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
-    bool inplace = src.data == dst.data;
-    bool sortDescending = (flags & CV_SORT_DESCENDING) != 0;
+    typedef uchar key_type;
+    static inline key_type toKey( uchar v ) { return v; }
+    static inline uchar fromKey( key_type k ) { return k; }
+};
+
+template<> struct SortKey<schar>
+{
+    typedef uchar key_type;
+    static inline key_type toKey( schar v ) { return (uchar)((uchar)v ^ 0x80); }
+    static inline schar fromKey( key_type k ) { return (schar)(uchar)(k ^ 0x80); }
+};
+
+template<> struct SortKey<ushort>
+{
+    typedef ushort key_type;
+    static inline key_type toKey( ushort v ) { return v; }
+    static inline ushort fromKey( key_type k ) { return k; }
+};
+
+template<> struct SortKey<short>
+{
+    typedef ushort key_type;
+    static inline key_type toKey( short v ) { return (ushort)((ushort)v ^ 0x8000); }
+    static inline short fromKey( key_type k ) { return (short)(ushort)(k ^ 0x8000); }
+};
+
+template<> struct SortKey<int>
+{
+    typedef unsigned key_type;
+    static inline key_type toKey( int v ) { return (unsigned)v ^ 0x80000000u; }
+    static inline int fromKey( key_type k ) { return (int)(k ^ 0x80000000u); }
+};
+
+template<> struct SortKey<float>
+{
+    typedef unsigned key_type;
+    static inline key_type toKey( float v )
+    {
+        Cv32suf u; u.f = v;
+        return (unsigned)(u.i ^ ((u.i >> 31) | (int)0x80000000));
+    }
+    static inline float fromKey( key_type k )
+    {
+        Cv32suf u; u.u = k ^ (((k >> 31) - 1) | 0x80000000u);
+        return u.f;
+    }
+};
 
-    if( sortRows )
-        n = src.rows, len = src.cols;
+template<> struct SortKey<double>
+{
+    typedef uint64 key_type;
+    static inline key_type toKey( double v )
+    {
+        Cv64suf u; u.f = v;
+        return (uint64)(u.i ^ ((u.i >> 63) | (int64)CV_BIG_UINT(0x8000000000000000)));
+    }
+    static inline double fromKey( key_type k )
+    {
+        Cv64suf u; u.u = k ^ (((k >> 63) - 1) | CV_BIG_UINT(0x8000000000000000));
+        return u.f;
+    }
+};
+
+enum
+{
+    // the radix sort is used for the lines of at least RADIX_SORT_MIN_LEN*sizeof(key) elements
+    RADIX_SORT_MIN_LEN = 64,
+    // the lines of at least this length are sorted by several threads each
+    RADIX_SORT_PARALLEL_MIN_LEN = 1 << 16,
+    RADIX_SORT_PARALLEL_CHUNK = 1 << 14,
+    // k of len elements are selected with a heap when k*RADIX_TOPK_RATIO <= len
+    RADIX_TOPK_RATIO = 32
+};
+
+template<typename K> static inline void
+radixHist_( const K* src, int start, int end, int shift, int* hist )
+{
+    memset(hist, 0, 256*sizeof(hist[0]));
+    for( int i = start; i < end; i++ )
+        hist[(src[i] >> shift) & 255]++;
+}
+
+template<typename K> static inline void
+radixScatter_( const K* src, K* dst, const int* isrc, int* idst,
+               int start, int end, int shift, int* offsets )
+{
+    if( isrc )
+    {
+        for( int i = start; i < end; i++ )
+        {
+            int pos = offsets[(src[i] >> shift) & 255]++;
+            dst[pos] = src[i];
+            idst[pos] = isrc[i];
+        }
+    }
     else
     {
-        n = src.cols, len = src.rows;
-        buf.allocate(len);
+        for( int i = start; i < end; i++ )
+            dst[offsets[(src[i] >> shift) & 255]++] = src[i];
     }
-    T* bptr = buf.data();
+}
 
-    for( int i = 0; i < n; i++ )
+// Stable LSD radix sort with 8-bit digits. keys (and the optional idx) are sorted in-place,
+// kbuf and ibuf are the scratch buffers of len elements. The histograms of all the digits are
+// collected in a single scan; the passes where all the keys share the same digit are skipped.
+template<typename K> static void
+radixSort_( K* keys, K* kbuf, int* idx, int* ibuf, int len )
+{
+    const int npasses = (int)sizeof(K);
+    int hist[sizeof(K)][256];
+    memset(hist, 0, sizeof(hist));
+
+    for( int i = 0; i < len; i++ )
     {
-        T* ptr = bptr;
-        if( sortRows )
+        K k = keys[i];
+        for( int p = 0; p < npasses; p++ )
+            hist[p][(k >> (p*8)) & 255]++;
+    }
+
+    K *src = keys, *dst = kbuf;
+    int *isrc = idx, *idst = ibuf;
+    for( int p = 0; p < npasses; p++ )
+    {
+        int* h = hist[p];
+        if( h[(src[0] >> (p*8)) & 255] == len )
+            continue;
+        for( int d = 0, sum = 0; d < 256; d++ )
         {
-            T* dptr = dst.ptr<T>(i);
-            if( !inplace )
+            int t = h[d];
+            h[d] = sum;
+            sum += t;
+        }
+        radixScatter_(src, dst, isrc, idst, 0, len, p*8, h);
+        std::swap(src, dst);
+        if( idx )
+            std::swap(isrc, idst);
+    }
+
+    if( src != keys )
+    {
+        memcpy(keys, src, len*sizeof(keys[0]));
+        if( idx )
+            memcpy(idx, isrc, len*sizeof(idx[0]));
+    }
+}
+
+template<typename K> class RadixSortPassInvoker : public ParallelLoopBody
+{
+public:
+    RadixSortPassInvoker( const K* _src, K* _dst, const int* _isrc, int* _idst,
+                          int _len, int _nchunks, int _shift, int* _hist, bool _scatter )
+        : src(_src), dst(_dst), isrc(_isrc), idst(_idst), len(_len), nchunks(_nchunks),
+          shift(_shift), hist(_hist), scatter(_scatter) {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int c = range.start; c < range.end; c++ )
+        {
+            int start = (int)((int64)len*c/nchunks), end = (int)((int64)len*(c + 1)/nchunks);
+            if( scatter )
+                radixScatter_(src, dst, isrc, idst, start, end, shift, hist + c*256);
+            else
+                radixHist_(src, start, end, shift, hist + c*256);
+        }
+    }
+
+private:
+    const K* src;
+    K* dst;
+    const int* isrc;
+    int* idst;
+    int len, nchunks, shift;
+    int* hist;
+    bool scatter;
+};
+
+// The same as radixSort_, but each pass is split between the threads: the chunks compute their
+// digit histograms and then scatter the elements concurrently, chunk c placing its elements with
+// the digit d right after the ones of the preceding chunks. The result does not depend on nchunks.
+template<typename K> static void
+radixSortParallel_( K* keys, K* kbuf, int* idx, int* ibuf, int len )
+{
+    int nchunks = std::max(std::min(getNumThreads(), len / (int)RADIX_SORT_PARALLEL_CHUNK), 1);
+    std::vector<int> _hist(nchunks*256);
+    int* hist = &_hist[0];
+
+    K *src = keys, *dst = kbuf;
+    int *isrc = idx, *idst = ibuf;
+    for( int p = 0; p < (int)sizeof(K); p++ )
+    {
+        int shift = p*8;
+        parallel_for_(Range(0, nchunks), RadixSortPassInvoker<K>(src, dst, isrc, idst, len, nchunks, shift, hist, false));
+
+        int first = (int)((src[0] >> shift) & 255), firstCount = 0;
+        for( int c = 0; c < nchunks; c++ )
+            firstCount += hist[c*256 + first];
+        if( firstCount == len )
+            continue;
+
+        for( int d = 0, sum = 0; d < 256; d++ )
+            for( int c = 0; c < nchunks; c++ )
             {
-                const T* sptr = src.ptr<T>(i);
-                memcpy(dptr, sptr, sizeof(T) * len);
+                int t = hist[c*256 + d];
+                hist[c*256 + d] = sum;
+                sum += t;
             }
-            ptr = dptr;
+        parallel_for_(Range(0, nchunks), RadixSortPassInvoker<K>(src, dst, isrc, idst, len, nchunks, shift, hist, true));
+        std::swap(src, dst);
+        if( idx )
+            std::swap(isrc, idst);
+    }
+
+    if( src != keys )
+    {
+        memcpy(keys, src, len*sizeof(keys[0]));
+        if( idx )
+            memcpy(idx, isrc, len*sizeof(idx[0]));
+    }
+}
+
+// orders the indices by the values; the equal values are ordered by the index
+template<typename _Tp> class LessThanIdx
+{
+public:
+    LessThanIdx( const _Tp* _arr, bool _descending=false ) : arr(_arr), descending(_descending) {}
+    bool operator()(int a, int b) const
+    {
+        _Tp va = arr[a], vb = arr[b];
+        if( descending )
+            std::swap(va, vb);
+        return va < vb || (!(vb < va) && a < b);
+    }
+    const _Tp* arr;
+    bool descending;
+};
+
+// Returns the position of the first vector block starting at j or later that may contain an element
+// preceding thr in the requested order; the remaining tail is left to the scalar code.
+template<typename T> static inline int
+topKSkip_( const T*, int j, int, T, bool )
+{
+    return j;
+}
+
+#if CV_SIMD
+#define CV_TOPK_SKIP_SIMD(T, _Tpvec, suffix) \
+static inline int topKSkip_( const T* vals, int j, int len, T thr, bool descending ) \
+{ \
+    const int nlanes = _Tpvec::nlanes; \
+    _Tpvec vthr = vx_setall_##suffix(thr); \
+    if( descending ) \
+    { \
+        for( ; j <= len - nlanes; j += nlanes ) \
+            if( v_check_any(vx_load(vals + j) > vthr) ) \
+                break; \
+    } \
+    else \
+    { \
+        for( ; j <= len - nlanes; j += nlanes ) \
+            if( v_check_any(vx_load(vals + j) < vthr) ) \
+                break; \
+    } \
+    return j; \
+}
+
+CV_TOPK_SKIP_SIMD(uchar, v_uint8, u8)
+CV_TOPK_SKIP_SIMD(schar, v_int8, s8)
+CV_TOPK_SKIP_SIMD(ushort, v_uint16, u16)
+CV_TOPK_SKIP_SIMD(short, v_int16, s16)
+CV_TOPK_SKIP_SIMD(int, v_int32, s32)
+CV_TOPK_SKIP_SIMD(float, v_float32, f32)
+#if CV_SIMD_64F
+CV_TOPK_SKIP_SIMD(double, v_float64, f64)
+#endif
+#undef CV_TOPK_SKIP_SIMD
+#endif
+
+// Selects the first k elements of vals[start..end) in the sorted order (as sortIdx would place
+// them) using a heap of k indices. The heap top is the current threshold, so most of the elements
+// are rejected by a single (vectorized) comparison. The selected indices are stored to idx sorted,
+// the function returns their number.
+template<typename T> static int
+topKSelect_( const T* vals, int start, int end, int k, bool descending, int* idx )
+{
+    LessThanIdx<T> cmp(vals, descending);
+    k = std::min(k, end - start);
+    if( k <= 0 )
+        return 0;
+    for( int j = 0; j < k; j++ )
+        idx[j] = start + j;
+    std::make_heap(idx, idx + k, cmp);
+
+    T thr = vals[idx[0]];
+    for( int j = start + k; j < end; j++ )
+    {
+        j = topKSkip_(vals, j, end, thr, descending);
+        if( j >= end )
+            break;
+        T v = vals[j];
+        if( descending ? thr < v : v < thr )
+        {
+            std::pop_heap(idx, idx + k, cmp);
+            idx[k-1] = j;
+            std::push_heap(idx, idx + k, cmp);
+            thr = vals[idx[0]];
         }
-        else
+    }
+    std::sort_heap(idx, idx + k, cmp);
+    return k;
+}
+
+template<typename T> class TopKChunkInvoker : public ParallelLoopBody
+{
+public:
+    TopKChunkInvoker( const T* _vals, int _len, int _nchunks, int _k, bool _descending, int* _idx, int* _counts )
+        : vals(_vals), len(_len), nchunks(_nchunks), k(_k), descending(_descending), idx(_idx), counts(_counts) {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int c = range.start; c < range.end; c++ )
         {
-            for( int j = 0; j < len; j++ )
-                ptr[j] = src.ptr<T>(j)[i];
+            int start = (int)((int64)len*c/nchunks), end = (int)((int64)len*(c + 1)/nchunks);
+            counts[c] = topKSelect_(vals, start, end, k, descending, idx + (size_t)c*k);
         }
+    }
 
-        std::sort( ptr, ptr + len );
-        if( sortDescending )
+private:
+    const T* vals;
+    int len, nchunks, k;
+    bool descending;
+    int* idx;
+    int* counts;
+};
+
+// topKSelect_ over the whole line split between the threads: every chunk selects its own k best
+// elements, then the best k of the candidates are taken.
+template<typename T> static void
+topKSelectParallel_( const T* vals, int len, int k, bool descending, int* idx )
+{
+    int nchunks = std::max(std::min(getNumThreads(), len / (int)RADIX_SORT_PARALLEL_CHUNK), 1);
+    std::vector<int> cand((size_t)nchunks*k), counts(nchunks);
+    parallel_for_(Range(0, nchunks), TopKChunkInvoker<T>(vals, len, nchunks, k, descending, &cand[0], &counts[0]));
+
+    int ncand = 0;
+    for( int c = 0; c < nchunks; c++ )
+    {
+        memmove(&cand[ncand], &cand[(size_t)c*k], counts[c]*sizeof(cand[0]));
+        ncand += counts[c];
+    }
+    LessThanIdx<T> cmp(vals, descending);
+    std::partial_sort(cand.begin(), cand.begin() + k, cand.begin() + ncand, cmp);
+    memcpy(idx, &cand[0], k*sizeof(idx[0]));
+}
+
+// Sorts every row (or column) of src and stores the first k sorted values to dst and/or their
+// indices to dstIdx. Each output line holds k elements; k < len enables the partial (top-k) mode.
+template<typename T> class SortLinesInvoker : public ParallelLoopBody
+{
+public:
+    typedef typename SortKey<T>::key_type K;
+
+    SortLinesInvoker( const Mat& _src, Mat* _dst, Mat* _dstIdx, int flags, int _k, bool _parallelLine )
+        : src(_src), dst(_dst), dstIdx(_dstIdx), k(_k), parallelLine(_parallelLine)
+    {
+        sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+        descending = (flags & CV_SORT_DESCENDING) != 0;
+        len = sortRows ? src.cols : src.rows;
+    }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        AutoBuffer<T> vbuf(len);
+        AutoBuffer<K> kbuf(len*2);
+        AutoBuffer<int> ibuf(len*2);
+        T* vals = vbuf.data();
+        int* idx = ibuf.data();
+        bool needIdx = dstIdx != 0 || k < len;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            if( sortRows )
+                memcpy(vals, src.ptr<T>(i), len*sizeof(T));
+            else
+                for( int j = 0; j < len; j++ )
+                    vals[j] = src.ptr<T>(j)[i];
+
+            sortLine(vals, kbuf.data(), needIdx ? idx : 0, idx + len);
+
+            // when the indices are computed, vals keeps the original order
+            if( dst )
+            {
+                for( int j = 0; j < k; j++ )
+                {
+                    T v = needIdx ? vals[idx[j]] : vals[j];
+                    if( sortRows )
+                        dst->ptr<T>(i)[j] = v;
+                    else
+                        dst->ptr<T>(j)[i] = v;
+                }
+            }
+            if( dstIdx )
+            {
+                if( sortRows )
+                    memcpy(dstIdx->ptr<int>(i), idx, k*sizeof(int));
+                else
+                    for( int j = 0; j < k; j++ )
+                        dstIdx->ptr<int>(j)[i] = idx[j];
+            }
+        }
+    }
+
+private:
+    void sortLine( T* vals, K* keys, int* idx, int* ibuf ) const
+    {
+        if( idx && (int64)k*RADIX_TOPK_RATIO <= len )
+        {
+            if( parallelLine )
+                topKSelectParallel_(vals, len, k, descending, idx);
+            else
+                topKSelect_(vals, 0, len, k, descending, idx);
+            return;
+        }
+
+        if( len < (int)(RADIX_SORT_MIN_LEN*sizeof(K)) )
         {
-            for( int j = 0; j < len/2; j++ )
-                std::swap(ptr[j], ptr[len-1-j]);
+            if( idx )
+            {
+                for( int j = 0; j < len; j++ )
+                    idx[j] = j;
+                std::sort(idx, idx + len, LessThanIdx<T>(vals, descending));
+            }
+            else
+            {
+                std::sort(vals, vals + len);
+                if( descending )
+                    std::reverse(vals, vals + len);
+            }
+            return;
         }
 
-        if( !sortRows )
+        // the descending order is the ascending order of the inverted keys, so it stays stable
+        K flip = descending ? (K)~(K)0 : (K)0;
+        for( int j = 0; j < len; j++ )
+            keys[j] = (K)(SortKey<T>::toKey(vals[j]) ^ flip);
+        if( idx )
             for( int j = 0; j < len; j++ )
-                dst.ptr<T>(j)[i] = ptr[j];
+                idx[j] = j;
+
+        if( parallelLine )
+            radixSortParallel_(keys, keys + len, idx, ibuf, len);
+        else
+            radixSort_(keys, keys + len, idx, ibuf, len);
+
+        if( !idx )
+            for( int j = 0; j < len; j++ )
+                vals[j] = SortKey<T>::fromKey((K)(keys[j] ^ flip));
     }
+
+    const Mat& src;
+    Mat* dst;
+    Mat* dstIdx;
+    int k, len;
+    bool sortRows, descending, parallelLine;
+};
+
+template<typename T> static void
+sortLines_( const Mat& src, Mat* dst, Mat* dstIdx, int flags, int k )
+{
+    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+    int n = sortRows ? src.rows : src.cols, len = sortRows ? src.cols : src.rows;
+
+    // a few long lines are split between the threads, otherwise the threads take whole lines
+    bool parallelLine = len >= RADIX_SORT_PARALLEL_MIN_LEN && n < getNumThreads();
+    SortLinesInvoker<T> body(src, dst, dstIdx, flags, k, parallelLine);
+    if( parallelLine || n == 1 || (int64)n*len < RADIX_SORT_PARALLEL_MIN_LEN )
+        body(Range(0, n));
+    else
+        parallel_for_(Range(0, n), body);
+}
+
+template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
+{
+    int len = (flags & 1) == CV_SORT_EVERY_ROW ? src.cols : src.rows;
+    sortLines_<T>(src, &dst, 0, flags, len);
+}
+
+template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
+{
+    CV_Assert( src.data != dst.data );
+    int len = (flags & 1) == CV_SORT_EVERY_ROW ? src.cols : src.rows;
+    sortLines_<T>(src, 0, &dst, flags, len);
 }
 
 #ifdef HAVE_IPP
@@ -1264,66 +1715,6 @@ static bool ipp_sort(const Mat& src, Mat& dst, int flags)
 }
 #endif
 
-template<typename _Tp> class LessThanIdx
-{
-public:
-    LessThanIdx( const _Tp* _arr ) : arr(_arr) {}
-    bool operator()(int a, int b) const { return arr[a] < arr[b]; }
-    const _Tp* arr;
-};
-
-template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
-{
-    AutoBuffer<T> buf;
-    AutoBuffer<int> ibuf;
-    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
-    bool sortDescending = (flags & CV_SORT_DESCENDING) != 0;
-
-    CV_Assert( src.data != dst.data );
-
-    int n, len;
-    if( sortRows )
-        n = src.rows, len = src.cols;
-    else
-    {
-        n = src.cols, len = src.rows;
-        buf.allocate(len);
-        ibuf.allocate(len);
-    }
-    T* bptr = buf.data();
-    int* _iptr = ibuf.data();
-
-    for( int i = 0; i < n; i++ )
-    {
-        T* ptr = bptr;
-        int* iptr = _iptr;
-
-        if( sortRows )
-        {
-            ptr = (T*)(src.data + src.step*i);
-            iptr = dst.ptr<int>(i);
-        }
-        else
-        {
-            for( int j = 0; j < len; j++ )
-                ptr[j] = src.ptr<T>(j)[i];
-        }
-        for( int j = 0; j < len; j++ )
-            iptr[j] = j;
-
-        std::sort( iptr, iptr + len, LessThanIdx<T>(ptr) );
-        if( sortDescending )
-        {
-            for( int j = 0; j < len/2; j++ )
-                std::swap(iptr[j], iptr[len-1-j]);
-        }
-
-        if( !sortRows )
-            for( int j = 0; j < len; j++ )
-                dst.ptr<int>(j)[i] = iptr[j];
-    }
-}
-
 #ifdef HAVE_IPP
 typedef IppStatus (CV_STDCALL *IppSortIndexFunc)(const void*  pSrc, Ipp32s srcStrideBytes, Ipp32s *pDstIndx, int len, Ipp8u *pBuffer);
 
@@ -1405,6 +1796,7 @@ static bool ipp_sortIdx( const Mat& src, Mat& dst, int flags )
 #endif
 
 typedef void (*SortFunc)(const Mat& src, Mat& dst, int flags);
+typedef void (*SortLinesFunc)(const Mat& src, Mat* dst, Mat* dstIdx, int flags, int k);
 }
 
 void cv::sort( InputArray _src, OutputArray _dst, int flags )
@@ -1451,3 +1843,40 @@ void cv::sortIdx( InputArray _src, OutputArray _dst, int flags )
     CV_Assert( func != 0 );
     func( src, dst, flags );
 }
+
+void cv::topK( InputArray _src, int k, int dim, OutputArray _values, OutputArray _indices, bool largest )
+{
+    CV_INSTRUMENT_REGION();
+
+    Mat src = _src.getMat();
+    CV_Assert( src.dims <= 2 && src.channels() == 1 && (dim == 0 || dim == 1) );
+    int len = dim == 1 ? src.cols : src.rows;
+    CV_Assert( 0 < k && k <= len );
+
+    Size dsz = dim == 1 ? Size(k, src.rows) : Size(src.cols, k);
+    int flags = (dim == 1 ? SORT_EVERY_ROW : SORT_EVERY_COLUMN) | (largest ? SORT_DESCENDING : SORT_ASCENDING);
+
+    // every line is copied before its outputs are written, so they may share the data with src
+    Mat values, indices;
+    if( _values.needed() )
+    {
+        _values.create( dsz, src.type() );
+        values = _values.getMat();
+    }
+    if( _indices.needed() )
+    {
+        _indices.create( dsz, CV_32S );
+        indices = _indices.getMat();
+    }
+    if( values.empty() && indices.empty() )
+        return;
+
+    static SortLinesFunc tab[] =
+    {
+        sortLines_<uchar>, sortLines_<schar>, sortLines_<ushort>, sortLines_<short>,
+        sortLines_<int>, sortLines_<float>, sortLines_<double>, 0
+    };
+    SortLinesFunc func = tab[src.depth()];
+    CV_Assert( func != 0 );
+    func( src, values.empty() ? 0 : &values, indices.empty() ? 0 : &indices, flags, k );
+}
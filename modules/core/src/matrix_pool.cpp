@@ -0,0 +1,297 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "opencv2/core/bufferpool.hpp"
+#include "opencv2/core/utils/configuration.private.hpp"
+#include "opencv2/core/utils/tls.hpp"
+
+#include <atomic>
+
+namespace cv {
+
+// Pooled CPU allocator.
+//
+// Buffers are rounded up to a size class (4 classes per power of two, starting from 64 bytes)
+// and released buffers are kept in per-thread free lists, so allocate/release pairs of the
+// same size (temporary Mats inside of loops) don't go into the system allocator.
+// The total amount of reserved (cached, but unused) memory is limited by the BufferPoolController
+// interface, which is also used to drop the cached buffers.
+
+namespace {
+
+enum
+{
+    MIN_SIZE_SHIFT = 6,   // 64 bytes
+    MAX_SIZE_SHIFT = 28,  // 256Mb, larger buffers are not pooled
+    SUBCLASS_BITS = 2,
+    SIZE_CLASSES = (MAX_SIZE_SHIFT - MIN_SIZE_SHIFT) * (1 << SUBCLASS_BITS) + 1
+};
+
+// returns -1 for non-pooled sizes
+static int getSizeClass(size_t size, size_t& capacity)
+{
+    if (size <= ((size_t)1 << MIN_SIZE_SHIFT))
+    {
+        capacity = (size_t)1 << MIN_SIZE_SHIFT;
+        return 0;
+    }
+    if (size > ((size_t)1 << MAX_SIZE_SHIFT))
+        return -1;
+    int shift = MIN_SIZE_SHIFT;  // size - 1 is in [2^shift, 2^(shift+1))
+    while (((size - 1) >> (shift + 1)) != 0)
+        shift++;
+    const size_t step = (size_t)1 << (shift - SUBCLASS_BITS);
+    capacity = (size + step - 1) & ~(step - 1);
+    int subclass = (int)(capacity >> (shift - SUBCLASS_BITS)) - (1 << SUBCLASS_BITS);  // 1..4
+    return (shift - MIN_SIZE_SHIFT) * (1 << SUBCLASS_BITS) + subclass;
+}
+
+static size_t getSizeClassCapacity(int sizeClass)
+{
+    if (sizeClass == 0)
+        return (size_t)1 << MIN_SIZE_SHIFT;
+    int shift = MIN_SIZE_SHIFT + (sizeClass - 1) / (1 << SUBCLASS_BITS);
+    int subclass = (sizeClass - 1) % (1 << SUBCLASS_BITS) + 1;
+    return (size_t)((1 << SUBCLASS_BITS) + subclass) << (shift - SUBCLASS_BITS);
+}
+
+struct ThreadBufferCache
+{
+    Mutex mutex;  // not contended: locked by the owner thread, and by trim() calls only
+    std::vector<void*> buffers[SIZE_CLASSES];
+};
+
+class CPUBufferPool;
+
+class ThreadBufferCacheStorage : public TLSData<ThreadBufferCache>
+{
+public:
+    ThreadBufferCacheStorage(CPUBufferPool& pool_) : pool(pool_) {}
+    ~ThreadBufferCacheStorage() { release(); }  // virtual deleteDataInstance() is not available in the base destructor
+protected:
+    virtual void* createDataInstance() const CV_OVERRIDE;
+    virtual void deleteDataInstance(void* pData) const CV_OVERRIDE;
+
+    CPUBufferPool& pool;
+};
+
+class CPUBufferPool CV_FINAL : public BufferPoolController
+{
+public:
+    CPUBufferPool()
+        : currentReservedSize(0),
+          maxReservedSize(utils::getConfigurationParameterSizeT("OPENCV_CPU_BUFFERPOOL_LIMIT", (size_t)1 << 27)),
+          threadCaches(*this)
+    {
+        // nothing
+    }
+    ~CPUBufferPool()
+    {
+        freeAllReservedBuffers();
+    }
+
+    void* allocate(size_t size)
+    {
+        size_t capacity = 0;
+        int sizeClass = getSizeClass(size, capacity);
+        if (sizeClass >= 0 && currentReservedSize.load(std::memory_order_relaxed) > 0)
+        {
+            ThreadBufferCache& cache = threadCaches.getRef();
+            AutoLock lock(cache.mutex);
+            std::vector<void*>& buffers = cache.buffers[sizeClass];
+            if (!buffers.empty())
+            {
+                void* ptr = buffers.back();
+                buffers.pop_back();
+                currentReservedSize -= capacity;
+                return ptr;
+            }
+        }
+        return fastMalloc(sizeClass >= 0 ? capacity : size);
+    }
+
+    void release(void* ptr, size_t size)
+    {
+        size_t capacity = 0;
+        int sizeClass = getSizeClass(size, capacity);
+        size_t limit = maxReservedSize.load(std::memory_order_relaxed);
+        if (sizeClass < 0 || capacity > limit / 8)
+        {
+            fastFree(ptr);
+            return;
+        }
+        if (currentReservedSize.fetch_add(capacity) + capacity > limit)
+        {
+            currentReservedSize -= capacity;
+            fastFree(ptr);
+            return;
+        }
+        ThreadBufferCache& cache = threadCaches.getRef();
+        AutoLock lock(cache.mutex);
+        cache.buffers[sizeClass].push_back(ptr);
+    }
+
+    virtual size_t getReservedSize() const CV_OVERRIDE { return currentReservedSize; }
+    virtual size_t getMaxReservedSize() const CV_OVERRIDE { return maxReservedSize; }
+    virtual void setMaxReservedSize(size_t size) CV_OVERRIDE
+    {
+        maxReservedSize = size;
+        trim(size);
+    }
+    virtual void freeAllReservedBuffers() CV_OVERRIDE
+    {
+        trim(0);
+    }
+
+    void registerCache(ThreadBufferCache* cache)
+    {
+        AutoLock lock(mutex_);
+        caches_.push_back(cache);
+    }
+
+    void unregisterCache(ThreadBufferCache* cache)
+    {
+        AutoLock lock(mutex_);
+        std::vector<ThreadBufferCache*>::iterator i = std::find(caches_.begin(), caches_.end(), cache);
+        CV_DbgAssert(i != caches_.end());
+        if (i != caches_.end())
+            caches_.erase(i);
+        releaseCache(*cache, 0);
+        delete cache;
+    }
+
+protected:
+    // drops cached buffers (larger first) until reserved size fits into the limit
+    void trim(size_t limit)
+    {
+        AutoLock lock(mutex_);
+        for (int sizeClass = SIZE_CLASSES - 1; sizeClass >= 0; sizeClass--)
+        {
+            for (size_t i = 0; i < caches_.size(); i++)
+            {
+                if (currentReservedSize <= limit)
+                    return;
+                ThreadBufferCache& cache = *caches_[i];
+                AutoLock cacheLock(cache.mutex);
+                releaseBuffers(cache.buffers[sizeClass], sizeClass, limit);
+            }
+        }
+    }
+
+    // synchronized
+    void releaseCache(ThreadBufferCache& cache, size_t limit)
+    {
+        AutoLock cacheLock(cache.mutex);
+        for (int sizeClass = SIZE_CLASSES - 1; sizeClass >= 0; sizeClass--)
+            releaseBuffers(cache.buffers[sizeClass], sizeClass, limit);
+    }
+
+    // synchronized
+    void releaseBuffers(std::vector<void*>& buffers, int sizeClass, size_t limit)
+    {
+        const size_t capacity = getSizeClassCapacity(sizeClass);
+        while (!buffers.empty() && currentReservedSize > limit)
+        {
+            fastFree(buffers.back());
+            buffers.pop_back();
+            currentReservedSize -= capacity;
+        }
+        if (buffers.empty())
+            std::vector<void*>().swap(buffers);
+    }
+
+    std::atomic<size_t> currentReservedSize;
+    std::atomic<size_t> maxReservedSize;
+
+    Mutex mutex_;
+    std::vector<ThreadBufferCache*> caches_;
+
+    ThreadBufferCacheStorage threadCaches;  // should be destroyed first
+};
+
+void* ThreadBufferCacheStorage::createDataInstance() const
+{
+    ThreadBufferCache* cache = new ThreadBufferCache();
+    pool.registerCache(cache);
+    return cache;
+}
+
+void ThreadBufferCacheStorage::deleteDataInstance(void* pData) const
+{
+    pool.unregisterCache((ThreadBufferCache*)pData);
+}
+
+class PooledMatAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, AccessFlag /*flags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+            {
+                if( data0 && step[i] != CV_AUTOSTEP )
+                {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else
+                    step[i] = total;
+            }
+            total *= sizes[i];
+        }
+        uchar* data = data0 ? (uchar*)data0 : (uchar*)pool.allocate(total);
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        if(data0)
+            u->flags |= UMatData::USER_ALLOCATED;
+
+        return u;
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        if(!u) return false;
+        return true;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if( !(u->flags & UMatData::USER_ALLOCATED) )
+        {
+            pool.release(u->origdata, u->size);
+            u->origdata = 0;
+        }
+        delete u;
+    }
+
+    BufferPoolController* getBufferPoolController(const char* id) const CV_OVERRIDE
+    {
+        if (id != NULL && strcmp(id, "CPU") != 0)
+        {
+            CV_Error(cv::Error::StsBadArg, "getBufferPoolController(): unknown BufferPool ID\n");
+        }
+        return &pool;
+    }
+
+    mutable CPUBufferPool pool;
+};
+
+} // namespace
+
+MatAllocator* Mat::getPooledAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new PooledMatAllocator())
+}
+
+} // namespace cv
@@ -160,6 +160,46 @@ struct SumSqr_SIMD<schar, int, int>
     }
 };
 
+#if CV_SIMD_64F
+template <>
+struct SumSqr_SIMD<float16_t, double, double>
+{
+    int operator () (const float16_t * src0, const uchar * mask, double * sum, double * sqsum, int len, int cn) const
+    {
+        if (mask || (cn != 1 && cn != 2 && cn != 4))
+            return 0;
+        len *= cn;
+
+        int x = 0;
+        v_float64 v_sum0 = vx_setzero_f64(), v_sum1 = vx_setzero_f64();
+        v_float64 v_sqsum0 = vx_setzero_f64(), v_sqsum1 = vx_setzero_f64();
+
+        for (; x <= len - v_float32::nlanes; x += v_float32::nlanes)
+        {
+            v_float32 v_src = vx_load_expand(src0 + x);
+            v_float64 v_src0 = v_cvt_f64(v_src), v_src1 = v_cvt_f64_high(v_src);
+            v_sum0 += v_src0;
+            v_sum1 += v_src1;
+            v_sqsum0 = v_fma(v_src0, v_src0, v_sqsum0);
+            v_sqsum1 = v_fma(v_src1, v_src1, v_sqsum1);
+        }
+
+        double CV_DECL_ALIGNED(CV_SIMD_WIDTH) ar[4 * v_float64::nlanes];
+        v_store_aligned(ar, v_sum0);
+        v_store_aligned(ar + v_float64::nlanes, v_sum1);
+        v_store_aligned(ar + 2 * v_float64::nlanes, v_sqsum0);
+        v_store_aligned(ar + 3 * v_float64::nlanes, v_sqsum1);
+        for (int i = 0; i < 2 * v_float64::nlanes; ++i)
+        {
+            sum[i % cn] += ar[i];
+            sqsum[i % cn] += ar[2 * v_float64::nlanes + i];
+        }
+        v_cleanup();
+        return x / cn;
+    }
+};
+#endif
+
 #endif
 
 template<typename T, typename ST, typename SQT>
@@ -308,13 +348,16 @@ static int sqsum32f( const float* src, const uchar* mask, double* sum, double* s
 static int sqsum64f( const double* src, const uchar* mask, double* sum, double* sqsum, int len, int cn )
 { CV_INSTRUMENT_REGION(); return sumsqr_(src, mask, sum, sqsum, len, cn); }
 
+static int sqsum16f( const float16_t* src, const uchar* mask, double* sum, double* sqsum, int len, int cn )
+{ CV_INSTRUMENT_REGION(); return sumsqr_(src, mask, sum, sqsum, len, cn); }
+
 SumSqrFunc getSumSqrFunc(int depth)
 {
     CV_INSTRUMENT_REGION();
     static SumSqrFunc sumSqrTab[] =
     {
         (SumSqrFunc)GET_OPTIMIZED(sqsum8u), (SumSqrFunc)sqsum8s, (SumSqrFunc)sqsum16u, (SumSqrFunc)sqsum16s,
-        (SumSqrFunc)sqsum32s, (SumSqrFunc)GET_OPTIMIZED(sqsum32f), (SumSqrFunc)sqsum64f, 0
+        (SumSqrFunc)sqsum32s, (SumSqrFunc)GET_OPTIMIZED(sqsum32f), (SumSqrFunc)sqsum64f, (SumSqrFunc)sqsum16f
     };
 
     return sumSqrTab[depth];
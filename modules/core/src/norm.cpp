@@ -6,6 +6,7 @@
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
 #include "stat.hpp"
+#include <opencv2/core/utils/configuration.private.hpp>
 
 /****************************************************************************************\
 *                                         norm                                           *
@@ -596,28 +597,10 @@ static bool ipp_norm(Mat &src, int normType, Mat &mask, double &result)
 
 } // cv::
 
-double cv::norm( InputArray _src, int normType, InputArray _mask )
-{
-    CV_INSTRUMENT_REGION();
-
-    normType &= NORM_TYPE_MASK;
-    CV_Assert( normType == NORM_INF || normType == NORM_L1 ||
-               normType == NORM_L2 || normType == NORM_L2SQR ||
-               ((normType == NORM_HAMMING || normType == NORM_HAMMING2) && _src.type() == CV_8U) );
-
-#if defined HAVE_OPENCL || defined HAVE_IPP
-    double _result = 0;
-#endif
-
-#ifdef HAVE_OPENCL
-    CV_OCL_RUN_(OCL_PERFORMANCE_CHECK(_src.isUMat()) && _src.dims() <= 2,
-                ocl_norm(_src, normType, _mask, _result),
-                _result)
-#endif
-
-    Mat src = _src.getMat(), mask = _mask.getMat();
-    CV_IPP_RUN(IPP_VERSION_X100 >= 700, ipp_norm(src, normType, mask, _result), _result);
+namespace cv {
 
+static double norm_( const Mat& src, int normType, const Mat& mask )
+{
     int depth = src.depth(), cn = src.channels();
     if( src.isContinuous() && mask.empty() )
     {
@@ -726,7 +709,7 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
         if( depth == CV_16F )
         {
             blockSize = std::min(blockSize, 1024);
-            fltbuf_.allocate(blockSize);
+            fltbuf_.allocate(blockSize*cn);
             fltbuf = fltbuf_.data();
         }
         else
@@ -745,7 +728,7 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
             const uchar* data = ptrs[0];
             if( depth == CV_16F )
             {
-                hal::cvt16f32f((const float16_t*)ptrs[0], fltbuf, bsz);
+                hal::cvt16f32f((const float16_t*)ptrs[0], fltbuf, bsz*cn);
                 data = (const uchar*)fltbuf;
             }
             func( data, ptrs[1], (uchar*)ibuf, bsz, cn );
@@ -764,7 +747,7 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     {
         if( depth == CV_64F )
             ;
-        else if( depth == CV_32F )
+        else if( depth == CV_32F || depth == CV_16F )
             result.d = result.f;
         else
             result.d = result.i;
@@ -775,6 +758,110 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     return result.d;
 }
 
+static double normDiff_( const Mat& src1, const Mat& src2, int normType, const Mat& mask );
+
+// Large arrays are split into a fixed number of chunks (row ranges, or column ranges when
+// continuous data is viewed as a single row), the partial norms are merged in chunk order,
+// so the result does not depend on the number of threads.
+static size_t CV_NORM_PARALLEL_THRESHOLD = utils::getConfigurationParameterSizeT("OPENCV_NORM_PARALLEL_THRESHOLD", 1 << 20);
+static size_t CV_NORM_PARALLEL_GRANULARITY = utils::getConfigurationParameterSizeT("OPENCV_NORM_PARALLEL_GRANULARITY", 1 << 18);
+
+class NormInvoker : public ParallelLoopBody
+{
+public:
+    NormInvoker(const Mat& _src1, const Mat& _src2, const Mat& _mask, int _normType,
+                int _nchunks, double* _results)
+        : src1(_src1), src2(_src2), mask(_mask), normType(_normType),
+          nchunks(_nchunks), results(_results)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        bool byRows = src1.rows > 1;
+        int len = byRows ? src1.rows : src1.cols;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Range r((int)((int64)len*i/nchunks), (int)((int64)len*(i + 1)/nchunks));
+            Mat s1 = byRows ? src1.rowRange(r) : src1.colRange(r);
+            Mat m = mask.empty() ? Mat() : byRows ? mask.rowRange(r) : mask.colRange(r);
+            if( src2.empty() )
+                results[i] = norm_(s1, normType, m);
+            else
+                results[i] = normDiff_(s1, byRows ? src2.rowRange(r) : src2.colRange(r), normType, m);
+        }
+    }
+
+private:
+    Mat src1, src2, mask;
+    int normType;
+    int nchunks;
+    double* results;
+};
+
+static double normImpl( Mat src1, Mat src2, int normType, Mat mask )
+{
+    size_t total = src1.total()*src1.elemSize();
+    if( total >= CV_NORM_PARALLEL_THRESHOLD && (mask.empty() || mask.size == src1.size) )
+    {
+        bool continuous = src1.isContinuous() && (src2.empty() || src2.isContinuous()) &&
+                          (mask.empty() || mask.isContinuous());
+        if( continuous && src1.total() < (size_t)INT_MAX )
+        {
+            src1 = src1.reshape(0, 1);
+            if( !src2.empty() )
+                src2 = src2.reshape(0, 1);
+            if( !mask.empty() )
+                mask = mask.reshape(0, 1);
+        }
+
+        if( src1.dims <= 2 )
+        {
+            int len = src1.rows > 1 ? src1.rows : src1.cols;
+            int nchunks = (int)std::min((size_t)len, divUp(total, CV_NORM_PARALLEL_GRANULARITY));
+            if( nchunks > 1 )
+            {
+                int chunkNormType = normType == NORM_L2 ? NORM_L2SQR : normType;
+                std::vector<double> results(nchunks);
+                parallel_for_(Range(0, nchunks), NormInvoker(src1, src2, mask, chunkNormType, nchunks, &results[0]));
+
+                double result = 0;
+                for( int i = 0; i < nchunks; i++ )
+                    result = normType == NORM_INF ? std::max(result, results[i]) : result + results[i];
+                return normType == NORM_L2 ? std::sqrt(result) : result;
+            }
+        }
+    }
+
+    return src2.empty() ? norm_(src1, normType, mask) : normDiff_(src1, src2, normType, mask);
+}
+
+} // cv::
+
+double cv::norm( InputArray _src, int normType, InputArray _mask )
+{
+    CV_INSTRUMENT_REGION();
+
+    normType &= NORM_TYPE_MASK;
+    CV_Assert( normType == NORM_INF || normType == NORM_L1 ||
+               normType == NORM_L2 || normType == NORM_L2SQR ||
+               ((normType == NORM_HAMMING || normType == NORM_HAMMING2) && _src.type() == CV_8U) );
+
+#if defined HAVE_OPENCL || defined HAVE_IPP
+    double _result = 0;
+#endif
+
+#ifdef HAVE_OPENCL
+    CV_OCL_RUN_(OCL_PERFORMANCE_CHECK(_src.isUMat()) && _src.dims() <= 2,
+                ocl_norm(_src, normType, _mask, _result),
+                _result)
+#endif
+
+    Mat src = _src.getMat(), mask = _mask.getMat();
+    CV_IPP_RUN(IPP_VERSION_X100 >= 700, ipp_norm(src, normType, mask, _result), _result);
+
+    return normImpl(src, Mat(), normType, mask);
+}
+
 //==================================================================================================
 
 #ifdef HAVE_OPENCL
@@ -1074,38 +1161,12 @@ static bool ipp_norm(InputArray _src1, InputArray _src2, int normType, InputArra
 #endif
 
 
-double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _mask )
-{
-    CV_INSTRUMENT_REGION();
-
-    CV_CheckTypeEQ(_src1.type(), _src2.type(), "Input type mismatch");
-    CV_Assert(_src1.sameSize(_src2));
-
-#if defined HAVE_OPENCL || defined HAVE_IPP
-    double _result = 0;
-#endif
-
-#ifdef HAVE_OPENCL
-    CV_OCL_RUN_(OCL_PERFORMANCE_CHECK(_src1.isUMat()),
-                ocl_norm(_src1, _src2, normType, _mask, _result),
-                _result)
-#endif
-
-    CV_IPP_RUN(IPP_VERSION_X100 >= 700, ipp_norm(_src1, _src2, normType, _mask, _result), _result);
-
-    if( normType & CV_RELATIVE )
-    {
-        return norm(_src1, _src2, normType & ~CV_RELATIVE, _mask)/(norm(_src2, normType, _mask) + DBL_EPSILON);
-    }
+namespace cv {
 
-    Mat src1 = _src1.getMat(), src2 = _src2.getMat(), mask = _mask.getMat();
+static double normDiff_( const Mat& src1, const Mat& src2, int normType, const Mat& mask )
+{
     int depth = src1.depth(), cn = src1.channels();
 
-    normType &= 7;
-    CV_Assert( normType == NORM_INF || normType == NORM_L1 ||
-               normType == NORM_L2 || normType == NORM_L2SQR ||
-              ((normType == NORM_HAMMING || normType == NORM_HAMMING2) && src1.type() == CV_8U) );
-
     if( src1.isContinuous() && src2.isContinuous() && mask.empty() )
     {
         size_t len = src1.total()*src1.channels();
@@ -1202,7 +1263,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
         if( depth == CV_16F )
         {
             blockSize = std::min(blockSize, 1024);
-            fltbuf_.allocate(blockSize*2);
+            fltbuf_.allocate(blockSize*cn*2);
             fltbuf = fltbuf_.data();
         }
         else
@@ -1221,10 +1282,10 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
             const uchar *data0 = ptrs[0], *data1 = ptrs[1];
             if( depth == CV_16F )
             {
-                hal::cvt16f32f((const float16_t*)ptrs[0], fltbuf, bsz);
-                hal::cvt16f32f((const float16_t*)ptrs[1], fltbuf + bsz, bsz);
+                hal::cvt16f32f((const float16_t*)ptrs[0], fltbuf, bsz*cn);
+                hal::cvt16f32f((const float16_t*)ptrs[1], fltbuf + bsz*cn, bsz*cn);
                 data0 = (const uchar*)fltbuf;
-                data1 = (const uchar*)(fltbuf + bsz);
+                data1 = (const uchar*)(fltbuf + bsz*cn);
             }
             func( data0, data1, ptrs[2], (uchar*)ibuf, bsz, cn );
             if( blockSum && depth != CV_16F )
@@ -1243,7 +1304,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     {
         if( depth == CV_64F )
             ;
-        else if( depth == CV_32F )
+        else if( depth == CV_32F || depth == CV_16F )
             result.d = result.f;
         else
             result.d = result.u;
@@ -1254,6 +1315,42 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     return result.d;
 }
 
+} // cv::
+
+double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _mask )
+{
+    CV_INSTRUMENT_REGION();
+
+    CV_CheckTypeEQ(_src1.type(), _src2.type(), "Input type mismatch");
+    CV_Assert(_src1.sameSize(_src2));
+
+#if defined HAVE_OPENCL || defined HAVE_IPP
+    double _result = 0;
+#endif
+
+#ifdef HAVE_OPENCL
+    CV_OCL_RUN_(OCL_PERFORMANCE_CHECK(_src1.isUMat()),
+                ocl_norm(_src1, _src2, normType, _mask, _result),
+                _result)
+#endif
+
+    CV_IPP_RUN(IPP_VERSION_X100 >= 700, ipp_norm(_src1, _src2, normType, _mask, _result), _result);
+
+    if( normType & CV_RELATIVE )
+    {
+        return norm(_src1, _src2, normType & ~CV_RELATIVE, _mask)/(norm(_src2, normType, _mask) + DBL_EPSILON);
+    }
+
+    Mat src1 = _src1.getMat(), src2 = _src2.getMat(), mask = _mask.getMat();
+
+    normType &= 7;
+    CV_Assert( normType == NORM_INF || normType == NORM_L1 ||
+               normType == NORM_L2 || normType == NORM_L2SQR ||
+              ((normType == NORM_HAMMING || normType == NORM_HAMMING2) && src1.type() == CV_8U) );
+
+    return normImpl(src1, src2, normType, mask);
+}
+
 cv::Hamming::ResultType cv::Hamming::operator()( const unsigned char* a, const unsigned char* b, int size ) const
 {
     return cv::hal::normHamming(a, b, size);
@@ -44,6 +44,7 @@
 
 #include <opencv2/core/utils/configuration.private.hpp>
 #include <opencv2/core/utils/trace.private.hpp>
+#include <opencv2/core/utils/logger.hpp>
 
 #if defined _WIN32 || defined WINCE
     #include <windows.h>
@@ -139,6 +140,7 @@
 #  define CV_PARALLEL_FRAMEWORK "ms-concurrency"
 #elif defined HAVE_PTHREADS_PF
 #  define CV_PARALLEL_FRAMEWORK "pthreads"
+#  define CV_PARALLEL_FOR_NESTED  // thread pool schedules nested and concurrent calls itself
 #endif
 
 #ifdef CV_PARALLEL_FRAMEWORK
@@ -147,6 +149,9 @@
 
 #include "parallel_impl.hpp"
 
+#include "opencv2/core/parallel/parallel_backend.hpp"
+#include "opencv2/core/utils/parallel_stats.hpp"
+
 #include "opencv2/core/detail/exception_ptr.hpp"  // CV__EXCEPTION_PTR = 1 if std::exception_ptr is available
 
 using namespace cv;
@@ -199,8 +204,10 @@ namespace
 
             // propagate main thread state
             rng = cv::theRNG();
+            executionContext = getCoreTlsData().executionContext;
 
 #ifdef OPENCV_TRACE
+            allocationRegion = getCoreTlsData().getAllocationRegion();
             traceRootRegion = CV_TRACE_NS::details::getCurrentRegion();
             traceRootContext = CV_TRACE_NS::details::getTraceManager().tls.get();
 #endif
@@ -246,7 +253,9 @@ namespace
         int nstripes;
         cv::RNG rng;
         mutable bool is_rng_used;
+        const cv::parallel::ExecutionContext* executionContext;
 #ifdef OPENCV_TRACE
+        const CV_TRACE_NS::details::Region::LocationStaticStorage* allocationRegion;
         CV_TRACE_NS::details::Region* traceRootRegion;
         CV_TRACE_NS::details::TraceManagerThreadLocal* traceRootContext;
 #endif
@@ -315,6 +324,13 @@ namespace
 
             // propagate main thread state
             cv::theRNG() = ctx.rng;
+            CoreTLSData& tlsData = getCoreTlsData();
+            const cv::parallel::ExecutionContext* executionContext = tlsData.executionContext;
+            tlsData.executionContext = ctx.executionContext;
+#ifdef OPENCV_TRACE
+            const CV_TRACE_NS::details::Region::LocationStaticStorage* allocationRootRegion = tlsData.allocationRootRegion;
+            tlsData.allocationRootRegion = ctx.allocationRegion;
+#endif
 
             cv::Range r;
             cv::Range wholeRange = ctx.wholeRange;
@@ -353,6 +369,11 @@ namespace
             }
 #endif
 
+            tlsData.executionContext = executionContext;
+#ifdef OPENCV_TRACE
+            tlsData.allocationRootRegion = allocationRootRegion;
+#endif
+
             if (!ctx.is_rng_used && !(cv::theRNG() == ctx.rng))
                 ctx.is_rng_used = true;
         }
@@ -427,6 +448,23 @@ namespace
     typedef ParallelLoopBodyWrapper ProxyLoopBody;
 #endif
 
+    // body of ParallelForAPI::parallel_for() call
+    class CallbackLoopBody : public cv::ParallelLoopBody
+    {
+    public:
+        CallbackLoopBody(cv::parallel::ParallelForAPI::FN_parallel_for_body_cb_t* callback_, void* data_) :
+            callback(callback_), data(data_)
+        {
+        }
+        void operator()(const cv::Range& r) const CV_OVERRIDE
+        {
+            callback(r.start, r.end, data);
+        }
+    protected:
+        cv::parallel::ParallelForAPI::FN_parallel_for_body_cb_t* callback;
+        void* data;
+    };
+
 static int numThreads = -1;
 
 #if defined HAVE_TBB
@@ -483,6 +521,87 @@ static SchedPtr pplScheduler;
 #ifdef CV_PARALLEL_FRAMEWORK
 static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes); // forward declaration
 #endif
+static int getNumThreads_(); // forward declarations
+static void setNumThreads_(int threads);
+static int getThreadNum_();
+
+namespace cv { namespace parallel {
+
+ParallelForAPI::~ParallelForAPI()
+{
+    // nothing
+}
+
+namespace {
+
+#ifdef CV_PARALLEL_FRAMEWORK
+class BuiltinParallelForAPI CV_FINAL : public ParallelForAPI
+{
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) CV_OVERRIDE;
+    int getThreadNum() const CV_OVERRIDE { return getThreadNum_(); }
+    int getNumThreads() const CV_OVERRIDE { return getNumThreads_(); }
+    int setNumThreads(int nThreads) CV_OVERRIDE
+    {
+        int prev = getNumThreads_();
+        setNumThreads_(nThreads);
+        return prev;
+    }
+    const char* getName() const CV_OVERRIDE { return CV_PARALLEL_FRAMEWORK; }
+};
+#endif
+
+class SequentialParallelForAPI CV_FINAL : public ParallelForAPI
+{
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) CV_OVERRIDE
+    {
+        if (tasks > 0)
+            body_callback(0, tasks, callback_data);
+    }
+    int getThreadNum() const CV_OVERRIDE { return 0; }
+    int getNumThreads() const CV_OVERRIDE { return 1; }
+    int setNumThreads(int /*nThreads*/) CV_OVERRIDE { return 1; }
+    const char* getName() const CV_OVERRIDE { return "sequential"; }
+};
+
+static std::shared_ptr<ParallelForAPI>& getBuiltinParallelForAPI()
+{
+#ifdef CV_PARALLEL_FRAMEWORK
+    CV_SINGLETON_LAZY_INIT_REF(std::shared_ptr<ParallelForAPI>, new std::shared_ptr<ParallelForAPI>(std::make_shared<BuiltinParallelForAPI>()))
+#else
+    CV_SINGLETON_LAZY_INIT_REF(std::shared_ptr<ParallelForAPI>, new std::shared_ptr<ParallelForAPI>(std::make_shared<SequentialParallelForAPI>()))
+#endif
+}
+
+static std::shared_ptr<ParallelForAPI>& getCurrentParallelForAPI()
+{
+    CV_SINGLETON_LAZY_INIT_REF(std::shared_ptr<ParallelForAPI>, new std::shared_ptr<ParallelForAPI>())
+}
+
+// non-NULL if loops are routed to the backend instead of the built-in parallel framework
+static ParallelForAPI* currentExternalAPI = NULL;
+
+static void parallel_for_cb(int start, int end, void* data)
+{
+    const cv::ParallelLoopBody& body = *(const cv::ParallelLoopBody*)data;
+    body(cv::Range(start, end));
+}
+
+} // namespace
+}} // namespace
+
+// reduces number of stripes according to the thread and grain size limits of the context
+static double limitStripes(const cv::Range& range, double nstripes, const cv::parallel::ExecutionContext& context)
+{
+    double len = range.end - range.start;
+    double result = nstripes <= 0 ? len : std::min(nstripes, len);
+    if (context.getGrainSize() > 0)
+        result = std::min(result, std::max(1., std::floor(len / context.getGrainSize())));
+    if (context.getMaxThreads() > 0 && context.getMaxThreads() < getNumThreads_())
+        result = std::min(result, (double)context.getMaxThreads());
+    return result;
+}
 
 void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
 {
@@ -497,6 +616,27 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
     if (range.empty())
         return;
 
+    const cv::parallel::ExecutionContext* context = getCoreTlsData().executionContext;
+    if (context)
+    {
+        nstripes = limitStripes(range, nstripes, *context);
+        if (nstripes <= 1 && !context->getExecutor())
+        {
+            body(range);
+            return;
+        }
+    }
+
+#ifdef CV_PARALLEL_FRAMEWORK
+    if (cv::parallel::currentExternalAPI)
+    {
+        parallel_for_impl(range, body, nstripes);
+        return;
+    }
+#endif
+#if defined CV_PARALLEL_FRAMEWORK && defined CV_PARALLEL_FOR_NESTED
+    parallel_for_impl(range, body, nstripes);
+#else
 #ifdef CV_PARALLEL_FRAMEWORK
     static std::atomic<bool> flagNestedParallelFor(false);
     bool isNotNestedRegion = !flagNestedParallelFor.load();
@@ -521,70 +661,87 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
         CV_UNUSED(nstripes);
         body(range);
     }
+#endif // CV_PARALLEL_FOR_NESTED
 }
 
 #ifdef CV_PARALLEL_FRAMEWORK
-static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
+static void parallel_for_framework(ProxyLoopBody& pbody)
 {
-    if ((numThreads < 0 || numThreads > 1) && range.end - range.start > 1)
-    {
-        ParallelLoopBodyWrapperContext ctx(body, range, nstripes);
-        ProxyLoopBody pbody(ctx);
-        cv::Range stripeRange = pbody.stripeRange();
-        if( stripeRange.end - stripeRange.start == 1 )
-        {
-            body(range);
-            return;
-        }
+    cv::Range stripeRange = pbody.stripeRange();
+    CV_UNUSED(stripeRange);
 
 #if defined HAVE_TBB
 
 #if TBB_INTERFACE_VERSION >= 8000
-        tbbArena.execute(pbody);
+    tbbArena.execute(pbody);
 #else
-        pbody();
+    pbody();
 #endif
 
 #elif defined HAVE_HPX
-        pbody();
+    pbody();
 
 #elif defined HAVE_OPENMP
 
-        #pragma omp parallel for schedule(dynamic) num_threads(numThreads > 0 ? numThreads : numThreadsMax)
-        for (int i = stripeRange.start; i < stripeRange.end; ++i)
-            pbody(Range(i, i + 1));
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads > 0 ? numThreads : numThreadsMax)
+    for (int i = stripeRange.start; i < stripeRange.end; ++i)
+        pbody(Range(i, i + 1));
 
 #elif defined HAVE_GCD
 
-        dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
-        dispatch_apply_f(stripeRange.end - stripeRange.start, concurrent_queue, &pbody, block_function);
+    dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_apply_f(stripeRange.end - stripeRange.start, concurrent_queue, &pbody, block_function);
 
 #elif defined WINRT
 
-        Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
+    Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
 
 #elif defined HAVE_CONCURRENCY
 
-        if(!pplScheduler || pplScheduler->Id() == Concurrency::CurrentScheduler::Id())
-        {
-            Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
-        }
-        else
-        {
-            pplScheduler->Attach();
-            Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
-            Concurrency::CurrentScheduler::Detach();
-        }
+    if(!pplScheduler || pplScheduler->Id() == Concurrency::CurrentScheduler::Id())
+    {
+        Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
+    }
+    else
+    {
+        pplScheduler->Attach();
+        Concurrency::parallel_for(stripeRange.start, stripeRange.end, pbody);
+        Concurrency::CurrentScheduler::Detach();
+    }
 
 #elif defined HAVE_PTHREADS_PF
 
-        parallel_for_pthreads(pbody.stripeRange(), pbody, pbody.stripeRange().size());
+    parallel_for_pthreads(pbody.stripeRange(), pbody, pbody.stripeRange().size());
 
 #else
 
 #error You have hacked and compiling with unsupported parallel framework
 
 #endif
+}
+
+static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
+{
+    const cv::parallel::ExecutionContext* context = getCoreTlsData().executionContext;
+    const bool useExecutor = context && context->getExecutor();
+    cv::parallel::ParallelForAPI* api = cv::parallel::currentExternalAPI;
+    if ((numThreads < 0 || numThreads > 1 || useExecutor || api) && range.end - range.start > 1)
+    {
+        ParallelLoopBodyWrapperContext ctx(body, range, nstripes);
+        ProxyLoopBody pbody(ctx);
+        cv::Range stripeRange = pbody.stripeRange();
+        if( stripeRange.end - stripeRange.start == 1 )
+        {
+            body(range);
+            return;
+        }
+
+        if (useExecutor)
+            context->getExecutor()(stripeRange, pbody, stripeRange.size());
+        else if (api)
+            api->parallel_for(stripeRange.size(), cv::parallel::parallel_for_cb, (void*)static_cast<const cv::ParallelLoopBody*>(&pbody));
+        else
+            parallel_for_framework(pbody);
 
         ctx.finalize();  // propagate exceptions if exists
     }
@@ -593,10 +750,134 @@ static void parallel_for_impl(const cv::Range& range, const cv::ParallelLoopBody
         body(range);
     }
 }
+
+void cv::parallel::BuiltinParallelForAPI::parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data)
+{
+    if (tasks <= 0)
+        return;
+    CallbackLoopBody body(body_callback, callback_data);
+    ParallelLoopBodyWrapperContext ctx(body, cv::Range(0, tasks), tasks);
+    ProxyLoopBody pbody(ctx);
+    if (tasks == 1 || numThreads == 0 || numThreads == 1)
+        body(cv::Range(0, tasks));
+    else
+        parallel_for_framework(pbody);
+    ctx.finalize();  // propagate exceptions if exists
+}
 #endif // CV_PARALLEL_FRAMEWORK
 
+namespace cv { namespace parallel {
+
+void setParallelForBackend(const std::shared_ptr<ParallelForAPI>& api, bool propagateNumThreads)
+{
+    std::shared_ptr<ParallelForAPI>& current = getCurrentParallelForAPI();
+    current = api;
+    currentExternalAPI = (api && api != getBuiltinParallelForAPI()) ? api.get() : NULL;
+    CV_LOG_INFO(NULL, "core(parallel): switched to " << (api ? api->getName() : "built-in") << " backend");
+#ifdef CV_PARALLEL_FRAMEWORK
+    if (propagateNumThreads && currentExternalAPI && numThreads >= 0)
+        currentExternalAPI->setNumThreads(numThreads);
+#else
+    CV_UNUSED(propagateNumThreads);
+#endif
+}
+
+bool setParallelForBackend(const std::string& backendName, bool propagateNumThreads)
+{
+    std::shared_ptr<ParallelForAPI> api;
+    const std::string name = cv::toLowerCase(backendName);
+    if (name == getBuiltinParallelForAPI()->getName())
+        api = getBuiltinParallelForAPI();
+    else if (name == "sequential")
+        api = std::make_shared<SequentialParallelForAPI>();
+    else
+    {
+        CV_LOG_WARNING(NULL, "core(parallel): unknown backend: " << backendName);
+        return false;
+    }
+    setParallelForBackend(api, propagateNumThreads);
+    return true;
+}
+
+std::shared_ptr<ParallelForAPI> getParallelForBackend()
+{
+    const std::shared_ptr<ParallelForAPI>& current = getCurrentParallelForAPI();
+    return current ? current : getBuiltinParallelForAPI();
+}
+
+std::vector<std::string> getParallelForBackendNames()
+{
+    std::vector<std::string> names;
+#ifdef CV_PARALLEL_FRAMEWORK
+    names.push_back(CV_PARALLEL_FRAMEWORK);
+#endif
+    names.push_back("sequential");
+    return names;
+}
+
+ExecutionContext::ExecutionContext(int maxThreads, int grainSize, const Executor& executor) :
+    maxThreads_(std::max(0, maxThreads)),
+    grainSize_(std::max(0, grainSize)),
+    executor_(executor)
+{
+    CoreTLSData& tlsData = getCoreTlsData();
+    previous_ = tlsData.executionContext;
+    if (previous_)
+    {
+        if (previous_->maxThreads_ > 0)
+            maxThreads_ = maxThreads_ > 0 ? std::min(maxThreads_, previous_->maxThreads_) : previous_->maxThreads_;
+        grainSize_ = std::max(grainSize_, previous_->grainSize_);
+        if (!executor_)
+            executor_ = previous_->executor_;
+    }
+    tlsData.executionContext = this;
+}
+
+ExecutionContext::~ExecutionContext()
+{
+    CoreTLSData& tlsData = getCoreTlsData();
+    CV_DbgAssert(tlsData.executionContext == this);
+    tlsData.executionContext = previous_;
+}
+
+const ExecutionContext* ExecutionContext::getCurrent()
+{
+    return getCoreTlsData().executionContext;
+}
+
+}} // namespace
+
+
+cv::utils::ParallelStats cv::utils::getParallelStats()
+{
+    ParallelStats stats;
+    stats.backend = cv::parallel::getParallelForBackend()->getName();
+    stats.numThreads = cv::getNumThreads();
+#ifdef HAVE_PTHREADS_PF
+    if (!cv::parallel::currentExternalAPI)
+        parallel_pthreads_get_stats(stats);
+#endif
+    return stats;
+}
+
+void cv::utils::resetParallelStats()
+{
+#ifdef HAVE_PTHREADS_PF
+    parallel_pthreads_reset_stats();
+#endif
+}
 
 int cv::getNumThreads(void)
+{
+    cv::parallel::ParallelForAPI* api = cv::parallel::currentExternalAPI;
+    int result = api ? api->getNumThreads() : getNumThreads_();
+    const cv::parallel::ExecutionContext* context = getCoreTlsData().executionContext;
+    if (context && context->getMaxThreads() > 0)
+        result = std::min(result, context->getMaxThreads());
+    return result;
+}
+
+static int getNumThreads_()
 {
 #ifdef CV_PARALLEL_FRAMEWORK
 
@@ -679,6 +960,14 @@ unsigned defaultNumberOfThreads()
 }
 
 void cv::setNumThreads( int threads_ )
+{
+    setNumThreads_(threads_);
+    cv::parallel::ParallelForAPI* api = cv::parallel::currentExternalAPI;
+    if (api)
+        api->setNumThreads(threads_ < 0 ? (int)defaultNumberOfThreads() : threads_);
+}
+
+static void setNumThreads_( int threads_ )
 {
     CV_UNUSED(threads_);
 #ifdef CV_PARALLEL_FRAMEWORK
@@ -739,6 +1028,12 @@ void cv::setNumThreads( int threads_ )
 
 
 int cv::getThreadNum(void)
+{
+    cv::parallel::ParallelForAPI* api = cv::parallel::currentExternalAPI;
+    return api ? api->getThreadNum() : getThreadNum_();
+}
+
+static int getThreadNum_()
 {
 #if defined HAVE_TBB
     #if TBB_INTERFACE_VERSION >= 9100
@@ -826,6 +1121,52 @@ int getNumberOfCPUsImpl(const char *filename)
 }
 #endif
 
+#if defined __linux__
+static
+std::vector<int> parseCPUList(const std::string& str)
+{
+    //parse string of form "0-1,3,5-7,10,13-15"
+    std::vector<int> result;
+    size_t pos = 0;
+    while (pos < str.size())
+    {
+        size_t end = str.find(',', pos);
+        if (end == std::string::npos)
+            end = str.size();
+        int rstart = 0, rend = 0;
+        int n = sscanf(str.c_str() + pos, "%d-%d", &rstart, &rend);
+        if (n == 1)
+            rend = rstart;
+        if (n >= 1)
+        {
+            for (int i = rstart; i <= rend; i++)
+                result.push_back(i);
+        }
+        pos = end + 1;
+    }
+    return result;
+}
+#endif
+
+std::vector<int> cv::getNUMANodes()
+{
+#if defined __linux__
+    return parseCPUList(getFileContents("/sys/devices/system/node/online"));
+#else
+    return std::vector<int>();
+#endif
+}
+
+std::vector<int> cv::getNUMANodeCPUs(int node)
+{
+#if defined __linux__
+    return parseCPUList(getFileContents(cv::format("/sys/devices/system/node/node%d/cpulist", node).c_str()));
+#else
+    CV_UNUSED(node);
+    return std::vector<int>();
+#endif
+}
+
 #if defined CV_HAVE_CGROUPS
 static inline
 unsigned getNumberOfCPUsCFS()
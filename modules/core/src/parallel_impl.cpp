@@ -17,13 +17,15 @@
 #include <opencv2/core/utils/logger.hpp>
 
 #include <opencv2/core/utils/trace.private.hpp>
-
-//#define CV_PROFILE_THREADS 64
-//#define getTickCount getCPUTickCount  // use this if getTickCount() calls are expensive (and getCPUTickCount() is accurate)
-
-//#define CV_USE_GLOBAL_WORKERS_COND_VAR  // not effective on many-core systems (10+)
+#include <opencv2/core/utils/parallel_stats.hpp>
 
 #include <atomic>
+#include <deque>
+
+#if defined __linux__ && defined _GNU_SOURCE && !defined __ANDROID__ && !defined __EMSCRIPTEN__
+#include <sched.h>
+#define CV_HAVE_THREAD_AFFINITY 1
+#endif
 
 // Spin lock's OS-level yield
 #ifdef DECLARE_CV_YIELD
@@ -60,6 +62,8 @@ DECLARE_CV_PAUSE
 #endif // CV_PAUSE
 
 
+
+
 namespace cv
 {
 
@@ -69,9 +73,117 @@ static int CV_MAIN_THREAD_ACTIVE_WAIT = (int)utils::getConfigurationParameterSiz
 
 static int CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT = (int)utils::getConfigurationParameterSizeT("OPENCV_THREAD_POOL_ACTIVE_WAIT_THREADS_LIMIT", 0); // number of real cores
 
+enum { WORKER_AFFINITY_NONE = 0, WORKER_AFFINITY_CORE, WORKER_AFFINITY_NODE };
+
+// OPENCV_THREAD_POOL_AFFINITY:
+// - "none": workers are scheduled by OS
+// - "core": worker N is pinned to the (N+1)-th CPU of the process affinity mask (the first one is left for the calling thread)
+// - "node": workers are distributed over NUMA nodes, and each worker may run on any CPU of its node
+static int getWorkerAffinityMode()
+{
+    static int mode = -1;
+    if (mode < 0)
+    {
+        std::string value = utils::getConfigurationParameterString("OPENCV_THREAD_POOL_AFFINITY", "none");
+        if (value == "core")
+            mode = WORKER_AFFINITY_CORE;
+        else if (value == "node")
+            mode = WORKER_AFFINITY_NODE;
+        else
+        {
+            if (value != "none" && !value.empty())
+                CV_LOG_WARNING(NULL, "Unknown OPENCV_THREAD_POOL_AFFINITY value: " << value << " (supported: none, core, node)");
+            mode = WORKER_AFFINITY_NONE;
+        }
+    }
+    return mode;
+}
+
+/*
+ Scheduling of the thread pool:
+ - each worker thread owns a queue of tasks (parts of the stripes range of some job).
+   The owner takes tasks from the back of its queue, other threads steal tasks from the front (the oldest and the largest parts).
+ - threads outside of the pool get a queue from the set of "external" slots for the time of parallel_for_() call,
+   so jobs of concurrent callers are processed at the same time.
+ - a new job is split into parts for all threads. Part of a task is split in halves down to the job grain size,
+   the second halves stay in the queue of the executing thread and can be stolen.
+ - nested parallel_for_() calls are handled in the same way as the top-level ones.
+ - a thread waits for completion of its job by executing tasks of this job from any queue.
+
+ Statistics (see cv::utils::getParallelStats()) are updated with each executed task and with each completed job.
+*/
+
 class WorkerThread;
 class ParallelJob;
 
+struct ParallelTask
+{
+    ParallelJob* job;
+    int begin;  // range of stripes of the job
+    int end;
+};
+
+class TaskQueue
+{
+public:
+    TaskQueue(int index_) :
+        index(index_),
+        is_used(false)
+    {
+        size.store(0, std::memory_order_relaxed);
+        int res = pthread_mutex_init(&mutex, NULL);
+        if (res != 0)
+        {
+            CV_LOG_ERROR(NULL, index << ": Can't create task queue mutex: res = " << res);
+        }
+        dummy_[0] = 0; // compiler warning
+    }
+
+    ~TaskQueue()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void push(const ParallelTask& task)
+    {
+        pthread_mutex_lock(&mutex);
+        tasks.push_back(task);
+        size.fetch_add(1, std::memory_order_seq_cst);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Takes a task of the specified job (of any job if NULL) from the back (owner side) or from the front (thief side)
+    bool take(ParallelTask& task, const ParallelJob* job, bool from_back)
+    {
+        if (size.load(std::memory_order_acquire) <= 0)
+            return false;
+        bool res = false;
+        pthread_mutex_lock(&mutex);
+        const int n = (int)tasks.size();
+        for (int i = 0; i < n; i++)
+        {
+            int idx = from_back ? n - 1 - i : i;
+            if (job == NULL || tasks[idx].job == job)
+            {
+                task = tasks[idx];
+                tasks.erase(tasks.begin() + idx);
+                size.fetch_sub(1, std::memory_order_seq_cst);
+                res = true;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&mutex);
+        return res;
+    }
+
+    const int index;  // in ThreadPool::queues
+    std::atomic<bool> is_used;  // slot is taken by a thread outside of the pool
+    std::atomic<int> size;
+    pthread_mutex_t mutex;
+    std::deque<ParallelTask> tasks;
+    int64 dummy_[8];  // avoid cache-line reusing for queues of different threads
+};
+
 class ThreadPool
 {
 public:
@@ -91,7 +203,8 @@ public:
         if (new_threads_count == threads.size())
             return;
         pthread_mutex_lock(&mutex);
-        reconfigure_(new_threads_count);
+        if (active_jobs == 0)
+            reconfigure_(new_threads_count);
         pthread_mutex_unlock(&mutex);
     }
     bool reconfigure_(unsigned new_threads_count); // internal implementation
@@ -102,84 +215,51 @@ public:
 
     void setNumOfThreads(unsigned n);
 
+    void push(TaskQueue& queue, const ParallelTask& task, WorkerThread* target);
+    bool findTask(TaskQueue* queue, const ParallelJob* job, ParallelTask& task);
+    void execute(ParallelTask task, TaskQueue* queue, WorkerThread* worker);
+    void wait(ParallelJob& job, TaskQueue* queue, WorkerThread* worker);
+
+    void updateStats(const ParallelJob& job);
+    void getStats(utils::ParallelStats& stats);
+    void resetStats();
+
     ThreadPool();
 
     ~ThreadPool();
 
     unsigned num_threads;
 
-    pthread_mutex_t mutex;  // guards fields (job/threads) from non-worker threads (concurrent parallel_for calls)
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    pthread_cond_t cond_thread_wake;
-#endif
+    pthread_mutex_t mutex;  // guards threads/queues reconfiguration from parallel_for calls
+    std::atomic<int> active_jobs;  // threads/queues are not changed while jobs are processed
+
+    pthread_key_t worker_key;  // WorkerThread of the current thread
 
     pthread_mutex_t mutex_notify;
     pthread_cond_t cond_thread_task_complete;
+    std::atomic<int> blocked_waiters;  // threads which wait on cond_thread_task_complete
 
     std::vector< Ptr<WorkerThread> > threads;
-
-    Ptr<ParallelJob> job;
-
-#ifdef CV_PROFILE_THREADS
-    double tickFreq;
-    int64 jobSubmitTime;
-    struct ThreadStatistics
-    {
-        ThreadStatistics() : threadWait(0)
-        {
-            reset();
-        }
-        void reset()
-        {
-            threadWake = 0;
-            threadExecuteStart = 0;
-            threadExecuteStop = 0;
-            executedTasks = 0;
-            keepActive = false;
-            threadPing = getTickCount();
-        }
-        int64 threadWait; // don't reset by default
-        int64 threadPing; // don't reset by default
-        int64 threadWake;
-        int64 threadExecuteStart;
-        int64 threadExecuteStop;
-        int64 threadFree;
-        unsigned executedTasks;
-        bool keepActive;
-
-        int64 dummy_[8]; // separate cache lines
-
-        void dump(int id, int64 baseTime, double tickFreq)
-        {
-            if (id < 0)
-                std::cout << "Main: ";
-            else
-                printf("T%03d: ", id + 2);
-            printf("wait=% 10.1f   ping=% 6.1f",
-                    threadWait > 0 ? (threadWait - baseTime) / tickFreq * 1e6 : -0.0,
-                    threadPing > 0 ? (threadPing - baseTime) / tickFreq * 1e6 : -0.0);
-            if (threadWake > 0)
-                printf("   wake=% 6.1f",
-                    (threadWake > 0 ? (threadWake - baseTime) / tickFreq * 1e6 : -0.0));
-            if (threadExecuteStart > 0)
-            {
-                printf("   exec=% 6.1f - % 6.1f   tasksDone=%5u   free=% 6.1f",
-                    (threadExecuteStart > 0 ? (threadExecuteStart - baseTime) / tickFreq * 1e6 : -0.0),
-                    (threadExecuteStop > 0 ? (threadExecuteStop - baseTime) / tickFreq * 1e6 : -0.0),
-                    executedTasks,
-                    (threadFree > 0 ? (threadFree - baseTime) / tickFreq * 1e6 : -0.0));
-                if (id >= 0)
-                    printf(" active=%s\n", keepActive ? "true" : "false");
-                else
-                    printf("\n");
-            }
-            else
-                printf("   ------------------------------------------------------------------------------\n");
-        }
-    };
-    ThreadStatistics threads_stat[CV_PROFILE_THREADS]; // 0 - main thread, 1..N - worker threads
-#endif
-
+    std::vector< Ptr<TaskQueue> > queues;  // queues of worker threads followed by slots for external threads
+
+    std::atomic<int> queued_tasks;  // total number of tasks in all queues
+    std::atomic<int> sleeping_workers;
+
+    std::atomic<uint64> job_counter;
+
+    // statistics of threads outside of the pool
+    std::atomic<int64> external_busy_ticks;
+    std::atomic<uint64> external_tasks;
+    std::atomic<uint64> external_stripes;
+
+    pthread_mutex_t mutex_stats;  // guards statistics of completed jobs
+    uint64 stat_jobs;
+    uint64 stat_stripes;
+    uint64 stat_started_jobs;  // jobs with tasks started by worker threads
+    int64 stat_latency_sum;
+    int64 stat_latency_max;
+    double stat_imbalance_sum;
+    double stat_imbalance_max;
 };
 
 class WorkerThread
@@ -187,47 +267,56 @@ class WorkerThread
 public:
     ThreadPool& thread_pool;
     const unsigned id;
+    TaskQueue& queue;
     pthread_t posix_thread;
     bool is_created;
+    bool allow_active_wait;
 
     std::atomic<bool> stop_thread;
 
     std::atomic<bool> has_wake_signal;
-
-    Ptr<ParallelJob> job;
+    std::atomic<bool> is_sleeping;
 
     pthread_mutex_t mutex;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    volatile bool isActive;
     pthread_cond_t cond_thread_wake;
-#endif
 
-    WorkerThread(ThreadPool& thread_pool_, unsigned id_) :
+    uint64 last_job_id;  // to count threads which have processed a job
+    std::atomic<int64> start_time;  // creation or statistics reset time
+    std::atomic<int64> busy_ticks;
+    std::atomic<uint64> executed_tasks;
+    std::atomic<uint64> executed_stripes;
+
+    WorkerThread(ThreadPool& thread_pool_, unsigned id_, TaskQueue& queue_, unsigned pool_size) :
         thread_pool(thread_pool_),
         id(id_),
+        queue(queue_),
         posix_thread(0),
         is_created(false),
+        allow_active_wait(CV_WORKER_ACTIVE_WAIT > 0),
         stop_thread(false),
-        has_wake_signal(false)
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-        , isActive(true)
-#endif
+        has_wake_signal(false),
+        is_sleeping(false),
+        last_job_id(0)
     {
+        start_time.store(getTickCount());
+        busy_ticks.store(0);
+        executed_tasks.store(0);
+        executed_stripes.store(0);
         CV_LOG_VERBOSE(NULL, 1, "MainThread: initializing new worker: " << id);
+        if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0 && pool_size >= (unsigned)CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0)
+            allow_active_wait = false;  // turn off a half of threads
         int res = pthread_mutex_init(&mutex, NULL);
         if (res != 0)
         {
             CV_LOG_ERROR(NULL, id << ": Can't create thread mutex: res = " << res);
             return;
         }
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         res = pthread_cond_init(&cond_thread_wake, NULL);
         if (res != 0)
         {
             CV_LOG_ERROR(NULL, id << ": Can't create thread condition variable: res = " << res);
             return;
         }
-#endif
         res = pthread_create(&posix_thread, NULL, thread_loop_wrapper, (void*)this);
         if (res != 0)
         {
@@ -249,21 +338,30 @@ public:
                 pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
                 stop_thread = true;
                 pthread_mutex_unlock(&mutex);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                pthread_cond_broadcast(&thread_pool.cond_thread_wake);
-#else
                 pthread_cond_signal(&cond_thread_wake);
-#endif
             }
             pthread_join(posix_thread, NULL);
         }
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         pthread_cond_destroy(&cond_thread_wake);
-#endif
         pthread_mutex_destroy(&mutex);
     }
 
+    // returns false if the thread is not sleeping or it is already notified
+    bool wake()
+    {
+        if (!is_sleeping)
+            return false;
+        pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
+        bool need_signal = is_sleeping && !has_wake_signal;
+        has_wake_signal = true;
+        pthread_mutex_unlock(&mutex);
+        if (need_signal)
+            pthread_cond_signal(&cond_thread_wake);
+        return need_signal;
+    }
+
     void thread_body();
+    void setAffinity();
     static void* thread_loop_wrapper(void* thread_object)
     {
 #ifdef OPENCV_WITH_ITT
@@ -277,18 +375,19 @@ public:
 class ParallelJob
 {
 public:
-    ParallelJob(const ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_) :
-        thread_pool(thread_pool_),
+    ParallelJob(const Range& range_, const ParallelLoopBody& body_, int grain_, uint64 id_) :
         body(body_),
         range(range_),
-        nstripes((unsigned)nstripes_),
+        grain(grain_),
+        id(id_),
+        submit_time(getTickCount()),
         is_completed(false)
     {
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::ParallelJob(" << (void*)this << ")");
-        current_task.store(0, std::memory_order_relaxed);
-        active_thread_count.store(0, std::memory_order_relaxed);
-        completed_thread_count.store(0, std::memory_order_relaxed);
-        dummy0_[0] = 0, dummy1_[0] = 0, dummy2_[0] = 0; // compiler warning
+        remaining_tasks.store(range.size(), std::memory_order_relaxed);
+        start_latency.store(-1, std::memory_order_relaxed);
+        busy_ticks.store(0, std::memory_order_relaxed);
+        participants.store(1, std::memory_order_relaxed);  // the calling thread
     }
 
     ~ParallelJob()
@@ -296,80 +395,87 @@ public:
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::~ParallelJob(" << (void*)this << ")");
     }
 
-    unsigned execute(bool is_worker_thread)
-    {
-        unsigned executed_tasks = 0;
-        const int task_count = range.size();
-        const int remaining_multiplier = std::min(nstripes,
-                std::max(
-                        std::min(100u, thread_pool.num_threads * 4),
-                        thread_pool.num_threads * 2
-                ));  // experimental value
-        for (;;)
-        {
-            int chunk_size = std::max(1, (task_count - current_task) / remaining_multiplier);
-            int id = current_task.fetch_add(chunk_size, std::memory_order_seq_cst);
-            if (id >= task_count)
-                break; // no more free tasks
-
-            executed_tasks += chunk_size;
-            int start_id = id;
-            int end_id = std::min(task_count, id + chunk_size);
-            CV_LOG_VERBOSE(NULL, 9, "Thread: job " << start_id << "-" << end_id);
-
-            //TODO: if (not pending exception)
-            {
-                body.operator()(Range(range.start + start_id, range.start + end_id));
-            }
-            if (is_worker_thread && is_completed)
-            {
-                CV_LOG_ERROR(NULL, "\t\t\t\tBUG! Job: " << (void*)this << " " << id << " " << active_thread_count << " " << completed_thread_count);
-                CV_Assert(!is_completed); // TODO Dbg this
-            }
-        }
-        return executed_tasks;
-    }
-
-    const ThreadPool& thread_pool;
     const ParallelLoopBody& body;
     const Range range;
-    const unsigned nstripes;
-
-    std::atomic<int> current_task;  // next free part of job
-    int64 dummy0_[8];  // avoid cache-line reusing for the same atomics
-
-    std::atomic<int> active_thread_count;  // number of threads worked on this job
-    int64 dummy1_[8];  // avoid cache-line reusing for the same atomics
-
-    std::atomic<int> completed_thread_count;  // number of threads completed any activities on this job
-    int64 dummy2_[8];  // avoid cache-line reusing for the same atomics
+    const int grain;  // tasks of this size are not split anymore
+    const uint64 id;
+    const int64 submit_time;
 
+    std::atomic<int> remaining_tasks;  // number of not processed stripes
     std::atomic<bool> is_completed;
 
-    // TODO exception handling
+    std::atomic<int64> start_latency;  // till the first task started by a worker thread, -1 if there is no such task
+    std::atomic<int64> busy_ticks;  // execution time of all tasks
+    std::atomic<int> participants;  // number of threads which have processed tasks
 };
 
 
+void WorkerThread::setAffinity()
+{
+    int mode = getWorkerAffinityMode();
+    if (mode == WORKER_AFFINITY_NONE)
+        return;
+#ifdef CV_HAVE_THREAD_AFFINITY
+    cpu_set_t allowed;  // inherited from the thread which has created the pool
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return;
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (mode == WORKER_AFFINITY_CORE)
+    {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        }
+        if (!cpus.empty())
+            CPU_SET(cpus[(id + 1) % cpus.size()], &cpu_set);
+    }
+    else
+    {
+        std::vector<int> nodes = getNUMANodes();
+        if (nodes.empty())
+            return;
+        std::vector<int> cpus = getNUMANodeCPUs(nodes[id % nodes.size()]);
+        for (size_t i = 0; i < cpus.size(); i++)
+        {
+            if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE && CPU_ISSET(cpus[i], &allowed))
+                CPU_SET(cpus[i], &cpu_set);
+        }
+    }
+    if (CPU_COUNT(&cpu_set) == 0)
+        return;
+    int res = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (res != 0)
+        CV_LOG_WARNING(NULL, id << ": Can't set thread affinity: res = " << res);
+#else
+    if (id == 0)
+        CV_LOG_WARNING(NULL, "OPENCV_THREAD_POOL_AFFINITY is not supported on this platform");
+#endif
+}
+
 void WorkerThread::thread_body()
 {
     (void)cv::utils::getThreadID(); // notify OpenCV about new thread
     CV_LOG_VERBOSE(NULL, 5, "Thread: new thread: " << id);
-
-    bool allow_active_wait = true;
-
-#ifdef CV_PROFILE_THREADS
-    ThreadPool::ThreadStatistics& stat = thread_pool.threads_stat[id + 1];
-#endif
+    pthread_setspecific(thread_pool.worker_key, this);
+    setAffinity();
 
     while (!stop_thread)
     {
-        CV_LOG_VERBOSE(NULL, 5, "Thread: ... loop iteration: allow_active_wait=" << allow_active_wait << "   has_wake_signal=" << has_wake_signal);
-        if (allow_active_wait && CV_WORKER_ACTIVE_WAIT > 0)
+        ParallelTask task;
+        if (thread_pool.findTask(&queue, NULL, task))
+        {
+            thread_pool.execute(task, &queue, this);
+            continue;
+        }
+        if (allow_active_wait)
         {
-            allow_active_wait = false;
             for (int i = 0; i < CV_WORKER_ACTIVE_WAIT; i++)
             {
-                if (has_wake_signal)
+                if (thread_pool.queued_tasks > 0 || stop_thread)
                     break;
                 if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
                     CV_PAUSE(16);
@@ -378,104 +484,40 @@ void WorkerThread::thread_body()
             }
         }
         pthread_mutex_lock(&mutex);
-#ifdef CV_PROFILE_THREADS
-        stat.threadWait = getTickCount();
-#endif
-        while (!has_wake_signal) // to handle spurious wakeups
+        is_sleeping = true;
+        thread_pool.sleeping_workers++;
+        // queued_tasks is checked after sleeping_workers update, see ThreadPool::push()
+        while (!has_wake_signal && !stop_thread && thread_pool.queued_tasks <= 0) // to handle spurious wakeups
         {
-            //CV_LOG_VERBOSE(NULL, 5, "Thread: wait (sleep) ...");
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_wait(&thread_pool.cond_thread_wake, &mutex);
-#else
-            isActive = false;
             pthread_cond_wait(&cond_thread_wake, &mutex);
-            isActive = true;
-#endif
             CV_LOG_VERBOSE(NULL, 5, "Thread: wake ... (has_wake_signal=" << has_wake_signal << " stop_thread=" << stop_thread << ")")
         }
-#ifdef CV_PROFILE_THREADS
-        stat.threadWake = getTickCount();
-#endif
-
-        CV_LOG_VERBOSE(NULL, 5, "Thread: checking for new job");
-        if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT == 0)
-            allow_active_wait = true;
-        Ptr<ParallelJob> j_ptr; swap(j_ptr, job);
+        thread_pool.sleeping_workers--;
+        is_sleeping = false;
         has_wake_signal = false;
         pthread_mutex_unlock(&mutex);
-
-        if (!stop_thread)
-        {
-            ParallelJob* j = j_ptr;
-            if (j)
-            {
-                CV_LOG_VERBOSE(NULL, 5, "Thread: job size=" << j->range.size() << " done=" << j->current_task);
-                if (j->current_task < j->range.size())
-                {
-                    int other = j->active_thread_count.fetch_add(1, std::memory_order_seq_cst);
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: processing new job (with " << other << " other threads)"); CV_UNUSED(other);
-#ifdef CV_PROFILE_THREADS
-                    stat.threadExecuteStart = getTickCount();
-                    stat.executedTasks = j->execute(true);
-                    stat.threadExecuteStop = getTickCount();
-#else
-                    j->execute(true);
-#endif
-                    int completed = j->completed_thread_count.fetch_add(1, std::memory_order_seq_cst) + 1;
-                    int active = j->active_thread_count.load(std::memory_order_acquire);
-                    if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0)
-                    {
-                        allow_active_wait = true;
-                        if (active >= CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0) // turn off a half of threads
-                            allow_active_wait = false;
-                    }
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: completed job processing: " << active << " " << completed);
-                    if (active == completed)
-                    {
-                        bool need_signal = !j->is_completed;
-                        j->is_completed = true;
-                        j = NULL; j_ptr.release();
-                        if (need_signal)
-                        {
-                            CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying the main thread");
-                            pthread_mutex_lock(&thread_pool.mutex_notify);  // to avoid signal miss due pre-check condition
-                            // empty
-                            pthread_mutex_unlock(&thread_pool.mutex_notify);
-                            pthread_cond_broadcast/*pthread_cond_signal*/(&thread_pool.cond_thread_task_complete);
-                        }
-                    }
-                }
-                else
-                {
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: no free job tasks");
-                }
-            }
-        }
-#ifdef CV_PROFILE_THREADS
-        stat.threadFree = getTickCount();
-        stat.keepActive = allow_active_wait;
-#endif
     }
 }
 
 ThreadPool::ThreadPool()
 {
-#ifdef CV_PROFILE_THREADS
-    tickFreq = getTickFrequency();
-#endif
-
     int res = 0;
     res |= pthread_mutex_init(&mutex, NULL);
     res |= pthread_mutex_init(&mutex_notify, NULL);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    res |= pthread_cond_init(&cond_thread_wake, NULL);
-#endif
     res |= pthread_cond_init(&cond_thread_task_complete, NULL);
+    res |= pthread_mutex_init(&mutex_stats, NULL);
+    res |= pthread_key_create(&worker_key, NULL);
 
     if (0 != res)
     {
         CV_LOG_FATAL(NULL, "Failed to initialize ThreadPool (pthreads)");
     }
+    active_jobs.store(0);
+    blocked_waiters.store(0);
+    queued_tasks.store(0);
+    sleeping_workers.store(0);
+    job_counter.store(0);
+    resetStats();
     num_threads = defaultNumberOfThreads();
 }
 
@@ -484,38 +526,28 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
     if (new_threads_count == threads.size())
         return false;
 
-    if (new_threads_count < threads.size())
+    CV_LOG_VERBOSE(NULL, 1, "MainThread: reconfigure worker pool: " << threads.size() << " => " << new_threads_count);
+    // worker threads steal tasks from queues of each other, so all of them are stopped before the queues update
+    for (size_t i = 0; i < threads.size(); ++i)
     {
-        CV_LOG_VERBOSE(NULL, 1, "MainThread: reduce worker pool: " << threads.size() << " => " << new_threads_count);
-        std::vector< Ptr<WorkerThread> > release_threads(threads.size() - new_threads_count);
-        for (size_t i = new_threads_count; i < threads.size(); ++i)
-        {
-            pthread_mutex_lock(&threads[i]->mutex);  // to avoid signal miss due pre-check
-            threads[i]->stop_thread = true;
-            threads[i]->has_wake_signal = true;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_mutex_unlock(&threads[i]->mutex);
-            pthread_cond_broadcast/*pthread_cond_signal*/(&threads[i]->cond_thread_wake); // wake thread
-#else
-            pthread_mutex_unlock(&threads[i]->mutex);
-#endif
-            std::swap(threads[i], release_threads[i - new_threads_count]);
-        }
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-        CV_LOG_VERBOSE(NULL, 1, "MainThread: notify worker threads about termination...");
-        pthread_cond_broadcast(&cond_thread_wake); // wake all threads
-#endif
-        threads.resize(new_threads_count);
-        release_threads.clear();  // calls thread_join which want to lock mutex
-        return false;
+        WorkerThread& thread = *threads[i];
+        pthread_mutex_lock(&thread.mutex);  // to avoid signal miss due pre-check
+        thread.stop_thread = true;
+        thread.has_wake_signal = true;
+        pthread_mutex_unlock(&thread.mutex);
+        pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
     }
-    else
+    threads.clear();  // calls thread_join
+    CV_DbgAssert(queued_tasks == 0);
+    queues.clear();
+
+    if (new_threads_count > 0)
     {
-        CV_LOG_VERBOSE(NULL, 1, "MainThread: upgrade worker pool: " << threads.size() << " => " << new_threads_count);
-        for (size_t i = threads.size(); i < new_threads_count; ++i)
-        {
-            threads.push_back(Ptr<WorkerThread>(new WorkerThread(*this, (unsigned)i))); // spawn more threads
-        }
+        const unsigned num_queues = new_threads_count + /* external slots: */ new_threads_count + 1;
+        for (unsigned i = 0; i < num_queues; ++i)
+            queues.push_back(makePtr<TaskQueue>((int)i));
+        for (unsigned i = 0; i < new_threads_count; ++i)
+            threads.push_back(Ptr<WorkerThread>(new WorkerThread(*this, i, *queues[i], new_threads_count))); // spawn threads
     }
     return false;
 }
@@ -524,163 +556,219 @@ ThreadPool::~ThreadPool()
 {
     reconfigure(0);
     pthread_cond_destroy(&cond_thread_task_complete);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    pthread_cond_destroy(&cond_thread_wake);
-#endif
     pthread_mutex_destroy(&mutex);
     pthread_mutex_destroy(&mutex_notify);
+    pthread_mutex_destroy(&mutex_stats);
+    pthread_key_delete(worker_key);
+}
+
+void ThreadPool::push(TaskQueue& queue, const ParallelTask& task, WorkerThread* target)
+{
+    // Sleeping threads check queued_tasks after sleeping_workers/is_sleeping updates,
+    // so a thread either sees the new task or it is woken here.
+    queued_tasks.fetch_add(1, std::memory_order_seq_cst);
+    queue.push(task);
+    if (target && target->wake())
+        return;
+    if (sleeping_workers.load(std::memory_order_seq_cst) > 0)
+    {
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            if (threads[i]->wake())
+                break;
+        }
+    }
+}
+
+bool ThreadPool::findTask(TaskQueue* queue, const ParallelJob* job, ParallelTask& task)
+{
+    if (queued_tasks.load(std::memory_order_acquire) <= 0)
+        return false;
+    bool res = queue && queue->take(task, job, true);
+    const size_t n = queues.size();
+    const size_t start = queue ? (size_t)queue->index + 1 : 0;
+    for (size_t i = 0; !res && i < n; ++i)
+    {
+        TaskQueue& victim = *queues[(start + i) % n];
+        if (&victim != queue)
+            res = victim.take(task, job, false);
+    }
+    if (res)
+        queued_tasks.fetch_sub(1, std::memory_order_seq_cst);
+    return res;
+}
+
+void ThreadPool::execute(ParallelTask task, TaskQueue* queue, WorkerThread* worker)
+{
+    ParallelJob& job = *task.job;
+    if (queue)
+    {
+        // keep the first half, the second one is available for other threads
+        while (task.end - task.begin > job.grain)
+        {
+            ParallelTask tail = { task.job, task.begin + (task.end - task.begin) / 2, task.end };
+            push(*queue, tail, NULL);
+            task.end = tail.begin;
+        }
+    }
+    CV_LOG_VERBOSE(NULL, 9, "Thread: job " << task.begin << "-" << task.end);
+    const int64 start_time = getTickCount();
+    if (worker && worker->last_job_id != job.id)
+    {
+        worker->last_job_id = job.id;
+        if (job.participants.fetch_add(1) == 1)
+            job.start_latency = start_time - job.submit_time;
+    }
+
+    job.body(Range(job.range.start + task.begin, job.range.start + task.end));
+
+    const int count = task.end - task.begin;
+    const int64 ticks = getTickCount() - start_time;
+    job.busy_ticks += ticks;
+    if (worker)
+    {
+        worker->busy_ticks.fetch_add(ticks, std::memory_order_relaxed);
+        worker->executed_tasks.fetch_add(1, std::memory_order_relaxed);
+        worker->executed_stripes.fetch_add(count, std::memory_order_relaxed);
+    }
+    else
+    {
+        external_busy_ticks.fetch_add(ticks, std::memory_order_relaxed);
+        external_tasks.fetch_add(1, std::memory_order_relaxed);
+        external_stripes.fetch_add(count, std::memory_order_relaxed);
+    }
+    if (job.remaining_tasks.fetch_sub(count, std::memory_order_seq_cst) == count)
+    {
+        // the job may be destroyed by the waiting thread since this moment
+        job.is_completed = true;
+        if (blocked_waiters.load(std::memory_order_seq_cst) > 0)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying waiting threads");
+            pthread_mutex_lock(&mutex_notify);  // to avoid signal miss due pre-check condition
+            // empty
+            pthread_mutex_unlock(&mutex_notify);
+            pthread_cond_broadcast(&cond_thread_task_complete);
+        }
+    }
+}
+
+void ThreadPool::wait(ParallelJob& job, TaskQueue* queue, WorkerThread* worker)
+{
+    // Tasks of other jobs are not executed here: caller may hold locks which are not expected to be reentered
+    int i = 0;
+    while (!job.is_completed)
+    {
+        ParallelTask task;
+        if (findTask(queue, &job, task))
+        {
+            execute(task, queue, worker);
+            i = 0;
+        }
+        else if (i < CV_MAIN_THREAD_ACTIVE_WAIT)
+        {
+            if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
+                CV_PAUSE(16);
+            else
+                CV_YIELD();
+            i++;
+        }
+        else
+        {
+            // remaining tasks of the job are being processed by other threads
+            CV_LOG_VERBOSE(NULL, 5, "Thread: wait job completion (sleep) ...");
+            pthread_mutex_lock(&mutex_notify);
+            blocked_waiters++;
+            while (!job.is_completed)
+                pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
+            blocked_waiters--;
+            pthread_mutex_unlock(&mutex_notify);
+        }
+    }
+}
+
+static inline int partBoundary(int count, int part, int num_parts)
+{
+    return (int)((int64)count * part / num_parts);
 }
 
 void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double nstripes)
 {
-    CV_LOG_VERBOSE(NULL, 1, "MainThread: new parallel job: num_threads=" << num_threads << "   range=" << range.size() << "   nstripes=" << nstripes << "   job=" << (void*)job);
-#ifdef CV_PROFILE_THREADS
-    jobSubmitTime = getTickCount();
-    threads_stat[0].reset();
-    threads_stat[0].threadWait = jobSubmitTime;
-    threads_stat[0].threadWake = jobSubmitTime;
-#endif
+    CV_LOG_VERBOSE(NULL, 1, "Thread: new parallel job: num_threads=" << num_threads << "   range=" << range.size() << "   nstripes=" << nstripes);
     if (getNumOfThreads() > 1 &&
-        job == NULL &&
         (range.size() * nstripes >= 2 || (range.size() > 1 && nstripes <= 0))
     )
     {
         pthread_mutex_lock(&mutex);
-        if (job != NULL)
+        if (active_jobs == 0)
+            reconfigure_(num_threads - 1);
+        if (threads.empty())
         {
             pthread_mutex_unlock(&mutex);
             body(range);
             return;
         }
-        reconfigure_(num_threads - 1);
+        active_jobs++;
+        pthread_mutex_unlock(&mutex);
 
+        WorkerThread* worker = (WorkerThread*)pthread_getspecific(worker_key);
+        TaskQueue* queue = NULL;
+        if (worker)
         {
-            CV_LOG_VERBOSE(NULL, 1, "MainThread: initialize parallel job: " << range.size());
-            job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes));
-            pthread_mutex_unlock(&mutex);
-
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads...");
-            for (size_t i = 0; i < threads.size(); ++i)
-            {
-                WorkerThread& thread = *(threads[i].get());
-                if (
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                        thread.isActive ||
-#endif
-                        thread.has_wake_signal
-                        || !thread.job.empty()  // #10881
-                )
-                {
-                    pthread_mutex_lock(&thread.mutex);
-                    thread.job = job;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    bool isActive = thread.isActive;
-#endif
-                    thread.has_wake_signal = true;
-#ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-                    pthread_mutex_unlock(&thread.mutex);
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    if (!isActive)
-                    {
-                        pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-                    }
-#endif
-                }
-                else
-                {
-                    CV_Assert(thread.job.empty());
-                    thread.job = job;
-                    thread.has_wake_signal = true;
-#ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-#endif
-                }
-            }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadPing = getTickCount();
-#endif
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_broadcast(&cond_thread_wake); // wake all threads
-#endif
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadWake = getTickCount();
-#endif
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads... (done)");
-
+            queue = &worker->queue;  // nested call
+        }
+        else
+        {
+            for (size_t i = threads.size(); i < queues.size(); ++i)
             {
-                ParallelJob& j = *(this->job);
-#ifdef CV_PROFILE_THREADS
-                threads_stat[0].threadExecuteStart = getTickCount();
-                threads_stat[0].executedTasks = j.execute(false);
-                threads_stat[0].threadExecuteStop = getTickCount();
-#else
-                j.execute(false);
-#endif
-                CV_Assert(j.current_task >= j.range.size());
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: complete self-tasks: " << j.active_thread_count << " " << j.completed_thread_count);
-                if (job->is_completed || j.active_thread_count == 0)
+                bool expected = false;
+                if (queues[i]->is_used.compare_exchange_strong(expected, true))
                 {
-                    job->is_completed = true;
-                    CV_LOG_VERBOSE(NULL, 5, "MainThread: no WIP worker threads");
-                }
-                else
-                {
-                    if (CV_MAIN_THREAD_ACTIVE_WAIT > 0)
-                    {
-                        for (int i = 0; i < CV_MAIN_THREAD_ACTIVE_WAIT; i++)  // don't spin too much in any case (inaccurate getTickCount())
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (active wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
-                                CV_PAUSE(16);
-                            else
-                                CV_YIELD();
-                        }
-                    }
-                    if (!job->is_completed)
-                    {
-                        CV_LOG_VERBOSE(NULL, 5, "MainThread: prepare wait " << j.active_thread_count << " " << j.completed_thread_count);
-                        pthread_mutex_lock(&mutex_notify);
-                        for (;;)
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wait completion (sleep) ...");
-                            pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake");
-                        }
-                        pthread_mutex_unlock(&mutex_notify);
-                    }
+                    queue = queues[i].get();
+                    break;
                 }
             }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadFree = getTickCount();
-            std::cout << "Job: sz=" << range.size() << " nstripes=" << nstripes << "    Time: " << (threads_stat[0].threadFree - jobSubmitTime) / tickFreq * 1e6 << " usec" << std::endl;
-            for (int i = 0; i < (int)threads.size() + 1; i++)
+            if (!queue)
             {
-                threads_stat[i].dump(i - 1, jobSubmitTime, tickFreq);
-            }
-#endif
-            if (job)
-            {
-                pthread_mutex_lock(&mutex);
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: job release");
-                CV_Assert(job->is_completed);
-                job.release();
-                pthread_mutex_unlock(&mutex);
+                CV_LOG_VERBOSE(NULL, 5, "Thread: no free queue slots, own part of the job is not split");
             }
         }
+
+        const int task_count = range.size();
+        const int pool_size = (int)threads.size() + 1;
+        int remaining_multiplier = std::max(std::min(100, pool_size * 4), pool_size * 2);  // experimental value
+        if (nstripes > 0)
+            remaining_multiplier = std::min(remaining_multiplier, std::max(1, (int)nstripes));
+        ParallelJob job(range, body, std::max(1, task_count / remaining_multiplier), ++job_counter);
+        if (worker)
+            worker->last_job_id = job.id;  // counted as the calling thread
+
+        // the first part is processed by the calling thread, others are placed to queues of worker threads
+        const int num_parts = std::min(task_count, pool_size);
+        int part = 1;
+        for (size_t i = 0; i < threads.size() && part < num_parts; ++i)
+        {
+            WorkerThread* thread = threads[i].get();
+            if (thread == worker)
+                continue;
+            ParallelTask task = { &job, partBoundary(task_count, part, num_parts), partBoundary(task_count, part + 1, num_parts) };
+            push(thread->queue, task, thread);
+            part++;
+        }
+        if (part < num_parts)
+        {
+            ParallelTask task = { &job, partBoundary(task_count, part, num_parts), task_count };
+            push(queue ? *queue : threads[0]->queue, task, NULL);
+        }
+
+        ParallelTask task = { &job, 0, partBoundary(task_count, 1, num_parts) };
+        execute(task, queue, worker);
+        wait(job, queue, worker);
+        CV_DbgAssert(job.remaining_tasks == 0);
+        updateStats(job);
+
+        if (queue && !worker)
+            queue->is_used = false;
+        active_jobs--;
     }
     else
     {
@@ -688,6 +776,94 @@ void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double ns
     }
 }
 
+void ThreadPool::updateStats(const ParallelJob& job)
+{
+    const int64 duration = getTickCount() - job.submit_time;
+    const int64 busy = job.busy_ticks;
+    // duration of the job relative to the average busy time of its threads
+    const double imbalance = busy > 0 ? std::max(1.0, (double)duration * job.participants / busy) : 1.0;
+    const int64 latency = job.start_latency;
+
+    pthread_mutex_lock(&mutex_stats);
+    stat_jobs++;
+    stat_stripes += job.range.size();
+    if (latency >= 0)
+    {
+        stat_started_jobs++;
+        stat_latency_sum += latency;
+        stat_latency_max = std::max(stat_latency_max, latency);
+    }
+    stat_imbalance_sum += imbalance;
+    stat_imbalance_max = std::max(stat_imbalance_max, imbalance);
+    pthread_mutex_unlock(&mutex_stats);
+}
+
+void ThreadPool::getStats(utils::ParallelStats& stats)
+{
+    const double tick_time = 1.0 / getTickFrequency();
+
+    pthread_mutex_lock(&mutex_stats);
+    stats.jobs = stat_jobs;
+    stats.stripes = stat_stripes;
+    stats.avgStartLatency = stat_started_jobs > 0 ? stat_latency_sum * tick_time / stat_started_jobs : 0;
+    stats.maxStartLatency = stat_latency_max * tick_time;
+    stats.avgImbalance = stat_jobs > 0 ? stat_imbalance_sum / stat_jobs : 0;
+    stats.maxImbalance = stat_imbalance_max;
+    pthread_mutex_unlock(&mutex_stats);
+
+    stats.threads.clear();
+    pthread_mutex_lock(&mutex);  // threads are not changed
+    const int64 now = getTickCount();
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        const WorkerThread& thread = *threads[i];
+        utils::ParallelThreadStats s;
+        s.id = (int)thread.id;
+        s.busyTime = thread.busy_ticks * tick_time;
+        s.idleTime = std::max(0.0, (now - thread.start_time) * tick_time - s.busyTime);
+        s.tasks = thread.executed_tasks;
+        s.stripes = thread.executed_stripes;
+        stats.threads.push_back(s);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    utils::ParallelThreadStats s;
+    s.id = -1;
+    s.busyTime = external_busy_ticks * tick_time;
+    s.tasks = external_tasks;
+    s.stripes = external_stripes;
+    stats.threads.push_back(s);
+}
+
+void ThreadPool::resetStats()
+{
+    pthread_mutex_lock(&mutex_stats);
+    stat_jobs = 0;
+    stat_stripes = 0;
+    stat_started_jobs = 0;
+    stat_latency_sum = 0;
+    stat_latency_max = 0;
+    stat_imbalance_sum = 0;
+    stat_imbalance_max = 0;
+    pthread_mutex_unlock(&mutex_stats);
+
+    external_busy_ticks = 0;
+    external_tasks = 0;
+    external_stripes = 0;
+
+    pthread_mutex_lock(&mutex);
+    const int64 now = getTickCount();
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        WorkerThread& thread = *threads[i];
+        thread.start_time = now;
+        thread.busy_ticks = 0;
+        thread.executed_tasks = 0;
+        thread.executed_stripes = 0;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
 size_t ThreadPool::getNumOfThreads()
 {
     return num_threads;
@@ -699,7 +875,7 @@ void ThreadPool::setNumOfThreads(unsigned n)
     {
         num_threads = n;
         if (n == 1)
-           if (job == NULL) reconfigure(0);  // stop worker threads immediately
+            reconfigure(0);  // stop worker threads immediately (if there are no running jobs)
     }
 }
 
@@ -720,6 +896,16 @@ void parallel_pthreads_set_threads_num(int num)
     }
 }
 
+void parallel_pthreads_get_stats(utils::ParallelStats& stats)
+{
+    ThreadPool::instance().getStats(stats);
+}
+
+void parallel_pthreads_reset_stats()
+{
+    ThreadPool::instance().resetStats();
+}
+
 void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, double nstripes)
 {
     ThreadPool::instance().run(range, body, nstripes);
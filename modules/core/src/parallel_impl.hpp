@@ -6,11 +6,19 @@
 
 namespace cv {
 
+namespace utils { struct ParallelStats; }
+
 unsigned defaultNumberOfThreads();
 
+//! online NUMA nodes and CPUs of a node (Linux only, empty lists on other platforms)
+std::vector<int> getNUMANodes();
+std::vector<int> getNUMANodeCPUs(int node);
+
 void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, double nstripes);
 size_t parallel_pthreads_get_threads_num();
 void parallel_pthreads_set_threads_num(int num);
+void parallel_pthreads_get_stats(utils::ParallelStats& stats);
+void parallel_pthreads_reset_stats();
 
 }
 
@@ -6,6 +6,7 @@
 #include "persistence.hpp"
 #include <unordered_map>
 #include <iterator>
+#include <map>
 
 namespace cv
 {
@@ -376,6 +377,13 @@ public:
 
         filename.clear();
         lineno = 0;
+
+        handler = 0;
+        parsedNodes.clear();
+
+        binaryOfs = 0;
+        binaryStorage.release();
+        uniformElems.clear();
     }
 
     Impl(FileStorage* _fs)
@@ -406,6 +414,8 @@ public:
                     puts( "</opencv_storage>\n" );
                 else if ( fmt == FileStorage::FORMAT_JSON )
                     puts( "}\n" );
+                else if( fmt == FileStorage::FORMAT_BINARY )
+                    writeBinaryNodes();
             }
 
             closeFile();
@@ -447,7 +457,7 @@ public:
         }
     }
 
-    bool open( const char* filename_or_buf, int _flags, const char* encoding )
+    bool open( const char* filename_or_buf, int _flags, const char* encoding, size_t bufsize=0 )
     {
         _flags &= ~FileStorage::BASE64;
 
@@ -552,6 +562,8 @@ public:
                         ? FileStorage::FORMAT_XML
                     : (fs::strcasecmp(dot_pos, ".json") == 0 || fs::strcasecmp(dot_pos, ".json.gz") == 0)
                         ? FileStorage::FORMAT_JSON
+                    : (fs::strcasecmp(dot_pos, ".cvbin") == 0 || fs::strcasecmp(dot_pos, ".cvbin.gz") == 0)
+                        ? FileStorage::FORMAT_BINARY
                     : FileStorage::FORMAT_YAML;
             }
             else if( fmt == FileStorage::FORMAT_AUTO )
@@ -570,6 +582,22 @@ public:
                     append = false;
             }
 
+            if( fmt == FileStorage::FORMAT_BINARY )
+            {
+                if( append )
+                {
+                    closeFile();
+                    CV_Error( CV_StsNotImplemented, "Appending data to binary file storage is not implemented" );
+                }
+                if( file )
+                {
+                    fclose( file );
+                    file = fopen( filename.c_str(), "wb" );
+                    if( !file )
+                        return false;
+                }
+            }
+
             write_stack.clear();
             empty_stream = true;
             write_stack.push_back(FStructData("", FileNode::MAP | FileNode::EMPTY, 0));
@@ -650,6 +678,11 @@ public:
 
                 emitter = createYAMLEmitter(this);
             }
+            else if( fmt == FileStorage::FORMAT_BINARY )
+            {
+                addStreamsNode();
+                emitter = createBinaryEmitter(this);
+            }
             else
             {
                 CV_Assert( fmt == FileStorage::FORMAT_JSON );
@@ -713,6 +746,8 @@ public:
                 fmt = FileStorage::FORMAT_JSON;
             else if(strncmp( bufPtr, xml_signature, strlen(xml_signature) ) == 0)
                 fmt = FileStorage::FORMAT_XML;
+            else if(strncmp( bufPtr, binary_signature, strlen(binary_signature) ) == 0)
+                fmt = FileStorage::FORMAT_BINARY;
             else if(strbufsize  == bufOffset)
                 CV_Error(CV_BADARG_ERR, "Input file is invalid");
             else
@@ -726,12 +761,20 @@ public:
             {
                 char* ptr = bufferStart();
                 ptr[0] = ptr[1] = ptr[2] = '\0';
-                FileNode root_nodes(fs_ext, 0, 0);
+                FileNode root_nodes = addStreamsNode();
 
-                uchar* rptr = reserveNodeSpace(root_nodes, 9);
-                *rptr = FileNode::SEQ;
-                writeInt(rptr + 1, 4);
-                writeInt(rptr + 5, 0);
+                if( handler )
+                {
+                    parsedNodes.clear();
+                    ParsedNode root;
+                    root.blockIdx = root.ofs = 0;
+                    root.rewindBlockIdx = root.rewindOfs = root.rewindBlockSize = 0;
+                    root.depth = -2;
+                    root.report = false;
+                    root.keep = true;
+                    root.childMode = CHILD_STREAM;
+                    parsedNodes.push_back(root);
+                }
 
                 roots.clear();
 
@@ -759,6 +802,8 @@ public:
                             roots.push_back(*it);
                     }
                 }
+                else if( fmt == FileStorage::FORMAT_BINARY )
+                    loadBinary( bufsize );
             }
             catch(...)
             {
@@ -1070,6 +1115,9 @@ public:
         if( !data0 )
             CV_Error( CV_StsNullPtr, "Null data pointer" );
 
+        if( emitter->writeRawData(dt, data0, len*elemSize) )
+            return;
+
         if( fmt_pair_count == 1 )
         {
             fmt_pairs[0] *= (int)len;
@@ -1306,6 +1354,7 @@ public:
     // In the case (b) the existing tag and the name are copied automatically.
     uchar* reserveNodeSpace(FileNode& node, size_t sz)
     {
+        const size_t nodeBlockIdx = node.blockIdx, nodeOfs = node.ofs;
         bool shrinkBlock = false;
         size_t shrinkBlockIdx = 0, shrinkSize = 0;
 
@@ -1355,6 +1404,13 @@ public:
         node.ofs = 0;
         freeSpaceOfs = sz;
 
+        // the node being parsed has been moved
+        if( !parsedNodes.empty() && parsedNodes.back().blockIdx == nodeBlockIdx && parsedNodes.back().ofs == nodeOfs )
+        {
+            parsedNodes.back().blockIdx = node.blockIdx;
+            parsedNodes.back().ofs = node.ofs;
+        }
+
         if( ptr && ptr + 5 <= blockEnd )
         {
             new_ptr[0] = ptr[0];
@@ -1387,6 +1443,8 @@ public:
     {
         FileStorage_API* fs = this;
         bool noname = key.empty() || (fmt == FileStorage::FORMAT_XML && strcmp(key.c_str(), "_") == 0);
+        if( handler )
+            completeParsedNodes(collection);
         convertToCollection( noname ? FileNode::SEQ : FileNode::MAP, collection );
 
         bool isseq = collection.empty() ? false : collection.isSeq();
@@ -1411,10 +1469,13 @@ public:
 
         size_t blockIdx = fs_data_ptrs.size() - 1;
         size_t ofs = freeSpaceOfs;
+        size_t blockSize = fs_data_blksz[blockIdx];
         FileNode node(fs_ext, blockIdx, ofs);
 
         size_t sz0 = 1 + (noname ? 0 : 4) + 8;
         uchar* ptr = reserveNodeSpace(node, sz0);
+        if( handler )
+            startParsedNode(node, noname ? std::string() : key, blockIdx, ofs, blockSize);
 
         *ptr++ = (uchar)(elem_type | (noname ? 0 : FileNode::NAMED));
         if( elem_type == FileNode::NONE )
@@ -1429,7 +1490,7 @@ public:
         if( elem_type == FileNode::SEQ || elem_type == FileNode::MAP )
         {
             writeInt(ptr, 4);
-            writeInt(ptr, 0);
+            writeInt(ptr + 4, 0);
         }
 
         if( value )
@@ -1445,6 +1506,8 @@ public:
 
     void finalizeCollection( FileNode& collection )
     {
+        if( handler )
+            completeParsedNodes(collection);
         if( !collection.isSeq() && !collection.isMap() )
             return;
         uchar* ptr0 = collection.ptr(), *ptr = ptr0 + 1;
@@ -1468,6 +1531,409 @@ public:
         writeInt(ptr, (int)rawSize);
     }
 
+    // converts the just created empty sequence to the uniform sequence of raw data (binary storages only)
+    void setUniformData( FileNode& seq, int depth, size_t nelems, size_t dataOfs )
+    {
+        CV_Assert( seq.isSeq() && seq.size() == 0 && nelems <= (size_t)INT_MAX );
+        bool named = seq.isNamed();
+        uchar* ptr = reserveNodeSpace(seq, 1 + (named ? 4 : 0) + 4 + 16);
+        *ptr++ = (uchar)(FileNode::SEQ | FileNode::UNIFORM | (named ? FileNode::NAMED : 0));
+        if( named )
+            ptr += 4;
+        writeInt(ptr, 16);
+        writeInt(ptr + 4, (int)nelems);
+        writeInt(ptr + 8, depth);
+        writeInt(ptr + 12, (int)(unsigned)dataOfs);
+        writeInt(ptr + 16, (int)(unsigned)((uint64)dataOfs >> 32));
+    }
+
+    // creates the sequence of streams, which is the first node of the storage
+    FileNode addStreamsNode()
+    {
+        FileNode root_nodes(fs_ext, 0, 0);
+        uchar* rptr = reserveNodeSpace(root_nodes, 9);
+        *rptr = FileNode::SEQ;
+        writeInt(rptr + 1, 4);
+        writeInt(rptr + 5, 0);
+        return root_nodes;
+    }
+
+    // Incremental parsing (FileStorage::parse()).
+    // Nodes which are being parsed are kept in the stack. A node is complete when the next node
+    // is added to its parent (or to a collection above) or when the parent is finalized. Complete
+    // nodes are reported to the handler, then their storage is released, because all nodes
+    // allocated after a node belong to its subtree.
+    enum
+    {
+        CHILD_ASK = 0,  // ask handler
+        CHILD_SKIP,     // drop silently
+        CHILD_KEEP,     // keep silently (elements of a loaded node)
+        CHILD_STREAM    // top-level collections of the streams
+    };
+
+    struct ParsedNode
+    {
+        size_t blockIdx, ofs;  // position of the node
+        size_t rewindBlockIdx, rewindOfs, rewindBlockSize;  // state of the storage before the node allocation
+        int depth;
+        bool report;
+        bool keep;
+        int childMode;
+    };
+
+    struct StopParsing {};
+
+    bool parse( const char* filename_or_buf, int _flags, FileNodeHandler& _handler, size_t bufsize )
+    {
+        if( (_flags & 3) != FileStorage::READ )
+            CV_Error( CV_StsBadFlag, "FileStorage::parse() supports reading mode only" );
+        release();
+        handler = &_handler;
+        bool ok = false;
+        try
+        {
+            ok = open( filename_or_buf, _flags, 0, bufsize );
+        }
+        catch (const StopParsing&)
+        {
+            ok = false;
+        }
+        catch (...)
+        {
+            release();
+            init();
+            throw;
+        }
+        release();
+        init();
+        return ok;
+    }
+
+    void startParsedNode( const FileNode& node, const std::string& key,
+                          size_t rewindBlockIdx, size_t rewindOfs, size_t rewindBlockSize )
+    {
+        CV_Assert( !parsedNodes.empty() );
+        const ParsedNode& parent = parsedNodes.back();
+        ParsedNode n;
+        n.blockIdx = node.blockIdx;
+        n.ofs = node.ofs;
+        n.rewindBlockIdx = rewindBlockIdx;
+        n.rewindOfs = rewindOfs;
+        n.rewindBlockSize = rewindBlockSize;
+        n.depth = parent.depth + 1;
+        n.report = false;
+        n.keep = false;
+        n.childMode = parent.childMode;
+        if( parent.childMode == CHILD_STREAM )
+        {
+            n.keep = true;
+            n.childMode = CHILD_ASK;
+        }
+        else if( parent.childMode == CHILD_KEEP )
+        {
+            n.keep = true;
+        }
+        else if( parent.childMode == CHILD_ASK )
+        {
+            int action = handler->startNode(key, n.depth);
+            n.report = action != FileNodeHandler::SKIP;
+            n.childMode = action == FileNodeHandler::SKIP ? CHILD_SKIP :
+                          action == FileNodeHandler::LOAD ? CHILD_KEEP : CHILD_ASK;
+        }
+        parsedNodes.push_back(n);
+    }
+
+    // completes nodes which are parsed after the specified collection
+    void completeParsedNodes( const FileNode& collection )
+    {
+        size_t i = parsedNodes.size();
+        while( i > 0 && (parsedNodes[i-1].blockIdx != collection.blockIdx || parsedNodes[i-1].ofs != collection.ofs) )
+            i--;
+        CV_Assert( i > 0 );
+        while( parsedNodes.size() > i )
+        {
+            ParsedNode n = parsedNodes.back();
+            parsedNodes.pop_back();
+            if( n.report && !handler->endNode(FileNode(fs_ext, n.blockIdx, n.ofs), n.depth) )
+                throw StopParsing();
+            if( !n.keep )
+                releaseParsedNode(n);
+        }
+    }
+
+    void releaseParsedNode( const ParsedNode& n )
+    {
+        size_t blockIdx = n.rewindBlockIdx;
+        while( fs_data.size() > blockIdx + 1 )
+        {
+            fs_data.pop_back();
+            fs_data_ptrs.pop_back();
+            fs_data_blksz.pop_back();
+        }
+        if( fs_data_blksz[blockIdx] != n.rewindBlockSize )
+        {
+            fs_data[blockIdx]->resize(n.rewindBlockSize);
+            fs_data_ptrs[blockIdx] = &fs_data[blockIdx]->at(0);
+            fs_data_blksz[blockIdx] = n.rewindBlockSize;
+        }
+        freeSpaceOfs = n.rewindOfs;
+
+        const ParsedNode& parent = parsedNodes.back();
+        uchar* cp = fs_data_ptrs[parent.blockIdx] + parent.ofs;
+        if( *cp & FileNode::NAMED )
+            cp += 4;
+        writeInt(cp + 5, readInt(cp + 5) - 1);
+    }
+
+    // Binary storages (FileStorage::FORMAT_BINARY, see persistence_bin.cpp).
+    // The node tree of the file is used in place, raw data of uniform sequences are read directly
+    // from the file data. Elements of uniform sequences are converted to nodes on demand only.
+    size_t writeBinary( const void* data, size_t len, size_t alignment )
+    {
+        static const char zeros[64] = {0};
+        size_t pad = (alignment - binaryOfs % alignment) % alignment;
+        CV_Assert( pad <= sizeof(zeros) );
+        putBinary(zeros, pad);
+        size_t ofs = binaryOfs;
+        putBinary(data, len);
+        return ofs;
+    }
+
+    void putBinary( const void* data, size_t len )
+    {
+        CV_Assert( write_mode );
+        const char* ptr = (const char*)data;
+        binaryOfs += len;
+        if( mem_mode )
+            outbuf.insert(outbuf.end(), ptr, ptr + len);
+        else if( file )
+        {
+            if( len > 0 && fwrite( ptr, len, 1, file ) != 1 )
+                CV_Error( CV_StsError, "Can't write to the file storage" );
+        }
+#if USE_ZLIB
+        else if( gzfile )
+        {
+            for( ; len > 0; )
+            {
+                unsigned count = (unsigned)std::min(len, (size_t)1 << 30);
+                if( gzwrite( gzfile, ptr, count ) != (int)count )
+                    CV_Error( CV_StsError, "Can't write to the file storage" );
+                ptr += count;
+                len -= count;
+            }
+        }
+#endif
+        else
+            CV_Error( CV_StsError, "The storage is not opened" );
+    }
+
+    void writeBinaryNodes()
+    {
+        endWriteStruct();  // the top-level mapping
+        FileNode root_nodes(fs_ext, 0, 0);
+        finalizeCollection(root_nodes);
+
+        size_t i, nblocks = fs_data_ptrs.size(), nodesSize = 0;
+        size_t nodesOfs = writeBinary(0, 0, 8);
+        for( i = 0; i < nblocks; i++ )
+        {
+            size_t sz = i < nblocks - 1 ? fs_data_blksz[i] : freeSpaceOfs;
+            putBinary(fs_data_ptrs[i], sz);
+            nodesSize += sz;
+        }
+        size_t namesOfs = writeBinary(&str_hash_data[0], str_hash_data.size(), 1);
+        writeBinaryFooter(this, nodesOfs, nodesSize, namesOfs, str_hash_data.size());
+    }
+
+    void loadBinary( size_t bufsize )
+    {
+        binaryStorage = loadBinaryStorage(filename, gzfile, mem_mode ? strbuf : 0, bufsize);
+        const BinaryStorage& bs = *binaryStorage;
+
+        const char* names = (const char*)bs.data + bs.namesOfs;
+        if( bs.namesSize == 0 || bs.namesSize > (size_t)UINT_MAX ||
+            names[0] != '\0' || names[bs.namesSize - 1] != '\0' )
+            CV_Error( Error::StsParseError, "Invalid binary file storage: bad names" );
+        str_hash_data.assign(names, names + bs.namesSize);
+        str_hash.clear();
+        for( size_t ofs = 1; ofs < bs.namesSize; ofs += strlen(names + ofs) + 1 )
+            str_hash.insert(std::make_pair(std::string(names + ofs), (unsigned)ofs));
+
+        fs_data.assign(1, Ptr<std::vector<uchar> >());
+        fs_data_ptrs.assign(1, bs.data + bs.nodesOfs);
+        fs_data_blksz.assign(1, bs.nodesSize);
+        freeSpaceOfs = bs.nodesSize;
+        parsedNodes.clear();
+
+        if( bs.nodesSize == 0 || *fs_data_ptrs[0] != FileNode::SEQ ||
+            checkBinaryNode(fs_data_ptrs[0], bs.nodesSize, 0) != bs.nodesSize )
+            CV_Error( Error::StsParseError, "Invalid binary file storage: bad nodes" );
+
+        FileNode roots_node(fs_ext, 0, 0);
+        for( FileNodeIterator it = roots_node.begin(); it != roots_node.end(); ++it )
+            roots.push_back(*it);
+
+        if( handler )
+        {
+            for( size_t i = 0; i < roots.size(); i++ )
+                for( FileNodeIterator it = roots[i].begin(); it != roots[i].end(); ++it )
+                    reportBinaryNode(*it, 0);
+        }
+    }
+
+    // returns size of the node or 0 if the node is invalid
+    size_t checkBinaryNode( const uchar* p, size_t avail, int level ) const
+    {
+        const int MAX_LEVEL = 1000;
+        if( avail < 1 || level > MAX_LEVEL )
+            return 0;
+        int tag = *p, tp = tag & FileNode::TYPE_MASK;
+        size_t sz = 1;
+        if( (tag & ~(FileNode::TYPE_MASK | FileNode::UNIFORM | FileNode::NAMED)) != 0 ||
+            ((tag & FileNode::UNIFORM) && tp != FileNode::SEQ) )
+            return 0;
+        if( tag & FileNode::NAMED )
+        {
+            if( avail < 5 || (size_t)(unsigned)readInt(p + 1) >= str_hash_data.size() )
+                return 0;
+            sz = 5;
+        }
+
+        switch( tp )
+        {
+        case FileNode::NONE:
+            return sz;
+        case FileNode::INT:
+            return avail >= sz + 4 ? sz + 4 : 0;
+        case FileNode::REAL:
+            return avail >= sz + 8 ? sz + 8 : 0;
+        case FileNode::STRING:
+        {
+            if( avail < sz + 4 )
+                return 0;
+            size_t len = (size_t)(unsigned)readInt(p + sz);
+            if( len == 0 || len > avail - sz - 4 || p[sz + 4 + len - 1] != '\0' )
+                return 0;
+            return sz + 4 + len;
+        }
+        case FileNode::SEQ:
+        case FileNode::MAP:
+        {
+            if( avail < sz + 8 )
+                return 0;
+            size_t rawSize = (size_t)(unsigned)readInt(p + sz);
+            size_t nelems = (size_t)(unsigned)readInt(p + sz + 4);
+            if( rawSize < 4 || rawSize > avail - sz - 4 )
+                return 0;
+            const uchar* elems = p + sz + 8;
+            size_t elemsSize = rawSize - 4;
+            if( tag & FileNode::UNIFORM )
+            {
+                if( elemsSize != 12 )
+                    return 0;
+                const BinaryStorage& bs = *binaryStorage;
+                int depth = readInt(elems);
+                uint64 dataOfs = (unsigned)readInt(elems + 4) | ((uint64)(unsigned)readInt(elems + 8) << 32);
+                size_t esz = CV_ELEM_SIZE1(depth);
+                if( depth < CV_8U || depth > CV_16F || dataOfs < bs.payloadOfs ||
+                    dataOfs > bs.payloadOfs + bs.payloadSize || dataOfs % esz != 0 ||
+                    nelems > (bs.payloadOfs + bs.payloadSize - dataOfs)/esz )
+                    return 0;
+            }
+            else
+            {
+                size_t ofs = 0;
+                for( size_t i = 0; i < nelems; i++ )
+                {
+                    size_t esz = checkBinaryNode(elems + ofs, elemsSize - ofs, level + 1);
+                    if( esz == 0 || (tp == FileNode::MAP && !(elems[ofs] & FileNode::NAMED)) )
+                        return 0;
+                    ofs += esz;
+                }
+                if( ofs != elemsSize )
+                    return 0;
+            }
+            return sz + 4 + rawSize;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // FileStorage::parse() for binary storages: the whole tree is loaded already, so it's just traversed
+    void reportBinaryNode( const FileNode& node, int depth )
+    {
+        int action = handler->startNode(node.name(), depth);
+        if( action == FileNodeHandler::SKIP )
+            return;
+        if( action == FileNodeHandler::VISIT )
+        {
+            for( FileNodeIterator it = node.begin(); FileNode::isCollection(node.type()) && it != node.end(); ++it )
+                reportBinaryNode(*it, depth + 1);
+        }
+        if( !handler->endNode(node, depth) )
+            throw StopParsing();
+    }
+
+    const uchar* getUniformData( size_t blockIdx, size_t ofs, int& depth ) const
+    {
+        const uchar* p = getNodePtr(blockIdx, ofs);
+        CV_Assert( (*p & FileNode::UNIFORM) && !binaryStorage.empty() );
+        p += (*p & FileNode::NAMED) ? 5 : 1;
+        depth = readInt(p + 8);
+        uint64 dataOfs = (unsigned)readInt(p + 12) | ((uint64)(unsigned)readInt(p + 16) << 32);
+        return binaryStorage->data + dataOfs;
+    }
+
+    FileNode getUniformElement( size_t blockIdx, size_t ofs, size_t idx )
+    {
+        AutoLock lock(uniformMutex);
+        Ptr<FileStorage>& elems = uniformElems[std::make_pair(blockIdx, ofs)];
+        if( elems.empty() )
+        {
+            int depth = 0;
+            const uchar* data = getUniformData(blockIdx, ofs, depth);
+            size_t i, nelems = FileNode(fs_ext, blockIdx, ofs).size();
+            bool isReal = depth >= CV_32F;
+            size_t esz = isReal ? 9 : 5;
+            Ptr<std::vector<uchar> > block = makePtr<std::vector<uchar> >(std::max(nelems*esz, (size_t)1));
+            uchar* ptr = &block->at(0);
+            for( i = 0; i < nelems; i++, ptr += esz )
+            {
+                double value = fs::readRawValue(data, depth, i);
+                *ptr = (uchar)(isReal ? FileNode::REAL : FileNode::INT);
+                if( isReal )
+                    writeReal(ptr + 1, value);
+                else
+                    writeInt(ptr + 1, (int)value);
+            }
+            Ptr<FileStorage> storage = makePtr<FileStorage>();
+            storage->p->fs_data.push_back(block);
+            storage->p->fs_data_ptrs.push_back(&block->at(0));
+            storage->p->fs_data_blksz.push_back(block->size());
+            elems = storage;
+        }
+        size_t esz = *elems->p->fs_data_ptrs[0] == FileNode::REAL ? 9 : 5;
+        return FileNode(elems.get(), 0, idx*esz);
+    }
+
+    bool mapUniformData( const FileNode& node, int dims, const int* sizes, int type, Mat& m ) const
+    {
+        const uchar* p = node.ptr();
+        if( binaryStorage.empty() || !p || !(*p & FileNode::UNIFORM) )
+            return false;
+        int depth = 0;
+        uchar* data = (uchar*)getUniformData(node.blockIdx, node.ofs, depth);
+        if( depth != CV_MAT_DEPTH(type) )
+            return false;
+        Mat header(dims, sizes, type, data);
+        if( header.total()*header.channels() != node.size() )
+            return false;
+        createBinaryStorageMat(binaryStorage, header, m);
+        return true;
+    }
+
     void normalizeNodeOfs(size_t& blockIdx, size_t& ofs)
     {
         while( ofs >= fs_data_blksz[blockIdx] )
@@ -1781,6 +2247,14 @@ public:
     size_t strbufsize;
     size_t strbufpos;
     int lineno;
+
+    FileNodeHandler* handler;
+    std::vector<ParsedNode> parsedNodes;
+
+    size_t binaryOfs;  //!< size of the written binary data
+    Ptr<BinaryStorage> binaryStorage;
+    Mutex uniformMutex;
+    std::map<std::pair<size_t, size_t>, Ptr<FileStorage> > uniformElems;  //!< elements of uniform sequences
 };
 
 FileStorage::FileStorage()
@@ -1793,7 +2267,7 @@ FileStorage::FileStorage(const String& filename, int flags, const String& encodi
     : state(0)
 {
     p = makePtr<FileStorage::Impl>(this);
-    bool ok = p->open(filename.c_str(), flags, encoding.c_str());
+    bool ok = p->open(filename.c_str(), flags, encoding.c_str(), filename.size());
     if(ok)
         state = FileStorage::NAME_EXPECTED + FileStorage::INSIDE_MAP;
 }
@@ -1819,17 +2293,27 @@ void FileStorage::endWriteStruct()
 
 FileStorage::~FileStorage()
 {
+    // the binary writer walks the node tree through FileNode (and thus through `p`)
+    // when the storage is finalized, so close it while the implementation is still reachable
+    if( p )
+        p->release();
     p.release();
 }
 
 bool FileStorage::open(const String& filename, int flags, const String& encoding)
 {
-    bool ok = p->open(filename.c_str(), flags, encoding.c_str());
+    bool ok = p->open(filename.c_str(), flags, encoding.c_str(), filename.size());
     if(ok)
         state = FileStorage::NAME_EXPECTED + FileStorage::INSIDE_MAP;
     return ok;
 }
 
+bool FileStorage::parse(const String& filename, FileNodeHandler& handler, int flags)
+{
+    state = 0;
+    return p->parse(filename.c_str(), flags, handler, filename.size());
+}
+
 bool FileStorage::isOpened() const { return p->is_opened; }
 
 void FileStorage::release()
@@ -2157,7 +2641,7 @@ bool FileNode::isNamed() const
 std::string FileNode::name() const
 {
     const uchar* p = ptr();
-    if(!p)
+    if(!p || !(*p & NAMED))
         return std::string();
     size_t nameofs = p[1] | (p[2]<<8) | (p[3]<<16) | (p[4]<<24);
     return fs->p->getName(nameofs);
@@ -2384,6 +2868,13 @@ FileNodeIterator::FileNodeIterator( const FileNode& node, bool seekEnd )
         {
             nodeNElems = node.size();
             const uchar* p0 = node.ptr(), *p = p0 + 1;
+            if( *p0 & FileNode::UNIFORM )
+            {
+                // elements of uniform sequences are accessed by index, see operator*()
+                blockSize = 0;
+                idx = seekEnd ? nodeNElems : 0;
+                return;
+            }
             if(*p0 & FileNode::NAMED )
                 p += 4;
             if( !seekEnd )
@@ -2423,6 +2914,8 @@ FileNodeIterator& FileNodeIterator::operator=(const FileNodeIterator& it)
 
 FileNode FileNodeIterator::operator *() const
 {
+    if( blockSize == 0 && fs && idx < nodeNElems )
+        return fs->p->getUniformElement(blockIdx, ofs, idx);
     return FileNode(idx < nodeNElems ? fs : 0, blockIdx, ofs);
 }
 
@@ -2431,6 +2924,8 @@ FileNodeIterator& FileNodeIterator::operator ++ ()
     if( idx == nodeNElems || !fs )
         return *this;
     idx++;
+    if( blockSize == 0 )
+        return *this;
     FileNode n(fs, blockIdx, ofs);
     ofs += n.rawSize();
     if( ofs >= blockSize )
@@ -2468,6 +2963,27 @@ FileNodeIterator& FileNodeIterator::readRaw( const String& fmt, void* _data0, si
         CV_Assert( maxsz % esz == 0 );
         maxsz /= esz;
 
+        if( blockSize == 0 && fmt_pair_count == 1 && maxsz*fmt_pairs[0] <= nodeNElems - idx )
+        {
+            // raw data of a binary storage: copy or convert all the elements at once
+            int depth = 0, elem_type = fmt_pairs[1];
+            const uchar* src = fs->p->getUniformData(blockIdx, ofs, depth);
+            size_t count = maxsz*fmt_pairs[0], esz1 = CV_ELEM_SIZE1(depth);
+            src += idx*esz1;
+            if( depth == elem_type || (depth != CV_16F && elem_type != CV_16F) )
+            {
+                if( depth == elem_type )
+                    memcpy(data0, src, count*esz1);
+                else
+                {
+                    Mat dst(1, (int)count, elem_type, data0);
+                    Mat(1, (int)count, depth, (void*)src).convertTo(dst, elem_type);
+                }
+                idx += count;
+                maxsz = 0;
+            }
+        }
+
         for( ; maxsz > 0; maxsz--, data0 += esz )
         {
             size_t offset = 0;
@@ -2634,8 +3150,20 @@ void read(const FileNode& node, std::string& val, const std::string& default_val
     }
 }
 
+bool fs::readRawMat( const FileNode& node, int dims, const int* sizes, int type, Mat& m )
+{
+    return node.fs && node.fs->p->mapUniformData(node, dims, sizes, type, m);
+}
+
 FileStorage_API::~FileStorage_API() {}
 
+FileNodeHandler::~FileNodeHandler() {}
+
+int FileNodeHandler::startNode(const String& /*name*/, int /*depth*/)
+{
+    return VISIT;
+}
+
 namespace internal
 {
 
@@ -94,6 +94,9 @@ int calcElemSize( const char* dt, int initial_size );
 char* encodeFormat( int elem_type, char* dt );
 int decodeFormat( const char* dt, int* fmt_pairs, int max_len );
 int decodeSimpleFormat( const char* dt );
+
+double readRawValue( const uchar* data, int depth, size_t idx );
+bool readRawMat( const FileNode& node, int dims, const int* sizes, int type, Mat& m );
 }
 
 
@@ -157,6 +160,8 @@ public:
     virtual FileNode addNode( FileNode& collection, const std::string& key,
                                int type, const void* value=0, int len=-1 ) = 0;
     virtual void finalizeCollection( FileNode& collection ) = 0;
+    virtual void setUniformData( FileNode& seq, int depth, size_t nelems, size_t dataOfs ) = 0;
+    virtual size_t writeBinary( const void* data, size_t len, size_t alignment ) = 0;
     virtual double strtod(char* ptr, char** endptr) = 0;
 
     virtual char* parseBase64(char* ptr, int indent, FileNode& collection) = 0;
@@ -179,6 +184,8 @@ public:
     virtual void writeScalar(const char* key, const char* value) = 0;
     virtual void writeComment(const char* comment, bool eol_comment) = 0;
     virtual void startNextStream() = 0;
+    //! returns false if the data should be written element by element
+    virtual bool writeRawData(const std::string& /*dt*/, const void* /*data*/, size_t /*len*/) { return false; }
 };
 
 class FileStorageParser
@@ -197,6 +204,26 @@ Ptr<FileStorageParser> createXMLParser(FileStorage_API* fs);
 Ptr<FileStorageParser> createYAMLParser(FileStorage_API* fs);
 Ptr<FileStorageParser> createJSONParser(FileStorage_API* fs);
 
+//! contents of a binary file storage (see persistence_bin.cpp)
+class BinaryStorage
+{
+public:
+    virtual ~BinaryStorage() {}
+
+    uchar* data;
+    size_t size;
+    size_t payloadOfs, payloadSize;  //!< raw data of uniform sequences
+    size_t nodesOfs, nodesSize;      //!< tree of nodes
+    size_t namesOfs, namesSize;      //!< node names
+};
+
+Ptr<FileStorageEmitter> createBinaryEmitter(FileStorage_API* fs);
+void writeBinaryFooter(FileStorage_API* fs, size_t nodesOfs, size_t nodesSize, size_t namesOfs, size_t namesSize);
+Ptr<BinaryStorage> loadBinaryStorage(const std::string& filename, gzFile gzfile, const char* buf, size_t bufsize);
+void createBinaryStorageMat(const Ptr<BinaryStorage>& storage, const Mat& header, Mat& m);
+
+extern const char* const binary_signature;
+
 }
 
 #endif // SRC_PERSISTENCE_HPP
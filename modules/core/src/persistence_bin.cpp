@@ -0,0 +1,429 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include "persistence.hpp"
+
+#if defined __unix__ || defined __APPLE__
+#define OPENCV_FS_BINARY_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Binary file storage (FileStorage::FORMAT_BINARY).
+//
+// The file is a memory image of the storage, which is used as is when the file is read:
+//
+//   header     signature "%OPENCV-BIN:1.0\n", byte order mark (int 0x01020304), padded to 64 bytes
+//   raw data   elements of the uniform sequences (written with FileStorage::writeRaw()),
+//              each sequence is stored as a C array aligned to 64 bytes
+//   nodes      tree of nodes in the in-memory format of FileNode, starting from the sequence of streams
+//   names      zero-terminated node names; nodes refer to names by offsets in this table
+//   footer     offsets and sizes of nodes and names (4 x uint64), "%OPENCV-BIN-END\n"
+//
+// Raw data, byte order mark and footer are stored in the native byte order, so files written on
+// little-endian machines can't be read on big-endian ones and vice versa.
+//
+// A uniform sequence is a node with the FileNode::SEQ | FileNode::UNIFORM tag:
+//   tag (1 byte), [name (4 bytes)], raw size (4 bytes, == 16), number of elements (4 bytes),
+//   depth of elements (4 bytes), offset of the raw data in the file (8 bytes).
+
+namespace cv
+{
+
+const char* const binary_signature = "%OPENCV-BIN:1.0\n";
+
+namespace
+{
+
+const char* const binary_end_signature = "%OPENCV-BIN-END\n";
+
+enum
+{
+    BINARY_SIGNATURE_SIZE = 16,
+    BINARY_HEADER_SIZE = 64,
+    BINARY_FOOTER_SIZE = 4*8 + BINARY_SIGNATURE_SIZE,
+    BINARY_ALIGNMENT = 64,
+    BINARY_BYTE_ORDER_MARK = 0x01020304
+};
+
+// checks that [ofs, ofs + len) is inside of [0, limit)
+inline bool isInside(uint64 ofs, uint64 len, uint64 limit)
+{
+    return ofs <= limit && len <= limit - ofs;
+}
+
+class BinaryEmitter : public FileStorageEmitter
+{
+public:
+    BinaryEmitter(FileStorage_API* _fs) : fs(_fs), rawDepth(-1)
+    {
+        uchar header[BINARY_HEADER_SIZE] = {};
+        memcpy(header, binary_signature, BINARY_SIGNATURE_SIZE);
+        int bom = BINARY_BYTE_ORDER_MARK;
+        memcpy(header + BINARY_SIGNATURE_SIZE, &bom, sizeof(bom));
+        fs->writeBinary(header, sizeof(header), 1);
+
+        // the sequence of streams has been created by FileStorage::Impl::open()
+        nodes.push_back(FileNode(fs->getFS(), 0, 0));
+        startNextStream();
+    }
+    virtual ~BinaryEmitter() {}
+
+    FStructData startWriteStruct( const FStructData& /*parent*/, const char* key,
+                                  int struct_flags, const char* type_name=0 )
+    {
+        flushRawElements();
+        int type = struct_flags & FileNode::TYPE_MASK;
+        nodes.push_back(fs->addNode(nodes.back(), key ? key : "", type));
+        if( type_name && FileNode::isMap(type) )
+            fs->addNode(nodes.back(), "type_id", FileNode::STRING, type_name);
+        return FStructData(type_name ? type_name : "", struct_flags, 0);
+    }
+
+    void endWriteStruct(const FStructData& /*current_struct*/)
+    {
+        CV_Assert( nodes.size() > 1 );
+        FileNode& node = nodes.back();
+        if( rawDepth >= 0 )
+        {
+            size_t esz = CV_ELEM_SIZE1(rawDepth), nelems = rawData.size()/esz;
+            size_t dataOfs = fs->writeBinary(&rawData[0], rawData.size(), BINARY_ALIGNMENT);
+            fs->setUniformData(node, rawDepth, nelems, dataOfs);
+            rawData.clear();
+            rawDepth = -1;
+        }
+        fs->finalizeCollection(node);
+        nodes.pop_back();
+    }
+
+    void write(const char* key, int value)
+    {
+        flushRawElements();
+        fs->addNode(nodes.back(), key ? key : "", FileNode::INT, &value);
+    }
+
+    void write(const char* key, double value)
+    {
+        flushRawElements();
+        fs->addNode(nodes.back(), key ? key : "", FileNode::REAL, &value);
+    }
+
+    void write(const char* key, const char* value, bool /*quote*/)
+    {
+        flushRawElements();
+        fs->addNode(nodes.back(), key ? key : "", FileNode::STRING, value);
+    }
+
+    // used for the elements of raw data, which can't be stored as uniform sequences
+    void writeScalar(const char* key, const char* value)
+    {
+        char* endptr = 0;
+        long ival = strtol(value, &endptr, 10);
+        if( *endptr == '\0' && ival >= INT_MIN && ival <= INT_MAX )
+            write(key, (int)ival);
+        else
+            write(key, fs->strtod((char*)value, &endptr));
+    }
+
+    void writeComment(const char* /*comment*/, bool /*eol_comment*/)
+    {
+        // comments are not stored
+    }
+
+    void startNextStream()
+    {
+        CV_Assert( nodes.size() == 1 );
+        nodes.push_back(fs->addNode(nodes.back(), std::string(), FileNode::MAP));
+    }
+
+    bool writeRawData(const std::string& dt, const void* data, size_t len)
+    {
+        int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2];
+        int fmt_pair_count = fs::decodeFormat( dt.c_str(), fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+        int depth = fmt_pairs[1];
+        for( int k = 1; k < fmt_pair_count; k++ )
+            if( fmt_pairs[k*2+1] != depth )
+                depth = -1;
+
+        // only arrays of numbers of the same type, which are the only content of a sequence,
+        // are stored as raw data
+        FileNode& node = nodes.back();
+        if( depth < 0 || depth != (rawDepth >= 0 ? rawDepth : depth) ||
+            !node.isSeq() || (rawDepth < 0 && node.size() > 0) )
+        {
+            flushRawElements();
+            return false;
+        }
+
+        const uchar* ptr = (const uchar*)data;
+        rawData.insert(rawData.end(), ptr, ptr + len);
+        rawDepth = depth;
+        return true;
+    }
+
+protected:
+    // converts the buffered raw data to separate elements of the sequence
+    void flushRawElements()
+    {
+        if( rawDepth < 0 )
+            return;
+        int depth = rawDepth;
+        rawDepth = -1;
+        size_t i, nelems = rawData.size()/CV_ELEM_SIZE1(depth);
+        for( i = 0; i < nelems; i++ )
+        {
+            double value = fs::readRawValue(&rawData[0], depth, i);
+            if( depth < CV_32F )
+            {
+                int ival = (int)value;
+                fs->addNode(nodes.back(), std::string(), FileNode::INT, &ival);
+            }
+            else
+                fs->addNode(nodes.back(), std::string(), FileNode::REAL, &value);
+        }
+        rawData.clear();
+    }
+
+    FileStorage_API* fs;
+    std::vector<FileNode> nodes;
+    std::vector<uchar> rawData;  // elements of the current sequence written by writeRawData()
+    int rawDepth;
+};
+
+class BufferBinaryStorage : public BinaryStorage
+{
+public:
+    BufferBinaryStorage() : capacity(0)
+    {
+        data = 0;
+        size = 0;
+    }
+    virtual ~BufferBinaryStorage()
+    {
+        fastFree(data);
+    }
+
+    uchar* reserve(size_t len)
+    {
+        if( size + len > capacity )
+        {
+            size_t newCapacity = std::max(capacity*2, std::max(size + len, (size_t)1 << 16));
+            uchar* newData = (uchar*)fastMalloc(newCapacity);
+            if( size > 0 )
+                memcpy(newData, data, size);
+            fastFree(data);
+            data = newData;
+            capacity = newCapacity;
+        }
+        return data + size;
+    }
+
+    size_t capacity;
+};
+
+#ifdef OPENCV_FS_BINARY_MMAP
+class MappedBinaryStorage : public BinaryStorage
+{
+public:
+    MappedBinaryStorage(void* _data, size_t _size)
+    {
+        data = (uchar*)_data;
+        size = _size;
+    }
+    virtual ~MappedBinaryStorage()
+    {
+        munmap(data, size);
+    }
+};
+
+// returns empty pointer if the file can't be mapped
+static Ptr<BinaryStorage> mapBinaryStorage(const std::string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
+        return Ptr<BinaryStorage>();
+    struct stat st;
+    void* ptr = MAP_FAILED;
+    if( fstat(fd, &st) == 0 && st.st_size > 0 && (uint64)st.st_size <= (uint64)(size_t)-1 )
+        // private writable mapping: matrices which refer to the file data can be modified
+        ptr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if( ptr == MAP_FAILED )
+        return Ptr<BinaryStorage>();
+    return makePtr<MappedBinaryStorage>(ptr, (size_t)st.st_size);
+}
+#endif
+
+static void readBinaryLayout(BinaryStorage& s)
+{
+    if( s.size < BINARY_HEADER_SIZE + BINARY_FOOTER_SIZE ||
+        memcmp(s.data, binary_signature, BINARY_SIGNATURE_SIZE) != 0 )
+        CV_Error(Error::StsParseError, "Invalid binary file storage: bad header");
+    int bom = 0;
+    memcpy(&bom, s.data + BINARY_SIGNATURE_SIZE, sizeof(bom));
+    if( bom != BINARY_BYTE_ORDER_MARK )
+        CV_Error(Error::StsNotImplemented, "Binary file storage was written on a machine with different byte order");
+
+    const uchar* footer = s.data + s.size - BINARY_FOOTER_SIZE;
+    if( memcmp(footer + 4*8, binary_end_signature, BINARY_SIGNATURE_SIZE) != 0 )
+        CV_Error(Error::StsParseError, "Invalid binary file storage: bad footer (the file is truncated?)");
+    uint64 layout[4];
+    memcpy(layout, footer, sizeof(layout));
+
+    uint64 dataSize = s.size - BINARY_FOOTER_SIZE;
+    if( layout[0] < BINARY_HEADER_SIZE || !isInside(layout[0], layout[1], dataSize) ||
+        layout[2] < layout[0] + layout[1] || !isInside(layout[2], layout[3], dataSize) )
+        CV_Error(Error::StsParseError, "Invalid binary file storage: bad layout");
+
+    s.payloadOfs = BINARY_HEADER_SIZE;
+    s.payloadSize = (size_t)layout[0] - BINARY_HEADER_SIZE;
+    s.nodesOfs = (size_t)layout[0];
+    s.nodesSize = (size_t)layout[1];
+    s.namesOfs = (size_t)layout[2];
+    s.namesSize = (size_t)layout[3];
+}
+
+class BinaryStorageAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int /*dims*/, const int* /*sizes*/, int /*type*/,
+                       void* /*data*/, size_t* /*step*/, AccessFlag /*flags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        CV_Error(Error::StsNotImplemented, "The allocator is used for the data of binary file storages only");
+    }
+
+    bool allocate(UMatData* u, AccessFlag /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const CV_OVERRIDE
+    {
+        return u != 0;
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        delete (Ptr<BinaryStorage>*)u->userdata;
+        delete u;
+    }
+};
+
+static MatAllocator* getBinaryStorageAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new BinaryStorageAllocator())
+}
+
+} // namespace
+
+double fs::readRawValue( const uchar* data, int depth, size_t idx )
+{
+    switch( depth )
+    {
+    case CV_8U: return ((const uchar*)data)[idx];
+    case CV_8S: return ((const schar*)data)[idx];
+    case CV_16U: return ((const ushort*)data)[idx];
+    case CV_16S: return ((const short*)data)[idx];
+    case CV_32S: return ((const int*)data)[idx];
+    case CV_32F: return ((const float*)data)[idx];
+    case CV_64F: return ((const double*)data)[idx];
+    case CV_16F: return (float)((const float16_t*)data)[idx];
+    default:
+        CV_Error( Error::StsUnsupportedFormat, "Unsupported type" );
+    }
+}
+
+Ptr<FileStorageEmitter> createBinaryEmitter(FileStorage_API* fs)
+{
+    return makePtr<BinaryEmitter>(fs);
+}
+
+void writeBinaryFooter(FileStorage_API* fs, size_t nodesOfs, size_t nodesSize, size_t namesOfs, size_t namesSize)
+{
+    uchar footer[BINARY_FOOTER_SIZE];
+    uint64 layout[] = { nodesOfs, nodesSize, namesOfs, namesSize };
+    memcpy(footer, layout, sizeof(layout));
+    memcpy(footer + sizeof(layout), binary_end_signature, BINARY_SIGNATURE_SIZE);
+    fs->writeBinary(footer, sizeof(footer), 1);
+}
+
+Ptr<BinaryStorage> loadBinaryStorage(const std::string& filename, gzFile gzfile, const char* buf, size_t bufsize)
+{
+    Ptr<BinaryStorage> storage;
+    if( buf )
+    {
+        Ptr<BufferBinaryStorage> s = makePtr<BufferBinaryStorage>();
+        memcpy(s->reserve(bufsize), buf, bufsize);
+        s->size = bufsize;
+        storage = s;
+    }
+    else
+    {
+#ifdef OPENCV_FS_BINARY_MMAP
+        if( !gzfile )
+            storage = mapBinaryStorage(filename);
+#endif
+        if( storage.empty() )
+        {
+            Ptr<BufferBinaryStorage> s = makePtr<BufferBinaryStorage>();
+            FILE* file = 0;
+            if( gzfile )
+            {
+#if USE_ZLIB
+                gzrewind(gzfile);
+#endif
+            }
+            else
+            {
+                file = fopen(filename.c_str(), "rb");
+                if( !file )
+                    CV_Error_(Error::StsError, ("Can't open %s", filename.c_str()));
+            }
+            const size_t chunkSize = 1 << 20;
+            for(;;)
+            {
+                uchar* ptr = s->reserve(chunkSize);
+                size_t count = 0;
+                if( file )
+                    count = fread(ptr, 1, chunkSize, file);
+#if USE_ZLIB
+                else
+                {
+                    int n = gzread(gzfile, ptr, (unsigned)chunkSize);
+                    if( n < 0 )
+                        CV_Error(Error::StsError, "Can't decompress the binary file storage");
+                    count = (size_t)n;
+                }
+#endif
+                if( count == 0 )
+                    break;
+                s->size += count;
+            }
+            if( file )
+                fclose(file);
+            storage = s;
+        }
+    }
+    readBinaryLayout(*storage);
+    return storage;
+}
+
+void createBinaryStorageMat(const Ptr<BinaryStorage>& storage, const Mat& header, Mat& m)
+{
+    CV_Assert( header.isContinuous() );
+    UMatData* u = new UMatData(getBinaryStorageAllocator());
+    u->data = u->origdata = header.data;
+    u->size = header.total()*header.elemSize();
+    u->userdata = new Ptr<BinaryStorage>(storage);
+    u->refcount = 1;
+
+    Mat hdr = header;
+    hdr.u = u;
+    m = hdr;
+}
+
+}
@@ -235,6 +235,20 @@ BinaryFunc getConvertFunc(int sdepth, int ddepth);
 BinaryFunc getConvertScaleFunc(int sdepth, int ddepth);
 BinaryFunc getCopyMaskFunc(size_t esz);
 
+namespace hal {
+// CV_16F arithmetic kernels (arithm.simd.hpp), these are not a part of the public HAL interface
+void add16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void*);
+void sub16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void*);
+void max16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void*);
+void min16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void*);
+void absdiff16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void*);
+void cmp16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, uchar* dst, size_t step, int width, int height, void* _cmpop);
+void mul16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void* scale);
+void div16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void* scale);
+void recip16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void* scale);
+void addWeighted16f(const float16_t* src1, size_t step1, const float16_t* src2, size_t step2, float16_t* dst, size_t step, int width, int height, void* scalars);
+}
+
 /* default memory block for sparse array elements */
 #define  CV_SPARSE_MAT_BLOCK     (1<<12)
 
@@ -328,6 +342,10 @@ struct CoreTLSData
         useIPP_NE(-1)
 #ifdef HAVE_OPENVX
         ,useOpenVX(-1)
+#endif
+        ,executionContext(NULL)
+#ifdef OPENCV_TRACE
+        ,allocationRootRegion(NULL)
 #endif
     {}
 
@@ -341,6 +359,17 @@ struct CoreTLSData
     int useIPP_NE; // 1 - use, 0 - do not use, -1 - auto/not initialized
 #ifdef HAVE_OPENVX
     int useOpenVX; // 1 - use, 0 - do not use, -1 - auto/not initialized
+#endif
+    const parallel::ExecutionContext* executionContext; // active parallel_for_() limits, see parallel::ExecutionContext
+#ifdef OPENCV_TRACE
+    // CV_TRACE_FUNCTION() regions for allocator statistics, see cv::utils::setAllocatorRegionStatisticsEnabled()
+    std::vector<const utils::trace::details::Region::LocationStaticStorage*> allocationRegions;
+    const utils::trace::details::Region::LocationStaticStorage* allocationRootRegion; // region of parallel_for_() caller
+
+    const utils::trace::details::Region::LocationStaticStorage* getAllocationRegion() const
+    {
+        return allocationRegions.empty() ? allocationRootRegion : allocationRegions.back();
+    }
 #endif
 };
 
@@ -273,6 +273,45 @@ struct Sum_SIMD<float, double>
             v_sum1 += v_cvt_f64_high(v_src0) + v_cvt_f64_high(v_src1);
         }
 
+#if CV_SIMD256 || CV_SIMD512
+        double CV_DECL_ALIGNED(CV_SIMD_WIDTH) ar[v_float64::nlanes];
+        v_store_aligned(ar, v_sum0 + v_sum1);
+        for (int i = 0; i < v_float64::nlanes; ++i)
+            dst[i % cn] += ar[i];
+#else
+        double CV_DECL_ALIGNED(CV_SIMD_WIDTH) ar[2 * v_float64::nlanes];
+        v_store_aligned(ar, v_sum0);
+        v_store_aligned(ar + v_float64::nlanes, v_sum1);
+        for (int i = 0; i < 2 * v_float64::nlanes; ++i)
+            dst[i % cn] += ar[i];
+#endif
+        v_cleanup();
+
+        return x / cn;
+    }
+};
+
+template <>
+struct Sum_SIMD<float16_t, double>
+{
+    int operator () (const float16_t * src0, const uchar * mask, double * dst, int len, int cn) const
+    {
+        if (mask || (cn != 1 && cn != 2 && cn != 4))
+            return 0;
+        len *= cn;
+
+        int x = 0;
+        v_float64 v_sum0 = vx_setzero_f64();
+        v_float64 v_sum1 = vx_setzero_f64();
+
+        for (; x <= len - 2 * v_float32::nlanes; x += 2 * v_float32::nlanes)
+        {
+            v_float32 v_src0 = vx_load_expand(src0 + x);
+            v_float32 v_src1 = vx_load_expand(src0 + x + v_float32::nlanes);
+            v_sum0 += v_cvt_f64(v_src0) + v_cvt_f64(v_src1);
+            v_sum1 += v_cvt_f64_high(v_src0) + v_cvt_f64_high(v_src1);
+        }
+
 #if CV_SIMD256 || CV_SIMD512
         double CV_DECL_ALIGNED(CV_SIMD_WIDTH) ar[v_float64::nlanes];
         v_store_aligned(ar, v_sum0 + v_sum1);
@@ -432,6 +471,9 @@ static int sum32f( const float* src, const uchar* mask, double* dst, int len, in
 static int sum64f( const double* src, const uchar* mask, double* dst, int len, int cn )
 { CV_INSTRUMENT_REGION(); return sum_(src, mask, dst, len, cn); }
 
+static int sum16f( const float16_t* src, const uchar* mask, double* dst, int len, int cn )
+{ CV_INSTRUMENT_REGION(); return sum_(src, mask, dst, len, cn); }
+
 SumFunc getSumFunc(int depth)
 {
     static SumFunc sumTab[] =
@@ -440,7 +482,7 @@ SumFunc getSumFunc(int depth)
         (SumFunc)sum16u, (SumFunc)sum16s,
         (SumFunc)sum32s,
         (SumFunc)GET_OPTIMIZED(sum32f), (SumFunc)sum64f,
-        0
+        (SumFunc)sum16f
     };
 
     return sumTab[depth];
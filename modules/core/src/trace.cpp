@@ -7,6 +7,7 @@
 #include <opencv2/core/utils/trace.hpp>
 #include <opencv2/core/utils/trace.private.hpp>
 #include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/allocator_stats.hpp>
 
 #include <opencv2/core/opencl/ocl_defs.hpp>
 
@@ -72,13 +73,33 @@ static int64 getTimestamp()
     return (int64)((t - g_zero_timestamp) * tick_to_ns);
 }
 
-// TODO lazy configuration flags
-static bool param_traceEnable = utils::getConfigurationParameterBool("OPENCV_TRACE", false);
+// Trace may be activated by initializers of other static objects (logging),
+// so these options are read on the first use instead of static initialization.
+static bool isTraceEnabled()
+{
+    static bool param_traceEnable = utils::getConfigurationParameterBool("OPENCV_TRACE", false);
+    return param_traceEnable;
+}
+static const cv::String& getTraceLocation()
+{
+    static cv::String param_traceLocation = utils::getConfigurationParameterString("OPENCV_TRACE_LOCATION", "OpenCVTrace");
+    return param_traceLocation;
+}
+static bool isChromeTraceFormat()
+{
+    static bool param_traceFormatChrome = utils::getConfigurationParameterString("OPENCV_TRACE_FORMAT", "txt") == "chrome";  // txt, chrome
+    return param_traceFormatChrome;
+}
+static size_t getTraceBufferSize()
+{
+    static size_t param_traceBufferSize = utils::getConfigurationParameterSizeT("OPENCV_TRACE_BUFFER_SIZE", 1 << 16);  // events per thread
+    return param_traceBufferSize;
+}
 
+// TODO lazy configuration flags
 static int param_maxRegionDepthOpenCV = (int)utils::getConfigurationParameterSizeT("OPENCV_TRACE_DEPTH_OPENCV", 1);
 static int param_maxRegionChildrenOpenCV = (int)utils::getConfigurationParameterSizeT("OPENCV_TRACE_MAX_CHILDREN_OPENCV", 1000);
 static int param_maxRegionChildren = (int)utils::getConfigurationParameterSizeT("OPENCV_TRACE_MAX_CHILDREN", 10000);
-static cv::String param_traceLocation = utils::getConfigurationParameterString("OPENCV_TRACE_LOCATION", "OpenCVTrace");
 
 #ifdef HAVE_OPENCL
 static bool param_synchronizeOpenCL = utils::getConfigurationParameterBool("OPENCV_TRACE_SYNC_OPENCL", false);
@@ -367,6 +388,14 @@ void Region::Impl::leaveRegion(TraceManagerThreadLocal& ctx)
         __itt_task_end(domain);
     }
 #endif
+    if (ctx.eventBuffer)
+    {
+        TraceEvent event;
+        event.location = &location;
+        event.beginTimestamp = beginTimestamp;
+        event.duration = duration;
+        ctx.eventBuffer->put(event);
+    }
     TraceStorage* s = ctx.getStorage();
     if (s)
     {
@@ -433,6 +462,12 @@ Region::Region(const LocationStaticStorage& location) :
     pImpl(NULL),
     implFlags(0)
 {
+    if ((location.flags & REGION_FLAG_FUNCTION) && cv::utils::isAllocatorRegionStatisticsEnabled())
+    {
+        getCoreTlsData().allocationRegions.push_back(&location);
+        implFlags |= REGION_FLAG__ALLOCATION_STATS;
+    }
+
     // Checks:
     // - global enable flag
     // - parent region is disabled
@@ -590,6 +625,17 @@ void Region::destroy()
 {
     CV_DbgAssert(implFlags != 0);
 
+    if (implFlags & REGION_FLAG__ALLOCATION_STATS)
+    {
+        std::vector<const LocationStaticStorage*>& allocationRegions = getCoreTlsData().allocationRegions;
+        CV_DbgAssert(!allocationRegions.empty());
+        if (!allocationRegions.empty())
+            allocationRegions.pop_back();
+        implFlags &= ~REGION_FLAG__ALLOCATION_STATS;
+        if (implFlags == 0)
+            return;
+    }
+
     TraceManagerThreadLocal& ctx = getTraceManager().tls.getRef();
     CV_LOG(_spaces(ctx.getCurrentDepth()*4) << "Region::destruct(): " << (void*)this << " pImpl=" << pImpl << " implFlags=" << implFlags << ' ' << (ctx.stackTopLocation() ? ctx.stackTopLocation()->name : "<unknown>"));
 
@@ -809,7 +855,7 @@ TraceStorage* TraceManagerThreadLocal::getStorage() const
         TraceStorage* global = getTraceManager().trace_storage.get();
         if (global)
         {
-            const std::string filepath = cv::format("%s-%03d.txt", param_traceLocation.c_str(), threadID).c_str();
+            const std::string filepath = cv::format("%s-%03d.txt", getTraceLocation().c_str(), threadID).c_str();
             TraceMessage msg;
             const char* pos = strrchr(filepath.c_str(), '/'); // extract filename
 #ifdef _WIN32
@@ -829,6 +875,107 @@ TraceStorage* TraceManagerThreadLocal::getStorage() const
 }
 
 
+TraceEventBuffer* TraceEventBuffer::create()
+{
+    if (!isTraceEnabled() || !isChromeTraceFormat())
+        return NULL;
+    return new TraceEventBuffer(getTraceBufferSize());
+}
+
+void TraceEventBuffer::read(std::vector<TraceEvent>& result, uint64& dropped) const
+{
+    const uint64 capacity = events_.size();
+    const uint64 end = head_.load(std::memory_order_acquire);
+    const uint64 begin = end > capacity ? end - capacity : 0;
+    std::vector<TraceEvent> events;
+    events.reserve((size_t)(end - begin));
+    for (uint64 i = begin; i < end; i++)
+        events.push_back(events_[(size_t)(i % capacity)]);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // writer may overwrite copied slots concurrently, including the slot of the non-published event 'head'
+    const uint64 head = head_.load(std::memory_order_relaxed);
+    const uint64 valid = std::max(begin, head + 1 > capacity ? head + 1 - capacity : (uint64)0);
+    dropped = valid;
+    if (valid < end)
+        result.insert(result.end(), events.begin() + (size_t)(valid - begin), events.end());
+}
+
+static void writeJSONString(std::ostream& out, const char* str)
+{
+    out << '"';
+    for (const char* p = str ? str : ""; *p; p++)
+    {
+        const char c = *p;
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            out << cv::format("\\u%04x", (int)c);
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+static const char* getEventCategory(int flags)
+{
+    if (flags & REGION_FLAG_APP_CODE)
+        return "app";
+    switch (flags & REGION_FLAG_IMPL_MASK)
+    {
+    case REGION_FLAG_IMPL_IPP: return "opencv,ipp";
+    case REGION_FLAG_IMPL_OPENCL: return "opencv,opencl";
+    case REGION_FLAG_IMPL_OPENVX: return "opencv,openvx";
+    default: return "opencv";
+    }
+}
+
+static bool writeChromeTraceFile(const std::string& filename)
+{
+    std::vector<TraceManagerThreadLocal*> threads_ctx;
+    getTraceManager().tls.gather(threads_ctx);
+
+    std::ofstream out(filename.c_str(), std::ios::trunc);
+    if (!out.is_open())
+        return false;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char* separator = "\n";
+    uint64 totalDroppedEvents = 0;
+    std::vector<TraceEvent> events;
+    for (size_t i = 0; i < threads_ctx.size(); i++)
+    {
+        TraceManagerThreadLocal* ctx = threads_ctx[i];
+        if (!ctx || !ctx->eventBuffer)
+            continue;
+        events.clear();
+        uint64 dropped = 0;
+        ctx->eventBuffer->read(events, dropped);
+        totalDroppedEvents += dropped;
+        const int tid = ctx->threadID;
+        out << separator << cv::format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"OpenCV thread %d\"}}", tid, tid);
+        separator = ",\n";
+        for (size_t j = 0; j < events.size(); j++)
+        {
+            const TraceEvent& e = events[j];
+            const Region::LocationStaticStorage& location = *e.location;
+            out << separator << "{\"name\":";
+            writeJSONString(out, location.name);
+            out << ",\"cat\":\"" << getEventCategory(location.flags) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+                << cv::format(",\"ts\":%.3f,\"dur\":%.3f", e.beginTimestamp * 1e-3, e.duration * 1e-3)
+                << ",\"args\":{\"file\":";
+            writeJSONString(out, location.filename);
+            out << ",\"line\":" << location.line << "}}";
+        }
+    }
+    out << "\n],\"otherData\":{\"dropped_events\":" << totalDroppedEvents << "}}\n";
+    out.close();
+    if (totalDroppedEvents)
+    {
+        CV_LOG_WARNING(NULL, "Trace: " << totalDroppedEvents << " events are dropped by ring buffers (OPENCV_TRACE_BUFFER_SIZE=" << getTraceBufferSize() << ")");
+    }
+    return !out.fail();
+}
+
+
 
 static bool activated = false;
 static bool isInitialized = false;
@@ -841,10 +988,10 @@ TraceManager::TraceManager()
     CV_LOG("TraceManager ctor: " << (void*)this);
 
     CV_LOG("TraceManager configure()");
-    activated = param_traceEnable;
+    activated = isTraceEnabled();
 
-    if (activated)
-        trace_storage.reset(new SyncTraceStorage(std::string(param_traceLocation) + ".txt"));
+    if (activated && !isChromeTraceFormat())
+        trace_storage.reset(new SyncTraceStorage(std::string(getTraceLocation()) + ".txt"));
 
 #ifdef OPENCV_WITH_ITT
     if (isITTEnabled())
@@ -885,6 +1032,14 @@ TraceManager::~TraceManager()
     {
         CV_LOG_WARNING(NULL, "Trace: Total skipped events: " << totalSkippedEvents);
     }
+    if (isTraceEnabled() && isChromeTraceFormat())
+    {
+        const std::string filename = std::string(getTraceLocation()) + ".json";
+        if (!writeChromeTraceFile(filename))
+        {
+            CV_LOG_WARNING(NULL, "Trace: can't write " << filename);
+        }
+    }
 
     // This is a global static object, so process starts shutdown here
     // Turn off trace
@@ -1143,4 +1298,18 @@ void traceArg(const TraceArg&, double) {};
 
 #endif
 
-}}}} // namespace
+} // namespace details
+
+bool writeChromeTrace(const char* filename)
+{
+    CV_Assert(filename);
+#ifdef OPENCV_TRACE
+    if (!details::isTraceEnabled() || !details::isChromeTraceFormat())
+        return false;
+    return details::writeChromeTraceFile(filename);
+#else
+    return false;
+#endif
+}
+
+}}} // namespace
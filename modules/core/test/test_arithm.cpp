@@ -2026,7 +2026,8 @@ TEST(Compare, regression_16F_do_not_crash)
     cv::Mat mat1(2, 2, CV_16F, cv::Scalar(1));
     cv::Mat mat2(2, 2, CV_16F, cv::Scalar(2));
     cv::Mat dst;
-    EXPECT_THROW(cv::compare(mat1, mat2, dst, cv::CMP_EQ), cv::Exception);
+    EXPECT_NO_THROW(cv::compare(mat1, mat2, dst, cv::CMP_EQ));
+    EXPECT_EQ(0, cv::countNonZero(dst));
 }
 
 
@@ -2455,5 +2456,154 @@ TEST(Core_MinMaxIdx, rows_overflow)
     }
 }
 
+TEST(Core_Arithm, half_float)
+{
+    RNG& rng = theRNG();
+    for (int iter = 0; iter < 8; iter++)
+    {
+        int cn = iter % 2 ? 3 : 1;
+        Size sz(rng.uniform(1, 100), rng.uniform(1, 10));
+        Mat a32(sz, CV_32FC(cn)), b32(sz, CV_32FC(cn)), a16, b16;
+        cv::randu(a32, -10, 10);
+        cv::randu(b32, 1, 10);
+        a32.convertTo(a16, CV_16F);
+        b32.convertTo(b16, CV_16F);
+        a16.convertTo(a32, CV_32F);
+        b16.convertTo(b32, CV_32F);
+        // non-continuous array with an odd offset
+        Mat a16roi = Mat(sz.height, sz.width + 1, CV_16FC(cn)).colRange(1, sz.width + 1);
+        a16.copyTo(a16roi);
+
+        Mat res16, res, ref, ref16;
+        #define CHECK_16F_OP(op16, op32, eps) \
+            op16; op32; \
+            ASSERT_EQ(CV_16F, res16.depth()) << #op16; \
+            res16.convertTo(res, CV_32F); \
+            ref.convertTo(ref16, CV_16F); ref16.convertTo(ref, CV_32F); \
+            EXPECT_LE(cvtest::norm(res, ref, NORM_INF), eps) << #op16
+
+        CHECK_16F_OP(cv::add(a16roi, b16, res16), cv::add(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::subtract(a16, b16, res16), cv::subtract(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::absdiff(a16roi, b16, res16), cv::absdiff(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::min(a16, b16, res16), cv::min(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::max(a16roi, b16, res16), cv::max(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::multiply(a16, b16, res16), cv::multiply(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::multiply(a16, b16, res16, 0.5), cv::multiply(a32, b32, ref, 0.5), 0);
+        CHECK_16F_OP(cv::divide(a16roi, b16, res16), cv::divide(a32, b32, ref), 0);
+        CHECK_16F_OP(cv::divide(2., b16, res16), cv::divide(2., b32, ref), 0);
+        CHECK_16F_OP(cv::addWeighted(a16, 0.25, b16, 2, 1, res16), cv::addWeighted(a32, 0.25, b32, 2, 1, ref), 0.05);
+        CHECK_16F_OP(cv::scaleAdd(a16, 3, b16, res16), cv::scaleAdd(a32, 3, b32, ref), 0.05);
+        CHECK_16F_OP(cv::add(a16, Scalar::all(2), res16), cv::add(a32, Scalar::all(2), ref), 0);
+        CHECK_16F_OP(cv::subtract(Scalar::all(1), a16, res16), cv::subtract(Scalar::all(1), a32, ref), 0);
+        CHECK_16F_OP(cv::max(a16, 1.5, res16), cv::max(a32, 1.5, ref), 0);
+        #undef CHECK_16F_OP
+
+        // mixed types are computed in single precision
+        cv::add(a16, b32, res, noArray(), CV_32F);
+        cv::add(a32, b32, ref);
+        EXPECT_EQ(0, cvtest::norm(res, ref, NORM_INF));
+
+        for (int cmpop = CMP_EQ; cmpop <= CMP_NE; cmpop++)
+        {
+            Mat cmp16, cmp32;
+            cv::compare(a16roi, b16, cmp16, cmpop);
+            cv::compare(a32, b32, cmp32, cmpop);
+            EXPECT_EQ(0, cvtest::norm(cmp16, cmp32, NORM_INF)) << "cmpop=" << cmpop;
+            cv::compare(a16, 2.5, cmp16, cmpop);
+            cv::compare(a32, 2.5, cmp32, cmpop);
+            EXPECT_EQ(0, cvtest::norm(cmp16, cmp32, NORM_INF)) << "cmpop=" << cmpop;
+        }
+
+        Mat abs16, abs32;
+        cv::convertScaleAbs(a16roi, abs16, 10, 3);
+        cv::convertScaleAbs(a32, abs32, 10, 3);
+        EXPECT_LE(cvtest::norm(abs16, abs32, NORM_INF), 1);
+
+        EXPECT_LE(cvtest::norm(cv::sum(a16roi), cv::sum(a32), NORM_INF), 1e-3);
+        EXPECT_LE(cvtest::norm(cv::mean(a16), cv::mean(a32), NORM_INF), 1e-5);
+        Scalar m16, sd16, m32, sd32;
+        cv::meanStdDev(a16roi, m16, sd16);
+        cv::meanStdDev(a32, m32, sd32);
+        EXPECT_LE(cvtest::norm(m16, m32, NORM_INF), 1e-5);
+        EXPECT_LE(cvtest::norm(sd16, sd32, NORM_INF), 1e-3);
+
+        double minv16 = 0, maxv16 = 0, minv32 = 0, maxv32 = 0;
+        int minidx16[2] = {}, maxidx16[2] = {}, minidx32[2] = {}, maxidx32[2] = {};
+        Mat a16c1 = a16.reshape(1), a32c1 = a32.reshape(1);
+        cv::minMaxIdx(a16c1, &minv16, &maxv16, minidx16, maxidx16);
+        cv::minMaxIdx(a32c1, &minv32, &maxv32, minidx32, maxidx32);
+        EXPECT_EQ(minv32, minv16);
+        EXPECT_EQ(maxv32, maxv16);
+        EXPECT_EQ(a32c1.at<float>(minidx16[0], minidx16[1]), (float)minv32);
+        EXPECT_EQ(a32c1.at<float>(maxidx16[0], maxidx16[1]), (float)maxv32);
+        EXPECT_LE(std::abs(cv::norm(a16roi, NORM_L2) - cv::norm(a32, NORM_L2)), 1e-3);
+        EXPECT_LE(std::abs(cv::norm(a16roi, NORM_L1) - cv::norm(a32, NORM_L1)), 1e-2);
+        EXPECT_EQ(cv::norm(a32, NORM_INF), cv::norm(a16roi, NORM_INF));
+        EXPECT_LE(std::abs(cv::norm(a16roi, b16, NORM_L2) - cv::norm(a32, b32, NORM_L2)), 1e-3);
+        EXPECT_EQ(cv::norm(a32, b32, NORM_INF), cv::norm(a16roi, b16, NORM_INF));
+    }
+}
+
+
+TEST(Core_Arithm, parallel_large)
+{
+    // the arrays are large enough to be split between threads, every row alone is processed serially
+    Size sz(1920, 1080);
+    Mat a8(sz, CV_8UC3), b8(sz, CV_8UC3), mask(sz, CV_8U);
+    randu(a8, 0, 256);
+    randu(b8, 0, 256);
+    randu(mask, 0, 2);
+    Mat a32, b32big(sz.height + 2, sz.width + 3, CV_32FC3), b32;
+    a8.convertTo(a32, CV_32F, 1./16);
+    b32 = b32big(Rect(1, 1, sz.width, sz.height));
+    b8.convertTo(b32, CV_32F, 1./16, 1.);
+    ASSERT_FALSE(b32.isContinuous());
+
+    Mat dst, ref(sz, CV_8UC3), ref32(sz, CV_32FC3), refc(sz, CV_8UC3);
+    for (int y = 0; y < sz.height; y++)
+    {
+        Mat r = ref.row(y), r32 = ref32.row(y), rc = refc.row(y);
+        cv::absdiff(a8.row(y), b8.row(y), r);
+        cv::multiply(a32.row(y), b32.row(y), r32, 0.5);
+        cv::compare(a32.row(y), b32.row(y), rc, CMP_GT);
+    }
+
+    cv::absdiff(a8, b8, dst);
+    EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+    cv::multiply(a32, b32, dst, 0.5);
+    EXPECT_EQ(0, cvtest::norm(dst, ref32, NORM_INF));
+    cv::compare(a32, b32, dst, CMP_GT);
+    EXPECT_EQ(0, cvtest::norm(dst, refc, NORM_INF));
+
+    for (int y = 0; y < sz.height; y++)
+    {
+        Mat r = ref.row(y), r32 = ref32.row(y);
+        cv::add(a8.row(y), Scalar(10, 20, 30), r);
+        cv::subtract(Scalar(1, 2, 3), a32.row(y), r32);
+    }
+    cv::add(a8, Scalar(10, 20, 30), dst);
+    EXPECT_EQ(0, cvtest::norm(dst, ref, NORM_INF));
+    cv::subtract(Scalar(1, 2, 3), a32, dst);
+    EXPECT_EQ(0, cvtest::norm(dst, ref32, NORM_INF));
+
+    int nthreads = getNumThreads();
+    int normTypes[] = { NORM_INF, NORM_L1, NORM_L2, NORM_L2SQR };
+    for (int i = 0; i < 4; i++)
+    {
+        int normType = normTypes[i];
+        SCOPED_TRACE(cv::format("normType=%d", normType));
+        double n8 = cv::norm(a8, normType, mask), n32 = cv::norm(a32, b32, normType);
+        EXPECT_LE(std::abs(n8 - cvtest::norm(a8, normType, mask)), std::abs(n8)*1e-12);
+        EXPECT_LE(std::abs(n32 - cvtest::norm(a32, b32, normType)), std::abs(n32)*1e-6);
+
+        // the partial norms are merged in a fixed order
+        setNumThreads(1);
+        double n8_1 = cv::norm(a8, normType, mask), n32_1 = cv::norm(a32, b32, normType);
+        setNumThreads(nthreads);
+        EXPECT_EQ(n8_1, n8);
+        EXPECT_EQ(n32_1, n32);
+    }
+}
+
 
 }} // namespace
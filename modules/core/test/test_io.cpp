@@ -1559,6 +1559,136 @@ TEST(Core_InputOutput, FileStorage_format_yml_gz)
     EXPECT_EQ(FileStorage::FORMAT_YAML, fs.getFormat());
 }
 
+TEST(Core_InputOutput, FileStorage_format_binary)
+{
+    FileStorage fs;
+    fs.open("opencv_storage.cvbin", FileStorage::WRITE | FileStorage::MEMORY);
+    EXPECT_EQ(FileStorage::FORMAT_BINARY, fs.getFormat());
+}
+
+TEST(Core_InputOutput, FileStorage_format_binary_gz)
+{
+    FileStorage fs;
+    fs.open("opencv_storage.cvbin.gz", FileStorage::WRITE | FileStorage::MEMORY);
+    EXPECT_EQ(FileStorage::FORMAT_BINARY, fs.getFormat());
+}
+
+static void writeBinaryStorageContent(FileStorage& fs, const Mat& m2d, const Mat& m3d, const Mat& m8u,
+                                      const SparseMat& sm, const std::vector<int>& vi)
+{
+    fs << "i" << 5 << "r" << 0.25 << "s" << "text";
+    fs << "m2d" << m2d << "m3d" << m3d << "m8u" << m8u << "sparse" << sm << "vi" << vi;
+    fs << "nested" << "{" << "seq" << "[" << 1 << "x" << 2.5 << "]" << "empty" << Mat() << "}";
+}
+
+TEST(Core_InputOutput, FileStorage_binary)
+{
+    Mat m2d(30, 40, CV_32FC3), m3d, m8u;
+    randu(m2d, -1, 1);
+    int sz[] = { 4, 5, 6 };
+    m3d.create(3, sz, CV_16SC2);
+    randu(m3d, -1000, 1000);
+    m2d(Rect(0, 0, 7, 5)).convertTo(m8u, CV_8U, 255);
+    SparseMat sm(m2d(Rect(0, 0, 4, 4)).reshape(1) > 0.5);
+    std::vector<int> vi;
+    for (int i = 0; i < 100; i++)
+        vi.push_back(i*i - 50);
+
+    const std::string fileName = cv::tempfile(".cvbin");
+    {
+        FileStorage fs(fileName, FileStorage::WRITE);
+        writeBinaryStorageContent(fs, m2d, m3d, m8u, sm, vi);
+    }
+    FileStorage fsmem(".cvbin", FileStorage::WRITE + FileStorage::MEMORY);
+    writeBinaryStorageContent(fsmem, m2d, m3d, m8u, sm, vi);
+    const std::string content = fsmem.releaseAndGetString();
+    {
+        FileStorage fsgz(fileName + ".gz", FileStorage::WRITE);
+        writeBinaryStorageContent(fsgz, m2d, m3d, m8u, sm, vi);
+    }
+
+    const char* modes[] = { "file", "memory", "gz" };
+    for (int mode = 0; mode < 3; mode++)
+    {
+        SCOPED_TRACE(modes[mode]);
+        FileStorage fs;
+        if (mode == 0)
+            ASSERT_TRUE(fs.open(fileName, FileStorage::READ));
+        else if (mode == 1)
+            ASSERT_TRUE(fs.open(content, FileStorage::READ + FileStorage::MEMORY));
+        else
+            ASSERT_TRUE(fs.open(fileName + ".gz", FileStorage::READ));
+        EXPECT_EQ(FileStorage::FORMAT_BINARY, fs.getFormat());
+
+        EXPECT_EQ(5, (int)fs["i"]);
+        EXPECT_EQ(0.25, (double)fs["r"]);
+        EXPECT_EQ("text", (std::string)fs["s"]);
+
+        Mat r2d, r3d, r8u;
+        fs["m2d"] >> r2d;
+        fs["m3d"] >> r3d;
+        fs["m8u"] >> r8u;
+        EXPECT_EQ(0, cvtest::norm(m2d, r2d, NORM_INF));
+        ASSERT_EQ(m3d.type(), r3d.type());
+        EXPECT_EQ(0, cvtest::norm(m3d, r3d, NORM_INF));
+        ASSERT_EQ(CV_8UC3, r8u.type());
+        EXPECT_EQ(0, memcmp(m8u.data, r8u.data, m8u.total()*m8u.elemSize()));
+
+        // the data is not copied
+        Mat r2d2 = fs["m2d"].mat();
+        EXPECT_EQ(r2d.data, r2d2.data);
+
+        SparseMat rsm;
+        fs["sparse"] >> rsm;
+        Mat dense, rdense;
+        sm.copyTo(dense);
+        rsm.copyTo(rdense);
+        EXPECT_EQ(0, cvtest::norm(dense, rdense, NORM_INF));
+
+        std::vector<int> rvi;
+        std::vector<double> rvd;
+        fs["vi"] >> rvi;
+        fs["vi"] >> rvd;
+        EXPECT_EQ(vi, rvi);
+        ASSERT_EQ(vi.size(), rvd.size());
+        EXPECT_EQ((double)vi[99], rvd[99]);
+        FileNode vnode = fs["vi"];
+        ASSERT_EQ(vi.size(), vnode.size());
+        EXPECT_EQ(vi[3], (int)vnode[3]);
+        FileNodeIterator it = vnode.begin();
+        int prev = 0;
+        it += 10;
+        it >> prev;
+        EXPECT_EQ(vi[10], prev);
+        EXPECT_EQ(vi.size() - 11, it.remaining());
+
+        FileNode nested = fs["nested"];
+        EXPECT_EQ(3u, nested["seq"].size());
+        EXPECT_EQ(1, (int)nested["seq"][0]);
+        EXPECT_EQ("x", (std::string)nested["seq"][1]);
+        EXPECT_EQ(2.5, (double)nested["seq"][2]);
+        Mat empty;
+        nested["empty"] >> empty;
+        EXPECT_TRUE(empty.empty());
+
+        fs.release();
+        // matrices keep the storage data
+        EXPECT_EQ(0, cvtest::norm(m2d, r2d, NORM_INF));
+    }
+
+    // truncated file
+    EXPECT_ANY_THROW(FileStorage(content.substr(0, content.size() - 1), FileStorage::READ + FileStorage::MEMORY));
+    // broken node tree
+    std::string broken = content;
+    size_t pos = broken.find("text");
+    ASSERT_NE(std::string::npos, pos);
+    broken[pos - 1] = (char)0x7f;  // length of the string
+    EXPECT_ANY_THROW(FileStorage(broken, FileStorage::READ + FileStorage::MEMORY));
+
+    EXPECT_EQ(0, remove(fileName.c_str()));
+    EXPECT_EQ(0, remove((fileName + ".gz").c_str()));
+}
+
 TEST(Core_InputOutput, FileStorage_json_named_nodes)
 {
     std::string test =
@@ -1711,4 +1841,100 @@ TEST(Core_InputOutput, FileStorage_JSON_VeryLongLines)
     }
 }
 
+class FileNodeRecorder : public FileNodeHandler
+{
+public:
+    FileNodeRecorder() : nelems(0), inElems(false) {}
+
+    int startNode(const String& name, int /*depth*/) CV_OVERRIDE
+    {
+        if (name == "skipped")
+            return SKIP;
+        if (name == "loaded")
+            return LOAD;
+        if (name == "elems")
+            inElems = true;
+        return VISIT;
+    }
+
+    bool endNode(const FileNode& node, int depth) CV_OVERRIDE
+    {
+        if (inElems)
+        {
+            if (depth == 0)
+                inElems = false;
+            else if (node.isInt() && (int)node == nelems)
+                nelems++;
+            return true;
+        }
+        std::ostringstream s;
+        s << depth << ":" << node.name();
+        if (node.isInt())
+            s << ":" << (int)node;
+        else if (node.isReal())
+            s << ":" << (double)node;
+        else if (node.isString())
+            s << ":" << (std::string)node;
+        else if (node.name() == "loaded")
+        {
+            Mat m;
+            node >> m;
+            s << ":" << m.rows << "x" << m.cols << "=" << sum(m)[0];
+        }
+        else if (node.isCollection(node.type()))
+            s << (node.isSeq() ? ":seq" : ":map") << node.size();
+        events.push_back(s.str());
+        return node.name() != "stop";
+    }
+
+    std::vector<std::string> events;
+    int nelems;
+    bool inElems;
+};
+
+TEST(Core_InputOutput, FileStorage_parse_incrementally)
+{
+    const char* formats[] = { ".xml", ".yml", ".json" };
+    for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++)
+    {
+        SCOPED_TRACE(formats[i]);
+        FileStorage fs(formats[i], FileStorage::WRITE + FileStorage::MEMORY);
+        fs << "a" << 1;
+        fs << "skipped" << "{" << "x" << 1 << "y" << "[" << 1 << 2 << "]" << "}";
+        fs << "loaded" << Mat::eye(3, 3, CV_32F);
+        fs << "seq" << "[" << 1.5 << "str" << "{" << "k" << 2 << "}" << "]";
+        fs << "elems" << "[";
+        for (int j = 0; j < 30000; j++)
+            fs << j;
+        fs << "]";
+        fs << "last" << "end";
+        const std::string content = fs.releaseAndGetString();
+
+        FileNodeRecorder recorder;
+        ASSERT_TRUE(fs.parse(content, recorder, FileStorage::READ + FileStorage::MEMORY));
+        EXPECT_FALSE(fs.isOpened());
+        std::vector<std::string> expected;
+        expected.push_back("0:a:1");
+        expected.push_back("0:loaded:3x3=3");
+        expected.push_back("1::1.5");
+        expected.push_back("1::str");
+        expected.push_back("2:k:2");
+        expected.push_back("1::map0");
+        expected.push_back("0:seq:seq0");
+        expected.push_back("0:last:end");
+        EXPECT_EQ(expected, recorder.events);
+        EXPECT_EQ(30000, recorder.nelems);
+
+        // stop parsing from the handler
+        FileNodeRecorder stopped;
+        std::string content2 = content;
+        for (size_t pos; (pos = content2.find("loaded")) != std::string::npos; )
+            content2.replace(pos, 6, "stop");
+        EXPECT_FALSE(fs.parse(content2, stopped, FileStorage::READ + FileStorage::MEMORY));
+        ASSERT_FALSE(stopped.events.empty());
+        EXPECT_EQ("0:a:1", stopped.events.front());
+        EXPECT_EQ("0:stop:map0", stopped.events.back());
+    }
+}
+
 }} // namespace
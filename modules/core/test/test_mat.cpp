@@ -2036,6 +2036,64 @@ TEST(Core_Eigen, eigen2cv_check_Mat_type)
 }
 #endif // HAVE_EIGEN
 
+TEST(Mat, pooled_allocator)
+{
+    MatAllocator* allocator = Mat::getPooledAllocator();
+    BufferPoolController* c = allocator->getBufferPoolController();
+    ASSERT_TRUE(c != NULL);
+    EXPECT_EQ(c, allocator->getBufferPoolController("CPU"));
+    EXPECT_ANY_THROW(allocator->getBufferPoolController("OCL"));
+
+    const size_t oldMaxReservedSize = c->getMaxReservedSize();
+    c->freeAllReservedBuffers();
+    c->setMaxReservedSize(1 << 20);
+    EXPECT_EQ(0u, c->getReservedSize());
+
+    const uchar* data = NULL;
+    {
+        Mat m;
+        m.allocator = allocator;
+        m.create(100, 100, CV_8UC3);
+        m.setTo(Scalar::all(1));
+        data = m.data;
+    }
+    const size_t reservedSize = c->getReservedSize();
+    EXPECT_GE(reservedSize, (size_t)100 * 100 * 3);
+    {
+        Mat m;
+        m.allocator = allocator;
+        m.create(100, 300, CV_8UC1);  // same size class
+        EXPECT_EQ(data, m.data);
+        EXPECT_EQ(0u, c->getReservedSize());
+    }
+    {
+        Mat m;
+        m.allocator = allocator;
+        m.create(1000, 1000, CV_8UC1);  // > maxReservedSize / 8, not cached on release
+    }
+    EXPECT_EQ(reservedSize, c->getReservedSize());
+
+    parallel_for_(Range(0, 64), [&](const Range& r)
+    {
+        for (int i = r.start; i < r.end; i++)
+        {
+            Mat m;
+            m.allocator = allocator;
+            m.create(10 + i, 20 + i * 7, CV_32FC1);
+            m.setTo(Scalar::all(i));
+            Mat m2 = m.clone();
+            EXPECT_EQ(0, cvtest::norm(m, m2, NORM_INF));
+        }
+    });
+    EXPECT_LE(c->getReservedSize(), (size_t)1 << 20);
+
+    c->setMaxReservedSize(1 << 10);
+    EXPECT_LE(c->getReservedSize(), (size_t)1 << 10);
+    c->freeAllReservedBuffers();
+    EXPECT_EQ(0u, c->getReservedSize());
+    c->setMaxReservedSize(oldMaxReservedSize);
+}
+
 TEST(Mat, regression_12943)  // memory usage: ~4.5 Gb
 {
     applyTestTag(CV_TEST_TAG_MEMORY_6GB);
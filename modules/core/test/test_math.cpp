@@ -2746,6 +2746,49 @@ TEST(Core_CrossProduct, accuracy) { Core_CrossProductTest test; test.safe_run();
 TEST(Core_Determinant, accuracy) { Core_DetTest test; test.safe_run(); }
 TEST(Core_DotProduct, accuracy) { Core_DotProductTest test; test.safe_run(); }
 TEST(Core_GEMM, accuracy) { Core_GEMMTest test; test.safe_run(); }
+
+TEST(Core_GEMM, packed_large)
+{
+    // sizes above the threshold of the packed kernel with partial register tiles and k-slices
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+    for (int iter = 0; iter < 16; iter++)
+    {
+        int type = iter % 2 ? CV_64FC1 : CV_32FC1;
+        int flags = (iter / 2) % 8;
+        int m = rng.uniform(60, 200), n = rng.uniform(60, 200), k = rng.uniform(200, 600);
+        SCOPED_TRACE(cv::format("iter=%d type=%d flags=%d size=%dx%dx%d", iter, type, flags, m, n, k));
+
+        Mat a = (flags & GEMM_1_T) ? Mat(k, m, type) : Mat(m, k, type);
+        Mat b_big((flags & GEMM_2_T) ? n + 3 : k + 3, (flags & GEMM_2_T) ? k + 5 : n + 5, type);
+        Mat b = b_big(Rect(2, 1, b_big.cols - 5, b_big.rows - 3));
+        Mat c = (flags & GEMM_3_T) ? Mat(n, m, type) : Mat(m, n, type);
+        randu(a, -1, 1);
+        randu(b_big, -1, 1);
+        randu(c, -1, 1);
+        double alpha = rng.uniform(-2., 2.), beta = iter % 3 == 0 ? 0. : rng.uniform(-2., 2.);
+
+        Mat ref, dst;
+        cvtest::gemm(a, b, alpha, c, beta, ref, flags);
+        cv::gemm(a, b, alpha, c, beta, dst, flags);
+        EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), (type == CV_32FC1 ? 1e-5 : 1e-12)*k);
+
+        // every element is accumulated in the same order regardless of the number of threads
+        Mat dst1;
+        setNumThreads(1);
+        cv::gemm(a, b, alpha, c, beta, dst1, flags);
+        setNumThreads(nthreads);
+        EXPECT_EQ(0, cvtest::norm(dst, dst1, NORM_INF));
+
+        if (!(flags & GEMM_3_T) && beta != 0)
+        {
+            // in-place update of C
+            Mat cd = c.clone();
+            cv::gemm(a, b, alpha, cd, beta, cd, flags);
+            EXPECT_EQ(0, cvtest::norm(dst, cd, NORM_INF));
+        }
+    }
+}
 TEST(Core_Invert, accuracy) { Core_InvertTest test; test.safe_run(); }
 TEST(Core_Mahalanobis, accuracy) { Core_MahalanobisTest test; test.safe_run(); }
 TEST(Core_MulTransposed, accuracy) { Core_MulTransposedTest test; test.safe_run(); }
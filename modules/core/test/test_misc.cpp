@@ -3,6 +3,13 @@
 // of this distribution and at http://opencv.org/license.html.
 #include "test_precomp.hpp"
 
+#include "opencv2/core/parallel/parallel_backend.hpp"
+#include "opencv2/core/utils/parallel_stats.hpp"
+
+#ifdef CV_CXX11
+#include <thread>
+#endif
+
 namespace opencv_test { namespace {
 
 TEST(Core_OutputArrayCreate, _1997)
@@ -242,6 +249,226 @@ TEST(Core_Parallel, propagate_exceptions)
     }, cv::Exception);
 }
 
+#ifdef CV_CXX11
+TEST(Core_Parallel, nested_loops)
+{
+    Mat dst(64, 1000, CV_32SC1, Scalar::all(0));
+    parallel_for_(Range(0, dst.rows), [&](const Range& rows)
+    {
+        for (int y = rows.start; y < rows.end; y++)
+        {
+            int* row = dst.ptr<int>(y);
+            parallel_for_(Range(0, dst.cols), [&](const Range& cols)
+            {
+                for (int x = cols.start; x < cols.end; x++)
+                    row[x] += y * dst.cols + x;
+            });
+        }
+    });
+    Mat expected(dst.size(), CV_32SC1);
+    for (int y = 0; y < dst.rows; y++)
+        for (int x = 0; x < dst.cols; x++)
+            expected.at<int>(y, x) = y * dst.cols + x;
+    EXPECT_EQ(0, cvtest::norm(dst, expected, NORM_INF));
+
+    Mat dst2(64, 100, CV_8SC1, Scalar::all(0));
+    EXPECT_THROW({
+        parallel_for_(Range(0, 8), [&](const Range& r)
+        {
+            for (int i = r.start; i < r.end; i++)
+            {
+                Mat part = dst2.rowRange(i * 8, (i + 1) * 8);
+                parallel_for_(Range(0, part.rows), ThrowErrorParallelLoopBody(part, i == 5 ? 3 : -1));
+            }
+        });
+    }, cv::Exception);
+}
+
+TEST(Core_Parallel, concurrent_calls)
+{
+    const int num_callers = 4, num_iterations = 50;
+    std::vector<int64> sums(num_callers, 0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < num_callers; t++)
+    {
+        callers.push_back(std::thread([&sums, t]()
+        {
+            std::vector<int> values(10000, 0);
+            for (int iter = 0; iter < num_iterations; iter++)
+            {
+                parallel_for_(Range(0, (int)values.size()), [&](const Range& r)
+                {
+                    for (int i = r.start; i < r.end; i++)
+                        values[i] += t + 1;
+                });
+            }
+            int64 sum = 0;
+            for (size_t i = 0; i < values.size(); i++)
+                sum += values[i];
+            sums[t] = sum;
+        }));
+    }
+    for (size_t t = 0; t < callers.size(); t++)
+        callers[t].join();
+    for (int t = 0; t < num_callers; t++)
+        EXPECT_EQ((int64)10000 * num_iterations * (t + 1), sums[t]) << "caller " << t;
+}
+
+TEST(Core_Parallel, execution_context)
+{
+    const Range range(0, 100);
+    std::atomic<int> calls(0), minSize(range.size());
+    auto body = [&](const Range& r)
+    {
+        calls++;
+        int sz = r.size(), cur = minSize;
+        while (sz < cur && !minSize.compare_exchange_weak(cur, sz)) {}
+    };
+
+    ASSERT_TRUE(parallel::ExecutionContext::getCurrent() == NULL);
+    {
+        parallel::ExecutionContext ctx(1);
+        EXPECT_EQ(1, getNumThreads());
+        parallel_for_(range, body);
+        EXPECT_EQ(1, (int)calls);
+    }
+    ASSERT_TRUE(parallel::ExecutionContext::getCurrent() == NULL);
+
+    calls = 0;
+    {
+        parallel::ExecutionContext ctx(0, 30);
+        parallel_for_(range, body);
+        EXPECT_LE((int)calls, 3);
+        EXPECT_GE((int)minSize, 30);
+
+        parallel::ExecutionContext inner(0, 10);  // outer grain size is not reduced
+        EXPECT_EQ(30, inner.getGrainSize());
+        EXPECT_EQ(&inner, parallel::ExecutionContext::getCurrent());
+    }
+
+    int executorCalls = 0;
+    std::atomic<int> nestedWithContext(0);
+    {
+        parallel::ExecutionContext ctx(0, 0, [&](const Range& stripes, const ParallelLoopBody& b, double)
+        {
+            executorCalls++;
+            for (int i = stripes.start; i < stripes.end; i++)
+                b(Range(i, i + 1));
+        });
+        std::vector<int> values(range.end, 0);
+        parallel_for_(range, [&](const Range& r)
+        {
+            if (parallel::ExecutionContext::getCurrent() == &ctx)
+                nestedWithContext++;
+            for (int i = r.start; i < r.end; i++)
+                values[i] = i;
+        }, 4);
+        EXPECT_EQ(1, executorCalls);
+        EXPECT_EQ(4, (int)nestedWithContext);
+        for (int i = range.start; i < range.end; i++)
+            ASSERT_EQ(i, values[i]);
+    }
+    ASSERT_TRUE(parallel::ExecutionContext::getCurrent() == NULL);
+}
+
+class CountingParallelForAPI : public parallel::ParallelForAPI
+{
+public:
+    CountingParallelForAPI() : loops(0), threads(3) {}
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void* callback_data) CV_OVERRIDE
+    {
+        loops++;
+        for (int i = 0; i < tasks; i++)
+            body_callback(i, i + 1, callback_data);
+    }
+    int getThreadNum() const CV_OVERRIDE { return 0; }
+    int getNumThreads() const CV_OVERRIDE { return threads; }
+    int setNumThreads(int nThreads) CV_OVERRIDE { std::swap(threads, nThreads); return nThreads; }
+    const char* getName() const CV_OVERRIDE { return "counting"; }
+
+    std::atomic<int> loops;
+    int threads;
+};
+
+TEST(Core_Parallel, backend)
+{
+    const std::string defaultName = parallel::getParallelForBackend()->getName();
+    std::vector<std::string> names = parallel::getParallelForBackendNames();
+    EXPECT_NE(names.end(), std::find(names.begin(), names.end(), "sequential"));
+    EXPECT_FALSE(parallel::setParallelForBackend("unknown_backend"));
+
+    std::shared_ptr<CountingParallelForAPI> api = std::make_shared<CountingParallelForAPI>();
+    parallel::setParallelForBackend(api, false);
+    EXPECT_EQ(api, parallel::getParallelForBackend());
+    EXPECT_EQ(3, getNumThreads());
+
+    std::vector<int> values(100, 0);
+    EXPECT_NO_THROW(parallel_for_(Range(0, (int)values.size()), [&](const Range& r)
+    {
+        for (int i = r.start; i < r.end; i++)
+        {
+            values[i] = i;
+            parallel_for_(Range(0, 2), [&](const Range&) {});  // nested loops are passed to the backend too
+        }
+    }));
+    EXPECT_EQ(101, (int)api->loops);
+    for (int i = 0; i < (int)values.size(); i++)
+        ASSERT_EQ(i, values[i]);
+    Mat dst(10, 1, CV_8SC1, Scalar::all(0));
+    EXPECT_THROW(parallel_for_(Range(0, dst.rows), ThrowErrorParallelLoopBody(dst, 5)), cv::Exception);
+
+    EXPECT_TRUE(parallel::setParallelForBackend("sequential"));
+    EXPECT_EQ(1, getNumThreads());
+
+    parallel::setParallelForBackend(std::shared_ptr<parallel::ParallelForAPI>());
+    EXPECT_EQ(defaultName, parallel::getParallelForBackend()->getName());
+}
+
+TEST(Core_Parallel, stats)
+{
+    const int threads = getNumThreads();
+    setNumThreads(4);
+    utils::resetParallelStats();
+
+    const int num_jobs = 10, num_stripes = 100;
+    for (int i = 0; i < num_jobs; i++)
+    {
+        parallel_for_(Range(0, num_stripes), [&](const Range& r)
+        {
+            Mat m(64, 64, CV_32FC1);
+            for (int j = r.start; j < r.end; j++)
+                randu(m, 0, 1);
+        });
+    }
+    utils::ParallelStats stats = utils::getParallelStats();
+    setNumThreads(threads);
+
+    EXPECT_EQ(parallel::getParallelForBackend()->getName(), stats.backend);
+    EXPECT_EQ(4, stats.numThreads);
+    if (stats.backend != "pthreads")
+        throw SkipTestException("Statistics are collected by the built-in thread pool only");
+
+    EXPECT_EQ((uint64)num_jobs, stats.jobs);
+    EXPECT_EQ((uint64)(num_jobs * num_stripes), stats.stripes);
+    EXPECT_GE(stats.avgImbalance, 1.0);
+    EXPECT_GE(stats.maxImbalance, stats.avgImbalance);
+    EXPECT_LE(stats.avgStartLatency, stats.maxStartLatency);
+    ASSERT_EQ(4u, stats.threads.size());  // 3 workers and the calling thread
+    uint64 stripes = 0;
+    for (size_t i = 0; i < stats.threads.size(); i++)
+    {
+        const utils::ParallelThreadStats& t = stats.threads[i];
+        EXPECT_GE(t.busyTime, 0.0);
+        EXPECT_GE(t.idleTime, 0.0);
+        EXPECT_LE(t.tasks, t.stripes);
+        stripes += t.stripes;
+    }
+    EXPECT_EQ(-1, stats.threads.back().id);
+    EXPECT_GT(stats.threads.back().tasks, 0u);
+    EXPECT_EQ(stats.stripes, stripes);
+}
+#endif
+
 TEST(Core_Version, consistency)
 {
     // this test verifies that OpenCV version loaded in runtime
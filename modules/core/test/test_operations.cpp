@@ -1519,6 +1519,161 @@ TEST(Core_sortIdx, regression_8941)
         "expected=" << std::endl << expected;
 }
 
+TEST(Core_sort, radix_large)
+{
+    const int depths[] = { CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F, CV_64F };
+    const Size sizes[] = { Size(5000, 3), Size(3, 5000), Size(300000, 1) };
+    const int flags[] = {
+        SORT_EVERY_ROW | SORT_ASCENDING, SORT_EVERY_ROW | SORT_DESCENDING,
+        SORT_EVERY_COLUMN | SORT_ASCENDING, SORT_EVERY_COLUMN | SORT_DESCENDING
+    };
+    RNG& rng = theRNG();
+
+    for (size_t di = 0; di < sizeof(depths)/sizeof(depths[0]); di++)
+    for (size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++)
+    for (size_t fi = 0; fi < sizeof(flags)/sizeof(flags[0]); fi++)
+    {
+        const int depth = depths[di], flag = flags[fi];
+        SCOPED_TRACE(cv::format("depth=%d size=%dx%d flags=%d", depth, sizes[si].width, sizes[si].height, flag));
+
+        // plenty of equal values to check that the equal elements keep their order
+        Mat isrc(sizes[si], CV_32S), src, src64;
+        rng.fill(isrc, RNG::UNIFORM, -3000, 3000);
+        isrc.convertTo(src, depth, depth == CV_32F || depth == CV_64F ? 0.25 : 1);
+        src.convertTo(src64, CV_64F);
+
+        Mat dst, dstIdx, inplace = src.clone();
+        cv::sort(src, dst, flag);
+        cv::sortIdx(src, dstIdx, flag);
+        cv::sort(inplace, inplace, flag);
+        ASSERT_EQ(0, cvtest::norm(dst, inplace, NORM_INF));
+
+        Mat dst64;
+        dst.convertTo(dst64, CV_64F);
+        bool sortRows = (flag & 1) == SORT_EVERY_ROW, descending = (flag & SORT_DESCENDING) != 0;
+        int n = sortRows ? src.rows : src.cols, len = sortRows ? src.cols : src.rows;
+        std::vector<double> line(len);
+        std::vector<int> idx(len);
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < len; j++)
+            {
+                line[j] = sortRows ? src64.at<double>(i, j) : src64.at<double>(j, i);
+                idx[j] = j;
+            }
+            if (descending)
+                std::stable_sort(idx.begin(), idx.end(), [&](int a, int b) { return line[a] > line[b]; });
+            else
+                std::stable_sort(idx.begin(), idx.end(), [&](int a, int b) { return line[a] < line[b]; });
+            for (int j = 0; j < len; j++)
+            {
+                ASSERT_EQ(idx[j], sortRows ? dstIdx.at<int>(i, j) : dstIdx.at<int>(j, i)) << "line " << i << " pos " << j;
+                ASSERT_EQ(line[idx[j]], sortRows ? dst64.at<double>(i, j) : dst64.at<double>(j, i)) << "line " << i << " pos " << j;
+            }
+        }
+    }
+}
+
+TEST(Core_sort, radix_float_specials)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    Mat src(1, 1000, CV_32F);
+    for (int j = 0; j < src.cols; j++)
+        src.at<float>(j) = (float)((j * 7919) % 1000 - 500) * 1e-3f;
+    src.at<float>(10) = inf;
+    src.at<float>(20) = -inf;
+    src.at<float>(30) = FLT_MAX;
+    src.at<float>(40) = -FLT_MIN;
+    src.at<float>(50) = FLT_MIN;
+
+    Mat dst;
+    cv::sort(src, dst, SORT_EVERY_ROW | SORT_ASCENDING);
+    EXPECT_EQ(-inf, dst.at<float>(0));
+    EXPECT_EQ(inf, dst.at<float>(dst.cols - 1));
+    EXPECT_EQ(FLT_MAX, dst.at<float>(dst.cols - 2));
+    for (int j = 1; j < dst.cols; j++)
+        ASSERT_LE(dst.at<float>(j - 1), dst.at<float>(j)) << j;
+}
+TEST(Core_topK, accuracy)
+{
+    const int depths[] = { CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F, CV_64F };
+    const Size sizes[] = { Size(1000, 7), Size(5, 300), Size(200000, 1) };
+    RNG& rng = theRNG();
+
+    for (size_t di = 0; di < sizeof(depths)/sizeof(depths[0]); di++)
+    for (size_t si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++)
+    for (int dim = 0; dim <= 1; dim++)
+    for (int largest = 0; largest <= 1; largest++)
+    {
+        const int depth = depths[di];
+        const Size sz = sizes[si];
+        int len = dim == 1 ? sz.width : sz.height;
+        const int ks[] = { 1, std::min(len, 5), std::max(len / 3, 1), len };
+
+        Mat isrc(sz, CV_32S), src;
+        rng.fill(isrc, RNG::UNIFORM, -3000, 3000);
+        isrc.convertTo(src, depth, depth == CV_32F || depth == CV_64F ? 0.25 : 1);
+
+        // sortIdx keeps the equal elements in the order of their indices as well
+        Mat sortedIdx;
+        cv::sortIdx(src, sortedIdx, (dim == 1 ? SORT_EVERY_ROW : SORT_EVERY_COLUMN) |
+                                    (largest ? SORT_DESCENDING : SORT_ASCENDING));
+
+        for (size_t ki = 0; ki < sizeof(ks)/sizeof(ks[0]); ki++)
+        {
+            const int k = ks[ki];
+            SCOPED_TRACE(cv::format("depth=%d size=%dx%d dim=%d largest=%d k=%d",
+                                    depth, sz.width, sz.height, dim, largest, k));
+            Mat values, indices, valuesOnly;
+            cv::topK(src, k, dim, values, indices, largest != 0);
+            cv::topK(src, k, dim, valuesOnly, noArray(), largest != 0);
+
+            Size dsz = dim == 1 ? Size(k, sz.height) : Size(sz.width, k);
+            ASSERT_EQ(dsz, values.size());
+            ASSERT_EQ(src.type(), values.type());
+            ASSERT_EQ(dsz, indices.size());
+            ASSERT_EQ(CV_32SC1, indices.type());
+
+            Mat expectedIdx = dim == 1 ? sortedIdx.colRange(0, k) : sortedIdx.rowRange(0, k);
+            ASSERT_EQ(0, cvtest::norm(expectedIdx, indices, NORM_INF));
+            ASSERT_EQ(0, cvtest::norm(values, valuesOnly, NORM_INF));
+
+            Mat src64, values64;
+            src.convertTo(src64, CV_64F);
+            values.convertTo(values64, CV_64F);
+            for (int i = 0; i < values.rows; i++)
+                for (int j = 0; j < values.cols; j++)
+                {
+                    int idx = indices.at<int>(i, j);
+                    double expected = dim == 1 ? src64.at<double>(i, idx) : src64.at<double>(idx, j);
+                    ASSERT_EQ(expected, values64.at<double>(i, j)) << i << " " << j;
+                }
+        }
+    }
+}
+
+TEST(Core_topK, inplace_and_errors)
+{
+    Mat src = (Mat_<float>(2, 5) << 3, 1, 4, 1, 5,
+                                    9, 2, 6, 5, 3);
+    Mat values = src.clone(), indices;
+    cv::topK(values, 3, 1, values, indices);
+    Mat expectedValues = (Mat_<float>(2, 3) << 5, 4, 3, 9, 6, 5);
+    Mat expectedIndices = (Mat_<int>(2, 3) << 4, 2, 0, 0, 2, 3);
+    EXPECT_EQ(0, cvtest::norm(expectedValues, values, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(expectedIndices, indices, NORM_INF));
+
+    cv::topK(src, 2, 0, values, indices, false);
+    expectedValues = (Mat_<float>(2, 5) << 3, 1, 4, 1, 3, 9, 2, 6, 5, 5);
+    expectedIndices = (Mat_<int>(2, 5) << 0, 0, 0, 0, 1, 1, 1, 1, 1, 0);
+    EXPECT_EQ(0, cvtest::norm(expectedValues, values, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(expectedIndices, indices, NORM_INF));
+
+    EXPECT_THROW(cv::topK(src, 0, 1, values, indices), cv::Exception);
+    EXPECT_THROW(cv::topK(src, 6, 1, values, indices), cv::Exception);
+    EXPECT_THROW(cv::topK(src, 3, 0, values, indices), cv::Exception);
+    EXPECT_THROW(cv::topK(src, 1, 2, values, indices), cv::Exception);
+}
 
 //These tests guard regressions against running MatExpr
 //operations on empty operands and giving bogus
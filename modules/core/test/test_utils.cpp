@@ -4,6 +4,7 @@
 #include "test_precomp.hpp"
 #include "opencv2/core/utils/logger.hpp"
 #include "opencv2/core/utils/buffer_area.private.hpp"
+#include "opencv2/core/utils/allocator_stats.hpp"
 
 #include "test_utils_tls.impl.hpp"
 
@@ -446,5 +447,49 @@ TEST_P(BufferArea, bad)
 
 INSTANTIATE_TEST_CASE_P(/**/, BufferArea, testing::Values(true, false));
 
+TEST(Core_Allocator, region_statistics)
+{
+    const bool enabled = utils::isAllocatorRegionStatisticsEnabled();
+    utils::setAllocatorRegionStatisticsEnabled(true);
+    if (!utils::isAllocatorRegionStatisticsEnabled())
+        throw SkipTestException("OpenCV is built without tracing support");
+    utils::resetAllocatorRegionStatistics();
+
+    Mat src(480, 640, CV_8UC3, Scalar::all(1));
+    Mat dst;
+    cv::flip(src, dst, 0);  // dst buffer is allocated in cv::flip() region
+
+    std::vector<utils::AllocatorRegionStatistics> stats = utils::getAllocatorRegionStatistics();
+    const utils::AllocatorRegionStatistics* flip_stat = NULL;
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        if (i > 0)
+        {
+            EXPECT_GE(stats[i - 1].totalUsage, stats[i].totalUsage);
+        }
+        if (std::string(stats[i].name).find("flip") != std::string::npos)
+            flip_stat = &stats[i];
+    }
+    ASSERT_TRUE(flip_stat != NULL);
+    EXPECT_EQ(1u, flip_stat->numberOfAllocations);
+    EXPECT_GE(flip_stat->totalUsage, dst.total() * dst.elemSize());
+    EXPECT_EQ(flip_stat->totalUsage, flip_stat->currentUsage);
+    EXPECT_EQ(flip_stat->totalUsage, flip_stat->peakUsage);
+    EXPECT_NE(std::string::npos, utils::dumpAllocatorRegionStatistics().find("flip"));
+
+    dst.release();
+    stats = utils::getAllocatorRegionStatistics();
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        if (std::string(stats[i].name).find("flip") != std::string::npos)
+        {
+            EXPECT_EQ(0u, stats[i].currentUsage);
+            EXPECT_GE(stats[i].peakUsage, (uint64_t)src.total() * src.elemSize());
+        }
+    }
+
+    utils::setAllocatorRegionStatisticsEnabled(enabled);
+}
+
 
 }} // namespace
@@ -74,7 +74,8 @@ enum ImreadModes {
        IMREAD_REDUCED_COLOR_4      = 33, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/4.
        IMREAD_REDUCED_GRAYSCALE_8  = 64, //!< If set, always convert image to the single channel grayscale image and the image size reduced 1/8.
        IMREAD_REDUCED_COLOR_8      = 65, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/8.
-       IMREAD_IGNORE_ORIENTATION   = 128 //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_IGNORE_ORIENTATION   = 128, //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_MMAP                 = 256  //!< If set, map the file into memory instead of decoding it when it stores the image uncompressed with the layout of the output (see cv::imread). Use IMREAD_ANYDEPTH | IMREAD_ANYCOLOR instead of IMREAD_UNCHANGED with it.
      };
 
 //! Imwrite flags
@@ -88,6 +89,7 @@ enum ImwriteFlags {
        IMWRITE_PNG_COMPRESSION     = 16, //!< For PNG, it can be the compression level from 0 to 9. A higher value means a smaller size and longer compression time. If specified, strategy is changed to IMWRITE_PNG_STRATEGY_DEFAULT (Z_DEFAULT_STRATEGY). Default value is 1 (best speed setting).
        IMWRITE_PNG_STRATEGY        = 17, //!< One of cv::ImwritePNGFlags, default is IMWRITE_PNG_STRATEGY_RLE.
        IMWRITE_PNG_BILEVEL         = 18, //!< Binary level PNG, 0 or 1, default is 0.
+       IMWRITE_PNG_THREADS         = 19, //!< For PNG, number of row chunks compressed concurrently by cv::imwrite and cv::imencode, a negative value means cv::getNumThreads(). Default is 0 - single-threaded. The chunks are stitched into one compressed stream; each chunk holds at least 256KB of image data.
        IMWRITE_PXM_BINARY          = 32, //!< For PPM, PGM, or PBM, it can be a binary format flag, 0 or 1. Default value is 1.
        IMWRITE_EXR_TYPE            = (3 << 4) + 0, /* 48 */ //!< override EXR storage type (FLOAT (FP32) is default)
        IMWRITE_WEBP_QUALITY        = 64, //!< For WEBP, it can be a quality from 1 to 100 (the higher is the better). By default (without any parameter) and for quality above 100 the lossless compression is used.
@@ -96,6 +98,7 @@ enum ImwriteFlags {
        IMWRITE_TIFF_XDPI = 257,//!< For TIFF, use to specify the X direction DPI
        IMWRITE_TIFF_YDPI = 258, //!< For TIFF, use to specify the Y direction DPI
        IMWRITE_TIFF_COMPRESSION = 259, //!< For TIFF, use to specify the image compression scheme. See libtiff for integer constants corresponding to compression formats. Note, for images whose depth is CV_32F, only libtiff's SGILOG compression scheme is used. For other supported depths, the compression scheme can be specified by this flag; LZW compression is the default.
+       IMWRITE_TIFF_THREADS = 260, //!< For TIFF, number of threads compressing the strips of 8-bit and 16-bit images concurrently with the LZW, Deflate or PackBits schemes, a negative value means cv::getNumThreads(). Default is 0 - single-threaded. The file is the same as the single-threaded one.
        IMWRITE_JPEG2000_COMPRESSION_X1000 = 272 //!< For JPEG2000, use to specify the target compression rate (multiplied by 1000). The value can be from 0 to 1000. Default is 1000.
      };
 
@@ -176,6 +179,12 @@ Currently, the following file formats are supported:
     and thus the image will be rotated accordingly except if the flags @ref IMREAD_IGNORE_ORIENTATION
     or @ref IMREAD_UNCHANGED are passed.
 -   Use the IMREAD_UNCHANGED flag to keep the floating point values from PFM image.
+-   With @ref IMREAD_MMAP, binary 8-bit PGM (and 16-bit ones on big-endian machines), top-down
+    uncompressed BMP and uncompressed single-channel TIFF images stored in contiguous strips are mapped into
+    memory when the output has the type they are stored with. The returned matrix then refers to a private
+    copy-on-write mapping of the file, released with the last reference to it, so loading is nearly
+    instantaneous whatever the image size. Other images are decoded as usual. The bottom-up rows of regular
+    BMP and PFM images and the RGB order of PPM and color TIFF images don't match the Mat layout.
 -   By default number of pixels must be less than 2^30. Limit can be set using system
     variable OPENCV_IO_MAX_IMAGE_PIXELS
 
@@ -184,6 +193,23 @@ Currently, the following file formats are supported:
 */
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+/** @brief Loads a region of an image from a file.
+
+The function reads only the given region of the image that cv::imread would return with the same flags,
+i.e. the region is given in coordinates of the image after @ref IMREAD_REDUCED_GRAYSCALE_2 "IMREAD_REDUCED_*"
+reduction and EXIF orientation. It is clipped to the image bounds, an empty matrix is returned if it
+doesn't intersect the image.
+
+JPEG (when built with libjpeg-turbo), non-interlaced PNG and TIFF images are cropped while decoding,
+so the full image is never held in memory and the decoding stops after the last row of the region.
+Other formats are decoded completely and cropped afterwards.
+
+@param filename Name of file to be loaded.
+@param roi Region of the image to load.
+@param flags Flag that can take values of cv::ImreadModes
+*/
+CV_EXPORTS_W Mat imread( const String& filename, const Rect& roi, int flags = IMREAD_COLOR );
+
 /** @brief Loads a multi-page image from a file.
 
 The function imreadmulti loads a multi-page image from the specified file into a vector of Mat objects.
@@ -194,6 +220,21 @@ The function imreadmulti loads a multi-page image from the specified file into a
 */
 CV_EXPORTS_W bool imreadmulti(const String& filename, CV_OUT std::vector<Mat>& mats, int flags = IMREAD_ANYCOLOR);
 
+/** @brief Loads a range of pages of a multi-page image from a file.
+
+Pages before start are skipped without being decoded (TIFF images only), use cv::ImageCollection to access
+the pages one by one.
+@param filename Name of file to be loaded.
+@param mats A vector of Mat objects, the pages are appended to it.
+@param start Index of the first page to load.
+@param count Number of pages to load, the range is truncated at the last page. A negative value loads all
+the pages from start.
+@param flags Flag that can take values of cv::ImreadModes, default with cv::IMREAD_ANYCOLOR.
+@return true if at least one page has been loaded.
+@sa cv::imreadmulti
+*/
+CV_EXPORTS_W bool imreadmulti(const String& filename, CV_OUT std::vector<Mat>& mats, int start, int count, int flags = IMREAD_ANYCOLOR);
+
 /** @brief Saves an image to a specified file.
 
 The function imwrite saves the image to the specified file. The image format is chosen based on the
@@ -244,6 +285,66 @@ reallocations when the function is called repeatedly for images of the same size
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @brief Reads a region of an image from a buffer in memory.
+
+See cv::imread(const String&, const Rect&, int) for the region and cv::imdecode for the other details.
+
+@param buf Input array or vector of bytes.
+@param roi Region of the image to decode.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+*/
+CV_EXPORTS_W Mat imdecode( InputArray buf, const Rect& roi, int flags );
+
+/** @brief Reads a batch of images from buffers in memory.
+
+The buffers are decoded concurrently using the OpenCV parallel framework (see cv::parallel_for_). Unlike
+cv::imdecode, a buffer that can't be decoded doesn't interrupt the batch and doesn't throw: the corresponding
+output image is left empty and the reason is reported through the optional errors output. Only codecs able to
+decode directly from memory are used, no temporary files are created.
+
+@param bufs Input buffers, each one holds a complete compressed image (vector of bytes or 8-bit single row/column).
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param dst Output images, dst[i] is decoded from bufs[i]. Matrices that already have the decoded size and type
+are reused, so passing the same vector for batches of similar images saves reallocations.
+@param errors Optional output, errors[i] is empty if bufs[i] has been decoded and holds the error message otherwise.
+@return Number of successfully decoded images.
+*/
+CV_EXPORTS int imdecodeBatch( const std::vector<Mat>& bufs, int flags, std::vector<Mat>& dst,
+                              std::vector<String>* errors = NULL );
+
+/** @brief Image properties read from the header of an image file, see cv::imreadHeader.
+*/
+struct CV_EXPORTS ImageHeader
+{
+    ImageHeader() : depth(-1), channels(0), orientation(1), pages(0) {}
+
+    Size size;       //!< size of the (first page of the) image as stored, EXIF orientation is not applied
+    int depth;       //!< depth of the image cv::imread returns with @ref IMREAD_UNCHANGED
+    int channels;    //!< number of channels of the image cv::imread returns with @ref IMREAD_UNCHANGED
+    int orientation; //!< EXIF orientation, from 1 (top-left) to 8, 1 if the image has none
+    int pages;       //!< number of pages, more than 1 for multi-page images read by cv::imreadmulti
+};
+
+/** @brief Reads the properties of an image from its header, without decoding the pixels.
+
+The header is parsed by the same decoder cv::imread would use, so the function is as fast as reading the first bytes
+of the file (TIFF images also walk the chain of their pages).
+
+@param filename Name of the file.
+@param header Output image properties.
+@return false if the file can't be opened or has no supported format.
+*/
+CV_EXPORTS bool imreadHeader( const String& filename, ImageHeader& header );
+
+/** @brief Reads the properties of an image stored in a buffer in memory, without decoding the pixels.
+
+See cv::imreadHeader.
+
+@param buf Input array or vector of bytes.
+@param header Output image properties.
+*/
+CV_EXPORTS bool imdecodeHeader( InputArray buf, ImageHeader& header );
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -271,6 +372,208 @@ CV_EXPORTS_W bool haveImageReader( const String& filename );
 CV_EXPORTS_W bool haveImageWriter( const String& filename );
 
 
+/** @brief Reads an image from a file in bands of rows.
+
+The class gives the same image as cv::imread with the same flags, but lets the caller get it by horizontal
+bands, from top to bottom. Non-interlaced PNG, JPEG, TIFF (with top-left orientation) and PBM/PGM/PPM images
+are decoded incrementally, so only the current band is held in memory. Other formats, as well as images that
+need reduction (@ref IMREAD_REDUCED_GRAYSCALE_2 "IMREAD_REDUCED_*" flags for non-JPEG images) or EXIF
+orientation, are decoded completely on open() and then served by bands.
+
+@code
+    ImageReader reader("large.png", IMREAD_COLOR);
+    Mat band;
+    while (reader.read(band, 64))
+        process(band, reader.position() - band.rows);
+@endcode
+*/
+class CV_EXPORTS ImageReader
+{
+public:
+    /** @brief Default constructor, the reader is not opened. */
+    ImageReader();
+
+    /** @overload
+    @param filename Name of file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes
+    */
+    ImageReader(const String& filename, int flags = IMREAD_COLOR);
+
+    virtual ~ImageReader();
+
+    /** @brief Opens the image file and reads its header.
+
+    @param filename Name of file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes
+    @return true if the image can be read.
+    */
+    virtual bool open(const String& filename, int flags = IMREAD_COLOR);
+
+    /** @brief Returns true if the reader has been successfully opened. */
+    virtual bool isOpened() const;
+
+    /** @brief Closes the image file. */
+    virtual void release();
+
+    /** @brief Returns size of the image that is read. */
+    Size size() const;
+
+    /** @brief Returns type of the image that is read. */
+    int type() const;
+
+    /** @brief Returns index of the next row to read. */
+    int position() const;
+
+    /** @brief Reads the next band of rows.
+
+    @param band Output band, it has at most maxRows rows, the image width and type().
+    @param maxRows Maximum number of rows to read.
+    @return false if all rows have already been read or the image data is corrupted.
+    */
+    virtual bool read(OutputArray band, int maxRows);
+
+protected:
+    class Impl;
+    Ptr<Impl> p;
+};
+
+/** @brief Writes an image to a file in bands of rows.
+
+The image size and type are given to open(), then the image is passed to write() by horizontal bands, from
+top to bottom. The file is the same as the one cv::imwrite would write for the whole image with the same
+parameters. PNG, JPEG, TIFF and PBM/PGM/PPM images are encoded incrementally, so only the current band is held
+in memory. Other formats accumulate the bands and write the image after the last one.
+
+The file is complete once all the rows have been written, a file released before that is left truncated.
+*/
+class CV_EXPORTS ImageWriter
+{
+public:
+    /** @brief Default constructor, the writer is not opened. */
+    ImageWriter();
+
+    /** @overload
+    @param filename Name of the file, it defines the format.
+    @param size Size of the image.
+    @param type Type of the image, see cv::imwrite for the supported ones.
+    @param params Format-specific parameters. See cv::imwrite and cv::ImwriteFlags.
+    */
+    ImageWriter(const String& filename, Size size, int type,
+                const std::vector<int>& params = std::vector<int>());
+
+    virtual ~ImageWriter();
+
+    /** @brief Creates the image file.
+
+    @param filename Name of the file, it defines the format.
+    @param size Size of the image.
+    @param type Type of the image, see cv::imwrite for the supported ones.
+    @param params Format-specific parameters. See cv::imwrite and cv::ImwriteFlags.
+    @return true if the image can be written.
+    */
+    virtual bool open(const String& filename, Size size, int type,
+                      const std::vector<int>& params = std::vector<int>());
+
+    /** @brief Returns true if the writer has been successfully opened. */
+    virtual bool isOpened() const;
+
+    /** @brief Closes the image file. */
+    virtual void release();
+
+    /** @brief Returns index of the next row to write. */
+    int position() const;
+
+    /** @brief Writes the next band of rows.
+
+    @param band Band of rows with the image width and type, it must not go past the last image row.
+    @return false if the band can't be written.
+    */
+    virtual bool write(InputArray band);
+
+protected:
+    class Impl;
+    Ptr<Impl> p;
+};
+
+/** @brief Gives access to the pages of a multi-page image, decoding them on demand.
+
+Unlike cv::imreadmulti, only the page that is requested is decoded and nothing is kept in memory between the
+calls, so documents with hundreds of pages can be processed one page at a time. Pages of TIFF images are
+accessed in any order without decoding the others; other formats have a single page.
+
+@code
+    ImageCollection pages("scan.tiff", IMREAD_GRAYSCALE);
+    for (ImageCollection::iterator it = pages.begin(); it != pages.end(); ++it)
+        process(*it, it.index());
+@endcode
+*/
+class CV_EXPORTS ImageCollection
+{
+public:
+    /** @brief Forward iterator over the pages, dereferencing it decodes the page. */
+    class iterator
+    {
+    public:
+        iterator(ImageCollection* collection, int index) : collection_(collection), index_(index) {}
+        Mat operator*() const { return collection_->at(index_); }
+        iterator& operator++() { ++index_; return *this; }
+        bool operator==(const iterator& other) const { return collection_ == other.collection_ && index_ == other.index_; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+        /** @brief Returns index of the page the iterator points to. */
+        int index() const { return index_; }
+    private:
+        ImageCollection* collection_;
+        int index_;
+    };
+
+    /** @brief Default constructor, the collection is not opened. */
+    ImageCollection();
+
+    /** @overload
+    @param filename Name of file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes, applied to every page.
+    */
+    ImageCollection(const String& filename, int flags = IMREAD_ANYCOLOR);
+
+    virtual ~ImageCollection();
+
+    /** @brief Opens the image file and reads the header of its first page.
+
+    @param filename Name of file to be loaded.
+    @param flags Flag that can take values of cv::ImreadModes, applied to every page.
+    @return true if the image can be read.
+    */
+    virtual bool open(const String& filename, int flags = IMREAD_ANYCOLOR);
+
+    /** @brief Returns true if the collection has been successfully opened. */
+    virtual bool isOpened() const;
+
+    /** @brief Closes the image file. */
+    virtual void release();
+
+    /** @brief Returns number of pages. */
+    int size() const;
+
+    /** @brief Decodes the page with the given index.
+
+    @param index Index of the page, from 0 to size() - 1.
+    @param page Output image, the same as the one cv::imreadmulti returns for this page.
+    @return false if the index is out of range or the page can't be decoded.
+    */
+    virtual bool read(int index, OutputArray page);
+
+    /** @brief Returns the page with the given index, an empty matrix if it can't be decoded. */
+    Mat at(int index);
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+
+protected:
+    class Impl;
+    Ptr<Impl> p;
+};
+
+
 //! @} imgcodecs
 
 } // cv
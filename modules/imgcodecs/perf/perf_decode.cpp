@@ -0,0 +1,66 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test {
+
+// Many small images show the per-image overhead of the codecs (creation of the library state, tables and buffers)
+
+typedef tuple<string, Size> Ext_Size_t;
+typedef perf::TestBaseWithParam<Ext_Size_t> Ext_Size;
+
+static vector<uchar> encodeTestImage(const string& ext, const Size& size)
+{
+    Mat img(size, CV_8UC3, Scalar(40, 90, 160));
+    RNG rng(12345);
+    for (int i = 0; i < 20; i++)
+    {
+        Rect r(rng.uniform(0, size.width), rng.uniform(0, size.height), size.width / 4 + 1, size.height / 4 + 1);
+        img(r & Rect(Point(), size)).setTo(Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)));
+    }
+    vector<uchar> buf;
+    CV_Assert(imencode(ext, img, buf));
+    return buf;
+}
+
+#define IMGCODECS_PERF_EXTS testing::Values(".jpg", ".png", ".bmp")
+#define IMGCODECS_PERF_SIZES testing::Values(Size(32, 32), Size(128, 128), szQVGA)
+
+PERF_TEST_P(Ext_Size, imdecode_small, testing::Combine(IMGCODECS_PERF_EXTS, IMGCODECS_PERF_SIZES))
+{
+    const string ext = get<0>(GetParam());
+    const Size size = get<1>(GetParam());
+    const vector<uchar> buf = encodeTestImage(ext, size);
+    const int count = 100;
+    Mat img;
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < count; i++)
+            img = imdecode(buf, IMREAD_COLOR);
+    }
+
+    ASSERT_EQ(size, img.size());
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Ext_Size, imencode_small, testing::Combine(IMGCODECS_PERF_EXTS, IMGCODECS_PERF_SIZES))
+{
+    const string ext = get<0>(GetParam());
+    const Size size = get<1>(GetParam());
+    const Mat img = imdecode(encodeTestImage(ext, size), IMREAD_COLOR);
+    const int count = 100;
+    vector<uchar> buf;
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < count; i++)
+            imencode(ext, img, buf);
+    }
+
+    ASSERT_FALSE(buf.empty());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -7,4 +7,8 @@
 #include "opencv2/ts.hpp"
 #include "opencv2/imgcodecs.hpp"
 
+namespace opencv_test {
+using namespace perf;
+} // namespace
+
 #endif
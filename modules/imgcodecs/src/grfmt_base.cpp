@@ -89,11 +89,41 @@ int BaseImageDecoder::setScale( const int& scale_denom )
     return temp;
 }
 
+bool BaseImageDecoder::setROI( const Rect& )
+{
+    return false;
+}
+
+bool BaseImageDecoder::startReadRows( int )
+{
+    return false;
+}
+
+bool BaseImageDecoder::readRows( Mat& )
+{
+    return false;
+}
+
+bool BaseImageDecoder::getDataLayout( int, size_t&, size_t& ) const
+{
+    return false;
+}
+
 ImageDecoder BaseImageDecoder::newDecoder() const
 {
     return ImageDecoder();
 }
 
+void BaseImageDecoder::resetSource()
+{
+    m_filename = String();
+    m_buf.release();
+    m_width = m_height = 0;
+    m_type = -1;
+    m_scale_denom = 1;
+    m_roi = Rect();
+}
+
 BaseImageEncoder::BaseImageEncoder()
 {
     m_buf = 0;
@@ -132,6 +162,16 @@ bool BaseImageEncoder::writemulti(const std::vector<Mat>&, const std::vector<int
     return false;
 }
 
+bool BaseImageEncoder::startWriteRows( const Size&, int, const std::vector<int>& )
+{
+    return false;
+}
+
+bool BaseImageEncoder::writeRows( const Mat& )
+{
+    return false;
+}
+
 ImageEncoder BaseImageEncoder::newEncoder() const
 {
     return ImageEncoder();
@@ -68,21 +68,50 @@ public:
     virtual bool setSource( const String& filename );
     virtual bool setSource( const Mat& buf );
     virtual int setScale( const int& scale_denom );
+
+    /// Called after readHeader to request decoding of the given region only.
+    /// Returns false if the decoder can't crop natively; otherwise readData expects an image of roi.size().
+    virtual bool setROI( const Rect& roi );
+
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
 
+    /// Row-band decoding used by ImageReader instead of readData(). startReadRows() is called once after
+    /// readHeader() and setROI(); it returns false if the decoder can only decode the whole image.
+    virtual bool startReadRows( int type );
+    /// Decodes the next band.rows rows of the image (or of the region set by setROI()) into band.
+    virtual bool readRows( Mat& band );
+
+    /// Called after readHeader for IMREAD_MMAP. Returns true if the file stores the image uncompressed,
+    /// top to bottom, with the layout of a Mat of the given type: offset of the first row and step between rows.
+    virtual bool getDataLayout( int type, size_t& offset, size_t& step ) const;
+
     /// Called after readData to advance to the next page, if any.
     virtual bool nextPage() { return false; }
 
+    /// Number of pages of the image, called after readHeader.
+    virtual int pageCount() { return 1; }
+
+    /// Moves to the page with the given index (0-based) and reads its header, called after readHeader.
+    /// Returns false when the page doesn't exist or the decoder can't seek.
+    virtual bool setPage( int /*index*/ ) { return false; }
+
+    /// Returns the decoder to the state newDecoder() gives, keeping the resources that can serve the
+    /// next image (codec library state, scratch buffers). Returns false if the decoder can't be reused.
+    virtual bool reset() { return false; }
+
     virtual size_t signatureLength() const;
     virtual bool checkSignature( const String& signature ) const;
     virtual ImageDecoder newDecoder() const;
 
 protected:
+    void resetSource(); // forgets the source and the header of the previous image
+
     int  m_width;  // width  of the image ( filled by readHeader )
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
     int  m_scale_denom;
+    Rect m_roi;    // region to decode ( empty means the whole image, see setROI )
     String m_filename;
     String m_signature;
     Mat m_buf;
@@ -103,9 +132,18 @@ public:
     virtual bool write( const Mat& img, const std::vector<int>& params ) = 0;
     virtual bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params);
 
+    /// Row-band encoding used by ImageWriter instead of write(). startWriteRows() returns false if the
+    /// encoder can only write whole images; the image is complete after the last row passed to writeRows().
+    virtual bool startWriteRows( const Size& size, int type, const std::vector<int>& params );
+    virtual bool writeRows( const Mat& band );
+
     virtual String getDescription() const;
     virtual ImageEncoder newEncoder() const;
 
+    /// Returns the encoder to the state newEncoder() gives, keeping the resources that can serve the
+    /// next image. Returns false if the encoder can't be reused.
+    virtual bool reset() { return false; }
+
     virtual void throwOnEror() const;
 
 protected:
@@ -504,6 +504,29 @@ decode_rle8_bad: ;
 }
 
 
+bool BmpDecoder::getDataLayout( int type, size_t& offset, size_t& step ) const
+{
+    if( !m_buf.empty() || m_offset < 0 || m_origin != ORIGIN_TL || m_rle_code != BMP_RGB || type != m_type )
+        return false;
+
+    if( m_bpp == 8 )
+    {
+        // grayscale images are stored as is only when the palette is the identity
+        for( int i = 0; i < 256; i++ )
+        {
+            if( m_palette[i].b != i || m_palette[i].g != i || m_palette[i].r != i )
+                return false;
+        }
+    }
+    else if( m_bpp != 24 && m_bpp != 32 )
+        return false;
+
+    offset = (size_t)m_offset;
+    step = (size_t)(((m_width*m_bpp + 7)/8 + 3) & -4);
+    return true;
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 BmpEncoder::BmpEncoder()
@@ -61,6 +61,8 @@
 #include <ImfOutputFile.h>
 #include <ImfChannelList.h>
 #include <ImfStandardAttributes.h>
+#include <ImfIO.h>
+#include <Iex.h>
 #include <half.h>
 #include "grfmt_exr.hpp"
 
@@ -78,12 +80,75 @@
 namespace cv
 {
 
+/// Imf::IStream over a continuous memory buffer, exposed as memory mapped
+/// so that the library reads pixel data without intermediate copies
+class ExrMemIStream CV_FINAL : public Imf::IStream
+{
+public:
+    ExrMemIStream( const uchar* data, size_t size )
+        : Imf::IStream( "" ), m_data( (const char*)data ), m_size( (Imf::Int64)size ), m_pos( 0 ) {}
+
+    bool isMemoryMapped() const CV_OVERRIDE { return true; }
+
+    bool read( char c[], int n ) CV_OVERRIDE
+    {
+        if( n < 0 || (Imf::Int64)n > m_size - m_pos )
+            throw IEX_NAMESPACE::InputExc( "Unexpected end of memory buffer." );
+        memcpy( c, m_data + m_pos, n );
+        m_pos += n;
+        return m_pos < m_size;
+    }
+
+    char* readMemoryMapped( int n ) CV_OVERRIDE
+    {
+        if( n < 0 || (Imf::Int64)n > m_size - m_pos )
+            throw IEX_NAMESPACE::InputExc( "Unexpected end of memory buffer." );
+        char* ptr = const_cast<char*>( m_data + m_pos );
+        m_pos += n;
+        return ptr;
+    }
+
+    Imf::Int64 tellg() CV_OVERRIDE { return m_pos; }
+    void seekg( Imf::Int64 pos ) CV_OVERRIDE { m_pos = pos; }
+
+private:
+    const char* m_data;
+    Imf::Int64 m_size;
+    Imf::Int64 m_pos;
+};
+
+/// Imf::OStream appending to a std::vector<uchar>, seekable within written data
+class ExrVectorOStream CV_FINAL : public Imf::OStream
+{
+public:
+    explicit ExrVectorOStream( std::vector<uchar>& buf )
+        : Imf::OStream( "" ), m_buf( buf ), m_pos( 0 ) {}
+
+    void write( const char c[], int n ) CV_OVERRIDE
+    {
+        size_t end = m_pos + (size_t)n;
+        if( end > m_buf.size() )
+            m_buf.resize( end );
+        memcpy( &m_buf[0] + m_pos, c, n );
+        m_pos = end;
+    }
+
+    Imf::Int64 tellp() CV_OVERRIDE { return m_pos; }
+    void seekp( Imf::Int64 pos ) CV_OVERRIDE { m_pos = (size_t)pos; }
+
+private:
+    std::vector<uchar>& m_buf;
+    size_t m_pos;
+};
+
 /////////////////////// ExrDecoder ///////////////////
 
 ExrDecoder::ExrDecoder()
 {
     m_signature = "\x76\x2f\x31\x01";
     m_file = 0;
+    m_stream = 0;
+    m_buf_supported = true;
     m_red = m_green = m_blue = 0;
     m_type = ((Imf::PixelType)0);
     m_iscolor = false;
@@ -108,6 +173,11 @@ void  ExrDecoder::close()
         delete m_file;
         m_file = 0;
     }
+    if( m_stream )
+    {
+        delete m_stream;
+        m_stream = 0;
+    }
 }
 
 
@@ -121,7 +191,15 @@ bool  ExrDecoder::readHeader()
 {
     bool result = false;
 
-    m_file = new InputFile( m_filename.c_str() );
+    close();
+    if( !m_buf.empty() )
+    {
+        CV_Assert( m_buf.isContinuous() );
+        m_stream = new ExrMemIStream( m_buf.ptr(), m_buf.total() * m_buf.elemSize() );
+        m_file = new InputFile( *m_stream );
+    }
+    else
+        m_file = new InputFile( m_filename.c_str() );
 
     if( !m_file ) // probably paranoid
         return false;
@@ -551,6 +629,7 @@ ImageDecoder ExrDecoder::newDecoder() const
 ExrEncoder::ExrEncoder()
 {
     m_description = "OpenEXR Image files (*.exr)";
+    m_buf_supported = true;
 }
 
 
@@ -607,7 +686,16 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
         //printf("gray\n");
     }
 
-    OutputFile file( m_filename.c_str(), header );
+    // the stream has to outlive the file, which flushes its offset tables on destruction
+    Ptr<ExrVectorOStream> stream;
+    Ptr<OutputFile> file;
+    if( m_buf )
+    {
+        stream.reset( new ExrVectorOStream( *m_buf ) );
+        file.reset( new OutputFile( *stream, header ) );
+    }
+    else
+        file.reset( new OutputFile( m_filename.c_str(), header ) );
 
     FrameBuffer frame;
 
@@ -638,12 +726,12 @@ bool  ExrEncoder::write( const Mat& img, const std::vector<int>& params )
     else
         frame.insert( "Y", Slice( type, buffer, size, bufferstep ));
 
-    file.setFrameBuffer( frame );
+    file->setFrameBuffer( frame );
 
     result = true;
     try
     {
-        file.writePixels( height );
+        file->writePixels( height );
     }
     catch(...)
     {
@@ -85,6 +85,7 @@ protected:
     void  RGBToGray( float *in, float *out );
 
     InputFile      *m_file;
+    Imf::IStream   *m_stream;
     Imf::PixelType  m_type;
     Box2i           m_datawindow;
     bool            m_ischroma;
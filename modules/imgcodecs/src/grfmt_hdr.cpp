@@ -42,7 +42,6 @@
 
 #include "precomp.hpp"
 #include "grfmt_hdr.hpp"
-#include "rgbe.hpp"
 
 #ifdef HAVE_IMGCODEC_HDR
 
@@ -54,11 +53,23 @@ HdrDecoder::HdrDecoder()
     m_signature = "#?RGBE";
     m_signature_alt = "#?RADIANCE";
     file = NULL;
+    m_stream_opened = false;
     m_type = CV_32FC3;
+    m_buf_supported = true;
 }
 
 HdrDecoder::~HdrDecoder()
 {
+    close();
+}
+
+void HdrDecoder::close()
+{
+    if(file) {
+        fclose(file);
+        file = NULL;
+    }
+    m_stream_opened = false;
 }
 
 size_t HdrDecoder::signatureLength() const
@@ -69,14 +80,21 @@ size_t HdrDecoder::signatureLength() const
 
 bool  HdrDecoder::readHeader()
 {
-    file = fopen(m_filename.c_str(), "rb");
-    if(!file) {
-        return false;
+    close();
+    if(!m_buf.empty()) {
+        CV_Assert(m_buf.isContinuous());
+        RGBE_OpenMemoryReader(&m_stream, m_buf.ptr(), m_buf.total() * m_buf.elemSize());
+    } else {
+        file = fopen(m_filename.c_str(), "rb");
+        if(!file) {
+            return false;
+        }
+        RGBE_OpenFile(&m_stream, file);
     }
-    RGBE_ReadHeader(file, &m_width, &m_height, NULL);
+    m_stream_opened = true;
+    RGBE_ReadHeader(&m_stream, &m_width, &m_height, NULL);
     if(m_width <= 0 || m_height <= 0) {
-        fclose(file);
-        file = NULL;
+        close();
         return false;
     }
     return true;
@@ -85,13 +103,13 @@ bool  HdrDecoder::readHeader()
 bool HdrDecoder::readData(Mat& _img)
 {
     Mat img(m_height, m_width, CV_32FC3);
-    if(!file) {
+    if(!m_stream_opened) {
         if(!readHeader()) {
             return false;
         }
     }
-    RGBE_ReadPixels_RLE(file, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
-    fclose(file); file = NULL;
+    RGBE_ReadPixels_RLE(&m_stream, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
+    close();
 
     if(_img.depth() == img.depth()) {
         img.convertTo(_img, _img.type());
@@ -122,6 +140,7 @@ ImageDecoder HdrDecoder::newDecoder() const
 HdrEncoder::HdrEncoder()
 {
     m_description = "Radiance HDR (*.hdr;*.pic)";
+    m_buf_supported = true;
 }
 
 HdrEncoder::~HdrEncoder()
@@ -142,19 +161,28 @@ bool HdrEncoder::write( const Mat& input_img, const std::vector<int>& params )
         img.convertTo(img, CV_32FC3, 1/255.0f);
     }
     CV_Assert(params.empty() || params[0] == HDR_NONE || params[0] == HDR_RLE);
-    FILE *fout = fopen(m_filename.c_str(), "wb");
-    if(!fout) {
-        return false;
+    FILE *fout = NULL;
+    rgbe_stream stream;
+    if(m_buf) {
+        RGBE_OpenMemoryWriter(&stream, m_buf);
+    } else {
+        fout = fopen(m_filename.c_str(), "wb");
+        if(!fout) {
+            return false;
+        }
+        RGBE_OpenFile(&stream, fout);
     }
 
-    RGBE_WriteHeader(fout, img.cols, img.rows, NULL);
+    RGBE_WriteHeader(&stream, img.cols, img.rows, NULL);
     if(params.empty() || params[0] == HDR_RLE) {
-        RGBE_WritePixels_RLE(fout, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
+        RGBE_WritePixels_RLE(&stream, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
     } else {
-        RGBE_WritePixels(fout, const_cast<float*>(img.ptr<float>()), img.cols * img.rows);
+        RGBE_WritePixels(&stream, const_cast<float*>(img.ptr<float>()), img.cols * img.rows);
     }
 
-    fclose(fout);
+    if(fout) {
+        fclose(fout);
+    }
     return true;
 }
 
@@ -44,6 +44,7 @@
 #define _GRFMT_HDR_H_
 
 #include "grfmt_base.hpp"
+#include "rgbe.hpp"
 
 #ifdef HAVE_IMGCODEC_HDR
 
@@ -68,8 +69,12 @@ public:
     ImageDecoder newDecoder() const CV_OVERRIDE;
     size_t signatureLength() const CV_OVERRIDE;
 protected:
+    void close();
+
     String m_signature_alt;
     FILE *file;
+    rgbe_stream m_stream;
+    bool m_stream_opened;
 };
 
 // ... writer
@@ -75,6 +75,11 @@ extern "C" {
 #include "jpeglib.h"
 }
 
+// jpeg_crop_scanline() and jpeg_skip_scanlines() are libjpeg-turbo extensions (since 1.5)
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+#define HAVE_JPEG_CROP 1
+#endif
+
 namespace cv
 {
 
@@ -95,6 +100,10 @@ struct JpegState
     jpeg_decompress_struct cinfo; // IJG JPEG codec structure
     JpegErrorMgr jerr; // error processing manager state
     JpegSource source; // memory buffer source
+    jpeg_source_mgr* file_source; // stdio source, allocated by the library for the first file
+    JSAMPARRAY buffer; // decoded scanline
+    int xoffset; // first column of the image (region) in the scanline
+    int rows_left; // rows to decode by readRows
 };
 
 /////////////////////// Error processing /////////////////////
@@ -199,6 +208,29 @@ void  JpegDecoder::close()
     m_type = -1;
 }
 
+// Ends decoding of the current image, the decompressor is kept for the next one
+void  JpegDecoder::closeImage()
+{
+    if( m_state )
+        jpeg_abort_decompress( &((JpegState*)m_state)->cinfo );
+
+    if( m_f )
+    {
+        fclose( m_f );
+        m_f = 0;
+    }
+
+    m_width = m_height = 0;
+    m_type = -1;
+}
+
+bool  JpegDecoder::reset()
+{
+    closeImage();
+    resetSource();
+    return true;
+}
+
 ImageDecoder JpegDecoder::newDecoder() const
 {
     return makePtr<JpegDecoder>();
@@ -207,31 +239,58 @@ ImageDecoder JpegDecoder::newDecoder() const
 bool  JpegDecoder::readHeader()
 {
     volatile bool result = false;
-    close();
+    closeImage();
 
-    JpegState* state = new JpegState;
-    m_state = state;
-    state->cinfo.err = jpeg_std_error(&state->jerr.pub);
-    state->jerr.pub.error_exit = error_exit;
+    JpegState* state = (JpegState*)m_state;
+    bool reused = state != 0;
+    if( reused )
+    {
+        // tables of the previous image stay in the decompressor, empty the Huffman tables
+        // so that MJPEG frames which don't have them are still detected in startReadRows()
+        for( int i = 0; i < NUM_HUFF_TBLS; i++ )
+        {
+            if( state->cinfo.ac_huff_tbl_ptrs[i] )
+                memset( state->cinfo.ac_huff_tbl_ptrs[i]->bits, 0, sizeof(state->cinfo.ac_huff_tbl_ptrs[i]->bits) );
+            if( state->cinfo.dc_huff_tbl_ptrs[i] )
+                memset( state->cinfo.dc_huff_tbl_ptrs[i]->bits, 0, sizeof(state->cinfo.dc_huff_tbl_ptrs[i]->bits) );
+        }
+    }
+    else
+    {
+        state = new JpegState;
+        m_state = state;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+        state->file_source = 0;
+    }
 
     if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        jpeg_create_decompress( &state->cinfo );
+        if( !reused )
+            jpeg_create_decompress( &state->cinfo );
 
+        bool opened = false;
         if( !m_buf.empty() )
         {
             jpeg_buffer_src(&state->cinfo, &state->source);
             state->source.pub.next_input_byte = m_buf.ptr();
             state->source.pub.bytes_in_buffer = m_buf.cols*m_buf.rows*m_buf.elemSize();
+            opened = true;
         }
         else
         {
             m_f = fopen( m_filename.c_str(), "rb" );
             if( m_f )
+            {
+                // the library refuses to replace a source of another kind by its stdio one
+                state->cinfo.src = state->file_source;
                 jpeg_stdio_src( &state->cinfo, m_f );
+                state->file_source = state->cinfo.src;
+                opened = true;
+            }
         }
 
-        if (state->cinfo.src != 0)
+        if( opened )
         {
             jpeg_read_header( &state->cinfo, TRUE );
 
@@ -319,6 +378,18 @@ unsigned char my_jpeg_odml_dht[0x1a4] = {
     0xf9, 0xfa
 };
 
+/* missing table, or emptied by JpegDecoder::readHeader() when the decompressor is reused */
+static
+bool my_jpeg_huff_tbl_empty (const JHUFF_TBL* table)
+{
+    if (table == NULL)
+        return true;
+    for (int i = 1; i <= 16; ++i)
+        if (table->bits[i] != 0)
+            return false;
+    return true;
+}
+
 /*
  * Parse the DHT table.
  * This code comes from jpeg6b (jdmarker.c).
@@ -386,25 +457,42 @@ int my_jpeg_load_dht (struct jpeg_decompress_struct *info, unsigned char *dht,
  * based on a message of Laurent Pinchart on the video4linux mailing list
  ***************************************************************************/
 
+bool  JpegDecoder::setROI( const Rect& roi )
+{
+#ifdef HAVE_JPEG_CROP
+    m_roi = roi;
+    return true;
+#else
+    CV_UNUSED(roi);
+    return false;
+#endif
+}
+
 bool  JpegDecoder::readData( Mat& img )
+{
+    bool result = startReadRows( img.type() ) && readRows( img );
+    closeImage();
+    return result;
+}
+
+bool  JpegDecoder::startReadRows( int type )
 {
     volatile bool result = false;
-    size_t step = img.step;
-    bool color = img.channels() > 1;
+    bool color = CV_MAT_CN(type) > 1;
 
     if( m_state && m_width && m_height )
     {
-        jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
-        JpegErrorMgr* jerr = &((JpegState*)m_state)->jerr;
-        JSAMPARRAY buffer = 0;
+        JpegState* state = (JpegState*)m_state;
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+        JpegErrorMgr* jerr = &state->jerr;
 
         if( setjmp( jerr->setjmp_buffer ) == 0 )
         {
             /* check if this is a mjpeg image format */
-            if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
-                cinfo->ac_huff_tbl_ptrs[1] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[0] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[1] == NULL )
+            if ( my_jpeg_huff_tbl_empty(cinfo->ac_huff_tbl_ptrs[0]) &&
+                my_jpeg_huff_tbl_empty(cinfo->ac_huff_tbl_ptrs[1]) &&
+                my_jpeg_huff_tbl_empty(cinfo->dc_huff_tbl_ptrs[0]) &&
+                my_jpeg_huff_tbl_empty(cinfo->dc_huff_tbl_ptrs[1]) )
             {
                 /* yes, this is a mjpeg image format, so load the correct
                 huffman table */
@@ -443,35 +531,84 @@ bool  JpegDecoder::readData( Mat& img )
 
             jpeg_start_decompress( cinfo );
 
-            buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+            state->xoffset = 0;
+            state->rows_left = m_height;
+#ifdef HAVE_JPEG_CROP
+            if( !m_roi.empty() )
+            {
+                // the library widens the crop to the iMCU boundary on the left, and the chroma
+                // upsampling replicates the edge columns of the crop, so keep one column margin
+                int x0 = std::max(m_roi.x - 1, 0), x1 = std::min(m_roi.x + m_roi.width + 1, m_width);
+                JDIMENSION crop_x = x0, crop_width = x1 - x0;
+                jpeg_crop_scanline( cinfo, &crop_x, &crop_width );
+                if( m_roi.y > 0 )
+                    jpeg_skip_scanlines( cinfo, m_roi.y );
+                state->xoffset = m_roi.x - (int)crop_x;
+                state->rows_left = m_roi.height;
+            }
+#endif
+
+            state->buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
                                               JPOOL_IMAGE, m_width*4, 1 );
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
+    return result;
+}
 
-            uchar* data = img.ptr();
-            for( ; m_height--; data += step )
+bool  JpegDecoder::readRows( Mat& band )
+{
+    volatile bool result = false;
+    bool color = band.channels() > 1;
+    int width = band.cols;
+
+    if( m_state && band.rows <= ((JpegState*)m_state)->rows_left )
+    {
+        JpegState* state = (JpegState*)m_state;
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+        JpegErrorMgr* jerr = &state->jerr;
+
+        if( setjmp( jerr->setjmp_buffer ) == 0 )
+        {
+            for( int y = 0; y < band.rows; y++ )
             {
-                jpeg_read_scanlines( cinfo, buffer, 1 );
+                uchar* data = band.ptr(y);
+                jpeg_read_scanlines( cinfo, state->buffer, 1 );
+                const uchar* src = state->buffer[0] + state->xoffset*cinfo->out_color_components;
                 if( color )
                 {
                     if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, Size(m_width,1) );
+                        icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, Size(width,1) );
                     else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, Size(m_width,1) );
+                        icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, Size(width,1) );
                 }
                 else
                 {
                     if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
+                        memcpy( data, src, width );
                     else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, Size(m_width,1) );
+                        icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, Size(width,1) );
                 }
             }
 
+            state->rows_left -= band.rows;
+            if( state->rows_left == 0 )
+            {
+                // the remaining scanlines of a cropped image are not needed
+                if( m_roi.empty() )
+                    jpeg_finish_decompress( cinfo );
+                else
+                    jpeg_abort_decompress( cinfo );
+            }
             result = true;
-            jpeg_finish_decompress( cinfo );
         }
     }
 
-    close();
+    if( !result )
+        close();
     return result;
 }
 
@@ -528,11 +665,13 @@ JpegEncoder::JpegEncoder()
 {
     m_description = "JPEG files (*.jpeg;*.jpg;*.jpe)";
     m_buf_supported = true;
+    m_state = 0;
 }
 
 
 JpegEncoder::~JpegEncoder()
 {
+    close();
 }
 
 ImageEncoder JpegEncoder::newEncoder() const
@@ -540,182 +679,286 @@ ImageEncoder JpegEncoder::newEncoder() const
     return makePtr<JpegEncoder>();
 }
 
-bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+struct JpegEncoderState
 {
-    m_last_error.clear();
+    jpeg_compress_struct cinfo; // IJG JPEG codec structure
+    JpegErrorMgr jerr; // error processing manager state
+    JpegDestination dest; // memory buffer destination
+    jpeg_destination_mgr* file_dest; // stdio destination, allocated by the library for the first file
+    JHUFF_TBL std_huff_tbls[4]; // standard DC and AC tables, optimized coding overwrites them in cinfo
+    bool reused; // cinfo has already compressed an image
+    std::vector<uchar> out_buf;
+    AutoBuffer<uchar> buffer; // converted scanline
+    FILE* f;
+    int channels; // channels of the written image
+    int rows_left; // rows to write by writeRows
+};
 
-    struct fileWrapper
+void JpegEncoder::close()
+{
+    if( m_state )
     {
-        FILE* f;
+        JpegEncoderState* state = (JpegEncoderState*)m_state;
+        jpeg_destroy_compress( &state->cinfo );
+        if( state->f )
+            fclose( state->f );
+        delete state;
+        m_state = 0;
+    }
+}
 
-        fileWrapper() : f(0) {}
-        ~fileWrapper() { if(f) fclose(f); }
-    };
-    volatile bool result = false;
-    fileWrapper fw;
-    int width = img.cols, height = img.rows;
+// Ends the current image, the compressor is kept for the next one
+void JpegEncoder::closeImage()
+{
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( state )
+    {
+        jpeg_abort_compress( &state->cinfo );
+        if( state->f )
+        {
+            fclose( state->f );
+            state->f = 0;
+        }
+    }
+}
 
-    std::vector<uchar> out_buf(1 << 12);
-    AutoBuffer<uchar> _buffer;
-    uchar* buffer;
+bool JpegEncoder::reset()
+{
+    closeImage();
+    m_filename = String();
+    m_buf = 0;
+    m_last_error.clear();
+    return true;
+}
 
-    struct jpeg_compress_struct cinfo;
-    JpegErrorMgr jerr;
-    JpegDestination dest;
+void JpegEncoder::closeWithError()
+{
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( state )
+    {
+        char jmsg_buf[JMSG_LENGTH_MAX];
+        state->jerr.pub.format_message((j_common_ptr)&state->cinfo, jmsg_buf);
+        m_last_error = jmsg_buf;
+    }
+    close();
+}
+
+bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    return startWriteRows( img.size(), img.type(), params ) && writeRows( img );
+}
 
-    jpeg_create_compress(&cinfo);
-    cinfo.err = jpeg_std_error(&jerr.pub);
-    jerr.pub.error_exit = error_exit;
+bool JpegEncoder::startWriteRows( const Size& size, int type, const std::vector<int>& params )
+{
+    m_last_error.clear();
+    closeImage();
+
+    volatile bool result = false;
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( !state )
+    {
+        state = new JpegEncoderState;
+        m_state = state;
+        state->f = 0;
+        state->file_dest = 0;
+        state->reused = false;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+        jpeg_create_compress(&state->cinfo);
+    }
+    jpeg_compress_struct& cinfo = state->cinfo;
 
+    bool opened = true;
     if( !m_buf )
     {
-        fw.f = fopen( m_filename.c_str(), "wb" );
-        if( !fw.f )
-            goto _exit_;
-        jpeg_stdio_dest( &cinfo, fw.f );
+        state->f = fopen( m_filename.c_str(), "wb" );
+        if( state->f )
+        {
+            // the library refuses to replace a destination of another kind by its stdio one
+            cinfo.dest = state->file_dest;
+            jpeg_stdio_dest( &cinfo, state->f );
+            state->file_dest = cinfo.dest;
+        }
+        else
+            opened = false;
     }
     else
     {
+        JpegDestination& dest = state->dest;
+        state->out_buf.resize(1 << 12);
         dest.dst = m_buf;
-        dest.buf = &out_buf;
+        dest.buf = &state->out_buf;
 
         jpeg_buffer_dest( &cinfo, &dest );
 
-        dest.pub.next_output_byte = &out_buf[0];
-        dest.pub.free_in_buffer = out_buf.size();
+        dest.pub.next_output_byte = &state->out_buf[0];
+        dest.pub.free_in_buffer = state->out_buf.size();
     }
 
-    if( setjmp( jerr.setjmp_buffer ) == 0 )
+    if( opened )
     {
-        cinfo.image_width = width;
-        cinfo.image_height = height;
-
-        int _channels = img.channels();
-        int channels = _channels > 1 ? 3 : 1;
-        cinfo.input_components = channels;
-        cinfo.in_color_space = channels > 1 ? JCS_RGB : JCS_GRAYSCALE;
-
-        int quality = 95;
-        int progressive = 0;
-        int optimize = 0;
-        int rst_interval = 0;
-        int luma_quality = -1;
-        int chroma_quality = -1;
-
-        for( size_t i = 0; i < params.size(); i += 2 )
+        if( setjmp( state->jerr.setjmp_buffer ) == 0 )
         {
-            if( params[i] == CV_IMWRITE_JPEG_QUALITY )
+            cinfo.image_width = size.width;
+            cinfo.image_height = size.height;
+
+            int _channels = CV_MAT_CN(type);
+            int channels = _channels > 1 ? 3 : 1;
+            cinfo.input_components = channels;
+            cinfo.in_color_space = channels > 1 ? JCS_RGB : JCS_GRAYSCALE;
+
+            int quality = 95;
+            int progressive = 0;
+            int optimize = 0;
+            int rst_interval = 0;
+            int luma_quality = -1;
+            int chroma_quality = -1;
+
+            for( size_t i = 0; i < params.size(); i += 2 )
             {
-                quality = params[i+1];
-                quality = MIN(MAX(quality, 0), 100);
-            }
+                if( params[i] == CV_IMWRITE_JPEG_QUALITY )
+                {
+                    quality = params[i+1];
+                    quality = MIN(MAX(quality, 0), 100);
+                }
 
-            if( params[i] == CV_IMWRITE_JPEG_PROGRESSIVE )
-            {
-                progressive = params[i+1];
-            }
+                if( params[i] == CV_IMWRITE_JPEG_PROGRESSIVE )
+                {
+                    progressive = params[i+1];
+                }
 
-            if( params[i] == CV_IMWRITE_JPEG_OPTIMIZE )
-            {
-                optimize = params[i+1];
-            }
+                if( params[i] == CV_IMWRITE_JPEG_OPTIMIZE )
+                {
+                    optimize = params[i+1];
+                }
 
-            if( params[i] == CV_IMWRITE_JPEG_LUMA_QUALITY )
-            {
-                if (params[i+1] >= 0)
+                if( params[i] == CV_IMWRITE_JPEG_LUMA_QUALITY )
                 {
-                    luma_quality = MIN(MAX(params[i+1], 0), 100);
+                    if (params[i+1] >= 0)
+                    {
+                        luma_quality = MIN(MAX(params[i+1], 0), 100);
 
-                    quality = luma_quality;
+                        quality = luma_quality;
 
-                    if (chroma_quality < 0)
+                        if (chroma_quality < 0)
+                        {
+                            chroma_quality = luma_quality;
+                        }
+                    }
+                }
+
+                if( params[i] == CV_IMWRITE_JPEG_CHROMA_QUALITY )
+                {
+                    if (params[i+1] >= 0)
                     {
-                        chroma_quality = luma_quality;
+                        chroma_quality = MIN(MAX(params[i+1], 0), 100);
                     }
                 }
-            }
 
-            if( params[i] == CV_IMWRITE_JPEG_CHROMA_QUALITY )
-            {
-                if (params[i+1] >= 0)
+                if( params[i] == CV_IMWRITE_JPEG_RST_INTERVAL )
                 {
-                    chroma_quality = MIN(MAX(params[i+1], 0), 100);
+                    rst_interval = params[i+1];
+                    rst_interval = MIN(MAX(rst_interval, 0), 65535L);
                 }
             }
 
-            if( params[i] == CV_IMWRITE_JPEG_RST_INTERVAL )
+            jpeg_set_defaults( &cinfo );
+
+            // jpeg_set_defaults() doesn't replace the Huffman tables which are already there, so
+            // restore the standard ones that the previous image might have optimized
+            JHUFF_TBL** huff_tbls[] = { &cinfo.dc_huff_tbl_ptrs[0], &cinfo.dc_huff_tbl_ptrs[1],
+                                        &cinfo.ac_huff_tbl_ptrs[0], &cinfo.ac_huff_tbl_ptrs[1] };
+            for( int i = 0; i < 4; i++ )
             {
-                rst_interval = params[i+1];
-                rst_interval = MIN(MAX(rst_interval, 0), 65535L);
+                if( !state->reused )
+                    state->std_huff_tbls[i] = **huff_tbls[i];
+                else
+                    **huff_tbls[i] = state->std_huff_tbls[i];
             }
-        }
-
-        jpeg_set_defaults( &cinfo );
-        cinfo.restart_interval = rst_interval;
+            state->reused = true;
+            cinfo.restart_interval = rst_interval;
 
-        jpeg_set_quality( &cinfo, quality,
-                          TRUE /* limit to baseline-JPEG values */ );
-        if( progressive )
-            jpeg_simple_progression( &cinfo );
-        if( optimize )
-            cinfo.optimize_coding = TRUE;
+            jpeg_set_quality( &cinfo, quality,
+                              TRUE /* limit to baseline-JPEG values */ );
+            if( progressive )
+                jpeg_simple_progression( &cinfo );
+            if( optimize )
+                cinfo.optimize_coding = TRUE;
 
 #if JPEG_LIB_VERSION >= 70
-        if (luma_quality >= 0 && chroma_quality >= 0)
-        {
-            cinfo.q_scale_factor[0] = jpeg_quality_scaling(luma_quality);
-            cinfo.q_scale_factor[1] = jpeg_quality_scaling(chroma_quality);
-            if ( luma_quality != chroma_quality )
+            if (luma_quality >= 0 && chroma_quality >= 0)
             {
-                /* disable subsampling - ref. Libjpeg.txt */
-                cinfo.comp_info[0].v_samp_factor = 1;
-                cinfo.comp_info[0].h_samp_factor = 1;
-                cinfo.comp_info[1].v_samp_factor = 1;
-                cinfo.comp_info[1].h_samp_factor = 1;
+                cinfo.q_scale_factor[0] = jpeg_quality_scaling(luma_quality);
+                cinfo.q_scale_factor[1] = jpeg_quality_scaling(chroma_quality);
+                if ( luma_quality != chroma_quality )
+                {
+                    /* disable subsampling - ref. Libjpeg.txt */
+                    cinfo.comp_info[0].v_samp_factor = 1;
+                    cinfo.comp_info[0].h_samp_factor = 1;
+                    cinfo.comp_info[1].v_samp_factor = 1;
+                    cinfo.comp_info[1].h_samp_factor = 1;
+                }
+                jpeg_default_qtables( &cinfo, TRUE );
             }
-            jpeg_default_qtables( &cinfo, TRUE );
-        }
 #endif // #if JPEG_LIB_VERSION >= 70
 
-        jpeg_start_compress( &cinfo, TRUE );
+            jpeg_start_compress( &cinfo, TRUE );
 
-        if( channels > 1 )
-            _buffer.allocate(width*channels);
-        buffer = _buffer.data();
+            state->channels = _channels;
+            if( channels > 1 )
+                state->buffer.allocate(size.width*channels);
+            state->rows_left = size.height;
+            result = true;
+        }
+    }
 
-        for( int y = 0; y < height; y++ )
-        {
-            uchar *data = img.data + img.step*y, *ptr = data;
+    if( !result )
+        closeWithError();
+    return result;
+}
 
-            if( _channels == 3 )
+bool JpegEncoder::writeRows( const Mat& band )
+{
+    volatile bool result = false;
+    int width = band.cols;
+
+    if( m_state && band.rows <= ((JpegEncoderState*)m_state)->rows_left )
+    {
+        JpegEncoderState* state = (JpegEncoderState*)m_state;
+        uchar* buffer = state->buffer.data();
+
+        if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+        {
+            for( int y = 0; y < band.rows; y++ )
             {
-                icvCvt_BGR2RGB_8u_C3R( data, 0, buffer, 0, Size(width,1) );
-                ptr = buffer;
+                uchar *data = (uchar*)band.ptr(y), *ptr = data;
+
+                if( state->channels == 3 )
+                {
+                    icvCvt_BGR2RGB_8u_C3R( data, 0, buffer, 0, Size(width,1) );
+                    ptr = buffer;
+                }
+                else if( state->channels == 4 )
+                {
+                    icvCvt_BGRA2BGR_8u_C4C3R( data, 0, buffer, 0, Size(width,1), 2 );
+                    ptr = buffer;
+                }
+
+                jpeg_write_scanlines( &state->cinfo, &ptr, 1 );
             }
-            else if( _channels == 4 )
+
+            state->rows_left -= band.rows;
+            if( state->rows_left == 0 )
             {
-                icvCvt_BGRA2BGR_8u_C4C3R( data, 0, buffer, 0, Size(width,1), 2 );
-                ptr = buffer;
+                jpeg_finish_compress( &state->cinfo );
+                closeImage();
             }
-
-            jpeg_write_scanlines( &cinfo, &ptr, 1 );
+            result = true;
         }
-
-        jpeg_finish_compress( &cinfo );
-        result = true;
-    }
-
-_exit_:
-
-    if(!result)
-    {
-        char jmsg_buf[JMSG_LENGTH_MAX];
-        jerr.pub.format_message((j_common_ptr)&cinfo, jmsg_buf);
-        m_last_error = jmsg_buf;
     }
 
-    jpeg_destroy_compress( &cinfo );
-
+    if( !result )
+        closeWithError();
     return result;
 }
 
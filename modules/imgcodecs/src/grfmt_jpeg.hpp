@@ -62,11 +62,17 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
+    bool  reset() CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
 
 protected:
+    void  closeImage();
+
 
     FILE* m_f;
     void* m_state;
@@ -84,7 +90,22 @@ public:
     virtual ~JpegEncoder();
 
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( const Size& size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    bool  reset() CV_OVERRIDE;
+    void  close();
+
     ImageEncoder newEncoder() const CV_OVERRIDE;
+
+protected:
+    void  closeWithError();
+    void  closeImage();
+
+    void* m_state;
+
+private:
+    JpegEncoder(const JpegEncoder &); // copy disabled
+    JpegEncoder& operator=(const JpegEncoder &); // assign disabled
 };
 
 }
@@ -114,6 +114,7 @@ Jpeg2KDecoder::Jpeg2KDecoder()
     m_signature = String((const char*)signature_, (const char*)signature_ + sizeof(signature_));
     m_stream = 0;
     m_image = 0;
+    m_buf_supported = true;
 }
 
 
@@ -151,7 +152,15 @@ bool  Jpeg2KDecoder::readHeader()
     bool result = false;
 
     close();
-    jas_stream_t* stream = jas_stream_fopen( m_filename.c_str(), "rb" );
+    jas_stream_t* stream = 0;
+    if( !m_buf.empty() )
+    {
+        CV_Assert( m_buf.isContinuous() );
+        // read-only use of the caller's buffer, jasper doesn't take ownership
+        stream = jas_stream_memopen( (char*)m_buf.ptr(), validateToInt(m_buf.total() * m_buf.elemSize()) );
+    }
+    else
+        stream = jas_stream_fopen( m_filename.c_str(), "rb" );
     m_stream = stream;
 
     if( stream )
@@ -492,6 +501,7 @@ bool  Jpeg2KDecoder::readComponent16u( unsigned short *data, void *_buffer,
 Jpeg2KEncoder::Jpeg2KEncoder()
 {
     m_description = "JPEG-2000 files (*.jp2)";
+    m_buf_supported = true;
 }
 
 
@@ -565,7 +575,8 @@ bool  Jpeg2KEncoder::write( const Mat& _img, const std::vector<int>& params )
         result = writeComponent16u( img, _img );
     if( result )
     {
-        jas_stream_t *stream = jas_stream_fopen( m_filename.c_str(), "wb" );
+        // a growable memory stream is used when encoding into a buffer
+        jas_stream_t *stream = m_buf ? jas_stream_memopen( 0, 0 ) : jas_stream_fopen( m_filename.c_str(), "wb" );
         if( stream )
         {
             std::stringstream options;
@@ -573,6 +584,14 @@ bool  Jpeg2KEncoder::write( const Mat& _img, const std::vector<int>& params )
 
             result = !jas_image_encode( img, stream, jas_image_strtofmt( (char*)"jp2" ), (char*)options.str().c_str() );
 
+            if( result && m_buf )
+            {
+                result = jas_stream_flush( stream ) == 0;
+                const jas_stream_memobj_t* obj = (const jas_stream_memobj_t*)stream->obj_;
+                if( result )
+                    m_buf->assign( (const uchar*)obj->buf_, (const uchar*)obj->buf_ + obj->len_ );
+            }
+
             jas_stream_close( stream );
         }
 
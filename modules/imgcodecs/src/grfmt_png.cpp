@@ -92,6 +92,8 @@ PngDecoder::PngDecoder()
     m_buf_supported = true;
     m_buf_pos = 0;
     m_bit_depth = 0;
+    m_interlace_type = 0;
+    m_row = 0;
 }
 
 
@@ -172,19 +174,20 @@ bool  PngDecoder::readHeader()
                 if( !m_buf.empty() || m_f )
                 {
                     png_uint_32 wdth, hght;
-                    int bit_depth, color_type, num_trans=0;
+                    int bit_depth, color_type, interlace_type, num_trans=0;
                     png_bytep trans;
                     png_color_16p trans_values;
 
                     png_read_info( png_ptr, info_ptr );
 
                     png_get_IHDR( png_ptr, info_ptr, &wdth, &hght,
-                                  &bit_depth, &color_type, 0, 0, 0 );
+                                  &bit_depth, &color_type, &interlace_type, 0, 0 );
 
                     m_width = (int)wdth;
                     m_height = (int)hght;
                     m_color_type = color_type;
                     m_bit_depth = bit_depth;
+                    m_interlace_type = interlace_type;
 
                     if( bit_depth <= 8 || bit_depth == 16 )
                     {
@@ -221,64 +224,86 @@ bool  PngDecoder::readHeader()
 }
 
 
+bool  PngDecoder::setROI( const Rect& roi )
+{
+    // the passes of interlaced images span the whole image
+    if( m_interlace_type != PNG_INTERLACE_NONE )
+        return false;
+    m_roi = roi;
+    return true;
+}
+
+void  PngDecoder::setTransforms( int type )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    bool color = CV_MAT_CN(type) > 1;
+
+    if( CV_MAT_DEPTH(type) == CV_8U && m_bit_depth == 16 )
+        png_set_strip_16( png_ptr );
+    else if( !isBigEndian() )
+        png_set_swap( png_ptr );
+
+    if( CV_MAT_CN(type) < 4 )
+    {
+        /* observation: png_read_image() writes 400 bytes beyond
+         * end of data when reading a 400x118 color png
+         * "mpplus_sand.png".  OpenCV crashes even with demo
+         * programs.  Looking at the loaded image I'd say we get 4
+         * bytes per pixel instead of 3 bytes per pixel.  Test
+         * indicate that it is a good idea to always ask for
+         * stripping alpha..  18.11.2004 Axel Walthelm
+         */
+         png_set_strip_alpha( png_ptr );
+    } else
+        png_set_tRNS_to_alpha( png_ptr );
+
+    if( m_color_type == PNG_COLOR_TYPE_PALETTE )
+        png_set_palette_to_rgb( png_ptr );
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
+#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
+    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
+        png_set_expand_gray_1_2_4_to_8( png_ptr );
+#else
+        png_set_gray_1_2_4_to_8( png_ptr );
+#endif
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) && color )
+        png_set_bgr( png_ptr ); // convert RGB to BGR
+    else if( color )
+        png_set_gray_to_rgb( png_ptr ); // Gray->RGB
+    else
+        png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
+
+    png_set_interlace_handling( png_ptr );
+    png_read_update_info( png_ptr, (png_infop)m_info_ptr );
+}
+
+
 bool  PngDecoder::readData( Mat& img )
 {
+    // the passes of interlaced images span the whole image, other ones are read row by row
+    if( m_interlace_type == PNG_INTERLACE_NONE )
+    {
+        bool result = startReadRows( img.type() ) && readRows( img );
+        close();
+        return result;
+    }
+
     volatile bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer.data();
-    bool color = img.channels() > 1;
 
     png_structp png_ptr = (png_structp)m_png_ptr;
-    png_infop info_ptr = (png_infop)m_info_ptr;
     png_infop end_info = (png_infop)m_end_info;
 
     if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height )
     {
         if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
         {
-            int y;
-
-            if( img.depth() == CV_8U && m_bit_depth == 16 )
-                png_set_strip_16( png_ptr );
-            else if( !isBigEndian() )
-                png_set_swap( png_ptr );
-
-            if(img.channels() < 4)
-            {
-                /* observation: png_read_image() writes 400 bytes beyond
-                 * end of data when reading a 400x118 color png
-                 * "mpplus_sand.png".  OpenCV crashes even with demo
-                 * programs.  Looking at the loaded image I'd say we get 4
-                 * bytes per pixel instead of 3 bytes per pixel.  Test
-                 * indicate that it is a good idea to always ask for
-                 * stripping alpha..  18.11.2004 Axel Walthelm
-                 */
-                 png_set_strip_alpha( png_ptr );
-            } else
-                png_set_tRNS_to_alpha( png_ptr );
-
-            if( m_color_type == PNG_COLOR_TYPE_PALETTE )
-                png_set_palette_to_rgb( png_ptr );
-
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
-#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
-    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
-                png_set_expand_gray_1_2_4_to_8( png_ptr );
-#else
-                png_set_gray_1_2_4_to_8( png_ptr );
-#endif
+            setTransforms( img.type() );
 
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) && color )
-                png_set_bgr( png_ptr ); // convert RGB to BGR
-            else if( color )
-                png_set_gray_to_rgb( png_ptr ); // Gray->RGB
-            else
-                png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
-
-            png_set_interlace_handling( png_ptr );
-            png_read_update_info( png_ptr, info_ptr );
-
-            for( y = 0; y < m_height; y++ )
+            for( int y = 0; y < m_height; y++ )
                 buffer[y] = img.data + y*img.step;
 
             png_read_image( png_ptr, buffer );
@@ -293,18 +318,349 @@ bool  PngDecoder::readData( Mat& img )
 }
 
 
+bool  PngDecoder::startReadRows( int type )
+{
+    if( m_interlace_type != PNG_INTERLACE_NONE )
+        return false;
+
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            setTransforms( type );
+            m_row = 0;
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
+    return result;
+}
+
+
+bool  PngDecoder::readRows( Mat& band )
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( m_png_ptr )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            Rect region = m_roi.empty() ? Rect(0, 0, m_width, m_height) : m_roi;
+            CV_Assert( m_row - region.y + band.rows <= region.height );
+
+            // rows above the region are decoded into a scratch row and dropped,
+            // as well as the rows of a region narrower than the image before they are cropped
+            bool direct = region.width == m_width;
+            if( (!direct || m_row < region.y) && m_row_buf.empty() )
+                m_row_buf.resize( png_get_rowbytes( png_ptr, (png_infop)m_info_ptr ) );
+            for( ; m_row < region.y; m_row++ )
+                png_read_row( png_ptr, &m_row_buf[0], NULL );
+
+            size_t offset = region.x*band.elemSize(), width = region.width*band.elemSize();
+            for( int y = 0; y < band.rows; y++, m_row++ )
+            {
+                if( direct )
+                    png_read_row( png_ptr, band.ptr(y), NULL );
+                else
+                {
+                    png_read_row( png_ptr, &m_row_buf[0], NULL );
+                    memcpy( band.ptr(y), &m_row_buf[0] + offset, width );
+                }
+            }
+
+            if( m_row == m_height )
+                png_read_end( png_ptr, (png_infop)m_end_info );
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
+    return result;
+}
+
+
 /////////////////////// PngEncoder ///////////////////
 
+static void readPngParams( const std::vector<int>& params, int& compression_level, int& compression_strategy,
+                           bool& isBilevel, int& threads )
+{
+    compression_level = -1; // Invalid value to allow setting 0-9 as valid
+    compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
+    isBilevel = false;
+    threads = 0;
+
+    for( size_t i = 0; i < params.size(); i += 2 )
+    {
+        if( params[i] == IMWRITE_PNG_COMPRESSION )
+        {
+            compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
+            compression_level = params[i+1];
+            compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
+        }
+        if( params[i] == IMWRITE_PNG_STRATEGY )
+        {
+            compression_strategy = params[i+1];
+            compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
+        }
+        if( params[i] == IMWRITE_PNG_BILEVEL )
+        {
+            isBilevel = params[i+1] != 0;
+        }
+        if( params[i] == IMWRITE_PNG_THREADS )
+        {
+            threads = params[i+1];
+        }
+    }
+}
+
+// smallest amount of filtered data compressed as an independent deflate block sequence by writeParallel
+static const size_t PNG_MIN_PARALLEL_CHUNK = 1 << 18;
+// deflate window, the data preceding a chunk is used as its dictionary
+static const size_t PNG_DEFLATE_WINDOW = 1 << 15;
+
+static inline int paethPredictor( int a, int b, int c )
+{
+    int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2*c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// applies the PNG filter of the given type to the row cur, prev is the previous row (zeros for the first one)
+static void filterPngRow( int filter, const uchar* cur, const uchar* prev, uchar* dst, int rowbytes, int bpp )
+{
+    int i = 0;
+    switch( filter )
+    {
+    case PNG_FILTER_VALUE_NONE:
+        memcpy(dst, cur, rowbytes);
+        break;
+    case PNG_FILTER_VALUE_SUB:
+        for( ; i < bpp; i++ )
+            dst[i] = cur[i];
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(cur[i] - cur[i - bpp]);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(cur[i] - prev[i]);
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(cur[i] - (prev[i] >> 1));
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(cur[i] - ((cur[i - bpp] + prev[i]) >> 1));
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(cur[i] - prev[i]);
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(cur[i] - paethPredictor(cur[i - bpp], prev[i], prev[i - bpp]));
+        break;
+    default:
+        CV_Error(Error::StsBadArg, "unknown PNG filter");
+    }
+}
+
+// sum of the filtered bytes taken as signed values, the heuristic libpng uses to choose the filter
+static size_t pngFilterCost( const uchar* row, int rowbytes )
+{
+    size_t sum = 0;
+    for( int i = 0; i < rowbytes; i++ )
+        sum += row[i] < 128 ? row[i] : 256 - row[i];
+    return sum;
+}
+
+/** Converts the rows of the image to PNG samples (RGB order, big-endian) and filters them: each output row is the
+ filter type followed by the filtered row. The filter is either SUB or, when adaptive, chosen per row like libpng. */
+class PngFilterInvoker : public ParallelLoopBody
+{
+public:
+    PngFilterInvoker( const Mat& img, uchar* dst, bool adaptive )
+        : img_(img), dst_(dst), adaptive_(adaptive),
+          rowbytes_((int)(img.cols*img.elemSize())), bpp_((int)img.elemSize())
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        AutoBuffer<uchar> _buf(rowbytes_*3);
+        uchar *prev = _buf.data(), *cur = prev + rowbytes_, *tmp = cur + rowbytes_;
+
+        if( range.start > 0 )
+            convertRow(range.start - 1, prev);
+        else
+            memset(prev, 0, rowbytes_);
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            convertRow(y, cur);
+            uchar* dst = dst_ + (size_t)y*(rowbytes_ + 1);
+            if( !adaptive_ )
+            {
+                dst[0] = PNG_FILTER_VALUE_SUB;
+                filterPngRow(PNG_FILTER_VALUE_SUB, cur, prev, dst + 1, rowbytes_, bpp_);
+            }
+            else
+            {
+                size_t best_cost = 0;
+                for( int filter = PNG_FILTER_VALUE_NONE; filter <= PNG_FILTER_VALUE_PAETH; filter++ )
+                {
+                    filterPngRow(filter, cur, prev, tmp, rowbytes_, bpp_);
+                    size_t cost = pngFilterCost(tmp, rowbytes_);
+                    if( filter == PNG_FILTER_VALUE_NONE || cost < best_cost )
+                    {
+                        best_cost = cost;
+                        dst[0] = (uchar)filter;
+                        memcpy(dst + 1, tmp, rowbytes_);
+                    }
+                }
+            }
+            std::swap(prev, cur);
+        }
+    }
+
+private:
+    void convertRow( int y, uchar* row ) const
+    {
+        const uchar* src = img_.ptr(y);
+        int channels = img_.channels();
+        bool is16 = img_.depth() == CV_16U;
+        if( channels == 3 )
+        {
+            if( is16 )
+                icvCvt_BGR2RGB_16u_C3R( (const ushort*)src, 0, (ushort*)row, 0, Size(img_.cols, 1) );
+            else
+                icvCvt_BGR2RGB_8u_C3R( src, 0, row, 0, Size(img_.cols, 1) );
+        }
+        else if( channels == 4 )
+        {
+            if( is16 )
+                icvCvt_BGRA2RGBA_16u_C4R( (const ushort*)src, 0, (ushort*)row, 0, Size(img_.cols, 1) );
+            else
+                icvCvt_BGRA2RGBA_8u_C4R( src, 0, row, 0, Size(img_.cols, 1) );
+        }
+        else
+            memcpy(row, src, rowbytes_);
+
+        if( is16 && !isBigEndian() )
+        {
+            for( int i = 0; i < rowbytes_; i += 2 )
+                std::swap(row[i], row[i + 1]);
+        }
+    }
+
+    const Mat& img_;
+    uchar* dst_;
+    bool adaptive_;
+    int rowbytes_;
+    int bpp_;
+};
+
+/** Compresses the chunks data[offsets[i], offsets[i+1]) to raw deflate streams which, concatenated, form one stream:
+ each chunk is primed with the window preceding it and ends at a byte boundary (Z_SYNC_FLUSH), the last one
+ terminates the stream. The Adler-32 checksum of each chunk is computed along. */
+class PngDeflateInvoker : public ParallelLoopBody
+{
+public:
+    PngDeflateInvoker( const uchar* data, const std::vector<size_t>& offsets, int level, int strategy,
+                       std::vector<std::vector<uchar> >& chunks, std::vector<uLong>& adlers, std::vector<int>& status )
+        : data_(data), offsets_(offsets), level_(level), strategy_(strategy),
+          chunks_(chunks), adlers_(adlers), status_(status)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int i = range.start; i < range.end; i++ )
+            status_[i] = compress(i) ? 1 : 0;
+    }
+
+private:
+    bool compress( int i ) const
+    {
+        const size_t start = offsets_[i], len = offsets_[i + 1] - start;
+        const bool last = i + 2 == (int)offsets_.size();
+        const size_t max_step = (size_t)1 << 30; // z_stream counters are 32-bit
+
+        uLong adler = adler32(0L, Z_NULL, 0);
+        for( size_t pos = 0; pos < len; pos += max_step )
+            adler = adler32(adler, data_ + start + pos, (uInt)std::min(len - pos, max_step));
+        adlers_[i] = adler;
+
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        if( deflateInit2(&strm, level_, Z_DEFLATED, -MAX_WBITS, 8, strategy_) != Z_OK )
+            return false;
+
+        std::vector<uchar>& dst = chunks_[i];
+        size_t dst_pos = dst.size(); // the first chunk starts with the zlib header
+        dst.resize(dst_pos + len / 2 + 64);
+
+        int ret = Z_OK;
+        if( start > 0 )
+        {
+            size_t dict_size = std::min(start, PNG_DEFLATE_WINDOW);
+            ret = deflateSetDictionary(&strm, data_ + start - dict_size, (uInt)dict_size);
+        }
+
+        const uchar* src = data_ + start;
+        size_t left = len;
+        while( ret == Z_OK )
+        {
+            size_t in_size = std::min(left, max_step);
+            strm.next_in = (Bytef*)src;
+            strm.avail_in = (uInt)in_size;
+            src += in_size;
+            left -= in_size;
+            int flush = left > 0 ? Z_NO_FLUSH : last ? Z_FINISH : Z_SYNC_FLUSH;
+            do
+            {
+                if( dst_pos == dst.size() )
+                    dst.resize(dst.size()*2);
+                strm.next_out = &dst[dst_pos];
+                strm.avail_out = (uInt)std::min(dst.size() - dst_pos, max_step);
+                ret = deflate(&strm, flush);
+                dst_pos = strm.next_out - &dst[0];
+            }
+            while( ret == Z_OK && strm.avail_out == 0 );
+
+            if( left == 0 )
+                break;
+        }
+        deflateEnd(&strm);
+        dst.resize(dst_pos);
+
+        // a flush without pending output reports Z_BUF_ERROR, which is not an error
+        return last ? ret == Z_STREAM_END : ret == Z_OK || ret == Z_BUF_ERROR;
+    }
+
+    const uchar* data_;
+    const std::vector<size_t>& offsets_;
+    int level_;
+    int strategy_;
+    std::vector<std::vector<uchar> >& chunks_;
+    std::vector<uLong>& adlers_;
+    std::vector<int>& status_;
+};
+
 
 PngEncoder::PngEncoder()
 {
     m_description = "Portable Network Graphics files (*.png)";
     m_buf_supported = true;
+    m_png_ptr = m_info_ptr = 0;
+    m_f = 0;
+    m_rows_left = 0;
 }
 
 
 PngEncoder::~PngEncoder()
 {
+    close();
 }
 
 
@@ -338,20 +694,128 @@ void PngEncoder::flushBuf(void*)
 
 bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 {
-    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
-    png_infop info_ptr = 0;
-    FILE * volatile f = 0;
-    int y, width = img.cols, height = img.rows;
-    int depth = img.depth(), channels = img.channels();
+    int compression_level, compression_strategy, threads;
+    bool isBilevel;
+    readPngParams( params, compression_level, compression_strategy, isBilevel, threads );
+
+    if( threads < 0 )
+        threads = getNumThreads();
+    if( threads > 1 && !isBilevel && (img.depth() == CV_8U || img.depth() == CV_16U) )
+    {
+        size_t data_size = (img.cols*img.elemSize() + 1)*img.rows;
+        size_t nchunks = std::min(std::min((size_t)threads, (size_t)img.rows), data_size / PNG_MIN_PARALLEL_CHUNK);
+        if( nchunks > 1 )
+            return writeParallel( img, params, (int)nchunks, compression_level, compression_strategy );
+    }
+
+    return startWriteRows( img.size(), img.type(), params ) && writeRows( img );
+}
+
+
+/* The image data (IDAT) is a single zlib stream of the filtered rows. Here the rows are filtered and deflated by
+   chunks concurrently, then the chunks are stitched into one stream (see PngDeflateInvoker) and written as IDAT
+   chunks, while libpng writes the other chunks. */
+bool  PngEncoder::writeParallel( const Mat& img, const std::vector<int>& params, int nchunks,
+                                 int compression_level, int compression_strategy )
+{
+    const size_t row_size = img.cols*img.elemSize() + 1;
+    std::vector<uchar> filtered(row_size*img.rows);
+    parallel_for_(Range(0, img.rows), PngFilterInvoker(img, &filtered[0], compression_level >= 0), nchunks);
+
+    std::vector<size_t> offsets(nchunks + 1);
+    for( int i = 0; i <= nchunks; i++ )
+        offsets[i] = row_size*(size_t)((int64)img.rows*i/nchunks);
+
+    const int level = compression_level >= 0 ? compression_level : Z_BEST_SPEED;
+    std::vector<std::vector<uchar> > chunks(nchunks);
+    std::vector<uLong> adlers(nchunks);
+    std::vector<int> status(nchunks, 0);
+
+    // zlib header: deflate with 32K window, compression level hint as zlib sets it
+    int level_flags = compression_strategy >= Z_HUFFMAN_ONLY || level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    int header = (Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8 | level_flags << 6;
+    header += 31 - header % 31;
+    chunks[0].push_back((uchar)(header >> 8));
+    chunks[0].push_back((uchar)header);
+
+    parallel_for_(Range(0, nchunks),
+                  PngDeflateInvoker(&filtered[0], offsets, level, compression_strategy, chunks, adlers, status),
+                  nchunks);
+    for( int i = 0; i < nchunks; i++ )
+    {
+        if( !status[i] )
+            return false;
+    }
+    std::vector<uchar>().swap(filtered);
+
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for( int i = 0; i < nchunks; i++ )
+        adler = adler32_combine(adler, adlers[i], (z_off_t)(offsets[i + 1] - offsets[i]));
+    for( int shift = 24; shift >= 0; shift -= 8 )
+        chunks.back().push_back((uchar)(adler >> shift));
+
+    if( !startWriteRows( img.size(), img.type(), params ) )
+        return false;
+
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+    {
+        static const png_byte png_IDAT[5] = { 'I', 'D', 'A', 'T', '\0' };
+        static const png_byte png_IEND[5] = { 'I', 'E', 'N', 'D', '\0' };
+        const size_t max_chunk_size = (size_t)1 << 30;
+        for( int i = 0; i < nchunks; i++ )
+        {
+            const std::vector<uchar>& chunk = chunks[i];
+            for( size_t pos = 0; pos < chunk.size(); pos += max_chunk_size )
+                png_write_chunk( png_ptr, png_IDAT, &chunk[pos], std::min(chunk.size() - pos, max_chunk_size) );
+        }
+        png_write_chunk( png_ptr, png_IEND, NULL, 0 );
+        result = true;
+    }
+
+    close();
+    return result;
+}
+
+
+void  PngEncoder::close()
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    png_infop info_ptr = (png_infop)m_info_ptr;
+    png_destroy_write_struct( &png_ptr, &info_ptr );
+    m_png_ptr = m_info_ptr = 0;
+
+    if( m_f )
+    {
+        fclose( m_f );
+        m_f = 0;
+    }
+}
+
+
+bool  PngEncoder::startWriteRows( const Size& size, int type, const std::vector<int>& params )
+{
+    int width = size.width, height = size.height;
+    int depth = CV_MAT_DEPTH(type), channels = CV_MAT_CN(type);
     volatile bool result = false;
-    AutoBuffer<uchar*> buffer;
 
     if( depth != CV_8U && depth != CV_16U )
         return false;
 
+    int compression_level, compression_strategy, threads;
+    bool isBilevel;
+    readPngParams( params, compression_level, compression_strategy, isBilevel, threads );
+
+    close();
+    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
+    png_infop info_ptr = 0;
+
     if( png_ptr )
     {
         info_ptr = png_create_info_struct( png_ptr );
+        m_png_ptr = png_ptr;
+        m_info_ptr = info_ptr;
 
         if( info_ptr )
         {
@@ -364,35 +828,12 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                 }
                 else
                 {
-                    f = fopen( m_filename.c_str(), "wb" );
-                    if( f )
-                        png_init_io( png_ptr, (png_FILE_p)f );
-                }
-
-                int compression_level = -1; // Invalid value to allow setting 0-9 as valid
-                int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
-                bool isBilevel = false;
-
-                for( size_t i = 0; i < params.size(); i += 2 )
-                {
-                    if( params[i] == IMWRITE_PNG_COMPRESSION )
-                    {
-                        compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
-                        compression_level = params[i+1];
-                        compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
-                    }
-                    if( params[i] == IMWRITE_PNG_STRATEGY )
-                    {
-                        compression_strategy = params[i+1];
-                        compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
-                    }
-                    if( params[i] == IMWRITE_PNG_BILEVEL )
-                    {
-                        isBilevel = params[i+1] != 0;
-                    }
+                    m_f = fopen( m_filename.c_str(), "wb" );
+                    if( m_f )
+                        png_init_io( png_ptr, (png_FILE_p)m_f );
                 }
 
-                if( m_buf || f )
+                if( m_buf || m_f )
                 {
                     if( compression_level >= 0 )
                     {
@@ -422,22 +863,44 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     if( !isBigEndian() )
                         png_set_swap( png_ptr );
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
-
-                    png_write_image( png_ptr, buffer.data() );
-                    png_write_end( png_ptr, info_ptr );
-
+                    m_rows_left = height;
                     result = true;
                 }
             }
         }
     }
 
-    png_destroy_write_struct( &png_ptr, &info_ptr );
-    if(f) fclose( (FILE*)f );
+    if( !result )
+        close();
+    return result;
+}
 
+
+bool  PngEncoder::writeRows( const Mat& band )
+{
+    volatile bool result = false;
+    png_structp png_ptr = (png_structp)m_png_ptr;
+
+    if( png_ptr && band.rows <= m_rows_left )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            // libpng applies the transformations to its own copy of the row
+            for( int y = 0; y < band.rows; y++ )
+                png_write_row( png_ptr, (png_bytep)band.ptr(y) );
+
+            m_rows_left -= band.rows;
+            if( m_rows_left == 0 )
+            {
+                png_write_end( png_ptr, (png_infop)m_info_ptr );
+                close();
+            }
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
     return result;
 }
 
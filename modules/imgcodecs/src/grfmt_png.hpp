@@ -60,6 +60,9 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
@@ -67,6 +70,7 @@ public:
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    void  setTransforms( int type );
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -74,7 +78,10 @@ protected:
     void* m_end_info; // pointer to one more image information structure
     FILE* m_f;
     int   m_color_type;
+    int   m_interlace_type;
     size_t m_buf_pos;
+    int   m_row;       // next row of the image to decode by readRows
+    std::vector<uchar> m_row_buf;
 };
 
 
@@ -86,12 +93,23 @@ public:
 
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( const Size& size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    void  close();
 
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
     static void writeDataToBuf(void* png_ptr, uchar* src, size_t size);
     static void flushBuf(void* png_ptr);
+
+    bool  writeParallel( const Mat& img, const std::vector<int>& params, int nchunks,
+                         int compression_level, int compression_strategy );
+
+    void* m_png_ptr;  // pointer to compression structure
+    void* m_info_ptr; // pointer to image information structure
+    FILE* m_f;
+    int   m_rows_left; // rows to write by writeRows
 };
 
 }
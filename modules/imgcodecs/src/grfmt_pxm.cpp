@@ -207,19 +207,18 @@ bool PxMDecoder::readHeader()
 
 bool PxMDecoder::readData( Mat& img )
 {
-    bool color = img.channels() > 1;
-    uchar* data = img.ptr();
-    PaletteEntry palette[256];
-    bool   result = false;
+    return startReadRows( img.type() ) && readRows( img );
+}
+
+
+bool PxMDecoder::startReadRows( int )
+{
     const int bit_depth = CV_ELEM_SIZE1(m_type)*8;
-    const int src_pitch = divUp(m_width*m_bpp*(bit_depth/8), 8);
-    int  nch = CV_MAT_CN(m_type);
-    int  width3 = m_width*nch;
 
     if( m_offset < 0 || !m_strm.isOpened())
         return false;
 
-    uchar gray_palette[256] = {0};
+    memset( m_gray_palette, 0, sizeof(m_gray_palette) );
 
     // create LUT for converting colors
     if( bit_depth == 8 )
@@ -227,15 +226,46 @@ bool PxMDecoder::readData( Mat& img )
         CV_Assert(m_maxval < 256 && m_maxval > 0);
 
         for (int i = 0; i <= m_maxval; i++)
-            gray_palette[i] = (uchar)((i*255/m_maxval)^(m_bpp == 1 ? 255 : 0));
+            m_gray_palette[i] = (uchar)((i*255/m_maxval)^(m_bpp == 1 ? 255 : 0));
 
-        FillGrayPalette( palette, m_bpp==1 ? 1 : 8 , m_bpp == 1 );
+        FillGrayPalette( m_palette, m_bpp==1 ? 1 : 8 , m_bpp == 1 );
     }
 
+    m_strm.setPos( m_offset );
+    return true;
+}
+
+
+bool PxMDecoder::getDataLayout( int type, size_t& offset, size_t& step ) const
+{
+    // only binary PGM samples are stored as they are decoded, 16-bit ones are big-endian
+    if( !m_buf.empty() || m_offset < 0 || !m_binary || m_bpp != 8 || type != m_type ||
+        (CV_MAT_DEPTH(type) != CV_8U && !isBigEndian()) )
+        return false;
+
+    offset = (size_t)m_offset;
+    step = (size_t)m_width*CV_ELEM_SIZE(type);
+    return true;
+}
+
+
+bool PxMDecoder::readRows( Mat& band )
+{
+    bool color = band.channels() > 1;
+    uchar* data = band.ptr();
+    PaletteEntry* palette = m_palette;
+    uchar* gray_palette = m_gray_palette;
+    bool   result = false;
+    const int bit_depth = CV_ELEM_SIZE1(m_type)*8;
+    const int src_pitch = divUp(m_width*m_bpp*(bit_depth/8), 8);
+    int  nch = CV_MAT_CN(m_type);
+    int  width3 = m_width*nch;
+
+    if( !m_strm.isOpened() )
+        return false;
+
     try
     {
-        m_strm.setPos( m_offset );
-
         switch( m_bpp )
         {
         ////////////////////////// 1 BPP /////////////////////////
@@ -246,7 +276,7 @@ bool PxMDecoder::readData( Mat& img )
                 AutoBuffer<uchar> _src(m_width);
                 uchar* src = _src.data();
 
-                for (int y = 0; y < m_height; y++, data += img.step)
+                for (int y = 0; y < band.rows; y++, data += band.step)
                 {
                     for (int x = 0; x < m_width; x++)
                         src[x] = ReadNumber(m_strm, 1) != 0;
@@ -262,7 +292,7 @@ bool PxMDecoder::readData( Mat& img )
                 AutoBuffer<uchar> _src(src_pitch);
                 uchar* src = _src.data();
 
-                for (int y = 0; y < m_height; y++, data += img.step)
+                for (int y = 0; y < band.rows; y++, data += band.step)
                 {
                     m_strm.getBytes( src, src_pitch );
 
@@ -282,7 +312,7 @@ bool PxMDecoder::readData( Mat& img )
             AutoBuffer<uchar> _src(std::max<size_t>(width3*2, src_pitch));
             uchar* src = _src.data();
 
-            for (int y = 0; y < m_height; y++, data += img.step)
+            for (int y = 0; y < band.rows; y++, data += band.step)
             {
                 if( !m_binary )
                 {
@@ -310,7 +340,7 @@ bool PxMDecoder::readData( Mat& img )
                     }
                 }
 
-                if( img.depth() == CV_8U && bit_depth == 16 )
+                if( band.depth() == CV_8U && bit_depth == 16 )
                 {
                     for (int x = 0; x < width3; x++)
                     {
@@ -323,7 +353,7 @@ bool PxMDecoder::readData( Mat& img )
                 {
                     if( color )
                     {
-                        if( img.depth() == CV_8U ) {
+                        if( band.depth() == CV_8U ) {
                             uchar *d = data, *s = src, *end = src + m_width;
                             for( ; s < end; d += 3, s++)
                                 d[0] = d[1] = d[2] = *s;
@@ -334,18 +364,18 @@ bool PxMDecoder::readData( Mat& img )
                         }
                     }
                     else
-                        memcpy(data, src, img.elemSize1()*m_width);
+                        memcpy(data, src, band.elemSize1()*m_width);
                 }
                 else
                 {
                     if( color )
                     {
-                        if( img.depth() == CV_8U )
+                        if( band.depth() == CV_8U )
                             icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, Size(m_width,1) );
                         else
                             icvCvt_RGB2BGR_16u_C3R( (ushort *)src, 0, (ushort *)data, 0, Size(m_width,1) );
                     }
-                    else if( img.depth() == CV_8U )
+                    else if( band.depth() == CV_8U )
                         icvCvt_BGR2Gray_8u_C3C1R( src, 0, data, 0, Size(m_width,1), 2 );
                     else
                         icvCvt_BGRA2Gray_16u_CnC1R( (ushort *)src, 0, (ushort *)data, 0, Size(m_width,1), 3, 2 );
@@ -387,10 +417,14 @@ PxMEncoder::PxMEncoder(PxMMode mode) :
         CV_Error(Error::StsInternal, "");
     }
     m_buf_supported = true;
+    m_mode = mode;
+    m_isBinary = true;
+    m_rows_left = 0;
 }
 
 PxMEncoder::~PxMEncoder()
 {
+    close();
 }
 
 bool PxMEncoder::isFormatSupported(int depth) const
@@ -401,14 +435,18 @@ bool PxMEncoder::isFormatSupported(int depth) const
 }
 
 bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
+{
+    return startWriteRows(img.size(), img.type(), params) && writeRows(img);
+}
+
+bool PxMEncoder::startWriteRows(const Size& size, int type, const std::vector<int>& params)
 {
     bool isBinary = true;
 
-    int  width = img.cols, height = img.rows;
-    int  _channels = img.channels(), depth = (int)img.elemSize1()*8;
+    int  width = size.width, height = size.height;
+    int  _channels = CV_MAT_CN(type), depth = CV_ELEM_SIZE1(type)*8;
     int  channels = _channels > 1 ? 3 : 1;
-    int  fileStep = width*(int)img.elemSize();
-    int  x, y;
+    int  fileStep = width*CV_ELEM_SIZE(type);
 
     for( size_t i = 0; i < params.size(); i += 2 )
     {
@@ -419,49 +457,49 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
     int mode = mode_;
     if (mode == PXM_TYPE_AUTO)
     {
-        mode = img.channels() == 1 ? PXM_TYPE_PGM : PXM_TYPE_PPM;
+        mode = _channels == 1 ? PXM_TYPE_PGM : PXM_TYPE_PPM;
     }
 
-    if (mode == PXM_TYPE_PGM && img.channels() > 1)
+    if (mode == PXM_TYPE_PGM && _channels > 1)
     {
         CV_Error(Error::StsBadArg, "Portable bitmap(.pgm) expects gray image");
     }
-    if (mode == PXM_TYPE_PPM && img.channels() != 3)
+    if (mode == PXM_TYPE_PPM && _channels != 3)
     {
         CV_Error(Error::StsBadArg, "Portable bitmap(.ppm) expects BGR image");
     }
-    if (mode == PXM_TYPE_PBM && img.type() != CV_8UC1)
+    if (mode == PXM_TYPE_PBM && type != CV_8UC1)
     {
         CV_Error(Error::StsBadArg, "For portable bitmap(.pbm) type must be CV_8UC1");
     }
 
-    WLByteStream strm;
+    close();
 
     if( m_buf )
     {
-        if( !strm.open(*m_buf) )
+        if( !m_strm.open(*m_buf) )
             return false;
-        int t = CV_MAKETYPE(img.depth(), channels);
+        int t = CV_MAKETYPE(CV_MAT_DEPTH(type), channels);
         m_buf->reserve( alignSize(256 + (isBinary ? fileStep*height :
             ((t == CV_8UC1 ? 4 : t == CV_8UC3 ? 4*3+2 :
             t == CV_16UC1 ? 6 : 6*3+2)*width+1)*height), 256));
     }
-    else if( !strm.open(m_filename) )
+    else if( !m_strm.open(m_filename) )
         return false;
 
     int  lineLength;
     int  bufferSize = 128; // buffer that should fit a header
 
     if( isBinary )
-        lineLength = width * (int)img.elemSize();
+        lineLength = width * CV_ELEM_SIZE(type);
     else
         lineLength = (6 * channels + (channels > 1 ? 2 : 0)) * width + 32;
 
     if( bufferSize < lineLength )
         bufferSize = lineLength;
 
-    AutoBuffer<char> _buffer(bufferSize);
-    char* buffer = _buffer.data();
+    m_buffer.allocate(bufferSize);
+    char* buffer = m_buffer.data();
 
     // write header;
     const int code = ((mode == PXM_TYPE_PBM) ? 1 : (mode == PXM_TYPE_PGM) ? 2 : 3)
@@ -479,11 +517,34 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
         header_sz += sz;
     }
 
-    strm.putBytes(buffer, header_sz);
+    m_strm.putBytes(buffer, header_sz);
+
+    m_mode = mode;
+    m_isBinary = isBinary;
+    m_rows_left = height;
+    if( height == 0 )
+        close();
+    return true;
+}
+
+bool PxMEncoder::writeRows(const Mat& band)
+{
+    if( !m_strm.isOpened() || band.rows > m_rows_left )
+        return false;
+
+    const int mode = m_mode;
+    const bool isBinary = m_isBinary;
+    char* buffer = m_buffer.data();
+    int  width = band.cols, height = band.rows;
+    int  _channels = band.channels(), depth = (int)band.elemSize1()*8;
+    int  channels = _channels > 1 ? 3 : 1;
+    int  fileStep = width*(int)band.elemSize();
+    int  x, y;
+
 
     for( y = 0; y < height; y++ )
     {
-        const uchar* const data = img.ptr(y);
+        const uchar* const data = band.ptr(y);
         if( isBinary )
         {
             if (mode == PXM_TYPE_PBM)
@@ -512,7 +573,7 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
                 {
                     *ptr++ = byte;
                 }
-                strm.putBytes(buffer, (int)(ptr - buffer));
+                m_strm.putBytes(buffer, (int)(ptr - buffer));
                 continue;
             }
 
@@ -539,7 +600,7 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
                 }
             }
 
-            strm.putBytes( (channels > 1 || depth > 8) ? buffer : (const char*)data, fileStep);
+            m_strm.putBytes( (channels > 1 || depth > 8) ? buffer : (const char*)data, fileStep);
         }
         else
         {
@@ -610,14 +671,23 @@ bool PxMEncoder::write(const Mat& img, const std::vector<int>& params)
 
             *ptr++ = '\n';
 
-            strm.putBytes( buffer, (int)(ptr - buffer) );
+            m_strm.putBytes( buffer, (int)(ptr - buffer) );
         }
     }
 
-    strm.close();
+    m_rows_left -= height;
+    if( m_rows_left == 0 )
+        close();
     return true;
 }
 
+void PxMEncoder::close()
+{
+    m_strm.close();
+    m_buffer.allocate(0);
+    m_rows_left = 0;
+}
+
 }
 
 #endif // HAVE_IMGCODEC_PXM
@@ -68,6 +68,9 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
+    bool  getDataLayout( int type, size_t& offset, size_t& step ) const CV_OVERRIDE;
     void  close();
 
     size_t signatureLength() const CV_OVERRIDE;
@@ -78,6 +81,7 @@ protected:
 
     RLByteStream    m_strm;
     PaletteEntry    m_palette[256];
+    uchar           m_gray_palette[256];
     int             m_bpp;
     int             m_offset;
     bool            m_binary;
@@ -92,6 +96,9 @@ public:
 
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  startWriteRows( const Size& size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+    void  close();
 
     ImageEncoder newEncoder() const CV_OVERRIDE
     {
@@ -99,6 +106,13 @@ public:
     }
 
     const PxMMode mode_;
+
+protected:
+    WLByteStream m_strm;
+    AutoBuffer<char> m_buffer;
+    int  m_mode;
+    bool m_isBinary;
+    int  m_rows_left;
 };
 
 }
@@ -118,6 +118,7 @@ TiffDecoder::TiffDecoder()
     m_hdr = false;
     m_buf_supported = true;
     m_buf_pos = 0;
+    m_row = m_rows_y = 0;
 }
 
 
@@ -334,6 +335,23 @@ bool TiffDecoder::nextPage()
            readHeader();
 }
 
+bool TiffDecoder::setPage( int index )
+{
+    if (m_tif.empty() || index < 0 || index >= 65535)
+        return false;
+    TIFF* tif = static_cast<TIFF*>(m_tif.get());
+    // the next page is reached without walking the directories from the first one
+    if (index == (int)TIFFCurrentDirectory(tif) + 1)
+        return TIFFReadDirectory(tif) && readHeader();
+    return TIFFSetDirectory(tif, (tdir_t)index) && readHeader();
+}
+
+int TiffDecoder::pageCount()
+{
+    // walks the chain of directories without reading them
+    return m_tif.empty() ? 0 : (int)TIFFNumberOfDirectories(static_cast<TIFF*>(m_tif.get()));
+}
+
 static void fixOrientationPartial(Mat &img, uint16 orientation)
 {
     switch(orientation) {
@@ -405,7 +423,139 @@ static void fixOrientation(Mat &img, uint16 orientation, int dst_bpp)
     }
 }
 
+static uint16 getOrientation(TIFF* tif)
+{
+    uint16 img_orientation = ORIENTATION_TOPLEFT;
+    CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField(tif, TIFFTAG_ORIENTATION, &img_orientation));
+    return img_orientation;
+}
+
+/** Size of the tiles or, for images organized in strips, of the strips */
+static void getTileSize(TIFF* tif, int width, int height, uint32& tile_width0, uint32& tile_height0)
+{
+    int is_tiled = TIFFIsTiled(tif) != 0;
+    tile_width0 = width;
+    tile_height0 = 0;
+
+    if (is_tiled)
+    {
+        CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tile_width0));
+        CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_TILELENGTH, &tile_height0));
+    }
+    else
+    {
+        // optional
+        CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &tile_height0));
+    }
+
+    if (tile_width0 == 0)
+        tile_width0 = width;
+
+    if (tile_height0 == 0 ||
+            (!is_tiled && tile_height0 == std::numeric_limits<uint32>::max()) )
+        tile_height0 = height;
+
+    const int TILE_MAX_WIDTH = (1 << 24);
+    const int TILE_MAX_HEIGHT = (1 << 24);
+    CV_Assert((int)tile_width0 > 0 && (int)tile_width0 <= TILE_MAX_WIDTH);
+    CV_Assert((int)tile_height0 > 0 && (int)tile_height0 <= TILE_MAX_HEIGHT);
+}
+
+bool TiffDecoder::setROI( const Rect& roi )
+{
+    CV_Assert(!m_tif.empty());
+    // the tiles are selected in the stored layout, leave the other orientations to the caller
+    if (getOrientation((TIFF*)m_tif.get()) != ORIENTATION_TOPLEFT)
+        return false;
+    m_roi = roi;
+    return true;
+}
+
+bool TiffDecoder::startReadRows( int )
+{
+    CV_Assert(!m_tif.empty());
+    // the rows are decoded in the stored order
+    if (getOrientation((TIFF*)m_tif.get()) != ORIENTATION_TOPLEFT)
+        return false;
+    m_row = 0;
+    m_rows.release();
+    return true;
+}
+
+bool TiffDecoder::readRows( Mat& band )
+{
+    CV_Assert(!m_tif.empty());
+    const Rect region = m_roi.empty() ? Rect(0, 0, m_width, m_height) : m_roi;
+    CV_Assert(m_row + band.rows <= region.height);
+    uint32 tile_width0 = 0, tile_height0 = 0;
+    getTileSize((TIFF*)m_tif.get(), m_width, m_height, tile_width0, tile_height0);
+
+    for (int i = 0; i < band.rows; )
+    {
+        const int y = region.y + m_row;
+        if (m_rows.empty() || y >= m_rows_y + m_rows.rows)
+        {
+            // decode the whole row of strips (tiles) containing y, so that each of them is decoded once
+            m_rows_y = y - y % (int)tile_height0;
+            Rect rows(region.x, m_rows_y, region.width, std::min((int)tile_height0, m_height - m_rows_y));
+            m_rows.create(rows.size(), band.type());
+            if (!readRegion(m_rows, rows))
+                return false;
+        }
+        const int n = std::min(band.rows - i, m_rows_y + m_rows.rows - y);
+        m_rows.rowRange(y - m_rows_y, y - m_rows_y + n).copyTo(band.rowRange(i, i + n));
+        i += n;
+        m_row += n;
+    }
+    return true;
+}
+
 bool  TiffDecoder::readData( Mat& img )
+{
+    return readRegion(img, m_roi);
+}
+
+bool TiffDecoder::getDataLayout( int type, size_t& offset, size_t& step ) const
+{
+    TIFF* tif = static_cast<TIFF*>(m_tif.get());
+    if (!tif || !m_buf.empty() || m_hdr || type != m_type || CV_MAT_CN(type) != 1 ||
+        TIFFIsTiled(tif) || TIFFIsByteSwapped(tif))
+        return false;
+
+    // grayscale samples are decoded as they are stored, other photometric interpretations are converted
+    uint16 compression = COMPRESSION_NONE, photometric = 0, bpp = 1, ncn = 1;
+    uint32 rows_per_strip = 0;
+    if (!TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &compression) || compression != COMPRESSION_NONE ||
+        !TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric) || photometric != PHOTOMETRIC_MINISBLACK ||
+        !TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bpp) || bpp != CV_ELEM_SIZE1(type) * 8 ||
+        !TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &ncn) || ncn != 1 ||
+        !TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip) || rows_per_strip == 0 ||
+        getOrientation(tif) != ORIENTATION_TOPLEFT)
+        return false;
+
+    // the strips must follow each other in the file
+    toff_t* strip_offsets = NULL;
+    toff_t* strip_sizes = NULL;
+    if (!TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &strip_offsets) || !strip_offsets ||
+        !TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &strip_sizes) || !strip_sizes)
+        return false;
+    const size_t row_size = (size_t)m_width * CV_ELEM_SIZE(type);
+    const uint32 nstrips = TIFFNumberOfStrips(tif);
+    for (uint32 i = 0; i < nstrips; i++)
+    {
+        const uint64_t y = (uint64_t)i * rows_per_strip;
+        const uint64_t rows = std::min<uint64_t>(rows_per_strip, (uint64_t)m_height - y);
+        if ((uint64_t)strip_offsets[i] != (uint64_t)strip_offsets[0] + y * row_size ||
+            (uint64_t)strip_sizes[i] < rows * row_size)
+            return false;
+    }
+
+    offset = (size_t)strip_offsets[0];
+    step = row_size;
+    return true;
+}
+
+bool  TiffDecoder::readRegion( Mat& img, const Rect& roi )
 {
     int type = img.type();
     int depth = CV_MAT_DEPTH(type);
@@ -432,8 +582,7 @@ bool  TiffDecoder::readData( Mat& img )
         uint16 bpp = 8, ncn = isGrayScale ? 1 : 3;
         CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_BITSPERSAMPLE, &bpp));
         CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &ncn));
-        uint16 img_orientation = ORIENTATION_TOPLEFT;
-        CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField(tif, TIFFTAG_ORIENTATION, &img_orientation));
+        uint16 img_orientation = getOrientation(tif);
         const int bitsPerByte = 8;
         int dst_bpp = (int)(img.elemSize1() * bitsPerByte);
         bool vert_flip = dst_bpp == 8 &&
@@ -452,31 +601,10 @@ bool  TiffDecoder::readData( Mat& img )
             }
         }
 
-        uint32 tile_width0 = m_width, tile_height0 = 0;
+        uint32 tile_width0 = 0, tile_height0 = 0;
+        getTileSize(tif, m_width, m_height, tile_width0, tile_height0);
 
-        if (is_tiled)
         {
-            CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tile_width0));
-            CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_TILELENGTH, &tile_height0));
-        }
-        else
-        {
-            // optional
-            CV_TIFF_CHECK_CALL_DEBUG(TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &tile_height0));
-        }
-
-        {
-            if (tile_width0 == 0)
-                tile_width0 = m_width;
-
-            if (tile_height0 == 0 ||
-                    (!is_tiled && tile_height0 == std::numeric_limits<uint32>::max()) )
-                tile_height0 = m_height;
-
-            const int TILE_MAX_WIDTH = (1 << 24);
-            const int TILE_MAX_HEIGHT = (1 << 24);
-            CV_Assert((int)tile_width0 > 0 && (int)tile_width0 <= TILE_MAX_WIDTH);
-            CV_Assert((int)tile_height0 > 0 && (int)tile_height0 <= TILE_MAX_HEIGHT);
             const uint64_t MAX_TILE_SIZE = (CV_BIG_UINT(1) << 30);
             CV_CheckLE((int)ncn, 4, "");
             CV_CheckLE((int)bpp, 64, "");
@@ -497,17 +625,32 @@ bool  TiffDecoder::readData( Mat& img )
             AutoBuffer<uchar> _buffer(buffer_size);
             uchar* buffer = _buffer.data();
             ushort* buffer16 = (ushort*)buffer;
-            int tileidx = 0;
+            // only the tiles (strips) covering the region of interest are decoded,
+            // into a temporary image unless the region is aligned to them
+            Rect area(0, 0, m_width, m_height);
+            if (!roi.empty())
+            {
+                const int tw = (int)tile_width0, th = (int)tile_height0;
+                area.x = roi.x - roi.x % tw;
+                area.y = roi.y - roi.y % th;
+                area.width = std::min(m_width, (roi.x + roi.width + tw - 1) / tw * tw) - area.x;
+                area.height = std::min(m_height, (roi.y + roi.height + th - 1) / th * th) - area.y;
+            }
+            const bool crop = !roi.empty() && area != roi;
+            Mat dst = crop ? Mat(area.size(), img.type()) : img;
+            const int tiles_per_row = (m_width + (int)tile_width0 - 1) / (int)tile_width0;
 
-            for (int y = 0; y < m_height; y += (int)tile_height0)
+            for (int y = area.y; y < area.y + area.height; y += (int)tile_height0)
             {
                 int tile_height = std::min((int)tile_height0, m_height - y);
 
-                const int img_y = vert_flip ? m_height - y - tile_height : y;
+                const int img_y = (vert_flip ? m_height - y - tile_height : y) - area.y;
+                int tileidx = (y / (int)tile_height0) * tiles_per_row + area.x / (int)tile_width0;
 
-                for(int x = 0; x < m_width; x += (int)tile_width0, tileidx++)
+                for(int x = area.x; x < area.x + area.width; x += (int)tile_width0, tileidx++)
                 {
                     int tile_width = std::min((int)tile_width0, m_width - x);
+                    const int dst_x = x - area.x;
 
                     switch (dst_bpp)
                     {
@@ -532,14 +675,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R(bstart + i*tile_width0*4, 0,
-                                                img.ptr(img_y + tile_height - i - 1, x), 0,
+                                                dst.ptr(img_y + tile_height - i - 1, dst_x), 0,
                                                 Size(tile_width, 1) );
                                     }
                                     else
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "TIFF-8bpp: BGR/BGRA images are supported only");
                                         icvCvt_BGRA2BGR_8u_C4C3R(bstart + i*tile_width0*4, 0,
-                                                img.ptr(img_y + tile_height - i - 1, x), 0,
+                                                dst.ptr(img_y + tile_height - i - 1, dst_x), 0,
                                                 Size(tile_width, 1), 2);
                                     }
                                 }
@@ -547,7 +690,7 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     CV_CheckEQ(wanted_channels, 1, "");
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                            img.ptr(img_y + tile_height - i - 1, x), 0,
+                                            dst.ptr(img_y + tile_height - i - 1, dst_x), 0,
                                             Size(tile_width, 1), 2);
                                 }
                             }
@@ -573,14 +716,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "");
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y + i, dst_x), 0,
                                                 Size(tile_width, 1));
                                     }
                                     else if (ncn == 3)
                                     {
                                         CV_CheckEQ(wanted_channels, 3, "");
                                         icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y + i, dst_x), 0,
                                                 Size(tile_width, 1));
                                     }
                                     else if (ncn == 4)
@@ -588,14 +731,14 @@ bool  TiffDecoder::readData( Mat& img )
                                         if (wanted_channels == 4)
                                         {
                                             icvCvt_BGRA2RGBA_16u_C4R(buffer16 + i*tile_width0*ncn, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y + i, dst_x), 0,
                                                 Size(tile_width, 1));
                                         }
                                         else
                                         {
                                             CV_CheckEQ(wanted_channels, 3, "TIFF-16bpp: BGR/BGRA images are supported only");
                                             icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y + i, dst_x), 0,
                                                 Size(tile_width, 1), 2);
                                         }
                                     }
@@ -609,14 +752,14 @@ bool  TiffDecoder::readData( Mat& img )
                                     CV_CheckEQ(wanted_channels, 1, "");
                                     if( ncn == 1 )
                                     {
-                                        memcpy(img.ptr<ushort>(img_y + i, x),
+                                        memcpy(dst.ptr<ushort>(img_y + i, dst_x),
                                                buffer16 + i*tile_width0*ncn,
                                                tile_width*sizeof(ushort));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                img.ptr<ushort>(img_y + i, x), 0,
+                                                dst.ptr<ushort>(img_y + i, dst_x), 0,
                                                 Size(tile_width, 1), ncn, 2);
                                     }
                                 }
@@ -638,13 +781,13 @@ bool  TiffDecoder::readData( Mat& img )
 
                             Mat m_tile(Size(tile_width0, tile_height0), CV_MAKETYPE((dst_bpp == 32) ? CV_32F : CV_64F, ncn), buffer);
                             Rect roi_tile(0, 0, tile_width, tile_height);
-                            Rect roi_img(x, img_y, tile_width, tile_height);
+                            Rect roi_img(dst_x, img_y, tile_width, tile_height);
                             if (!m_hdr && ncn == 3)
-                                cvtColor(m_tile(roi_tile), img(roi_img), COLOR_RGB2BGR);
+                                cvtColor(m_tile(roi_tile), dst(roi_img), COLOR_RGB2BGR);
                             else if (!m_hdr && ncn == 4)
-                                cvtColor(m_tile(roi_tile), img(roi_img), COLOR_RGBA2BGRA);
+                                cvtColor(m_tile(roi_tile), dst(roi_img), COLOR_RGBA2BGRA);
                             else
-                                m_tile(roi_tile).copyTo(img(roi_img));
+                                m_tile(roi_tile).copyTo(dst(roi_img));
                             break;
                         }
                         default:
@@ -654,6 +797,8 @@ bool  TiffDecoder::readData( Mat& img )
                     }  // switch (dst_bpp)
                 }  // for x
             }  // for y
+            if (crop)
+                dst(Rect(roi.x - area.x, roi.y - area.y, roi.width, roi.height)).copyTo(img);
         }
         fixOrientation(img, img_orientation, dst_bpp);
     }
@@ -672,6 +817,7 @@ TiffEncoder::TiffEncoder()
 {
     m_description = "TIFF Files (*.tiff;*.tif)";
     m_buf_supported = true;
+    m_row = m_height = 0;
 }
 
 TiffEncoder::~TiffEncoder()
@@ -788,26 +934,20 @@ static bool readParam(const std::vector<int>& params, int key, int& value)
     return false;
 }
 
-bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
+void* TiffEncoder::open(TiffEncoderBufHelper& buf_helper)
 {
     // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
     // http://www.remotesensing.org/libtiff/man/TIFFOpen.3tiff.html
-    TIFF* tif = NULL;
-
-    TiffEncoderBufHelper buf_helper(m_buf);
     if ( m_buf )
-    {
-        tif = buf_helper.open();
-    }
-    else
-    {
-        tif = TIFFOpen(m_filename.c_str(), "w");
-    }
-    if (!tif)
-    {
-        return false;
-    }
-    cv::Ptr<void> tif_cleanup(tif, cv_tiffCloseHandle);
+        return buf_helper.open();
+    return TIFFOpen(m_filename.c_str(), "w");
+}
+
+bool TiffEncoder::writePageTags(void* tif_, int width, int height, int type, const std::vector<int>& params)
+{
+    TIFF* tif = (TIFF*)tif_;
+    int channels = CV_MAT_CN(type);
+    int depth = CV_MAT_DEPTH(type);
 
     //Settings that matter to all images
     int compression = COMPRESSION_LZW;
@@ -820,145 +960,309 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
     readParam(params, IMWRITE_TIFF_XDPI, dpiX);
     readParam(params, IMWRITE_TIFF_YDPI, dpiY);
 
-    //Iterate through each image in the vector and write them out as Tiff directories
-    for (size_t page = 0; page < img_vec.size(); page++)
-    {
-        const Mat& img = img_vec[page];
-        CV_Assert(!img.empty());
-        int channels = img.channels();
-        int width = img.cols, height = img.rows;
-        int type = img.type();
-        int depth = CV_MAT_DEPTH(type);
-        CV_CheckType(type, depth == CV_8U || depth == CV_16U || depth == CV_32F || depth == CV_64F, "");
-        CV_CheckType(type, channels >= 1 && channels <= 4, "");
-
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height));
+    int page_compression = compression;
 
-        if (img_vec.size() > 1)
+    int bitsPerChannel = -1;
+    switch (depth)
+    {
+        case CV_8U:
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE));
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, img_vec.size()));
+            bitsPerChannel = 8;
+            break;
         }
-
-        int compression_param = -1;  // OPENCV_FUTURE
-        if (type == CV_32FC3 && (!readParam(params, IMWRITE_TIFF_COMPRESSION, compression_param) || compression_param == COMPRESSION_SGILOG))
+        case CV_16U:
         {
-            if (!write_32FC3_SGILOG(img, tif))
-                return false;
-            continue;
+            bitsPerChannel = 16;
+            break;
         }
+        case CV_32F:
+        {
+            bitsPerChannel = 32;
+            page_compression = COMPRESSION_NONE;
+            break;
+        }
+        case CV_64F:
+        {
+            bitsPerChannel = 64;
+            page_compression = COMPRESSION_NONE;
+            break;
+        }
+        default:
+        {
+            return false;
+        }
+    }
 
-        int page_compression = compression;
+    const int bitsPerByte = 8;
+    size_t fileStep = (width * channels * bitsPerChannel) / bitsPerByte;
+    CV_Assert(fileStep > 0);
 
-        int bitsPerChannel = -1;
-        switch (depth)
+    int rowsPerStrip = (int)((1 << 13) / fileStep);
+    readParam(params, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+    rowsPerStrip = std::max(1, std::min(height, rowsPerStrip));
+
+    int colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
+
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, page_compression));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, colorspace));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip));
+
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, depth >= CV_32F ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT));
+
+    if (page_compression != COMPRESSION_NONE)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor));
+    }
+
+    if (resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit));
+    }
+    if (dpiX >= 0)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_XRESOLUTION, (float)dpiX));
+    }
+    if (dpiY >= 0)
+    {
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_YRESOLUTION, (float)dpiY));
+    }
+    return true;
+}
+
+void TiffEncoder::writeScanlines(void* tif_, const Mat& img, int y0)
+{
+    TIFF* tif = (TIFF*)tif_;
+    int channels = img.channels();
+    int width = img.cols;
+
+    // row buffer, because TIFFWriteScanline modifies the original data!
+    size_t scanlineSize = TIFFScanlineSize(tif);
+    AutoBuffer<uchar> _buffer(scanlineSize + 32);
+    uchar* buffer = _buffer.data(); CV_DbgAssert(buffer);
+    Mat m_buffer(Size(width, 1), img.type(), buffer, (size_t)scanlineSize);
+
+    for (int y = 0; y < img.rows; ++y)
+    {
+        switch (channels)
         {
-            case CV_8U:
+            case 1:
             {
-                bitsPerChannel = 8;
+                memcpy(buffer, img.ptr(y), scanlineSize);
                 break;
             }
-            case CV_16U:
+
+            case 3:
             {
-                bitsPerChannel = 16;
+                cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGR2RGB);
                 break;
             }
-            case CV_32F:
+
+            case 4:
             {
-                bitsPerChannel = 32;
-                page_compression = COMPRESSION_NONE;
+                cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGRA2RGBA);
                 break;
             }
-            case CV_64F:
+
+            default:
             {
-                bitsPerChannel = 64;
-                page_compression = COMPRESSION_NONE;
-                break;
+                CV_Assert(0);
             }
-            default:
+        }
+
+        CV_TIFF_CHECK_CALL(TIFFWriteScanline(tif, buffer, y0 + y, 0) == 1);
+    }
+}
+
+/** Compresses groups of strips of the image concurrently. Each group is written by libtiff to an in-memory TIFF
+ with the same tags; as every strip is encoded independently, its compressed strips are the ones libtiff would
+ produce for the whole image. */
+class TiffStripEncoder : public ParallelLoopBody
+{
+public:
+    TiffStripEncoder(TiffEncoder& encoder, const Mat& img, const std::vector<int>& params,
+                     int rows_per_strip, int ngroups, std::vector<std::vector<uchar> >& strips)
+        : encoder_(encoder), img_(img), params_(params),
+          rows_per_strip_(rows_per_strip), ngroups_(ngroups), strips_(strips)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int nstrips = (int)strips_.size();
+        for (int g = range.start; g < range.end; g++)
+        {
+            const int s0 = (int)((int64)nstrips * g / ngroups_), s1 = (int)((int64)nstrips * (g + 1) / ngroups_);
+            const int y0 = s0 * rows_per_strip_, y1 = std::min(s1 * rows_per_strip_, img_.rows);
+
+            std::vector<uchar> buf;
+            TiffEncoderBufHelper buf_helper(&buf);
+            TIFF* tif = buf_helper.open();
+            CV_Assert(tif);
+            cv::Ptr<void> tif_cleanup(tif, cv_tiffCloseHandle);
+
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, img_.cols));
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, y1 - y0));
+            CV_Assert(encoder_.writePageTags(tif, img_.cols, y1 - y0, img_.type(), params_));
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rows_per_strip_));
+            encoder_.writeScanlines(tif, img_.rowRange(y0, y1), 0);
+            CV_TIFF_CHECK_CALL(TIFFFlushData(tif));
+
+            toff_t* strip_offsets = NULL;
+            toff_t* strip_sizes = NULL;
+            CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &strip_offsets));
+            CV_TIFF_CHECK_CALL(TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &strip_sizes));
+            CV_Assert(strip_offsets && strip_sizes && (int)TIFFNumberOfStrips(tif) == s1 - s0);
+            for (int s = s0; s < s1; s++)
             {
-                return false;
+                const size_t offset = (size_t)strip_offsets[s - s0], size = (size_t)strip_sizes[s - s0];
+                CV_Assert(offset + size <= buf.size());
+                strips_[s].assign(buf.begin() + offset, buf.begin() + offset + size);
             }
         }
+    }
 
-        const int bitsPerByte = 8;
-        size_t fileStep = (width * channels * bitsPerChannel) / bitsPerByte;
-        CV_Assert(fileStep > 0);
+private:
+    TiffEncoder& encoder_;
+    const Mat& img_;
+    const std::vector<int>& params_;
+    int rows_per_strip_;
+    int ngroups_;
+    std::vector<std::vector<uchar> >& strips_;
+};
 
-        int rowsPerStrip = (int)((1 << 13) / fileStep);
-        readParam(params, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
-        rowsPerStrip = std::max(1, std::min(height, rowsPerStrip));
+bool TiffEncoder::writeStripsParallel(void* tif_, const Mat& img, const std::vector<int>& params)
+{
+    TIFF* tif = (TIFF*)tif_;
+    int threads = 0;
+    readParam(params, IMWRITE_TIFF_THREADS, threads);
+    if (threads < 0)
+        threads = getNumThreads();
+
+    // the other schemes either aren't worth it or share state between strips (JPEG tables)
+    uint16 compression = COMPRESSION_NONE;
+    uint32 rows_per_strip = 0;
+    if (threads <= 1 ||
+        !TIFFGetField(tif, TIFFTAG_COMPRESSION, &compression) ||
+        (compression != COMPRESSION_LZW && compression != COMPRESSION_ADOBE_DEFLATE &&
+         compression != COMPRESSION_DEFLATE && compression != COMPRESSION_PACKBITS) ||
+        !TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip) || rows_per_strip == 0)
+        return false;
 
-        int colorspace = channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK;
+    const int nstrips = (int)((img.rows + (int64)rows_per_strip - 1) / rows_per_strip);
+    const int ngroups = std::min(threads, nstrips);
+    if (ngroups < 2)
+        return false;
 
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_COMPRESSION, page_compression));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, colorspace));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG));
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip));
+    std::vector<std::vector<uchar> > strips(nstrips);
+    parallel_for_(Range(0, ngroups), TiffStripEncoder(*this, img, params, (int)rows_per_strip, ngroups, strips), ngroups);
 
-        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, depth >= CV_32F ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT));
+    for (int s = 0; s < nstrips; s++)
+    {
+        std::vector<uchar>& strip = strips[s];
+        CV_TIFF_CHECK_CALL(TIFFWriteRawStrip(tif, s, strip.empty() ? NULL : &strip[0], (tmsize_t)strip.size()) != (tmsize_t)-1);
+        std::vector<uchar>().swap(strip);
+    }
+    return true;
+}
 
-        if (page_compression != COMPRESSION_NONE)
-        {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor));
-        }
+bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
+{
+    TiffEncoderBufHelper buf_helper(m_buf);
+    TIFF* tif = (TIFF*)open(buf_helper);
+    if (!tif)
+    {
+        return false;
+    }
+    cv::Ptr<void> tif_cleanup(tif, cv_tiffCloseHandle);
 
-        if (resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER)
-        {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit));
-        }
-        if (dpiX >= 0)
+    //Iterate through each image in the vector and write them out as Tiff directories
+    for (size_t page = 0; page < img_vec.size(); page++)
+    {
+        const Mat& img = img_vec[page];
+        CV_Assert(!img.empty());
+        int channels = img.channels();
+        int width = img.cols, height = img.rows;
+        int type = img.type();
+        int depth = CV_MAT_DEPTH(type);
+        CV_CheckType(type, depth == CV_8U || depth == CV_16U || depth == CV_32F || depth == CV_64F, "");
+        CV_CheckType(type, channels >= 1 && channels <= 4, "");
+
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width));
+        CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height));
+
+        if (img_vec.size() > 1)
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_XRESOLUTION, (float)dpiX));
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_SUBFILETYPE, FILETYPE_PAGE));
+            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_PAGENUMBER, page, img_vec.size()));
         }
-        if (dpiY >= 0)
+
+        int compression_param = -1;  // OPENCV_FUTURE
+        if (type == CV_32FC3 && (!readParam(params, IMWRITE_TIFF_COMPRESSION, compression_param) || compression_param == COMPRESSION_SGILOG))
         {
-            CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_YRESOLUTION, (float)dpiY));
+            if (!write_32FC3_SGILOG(img, tif))
+                return false;
+            continue;
         }
 
-        // row buffer, because TIFFWriteScanline modifies the original data!
-        size_t scanlineSize = TIFFScanlineSize(tif);
-        AutoBuffer<uchar> _buffer(scanlineSize + 32);
-        uchar* buffer = _buffer.data(); CV_DbgAssert(buffer);
-        Mat m_buffer(Size(width, 1), CV_MAKETYPE(depth, channels), buffer, (size_t)scanlineSize);
+        if (!writePageTags(tif, width, height, type, params))
+            return false;
 
-        for (int y = 0; y < height; ++y)
-        {
-            switch (channels)
-            {
-                case 1:
-                {
-                    memcpy(buffer, img.ptr(y), scanlineSize);
-                    break;
-                }
+        if (!writeStripsParallel(tif, img, params))
+            writeScanlines(tif, img, 0);
 
-                case 3:
-                {
-                    cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGR2RGB);
-                    break;
-                }
+        CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+    }
 
-                case 4:
-                {
-                    cvtColor(img(Rect(0, y, width, 1)), (const Mat&)m_buffer, COLOR_BGRA2RGBA);
-                    break;
-                }
+    return true;
+}
 
-                default:
-                {
-                    CV_Assert(0);
-                }
-            }
+bool TiffEncoder::startWriteRows( const Size& size, int type, const std::vector<int>& params )
+{
+    int channels = CV_MAT_CN(type);
+    int depth = CV_MAT_DEPTH(type);
+    CV_CheckType(type, depth == CV_8U || depth == CV_16U || depth == CV_32F || depth == CV_64F, "");
+    CV_CheckType(type, channels >= 1 && channels <= 4, "");
 
-            CV_TIFF_CHECK_CALL(TIFFWriteScanline(tif, buffer, y, 0) == 1);
-        }
+    // LogLuv encoding converts whole images
+    int compression_param = -1;
+    if (type == CV_32FC3 && (!readParam(params, IMWRITE_TIFF_COMPRESSION, compression_param) || compression_param == COMPRESSION_SGILOG))
+        return false;
 
-        CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+    m_tif.release();
+    m_buf_helper.reset(new TiffEncoderBufHelper(m_buf));
+    TIFF* tif = (TIFF*)open(*m_buf_helper);
+    if (!tif)
+        return false;
+    m_tif.reset(tif, cv_tiffCloseHandle);
+
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, size.width));
+    CV_TIFF_CHECK_CALL(TIFFSetField(tif, TIFFTAG_IMAGELENGTH, size.height));
+    if (!writePageTags(tif, size.width, size.height, type, params))
+    {
+        m_tif.release();
+        return false;
     }
+    m_row = 0;
+    m_height = size.height;
+    return true;
+}
 
+bool TiffEncoder::writeRows( const Mat& band )
+{
+    CV_Assert(!m_tif.empty());
+    CV_Assert(m_row + band.rows <= m_height);
+    TIFF* tif = (TIFF*)m_tif.get();
+
+    writeScanlines(tif, band, m_row);
+    m_row += band.rows;
+
+    if (m_row == m_height)
+    {
+        CV_TIFF_CHECK_CALL(TIFFWriteDirectory(tif));
+        m_tif.release();
+    }
     return true;
 }
 
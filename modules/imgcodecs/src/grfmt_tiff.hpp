@@ -97,9 +97,15 @@ public:
     virtual ~TiffDecoder() CV_OVERRIDE;
 
     bool  readHeader() CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  startReadRows( int type ) CV_OVERRIDE;
+    bool  readRows( Mat& band ) CV_OVERRIDE;
+    bool  getDataLayout( int type, size_t& offset, size_t& step ) const CV_OVERRIDE;
     void  close();
     bool  nextPage() CV_OVERRIDE;
+    int   pageCount() CV_OVERRIDE;
+    bool  setPage( int index ) CV_OVERRIDE;
 
     size_t signatureLength() const CV_OVERRIDE;
     bool checkSignature( const String& signature ) const CV_OVERRIDE;
@@ -108,14 +114,21 @@ public:
 protected:
     cv::Ptr<void> m_tif;
     int normalizeChannelsNumber(int channels) const;
+    bool readRegion( Mat& img, const Rect& roi );
     bool m_hdr;
     size_t m_buf_pos;
+    int m_row;     // next row of the image (region) to decode by readRows
+    Mat m_rows;    // last row of strips (tiles) decoded by readRows
+    int m_rows_y;
 
 private:
     TiffDecoder(const TiffDecoder &); // copy disabled
     TiffDecoder& operator=(const TiffDecoder &); // assign disabled
 };
 
+class TiffEncoderBufHelper;
+class TiffStripEncoder;
+
 // ... and writer
 class TiffEncoder CV_FINAL : public BaseImageEncoder
 {
@@ -129,6 +142,9 @@ public:
 
     bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params) CV_OVERRIDE;
 
+    bool  startWriteRows( const Size& size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& band ) CV_OVERRIDE;
+
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
@@ -136,12 +152,23 @@ protected:
                     TiffFieldType fieldType,
                     int count, int value );
 
+    void* open( TiffEncoderBufHelper& buf_helper );
+    bool writePageTags( void* tif, int width, int height, int type, const std::vector<int>& params );
+    void writeScanlines( void* tif, const Mat& img, int y0 );
+    bool writeStripsParallel( void* tif, const Mat& img, const std::vector<int>& params );
     bool writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params );
     bool write_32FC3_SGILOG(const Mat& img, void* tif);
 
+    cv::Ptr<TiffEncoderBufHelper> m_buf_helper;
+    cv::Ptr<void> m_tif;  // image written by writeRows, closed before m_buf_helper is destroyed
+    int m_row;
+    int m_height;
+
 private:
     TiffEncoder(const TiffEncoder &); // copy disabled
     TiffEncoder& operator=(const TiffEncoder &); // assign disabled
+
+    friend class TiffStripEncoder;
 };
 
 }
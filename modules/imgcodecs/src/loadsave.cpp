@@ -52,7 +52,10 @@
 #include <iostream>
 #include <fstream>
 #include <cerrno>
+#include <map>
+#include <atomic>
 #include <opencv2/core/utils/logger.hpp>
+#include <opencv2/core/utils/tls.hpp>
 #include <opencv2/core/utils/configuration.private.hpp>
 
 
@@ -78,6 +81,37 @@ static Size validateInputImageSize(const Size& size)
     return size;
 }
 
+static inline int calcType(int type, int flags)
+{
+    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
+    {
+        if( (flags & IMREAD_ANYDEPTH) == 0 )
+            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+
+        if( (flags & IMREAD_COLOR) != 0 ||
+           ((flags & IMREAD_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+        else
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    }
+    return type;
+}
+
+static inline int calcScaleDenom(int flags)
+{
+    int scale_denom = 1;
+    if( flags > IMREAD_LOAD_GDAL )
+    {
+        if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
+            scale_denom = 2;
+        else if( flags & IMREAD_REDUCED_GRAYSCALE_4 )
+            scale_denom = 4;
+        else if( flags & IMREAD_REDUCED_GRAYSCALE_8 )
+            scale_denom = 8;
+    }
+    return scale_denom;
+}
+
 
 namespace {
 
@@ -195,6 +229,97 @@ struct ImageCodecInitializer
 
 static ImageCodecInitializer codecs;
 
+/**
+ * Codec instance kept by a thread to serve the next image of the same format
+*/
+template<typename Codec>
+struct CodecSlot
+{
+    CodecSlot() : idle(true) {}
+
+    Ptr<Codec> codec;       // empty until first use, or after the codec refused reset()
+    std::atomic<bool> idle; // false while a caller holds the codec
+};
+
+/**
+ * Deleter of the pointers handed out by acquireCodec(): resets the codec and gives it back to its slot.
+ * It may run on another thread than the owner of the slot, which doesn't touch a busy slot.
+*/
+template<typename Codec>
+struct CodecSlotReleaser
+{
+    Ptr<CodecSlot<Codec> > slot;
+
+    void operator()( Codec* ) const
+    {
+        bool reusable = false;
+        try
+        {
+            reusable = slot->codec->reset();
+        }
+        catch (...)
+        {
+        }
+        if( !reusable )
+            slot->codec.release();
+        slot->idle = true;
+    }
+};
+
+struct CodecCache
+{
+    std::map<const BaseImageDecoder*, Ptr<CodecSlot<BaseImageDecoder> > > decoders;
+    std::map<const BaseImageEncoder*, Ptr<CodecSlot<BaseImageEncoder> > > encoders;
+};
+
+static TLSData<CodecCache>& getCodecCache()
+{
+    static TLSData<CodecCache>* cache = new TLSData<CodecCache>();
+    return *cache;
+}
+
+/**
+ * Get an instance of the registered codec, reusing the one the calling thread used for the previous
+ * image of this format (so that e.g. libjpeg state and scratch buffers are not allocated again).
+ *
+ * @param[in] slots Cached instances of the thread, by registered codec
+ * @param[in] prototype Registered codec
+ * @param[in] create Factory of the codec (newDecoder() or newEncoder())
+*/
+template<typename Codec>
+static Ptr<Codec> acquireCodec( std::map<const Codec*, Ptr<CodecSlot<Codec> > >& slots,
+                                const Ptr<Codec>& prototype, Ptr<Codec> (Codec::*create)() const )
+{
+    Ptr<CodecSlot<Codec> >& slot = slots[prototype.get()];
+    if( !slot )
+        slot.reset(new CodecSlot<Codec>());
+
+    // the cached instance is still used, e.g. by an ImageReader
+    if( !slot->idle )
+        return ((*prototype).*create)();
+
+    if( !slot->codec )
+    {
+        slot->codec = ((*prototype).*create)();
+        if( !slot->codec )
+            return Ptr<Codec>();
+    }
+    slot->idle = false;
+    CodecSlotReleaser<Codec> releaser;
+    releaser.slot = slot;
+    return Ptr<Codec>(slot->codec.get(), releaser);
+}
+
+static ImageDecoder acquireDecoder( const ImageDecoder& prototype )
+{
+    return acquireCodec( getCodecCache().getRef().decoders, prototype, &BaseImageDecoder::newDecoder );
+}
+
+static ImageEncoder acquireEncoder( const ImageEncoder& prototype )
+{
+    return acquireCodec( getCodecCache().getRef().encoders, prototype, &BaseImageEncoder::newEncoder );
+}
+
 /**
  * Find the decoders
  *
@@ -230,20 +355,17 @@ static ImageDecoder findDecoder( const String& filename ) {
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return acquireDecoder(codecs.decoders[i]);
     }
 
     /// If no decoder was found, return base type
     return ImageDecoder();
 }
 
-static ImageDecoder findDecoder( const Mat& buf )
+static String readSignature( const Mat& buf )
 {
     size_t i, maxlen = 0;
 
-    if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
-        return ImageDecoder();
-
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         size_t len = codecs.decoders[i]->signatureLength();
@@ -254,16 +376,40 @@ static ImageDecoder findDecoder( const Mat& buf )
     size_t bufSize = buf.rows*buf.cols*buf.elemSize();
     maxlen = std::min(maxlen, bufSize);
     memcpy( (void*)signature.c_str(), buf.data, maxlen );
+    return signature;
+}
 
-    for( i = 0; i < codecs.decoders.size(); i++ )
+/**
+ * Find the registered codec matching the signature
+ *
+ * @param[in] signature Leading bytes of the image data, see readSignature()
+ * @param[in] hint Codec to probe first (e.g. the one which matched the previous buffer), may be empty
+ *
+ * @return Registered codec (use acquireDecoder() to get a decoder instance) or empty pointer.
+*/
+static ImageDecoder findDecoderPrototype( const String& signature, const ImageDecoder& hint = ImageDecoder() )
+{
+    if( hint && hint->checkSignature(signature) )
+        return hint;
+
+    for( size_t i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return codecs.decoders[i];
     }
 
     return ImageDecoder();
 }
 
+static ImageDecoder findDecoder( const Mat& buf )
+{
+    if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
+        return ImageDecoder();
+
+    ImageDecoder prototype = findDecoderPrototype( readSignature(buf) );
+    return prototype ? acquireDecoder(prototype) : ImageDecoder();
+}
+
 static ImageEncoder findEncoder( const String& _ext )
 {
     if( _ext.size() <= 1 )
@@ -295,7 +441,7 @@ static ImageEncoder findEncoder( const String& _ext )
                     break;
             }
             if( j == len && !isalnum(descr[j]))
-                return codecs.encoders[i]->newEncoder();
+                return acquireEncoder(codecs.encoders[i]);
             descr += j;
         }
     }
@@ -341,29 +487,38 @@ static void ExifTransform(int orientation, Mat& img)
     }
 }
 
-static void ApplyExifOrientation(const String& filename, Mat& img)
+static int readExifOrientation(std::istream& stream)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
-    if (filename.size() > 0)
+    ExifReader reader( stream );
+    if( reader.parse() )
     {
-        std::ifstream stream( filename.c_str(), std::ios_base::in | std::ios_base::binary );
-        ExifReader reader( stream );
-        if( reader.parse() )
+        ExifEntry_t entry = reader.getTag( ORIENTATION );
+        if (entry.tag != INVALID_TAG)
         {
-            ExifEntry_t entry = reader.getTag( ORIENTATION );
-            if (entry.tag != INVALID_TAG)
-            {
-                orientation = entry.field_u16; //orientation is unsigned short, so check field_u16
-            }
+            orientation = entry.field_u16; //orientation is unsigned short, so check field_u16
         }
+    }
+
+    return orientation;
+}
+
+static int getExifOrientation(const String& filename)
+{
+    int orientation = IMAGE_ORIENTATION_TL;
+
+    if (filename.size() > 0)
+    {
+        std::ifstream stream( filename.c_str(), std::ios_base::in | std::ios_base::binary );
+        orientation = readExifOrientation( stream );
         stream.close();
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
 }
 
-static void ApplyExifOrientation(const Mat& buf, Mat& img)
+static int getExifOrientation(const Mat& buf)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -371,18 +526,82 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
     {
         ByteStreamBuffer bsb( reinterpret_cast<char*>(buf.data), buf.total() * buf.elemSize() );
         std::istream stream( &bsb );
-        ExifReader reader( stream );
-        if( reader.parse() )
-        {
-            ExifEntry_t entry = reader.getTag( ORIENTATION );
-            if (entry.tag != INVALID_TAG)
-            {
-                orientation = entry.field_u16; //orientation is unsigned short, so check field_u16
-            }
-        }
+        orientation = readExifOrientation( stream );
+    }
+
+    return orientation;
+}
+
+static void ApplyExifOrientation(const String& filename, Mat& img)
+{
+    ExifTransform(getExifOrientation(filename), img);
+}
+
+static void ApplyExifOrientation(const Mat& buf, Mat& img)
+{
+    ExifTransform(getExifOrientation(buf), img);
+}
+
+/**
+ * Map a region of the image transformed by ExifTransform() back to the stored image
+ *
+ * @param[in] orientation EXIF orientation of the stored image
+ * @param[in] roi Region of the transformed image
+ * @param[in] size Size of the stored image
+*/
+static Rect exifSourceRect(int orientation, const Rect& roi, const Size& size)
+{
+    switch( orientation )
+    {
+        case    IMAGE_ORIENTATION_TR:
+            return Rect(size.width - roi.x - roi.width, roi.y, roi.width, roi.height);
+        case    IMAGE_ORIENTATION_BR:
+            return Rect(size.width - roi.x - roi.width, size.height - roi.y - roi.height, roi.width, roi.height);
+        case    IMAGE_ORIENTATION_BL:
+            return Rect(roi.x, size.height - roi.y - roi.height, roi.width, roi.height);
+        case    IMAGE_ORIENTATION_LT:
+            return Rect(roi.y, roi.x, roi.height, roi.width);
+        case    IMAGE_ORIENTATION_RT:
+            return Rect(roi.y, size.height - roi.x - roi.width, roi.height, roi.width);
+        case    IMAGE_ORIENTATION_RB:
+            return Rect(size.width - roi.y - roi.height, size.height - roi.x - roi.width, roi.height, roi.width);
+        case    IMAGE_ORIENTATION_LB:
+            return Rect(size.width - roi.y - roi.height, roi.x, roi.height, roi.width);
+        default:
+            return roi;
     }
+}
 
-    ExifTransform(orientation, img);
+/**
+ * Prepare reading of a region of the resulting image (after reduction and EXIF orientation)
+ *
+ * @param[in] decoder Decoder which has read the header
+ * @param[in] roi Region of the resulting image, clipped to the image
+ * @param[in] orientation EXIF orientation of the image
+ * @param[in] resize_denom Reduction applied after reading the data, 1 if none
+ * @param[in,out] size Size of the image to read, set to the region size if the decoder crops natively
+ * @param[out] crop Region to crop out of the read and reduced image, empty if the decoder crops natively
+ *
+ * @return false if the region doesn't intersect the image
+*/
+static bool setupROI(BaseImageDecoder& decoder, const Rect& roi, int orientation, int resize_denom,
+                     Size& size, Rect& crop)
+{
+    Size stored_size(size.width / resize_denom, size.height / resize_denom);
+    bool transposed = orientation >= IMAGE_ORIENTATION_LT && orientation <= IMAGE_ORIENTATION_LB;
+    Rect bounds(0, 0, transposed ? stored_size.height : stored_size.width,
+                      transposed ? stored_size.width : stored_size.height);
+    Rect region = roi & bounds;
+    if( region.empty() )
+        return false;
+
+    crop = exifSourceRect(orientation, region, stored_size);
+    if( resize_denom == 1 && decoder.setROI(crop) )
+    {
+        size = crop.size();
+        crop = Rect();
+    }
+    return true;
 }
 
 /**
@@ -395,10 +614,11 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
  *                      LOAD_MAT=2
  *                    }
  * @param[in] mat Reference to C++ Mat object (If LOAD_MAT)
+ * @param[in] roi Optional region of the image to read, EXIF orientation is applied to it in that case
  *
 */
 static bool
-imread_( const String& filename, int flags, Mat& mat )
+imread_( const String& filename, int flags, Mat& mat, const Rect* roi = NULL )
 {
     /// Search for the relevant decoder to handle the imagery
     ImageDecoder decoder;
@@ -418,16 +638,7 @@ imread_( const String& filename, int flags, Mat& mat )
         return 0;
     }
 
-    int scale_denom = 1;
-    if( flags > IMREAD_LOAD_GDAL )
-    {
-        if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
-            scale_denom = 2;
-        else if( flags & IMREAD_REDUCED_GRAYSCALE_4 )
-            scale_denom = 4;
-        else if( flags & IMREAD_REDUCED_GRAYSCALE_8 )
-            scale_denom = 8;
-    }
+    int scale_denom = calcScaleDenom(flags);
 
     /// set the scale_denom in the driver
     decoder->setScale( scale_denom );
@@ -457,17 +668,31 @@ imread_( const String& filename, int flags, Mat& mat )
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
     // grab the decoded type
-    int type = decoder->type();
-    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
+    int type = calcType(decoder->type(), flags);
+
+    // decoders reducing the image natively reset the scale in readHeader (see JpegDecoder)
+    bool resize_after = decoder->setScale( scale_denom ) > 1;
+
+    int orientation = IMAGE_ORIENTATION_TL;
+    Rect crop;
+    if( roi )
     {
-        if( (flags & IMREAD_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+        if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+            orientation = getExifOrientation(filename);
+        if( !setupROI(*decoder, *roi, orientation, resize_after ? scale_denom : 1, size, crop) )
+            return false;
+    }
 
-        if( (flags & IMREAD_COLOR) != 0 ||
-           ((flags & IMREAD_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    // IMREAD_UNCHANGED (-1) has all the bits set, so it doesn't request mapping
+    if( (flags & IMREAD_MMAP) != 0 && flags != IMREAD_UNCHANGED && !roi && scale_denom == 1 )
+    {
+        size_t offset = 0, step = 0;
+        if( decoder->getDataLayout(type, offset, step) )
+        {
+            mat = mapImageFile(filename, offset, size, type, step);
+            if( !mat.empty() )
+                return true;
+        }
     }
 
     mat.create( size.height, size.width, type );
@@ -493,39 +718,96 @@ imread_( const String& filename, int flags, Mat& mat )
         return false;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( resize_after )
     {
         resize( mat, mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
 
+    if( !crop.empty() )
+        mat = mat(crop).clone();
+    if( roi )
+        ExifTransform(orientation, mat);
+
     return true;
 }
 
 
+static ImageDecoder findMultiPageDecoder(const String& filename, int flags)
+{
+#ifdef HAVE_GDAL
+    if (flags != IMREAD_UNCHANGED && (flags & IMREAD_LOAD_GDAL) == IMREAD_LOAD_GDAL)
+        return GdalDecoder().newDecoder();
+#else
+    CV_UNUSED(flags);
+#endif
+    return findDecoder(filename);
+}
+
+/**
+* Decode the current page of a multi-page image, the header of the page must have been read
+*
+* @param[in] decoder Decoder positioned on the page
+* @param[in] filename File to load, used for the EXIF orientation and messages
+* @param[in] flags Flags
+* @param[out] mat Decoded page
+*
+*/
+static bool readPage_(BaseImageDecoder& decoder, const String& filename, int flags, Mat& mat)
+{
+    // grab the decoded type
+    int type = calcType(decoder.type(), flags);
+
+    // established the required input image size
+    Size size = validateInputImageSize(Size(decoder.width(), decoder.height()));
+
+    // read the image data
+    mat.create(size.height, size.width, type);
+    bool success = false;
+    try
+    {
+        if (decoder.readData(mat))
+            success = true;
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "imreadmulti_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "imreadmulti_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+    }
+    if (!success)
+    {
+        mat.release();
+        return false;
+    }
+
+    // optionally rotate the data if EXIF' orientation flag says so
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    {
+        ApplyExifOrientation(filename, mat);
+    }
+    return true;
+}
+
 /**
 * Read an image into memory and return the information
 *
 * @param[in] filename File to load
 * @param[in] flags Flags
 * @param[in] mats Reference to C++ vector<Mat> object to hold the images
+* @param[in] start Index of the first page to load
+* @param[in] count Number of pages to load, negative to load all pages from start
 *
 */
 static bool
-imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
+imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats, int start = 0, int count = -1)
 {
-    /// Search for the relevant decoder to handle the imagery
-    ImageDecoder decoder;
+    if (start < 0 || count == 0)
+        return false;
 
-#ifdef HAVE_GDAL
-    if (flags != IMREAD_UNCHANGED && (flags & IMREAD_LOAD_GDAL) == IMREAD_LOAD_GDAL){
-        decoder = GdalDecoder().newDecoder();
-    }
-    else{
-#endif
-        decoder = findDecoder(filename);
-#ifdef HAVE_GDAL
-    }
-#endif
+    /// Search for the relevant decoder to handle the imagery
+    ImageDecoder decoder = findMultiPageDecoder(filename, flags);
 
     /// if no decoder was found, return nothing.
     if (!decoder){
@@ -541,6 +823,9 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
         // read the header to make sure it succeeds
         if( !decoder->readHeader() )
             return 0;
+        // skip to the first requested page without decoding the previous ones
+        if( start > 0 && !decoder->setPage(start) )
+            return 0;
     }
     catch (const cv::Exception& e)
     {
@@ -553,58 +838,23 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
         return 0;
     }
 
+    size_t first = mats.size();
     for (;;)
     {
-        // grab the decoded type
-        int type = decoder->type();
-        if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-        {
-            if ((flags & IMREAD_ANYDEPTH) == 0)
-                type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-            if ((flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-                ((flags & IMREAD_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1))
-                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-            else
-                type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-        }
-
-        // established the required input image size
-        Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
-
-        // read the image data
-        Mat mat(size.height, size.width, type);
-        bool success = false;
-        try
-        {
-            if (decoder->readData(mat))
-                success = true;
-        }
-        catch (const cv::Exception& e)
-        {
-            std::cerr << "imreadmulti_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
-        }
-        catch (...)
-        {
-            std::cerr << "imreadmulti_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
-        }
-        if (!success)
+        Mat mat;
+        if (!readPage_(*decoder, filename, flags, mat))
             break;
 
-        // optionally rotate the data if EXIF' orientation flag says so
-        if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
-        {
-            ApplyExifOrientation(filename, mat);
-        }
-
         mats.push_back(mat);
+        if (count > 0 && (int)(mats.size() - first) >= count)
+            break;
         if (!decoder->nextPage())
         {
             break;
         }
     }
 
-    return !mats.empty();
+    return mats.size() > first;
 }
 
 /**
@@ -635,6 +885,15 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imread( const String& filename, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat img;
+    imread_( filename, flags, img, &roi );
+    return img;
+}
+
 /**
 * Read a multi-page image
 *
@@ -652,18 +911,168 @@ bool imreadmulti(const String& filename, std::vector<Mat>& mats, int flags)
     return imreadmulti_(filename, flags, mats);
 }
 
-static bool imwrite_( const String& filename, const std::vector<Mat>& img_vec,
-                      const std::vector<int>& params, bool flipv )
+bool imreadmulti(const String& filename, std::vector<Mat>& mats, int start, int count, int flags)
 {
-    bool isMultiImg = img_vec.size() > 1;
-    std::vector<Mat> write_vec;
+    CV_TRACE_FUNCTION();
 
-    ImageEncoder encoder = findEncoder( filename );
-    if( !encoder )
-        CV_Error( Error::StsError, "could not find a writer for the specified extension" );
+    return imreadmulti_(filename, flags, mats, start, count);
+}
 
-    for (size_t page = 0; page < img_vec.size(); page++)
-    {
+class ImageCollection::Impl
+{
+public:
+    Impl() : flags(IMREAD_ANYCOLOR), count(0), current(-1) {}
+
+    // positions the decoder on the page and reads its header
+    bool seek(int index)
+    {
+        if (index == current)
+            return true;
+        current = -1;
+        if (decoder && decoder->setPage(index))
+        {
+            current = index;
+            return true;
+        }
+        if (index != 0)
+            return false;
+
+        // decoders that can't seek are opened again for the first page
+        decoder = findMultiPageDecoder(filename, flags);
+        if (!decoder)
+            return false;
+        decoder->setSource(filename);
+        if (!decoder->readHeader())
+            return false;
+        current = 0;
+        return true;
+    }
+
+    ImageDecoder decoder;
+    String filename;
+    int flags;
+    int count;
+    int current; // page whose header has been read, -1 after its data has been decoded
+};
+
+ImageCollection::ImageCollection()
+{
+}
+
+ImageCollection::ImageCollection( const String& filename, int flags )
+{
+    open(filename, flags);
+}
+
+ImageCollection::~ImageCollection()
+{
+}
+
+bool ImageCollection::open( const String& filename, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    release();
+
+    Ptr<Impl> impl(new Impl);
+    impl->filename = filename;
+    impl->flags = flags;
+    impl->decoder = findMultiPageDecoder(filename, flags);
+    if (!impl->decoder)
+        return false;
+    impl->decoder->setSource(filename);
+    try
+    {
+        if (!impl->decoder->readHeader())
+            return false;
+        impl->count = impl->decoder->pageCount();
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "ImageCollection::open('" << filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+        return false;
+    }
+    catch (...)
+    {
+        std::cerr << "ImageCollection::open('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+        return false;
+    }
+    if (impl->count <= 0)
+        return false;
+    impl->current = 0;
+    p = impl;
+    return true;
+}
+
+bool ImageCollection::isOpened() const
+{
+    return !p.empty();
+}
+
+void ImageCollection::release()
+{
+    p.release();
+}
+
+int ImageCollection::size() const
+{
+    return p ? p->count : 0;
+}
+
+bool ImageCollection::read( int index, OutputArray _page )
+{
+    CV_TRACE_FUNCTION();
+
+    _page.release();
+    if (!p || index < 0 || index >= p->count)
+        return false;
+
+    bool positioned = false;
+    try
+    {
+        positioned = p->seek(index);
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "ImageCollection::read('" << p->filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "ImageCollection::read('" << p->filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+    }
+    if (!positioned)
+    {
+        p->current = -1;
+        return false;
+    }
+
+    Mat page;
+    p->current = -1;
+    if (!readPage_(*p->decoder, p->filename, p->flags, page))
+        return false;
+    _page.assign(page);
+    return true;
+}
+
+Mat ImageCollection::at( int index )
+{
+    Mat page;
+    read(index, page);
+    return page;
+}
+
+static bool imwrite_( const String& filename, const std::vector<Mat>& img_vec,
+                      const std::vector<int>& params, bool flipv )
+{
+    bool isMultiImg = img_vec.size() > 1;
+    std::vector<Mat> write_vec;
+
+    ImageEncoder encoder = findEncoder( filename );
+    if( !encoder )
+        CV_Error( Error::StsError, "could not find a writer for the specified extension" );
+
+    for (size_t page = 0; page < img_vec.size(); page++)
+    {
         Mat image = img_vec[page];
         CV_Assert(!image.empty());
 
@@ -744,7 +1153,7 @@ bool imwrite( const String& filename, InputArray _img,
 }
 
 static bool
-imdecode_( const Mat& buf, int flags, Mat& mat )
+imdecode_( const Mat& buf, int flags, Mat& mat, const Rect* roi = NULL )
 {
     CV_Assert(!buf.empty());
     CV_Assert(buf.isContinuous());
@@ -757,16 +1166,7 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
     if( !decoder )
         return 0;
 
-    int scale_denom = 1;
-    if( flags > IMREAD_LOAD_GDAL )
-    {
-        if( flags & IMREAD_REDUCED_GRAYSCALE_2 )
-            scale_denom = 2;
-        else if( flags & IMREAD_REDUCED_GRAYSCALE_4 )
-            scale_denom = 4;
-        else if( flags & IMREAD_REDUCED_GRAYSCALE_8 )
-            scale_denom = 8;
-    }
+    int scale_denom = calcScaleDenom(flags);
 
     /// set the scale_denom in the driver
     decoder->setScale( scale_denom );
@@ -820,34 +1220,39 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
     // established the required input image size
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
-    int type = decoder->type();
-    if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
-    {
-        if( (flags & IMREAD_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+    int type = calcType(decoder->type(), flags);
 
-        if( (flags & IMREAD_COLOR) != 0 ||
-           ((flags & IMREAD_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-    }
+    // decoders reducing the image natively reset the scale in readHeader (see JpegDecoder)
+    bool resize_after = decoder->setScale( scale_denom ) > 1;
 
-    mat.create( size.height, size.width, type );
-
-    success = false;
-    try
-    {
-        if (decoder->readData(mat))
-            success = true;
-    }
-    catch (const cv::Exception& e)
+    int orientation = IMAGE_ORIENTATION_TL;
+    Rect crop;
+    if( roi )
     {
-        std::cerr << "imdecode_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+        if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+            orientation = getExifOrientation(buf_row);
+        if( !setupROI(*decoder, *roi, orientation, resize_after ? scale_denom : 1, size, crop) )
+            success = false;
     }
-    catch (...)
+
+    if (success)
     {
-        std::cerr << "imdecode_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+        mat.create( size.height, size.width, type );
+
+        success = false;
+        try
+        {
+            if (decoder->readData(mat))
+                success = true;
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "imdecode_('" << filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+        }
+        catch (...)
+        {
+            std::cerr << "imdecode_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+        }
     }
 
     if (!filename.empty())
@@ -864,11 +1269,16 @@ imdecode_( const Mat& buf, int flags, Mat& mat )
         return false;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( resize_after )
     {
         resize(mat, mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
 
+    if( !crop.empty() )
+        mat = mat(crop).clone();
+    if( roi )
+        ExifTransform(orientation, mat);
+
     return true;
 }
 
@@ -889,6 +1299,15 @@ Mat imdecode( InputArray _buf, int flags )
     return img;
 }
 
+Mat imdecode( InputArray _buf, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat(), img;
+    imdecode_( buf, flags, img, &roi );
+    return img;
+}
+
 Mat imdecode( InputArray _buf, int flags, Mat* dst )
 {
     CV_TRACE_FUNCTION();
@@ -906,6 +1325,202 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
+namespace {
+
+class ImdecodeBatchInvoker : public ParallelLoopBody
+{
+public:
+    ImdecodeBatchInvoker( const std::vector<Mat>& bufs, int flags, std::vector<Mat>& dst, std::vector<String>& errors )
+        : bufs_(bufs), flags_(flags), dst_(dst), errors_(errors)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        // consecutive buffers usually come from the same codec, so it is probed first
+        ImageDecoder prototype;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            try
+            {
+                errors_[i] = decode( bufs_[i], dst_[i], prototype );
+            }
+            catch (const cv::Exception& e)
+            {
+                errors_[i] = e.what();
+            }
+            catch (const std::exception& e)
+            {
+                errors_[i] = e.what();
+            }
+            catch (...)
+            {
+                errors_[i] = "unknown exception";
+            }
+            if( !errors_[i].empty() )
+                dst_[i].release();
+        }
+    }
+
+private:
+    String decode( const Mat& buf, Mat& mat, ImageDecoder& prototype ) const
+    {
+        if( buf.empty() || !buf.isContinuous() || buf.checkVector(1, CV_8U) <= 0 )
+            return "input buffer is empty, non-continuous or not CV_8U";
+        Mat buf_row = buf.reshape(1, 1);  // decoders expects single row, avoid issues with vector columns
+
+        prototype = findDecoderPrototype( readSignature(buf_row), prototype );
+        if( !prototype )
+            return "can't find decoder";
+        ImageDecoder decoder = acquireDecoder(prototype);
+        if( !decoder )
+            return "can't create decoder";
+
+        int scale_denom = calcScaleDenom(flags_);
+        decoder->setScale( scale_denom );
+
+        // no temporary file fallback, concurrent decoders would compete for the filesystem
+        if( !decoder->setSource(buf_row) )
+            return "decoder doesn't support decoding from memory";
+
+        if( !decoder->readHeader() )
+            return "can't read header";
+
+        // the output is allocated from the header, so a matrix of the same size and type is reused
+        Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+        mat.create( size.height, size.width, calcType(decoder->type(), flags_) );
+
+        if( !decoder->readData(mat) )
+            return "can't read data";
+
+        if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+        {
+            resize(mat, mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
+        }
+
+        /// optionally rotate the data if EXIF' orientation flag says so
+        if( (flags_ & IMREAD_IGNORE_ORIENTATION) == 0 && flags_ != IMREAD_UNCHANGED )
+        {
+            ApplyExifOrientation(buf_row, mat);
+        }
+        return String();
+    }
+
+    const std::vector<Mat>& bufs_;
+    int flags_;
+    std::vector<Mat>& dst_;
+    std::vector<String>& errors_;
+};
+
+}
+
+int imdecodeBatch( const std::vector<Mat>& bufs, int flags, std::vector<Mat>& dst, std::vector<String>* errors )
+{
+    CV_TRACE_FUNCTION();
+
+    int n = (int)bufs.size();
+    dst.resize(n);
+    std::vector<String> errors_(n);
+    if( n > 0 )
+        parallel_for_(Range(0, n), ImdecodeBatchInvoker(bufs, flags, dst, errors_));
+
+    int count = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        if( errors_[i].empty() )
+            count++;
+    }
+    if( errors )
+        errors->swap(errors_);
+    return count;
+}
+
+static bool readImageHeader_( BaseImageDecoder& decoder, const String& name, ImageHeader& header )
+{
+    try
+    {
+        if( !decoder.readHeader() )
+            return false;
+        header.size = Size(decoder.width(), decoder.height());
+        header.depth = CV_MAT_DEPTH(decoder.type());
+        header.channels = CV_MAT_CN(decoder.type());
+        header.pages = decoder.pageCount();
+        return true;
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "imreadHeader('" << name << "'): can't read header: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "imreadHeader('" << name << "'): can't read header: unknown exception" << std::endl << std::flush;
+    }
+    return false;
+}
+
+bool imreadHeader( const String& filename, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    header = ImageHeader();
+    ImageDecoder decoder = findDecoder( filename );
+    if( !decoder )
+        return false;
+
+    decoder->setSource( filename );
+    if( !readImageHeader_( *decoder, filename, header ) )
+    {
+        header = ImageHeader();
+        return false;
+    }
+    header.orientation = getExifOrientation( filename );
+    return true;
+}
+
+bool imdecodeHeader( InputArray _buf, ImageHeader& header )
+{
+    CV_TRACE_FUNCTION();
+
+    header = ImageHeader();
+    Mat buf = _buf.getMat();
+    CV_Assert(!buf.empty());
+    CV_Assert(buf.isContinuous());
+    CV_Assert(buf.checkVector(1, CV_8U) > 0);
+    Mat buf_row = buf.reshape(1, 1);  // decoders expects single row, avoid issues with vector columns
+
+    ImageDecoder decoder = findDecoder( buf_row );
+    if( !decoder )
+        return false;
+
+    String filename;
+    if( !decoder->setSource( buf_row ) )
+    {
+        filename = tempfile();
+        FILE* f = fopen( filename.c_str(), "wb" );
+        if( !f )
+            return false;
+        size_t bufSize = buf_row.total()*buf.elemSize();
+        bool written = fwrite(buf_row.ptr(), 1, bufSize, f) == bufSize;
+        if( fclose(f) != 0 || !written )
+        {
+            remove(filename.c_str());
+            CV_Error( Error::StsError, "failed to write image data to temporary file" );
+        }
+        decoder->setSource( filename );
+    }
+
+    bool success = readImageHeader_( *decoder, filename, header );
+    decoder.release();
+    if( !filename.empty() && 0 != remove(filename.c_str()) )
+        std::cerr << "unable to remove temporary file:" << filename << std::endl << std::flush;
+    if( !success )
+    {
+        header = ImageHeader();
+        return false;
+    }
+    header.orientation = getExifOrientation( buf_row );
+    return true;
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params )
 {
@@ -959,6 +1574,317 @@ bool imencode( const String& ext, InputArray _image,
     return code;
 }
 
+/////////////////////////// ImageReader / ImageWriter ///////////////////////////
+
+class ImageReader::Impl
+{
+public:
+    Impl() : type(-1), row(0) {}
+
+    ImageDecoder decoder; // incremental decoding, empty when the whole image has been read
+    Mat image;            // whole image when the decoder can't produce rows
+    String filename;
+    Size size;
+    int type;
+    int row;
+};
+
+ImageReader::ImageReader()
+{
+}
+
+ImageReader::ImageReader( const String& filename, int flags )
+{
+    open(filename, flags);
+}
+
+ImageReader::~ImageReader()
+{
+}
+
+bool ImageReader::open( const String& filename, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    release();
+
+    ImageDecoder decoder;
+    bool load_gdal = flags != IMREAD_UNCHANGED && (flags & IMREAD_LOAD_GDAL) == IMREAD_LOAD_GDAL;
+    if( !load_gdal )
+        decoder = findDecoder( filename );
+    if( !load_gdal && !decoder )
+        return false;
+
+    Ptr<Impl> impl(new Impl);
+    impl->filename = filename;
+    if( decoder )
+    {
+        int scale_denom = calcScaleDenom(flags);
+        decoder->setScale( scale_denom );
+        decoder->setSource( filename );
+        try
+        {
+            if( !decoder->readHeader() )
+                return false;
+
+            impl->size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+            impl->type = calcType(decoder->type(), flags);
+
+            // reduction and rotation need the whole image, these cases are handled by imread below
+            bool resize_after = decoder->setScale( scale_denom ) > 1;
+            int orientation = IMAGE_ORIENTATION_TL;
+            if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+                orientation = getExifOrientation(filename);
+            if( !resize_after && orientation == IMAGE_ORIENTATION_TL && decoder->startReadRows(impl->type) )
+                impl->decoder = decoder;
+        }
+        catch (const cv::Exception& e)
+        {
+            std::cerr << "ImageReader::open('" << filename << "'): can't read header: " << e.what() << std::endl << std::flush;
+            return false;
+        }
+        catch (...)
+        {
+            std::cerr << "ImageReader::open('" << filename << "'): can't read header: unknown exception" << std::endl << std::flush;
+            return false;
+        }
+    }
+
+    if( !impl->decoder )
+    {
+        decoder.release();
+        impl->image = imread(filename, flags);
+        if( impl->image.empty() )
+            return false;
+        impl->size = impl->image.size();
+        impl->type = impl->image.type();
+    }
+
+    p = impl;
+    return true;
+}
+
+bool ImageReader::isOpened() const
+{
+    return !p.empty();
+}
+
+void ImageReader::release()
+{
+    p.release();
+}
+
+Size ImageReader::size() const
+{
+    return p ? p->size : Size();
+}
+
+int ImageReader::type() const
+{
+    return p ? p->type : -1;
+}
+
+int ImageReader::position() const
+{
+    return p ? p->row : 0;
+}
+
+bool ImageReader::read( OutputArray _band, int maxRows )
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert( maxRows > 0 );
+
+    if( !p || p->row >= p->size.height )
+        return false;
+
+    int rows = std::min(maxRows, p->size.height - p->row);
+    if( !p->decoder )
+    {
+        p->image.rowRange(p->row, p->row + rows).copyTo(_band);
+        p->row += rows;
+        if( p->row == p->size.height )
+            p->image.release();
+        return true;
+    }
+
+    _band.create(rows, p->size.width, p->type);
+    Mat band = _band.getMat();
+    bool success = false;
+    try
+    {
+        success = p->decoder->readRows(band);
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "ImageReader::read('" << p->filename << "'): can't read data: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "ImageReader::read('" << p->filename << "'): can't read data: unknown exception" << std::endl << std::flush;
+    }
+    if( !success )
+    {
+        _band.release();
+        p->decoder.release();
+        p->row = p->size.height;
+        return false;
+    }
+
+    p->row += rows;
+    if( p->row == p->size.height )
+        p->decoder.release();
+    return true;
+}
+
+
+class ImageWriter::Impl
+{
+public:
+    Impl() : type(-1), depth(-1), streaming(false), row(0) {}
+
+    ImageEncoder encoder;
+    Mat image;            // accumulated bands when the encoder can't write rows
+    String filename;
+    std::vector<int> params;
+    Size size;
+    int type;             // type of the bands
+    int depth;            // depth passed to the encoder
+    bool streaming;
+    int row;
+};
+
+ImageWriter::ImageWriter()
+{
+}
+
+ImageWriter::ImageWriter( const String& filename, Size size, int type, const std::vector<int>& params )
+{
+    open(filename, size, type, params);
+}
+
+ImageWriter::~ImageWriter()
+{
+}
+
+bool ImageWriter::open( const String& filename, Size size, int type, const std::vector<int>& params )
+{
+    CV_TRACE_FUNCTION();
+
+    release();
+
+    CV_Assert( size.width > 0 && size.height > 0 );
+    CV_Assert( CV_MAT_CN(type) == 1 || CV_MAT_CN(type) == 3 || CV_MAT_CN(type) == 4 );
+    CV_Assert( params.size() <= CV_IO_MAX_IMAGE_PARAMS*2 );
+
+    ImageEncoder encoder = findEncoder( filename );
+    if( !encoder )
+        return false;
+
+    Ptr<Impl> impl(new Impl);
+    impl->filename = filename;
+    impl->params = params;
+    impl->size = size;
+    impl->type = type;
+    impl->depth = CV_MAT_DEPTH(type);
+    if( !encoder->isFormatSupported(impl->depth) )
+    {
+        CV_Assert( encoder->isFormatSupported(CV_8U) );
+        impl->depth = CV_8U;
+    }
+
+    encoder->setDestination( filename );
+    try
+    {
+        impl->streaming = encoder->startWriteRows(size, CV_MAKETYPE(impl->depth, CV_MAT_CN(type)), params);
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "ImageWriter::open('" << filename << "'): can't write header: " << e.what() << std::endl << std::flush;
+        return false;
+    }
+    catch (...)
+    {
+        std::cerr << "ImageWriter::open('" << filename << "'): can't write header: unknown exception" << std::endl << std::flush;
+        return false;
+    }
+    if( !impl->streaming )
+        impl->image.create(size, CV_MAKETYPE(impl->depth, CV_MAT_CN(type)));
+
+    impl->encoder = encoder;
+    p = impl;
+    return true;
+}
+
+bool ImageWriter::isOpened() const
+{
+    return !p.empty();
+}
+
+void ImageWriter::release()
+{
+    p.release();
+}
+
+int ImageWriter::position() const
+{
+    return p ? p->row : 0;
+}
+
+bool ImageWriter::write( InputArray _band )
+{
+    CV_TRACE_FUNCTION();
+
+    if( !p || !p->encoder )
+        return false;
+
+    Mat band = _band.getMat();
+    CV_Assert( band.cols == p->size.width && band.type() == p->type );
+    CV_Assert( band.rows <= p->size.height - p->row );
+    if( band.empty() )
+        return true;
+
+    Mat temp;
+    if( band.depth() != p->depth )
+    {
+        band.convertTo( temp, p->depth );
+        band = temp;
+    }
+
+    bool success = false;
+    try
+    {
+        if( p->streaming )
+            success = p->encoder->writeRows(band);
+        else
+        {
+            band.copyTo(p->image.rowRange(p->row, p->row + band.rows));
+            success = p->row + band.rows < p->size.height || p->encoder->write(p->image, p->params);
+        }
+    }
+    catch (const cv::Exception& e)
+    {
+        std::cerr << "ImageWriter::write('" << p->filename << "'): can't write data: " << e.what() << std::endl << std::flush;
+    }
+    catch (...)
+    {
+        std::cerr << "ImageWriter::write('" << p->filename << "'): can't write data: unknown exception" << std::endl << std::flush;
+    }
+    if( !success )
+    {
+        p->encoder.release();
+        p->image.release();
+        return false;
+    }
+
+    p->row += band.rows;
+    if( p->row == p->size.height )
+    {
+        p->encoder.release();
+        p->image.release();
+    }
+    return true;
+}
+
 bool haveImageReader( const String& filename )
 {
     ImageDecoder decoder = cv::findDecoder(filename);
@@ -46,6 +46,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
 
 // This file contains code to read and write four byte rgbe file format
 // developed by Greg Ward.  It handles the conversions between rgbe and
@@ -142,33 +143,105 @@ rgbe2float(float *red, float *green, float *blue, unsigned char rgbe[4])
     *red = *green = *blue = 0.0;
 }
 
+/* stream helpers mirroring fread/fwrite/fgets/fprintf on a rgbe_stream */
+void RGBE_OpenFile(rgbe_stream *s, FILE *fp)
+{
+  memset(s, 0, sizeof(*s));
+  s->fp = fp;
+}
+
+void RGBE_OpenMemoryReader(rgbe_stream *s, const unsigned char *data, size_t size)
+{
+  memset(s, 0, sizeof(*s));
+  s->src = data;
+  s->src_size = size;
+}
+
+void RGBE_OpenMemoryWriter(rgbe_stream *s, std::vector<unsigned char> *buf)
+{
+  memset(s, 0, sizeof(*s));
+  s->dst = buf;
+}
+
+/* returns 1 if all numbytes were read, 0 otherwise (like fread(p,n,1,fp)) */
+static int rgbe_read(rgbe_stream *s, void *ptr, size_t numbytes)
+{
+  if (s->fp)
+    return (int)fread(ptr, numbytes, 1, s->fp);
+  if (numbytes > s->src_size - s->src_pos)
+    return 0;
+  memcpy(ptr, s->src + s->src_pos, numbytes);
+  s->src_pos += numbytes;
+  return 1;
+}
+
+static int rgbe_write(rgbe_stream *s, const void *ptr, size_t numbytes)
+{
+  if (s->fp)
+    return (int)fwrite(ptr, numbytes, 1, s->fp);
+  if (!s->dst)
+    return 0;
+  const unsigned char *bytes = (const unsigned char *)ptr;
+  s->dst->insert(s->dst->end(), bytes, bytes + numbytes);
+  return 1;
+}
+
+static char *rgbe_gets(rgbe_stream *s, char *buf, int size)
+{
+  if (s->fp)
+    return fgets(buf, size, s->fp);
+  if (size <= 0 || s->src_pos >= s->src_size)
+    return NULL;
+  int i = 0;
+  while (i < size - 1 && s->src_pos < s->src_size) {
+    char c = (char)s->src[s->src_pos++];
+    buf[i++] = c;
+    if (c == '\n')
+      break;
+  }
+  buf[i] = 0;
+  return buf;
+}
+
+static int rgbe_printf(rgbe_stream *s, const char *fmt, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len < 0 || len >= (int)sizeof(buf))
+    return -1;
+  return rgbe_write(s, buf, (size_t)len) == 1 ? len : -1;
+}
+
 /* default minimal header. modify if you want more information in header */
-int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info)
+int RGBE_WriteHeader(rgbe_stream *s, int width, int height, rgbe_header_info *info)
 {
   const char *programtype = "RADIANCE";
 
   if (info && (info->valid & RGBE_VALID_PROGRAMTYPE))
     programtype = info->programtype;
-  if (fprintf(fp,"#?%s\n",programtype) < 0)
+  if (rgbe_printf(s,"#?%s\n",programtype) < 0)
     return rgbe_error(rgbe_write_error,NULL);
   /* The #? is to identify file type, the programtype is optional. */
   if (info && (info->valid & RGBE_VALID_GAMMA)) {
-    if (fprintf(fp,"GAMMA=%g\n",info->gamma) < 0)
+    if (rgbe_printf(s,"GAMMA=%g\n",info->gamma) < 0)
       return rgbe_error(rgbe_write_error,NULL);
   }
   if (info && (info->valid & RGBE_VALID_EXPOSURE)) {
-    if (fprintf(fp,"EXPOSURE=%g\n",info->exposure) < 0)
+    if (rgbe_printf(s,"EXPOSURE=%g\n",info->exposure) < 0)
       return rgbe_error(rgbe_write_error,NULL);
   }
-  if (fprintf(fp,"FORMAT=32-bit_rle_rgbe\n\n") < 0)
+  if (rgbe_printf(s,"FORMAT=32-bit_rle_rgbe\n\n") < 0)
     return rgbe_error(rgbe_write_error,NULL);
-  if (fprintf(fp, "-Y %d +X %d\n", height, width) < 0)
+  if (rgbe_printf(s,"-Y %d +X %d\n", height, width) < 0)
     return rgbe_error(rgbe_write_error,NULL);
   return RGBE_RETURN_SUCCESS;
 }
 
 /* minimal header reading.  modify if you want to parse more information */
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
+int RGBE_ReadHeader(rgbe_stream *s, int *width, int *height, rgbe_header_info *info)
 {
   char buf[128];
   float tempf;
@@ -181,7 +254,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
   }
 
   // 1. read first line
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == NULL)
+  if (rgbe_gets(s,buf,sizeof(buf)/sizeof(buf[0])) == NULL)
     return rgbe_error(rgbe_read_error,NULL);
   if ((buf[0] != '#')||(buf[1] != '?')) {
     /* if you want to require the magic token then uncomment the next line */
@@ -200,7 +273,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
   // 2. reading other header lines
   bool hasFormat = false;
   for(;;) {
-    if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+    if (rgbe_gets(s,buf,sizeof(buf)/sizeof(buf[0])) == 0)
       return rgbe_error(rgbe_read_error,NULL);
     if (buf[0] == '\n') // end of the header
       break;
@@ -224,7 +297,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
       return rgbe_error(rgbe_format_error, "missing FORMAT specifier");
 
   // 3. reading resolution string
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+  if (rgbe_gets(s,buf,sizeof(buf)/sizeof(buf[0])) == 0)
     return rgbe_error(rgbe_read_error,NULL);
   if (sscanf(buf,"-Y %d +X %d",height,width) < 2)
     return rgbe_error(rgbe_format_error,"missing image size specifier");
@@ -234,7 +307,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
 /* simple write routine that does not use run length encoding */
 /* These routines can be made faster by allocating a larger buffer and
    fread-ing and fwrite-ing the data in larger chunks */
-int RGBE_WritePixels(FILE *fp, float *data, int numpixels)
+int RGBE_WritePixels(rgbe_stream *s, float *data, int numpixels)
 {
   unsigned char rgbe[4];
 
@@ -242,19 +315,19 @@ int RGBE_WritePixels(FILE *fp, float *data, int numpixels)
     float2rgbe(rgbe,data[RGBE_DATA_RED],
          data[RGBE_DATA_GREEN],data[RGBE_DATA_BLUE]);
     data += RGBE_DATA_SIZE;
-    if (fwrite(rgbe, sizeof(rgbe), 1, fp) < 1)
+    if (rgbe_write(s,rgbe,sizeof(rgbe)) < 1)
       return rgbe_error(rgbe_write_error,NULL);
   }
   return RGBE_RETURN_SUCCESS;
 }
 
 /* simple read routine.  will not correctly handle run length encoding */
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels)
+int RGBE_ReadPixels(rgbe_stream *s, float *data, int numpixels)
 {
   unsigned char rgbe[4];
 
   while(numpixels-- > 0) {
-    if (fread(rgbe, sizeof(rgbe), 1, fp) < 1)
+    if (rgbe_read(s,rgbe,sizeof(rgbe)) < 1)
       return rgbe_error(rgbe_read_error,NULL);
     rgbe2float(&data[RGBE_DATA_RED],&data[RGBE_DATA_GREEN],
          &data[RGBE_DATA_BLUE],rgbe);
@@ -268,7 +341,7 @@ int RGBE_ReadPixels(FILE *fp, float *data, int numpixels)
 /* save some space.  For each scanline, each channel (r,g,b,e) is */
 /* encoded separately for better compression. */
 
-static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
+static int RGBE_WriteBytes_RLE(rgbe_stream *s, unsigned char *data, int numbytes)
 {
 #define MINRUNLENGTH 4
   int cur, beg_run, run_count, old_run_count, nonrun_count;
@@ -291,7 +364,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
     if ((old_run_count > 1)&&(old_run_count == beg_run - cur)) {
       buf[0] = static_cast<unsigned char>(128 + old_run_count);   /*write short run*/
       buf[1] = data[cur];
-      if (fwrite(buf,sizeof(buf[0])*2,1,fp) < 1)
+      if (rgbe_write(s,buf,sizeof(buf[0])*2) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur = beg_run;
     }
@@ -301,9 +374,9 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
       if (nonrun_count > 128)
   nonrun_count = 128;
       buf[0] = static_cast<unsigned char>(nonrun_count);
-      if (fwrite(buf,sizeof(buf[0]),1,fp) < 1)
+      if (rgbe_write(s,buf,sizeof(buf[0])) < 1)
   return rgbe_error(rgbe_write_error,NULL);
-      if (fwrite(&data[cur],sizeof(data[0])*nonrun_count,1,fp) < 1)
+      if (rgbe_write(s,&data[cur],sizeof(data[0])*nonrun_count) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur += nonrun_count;
     }
@@ -311,7 +384,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
     if (run_count >= MINRUNLENGTH) {
       buf[0] = static_cast<unsigned char>(128 + run_count);
       buf[1] = data[beg_run];
-      if (fwrite(buf,sizeof(buf[0])*2,1,fp) < 1)
+      if (rgbe_write(s,buf,sizeof(buf[0])*2) < 1)
   return rgbe_error(rgbe_write_error,NULL);
       cur += run_count;
     }
@@ -320,7 +393,7 @@ static int RGBE_WriteBytes_RLE(FILE *fp, unsigned char *data, int numbytes)
 #undef MINRUNLENGTH
 }
 
-int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_WritePixels_RLE(rgbe_stream *s, float *data, int scanline_width,
        int num_scanlines)
 {
   unsigned char rgbe[4];
@@ -329,17 +402,17 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
 
   if ((scanline_width < 8)||(scanline_width > 0x7fff))
     /* run length encoding is not allowed so write flat*/
-    return RGBE_WritePixels(fp,data,scanline_width*num_scanlines);
+    return RGBE_WritePixels(s,data,scanline_width*num_scanlines);
   buffer = (unsigned char *)malloc(sizeof(unsigned char)*4*scanline_width);
   if (buffer == NULL)
     /* no buffer space so write flat */
-    return RGBE_WritePixels(fp,data,scanline_width*num_scanlines);
+    return RGBE_WritePixels(s,data,scanline_width*num_scanlines);
   while(num_scanlines-- > 0) {
     rgbe[0] = 2;
     rgbe[1] = 2;
     rgbe[2] = static_cast<unsigned char>(scanline_width >> 8);
     rgbe[3] = scanline_width & 0xFF;
-    if (fwrite(rgbe, sizeof(rgbe), 1, fp) < 1) {
+    if (rgbe_write(s,rgbe,sizeof(rgbe)) < 1) {
       free(buffer);
       return rgbe_error(rgbe_write_error,NULL);
     }
@@ -355,7 +428,7 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
     /* write out each of the four channels separately run length encoded */
     /* first red, then green, then blue, then exponent */
     for(i=0;i<4;i++) {
-      if ((err = RGBE_WriteBytes_RLE(fp,&buffer[i*scanline_width],
+      if ((err = RGBE_WriteBytes_RLE(s,&buffer[i*scanline_width],
              scanline_width)) != RGBE_RETURN_SUCCESS) {
   free(buffer);
   return err;
@@ -366,7 +439,7 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
   return RGBE_RETURN_SUCCESS;
 }
 
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(rgbe_stream *s, float *data, int scanline_width,
       int num_scanlines)
 {
   unsigned char rgbe[4], *scanline_buffer, *ptr, *ptr_end;
@@ -375,11 +448,11 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
 
   if ((scanline_width < 8)||(scanline_width > 0x7fff))
     /* run length encoding is not allowed so read flat*/
-    return RGBE_ReadPixels(fp,data,scanline_width*num_scanlines);
+    return RGBE_ReadPixels(s,data,scanline_width*num_scanlines);
   scanline_buffer = NULL;
   /* read in each successive scanline */
   while(num_scanlines > 0) {
-    if (fread(rgbe,sizeof(rgbe),1,fp) < 1) {
+    if (rgbe_read(s,rgbe,sizeof(rgbe)) < 1) {
       free(scanline_buffer);
       return rgbe_error(rgbe_read_error,NULL);
     }
@@ -388,7 +461,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
       rgbe2float(&data[RGBE_DATA_RED],&data[RGBE_DATA_GREEN],&data[RGBE_DATA_BLUE],rgbe);
       data += RGBE_DATA_SIZE;
       free(scanline_buffer);
-      return RGBE_ReadPixels(fp,data,scanline_width*num_scanlines-1);
+      return RGBE_ReadPixels(s,data,scanline_width*num_scanlines-1);
     }
     if ((((int)rgbe[2])<<8 | rgbe[3]) != scanline_width) {
       free(scanline_buffer);
@@ -405,7 +478,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     for(i=0;i<4;i++) {
       ptr_end = &scanline_buffer[(i+1)*scanline_width];
       while(ptr < ptr_end) {
-  if (fread(buf,sizeof(buf[0])*2,1,fp) < 1) {
+  if (rgbe_read(s,buf,sizeof(buf[0])*2) < 1) {
     free(scanline_buffer);
     return rgbe_error(rgbe_read_error,NULL);
   }
@@ -428,7 +501,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     }
     *ptr++ = buf[1];
     if (--count > 0) {
-      if (fread(ptr,sizeof(*ptr)*count,1,fp) < 1) {
+      if (rgbe_read(s,ptr,sizeof(*ptr)*count) < 1) {
         free(scanline_buffer);
         return rgbe_error(rgbe_read_error,NULL);
       }
@@ -48,6 +48,7 @@
 // based on code written by Greg Ward
 
 #include <stdio.h>
+#include <vector>
 
 typedef struct {
   int valid;            /* indicate which fields are valid */
@@ -69,21 +70,36 @@ typedef struct {
 #define RGBE_RETURN_SUCCESS 0
 #define RGBE_RETURN_FAILURE -1
 
+/* byte stream the routines below operate on: a stdio file when fp is set,
+ * otherwise a memory block (src/src_size/src_pos) for reading or a growable
+ * vector (dst) for writing */
+typedef struct {
+  FILE *fp;
+  const unsigned char *src;
+  size_t src_size;
+  size_t src_pos;
+  std::vector<unsigned char> *dst;
+} rgbe_stream;
+
+void RGBE_OpenFile(rgbe_stream *s, FILE *fp);
+void RGBE_OpenMemoryReader(rgbe_stream *s, const unsigned char *data, size_t size);
+void RGBE_OpenMemoryWriter(rgbe_stream *s, std::vector<unsigned char> *buf);
+
 /* read or write headers */
 /* you may set rgbe_header_info to null if you want to */
-int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info);
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info);
+int RGBE_WriteHeader(rgbe_stream *s, int width, int height, rgbe_header_info *info);
+int RGBE_ReadHeader(rgbe_stream *s, int *width, int *height, rgbe_header_info *info);
 
 /* read or write pixels */
 /* can read or write pixels in chunks of any size including single pixels*/
-int RGBE_WritePixels(FILE *fp, float *data, int numpixels);
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels);
+int RGBE_WritePixels(rgbe_stream *s, float *data, int numpixels);
+int RGBE_ReadPixels(rgbe_stream *s, float *data, int numpixels);
 
 /* read or write run length encoded files */
 /* must be called to read or write whole scanlines */
-int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_WritePixels_RLE(rgbe_stream *s, float *data, int scanline_width,
        int num_scanlines);
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(rgbe_stream *s, float *data, int scanline_width,
       int num_scanlines);
 
 #endif/*_RGBE_HDR_H_*/
@@ -42,6 +42,17 @@
 #include "precomp.hpp"
 #include "utils.hpp"
 
+#if defined _WIN32 && !defined WINRT
+#include <windows.h>
+#define HAVE_MAPPED_FILES
+#elif defined __unix__ || defined __APPLE__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAVE_MAPPED_FILES
+#endif
+
 namespace cv {
 
 int validateToInt(size_t sz)
@@ -606,4 +617,120 @@ uchar* FillGrayRow1( uchar* data, uchar* indices, int len, uchar* palette )
     return data;
 }
 
+#ifdef HAVE_MAPPED_FILES
+
+namespace {
+
+/** Owns the file mappings behind the matrices returned by mapImageFile(): UMatData::origdata is the start of
+ the mapping and UMatData::size its length. The allocate() calls of Mat::create() are forwarded to the standard
+ allocator, so a mapped Mat that is reallocated gets regular memory. */
+class MappedFileAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                       size_t* step, AccessFlag flags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, AccessFlag accessFlags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return Mat::getStdAllocator()->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if( !u )
+            return;
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+#ifdef _WIN32
+        UnmapViewOfFile(u->origdata);
+#else
+        munmap(u->origdata, u->size);
+#endif
+        delete u;
+    }
+};
+
+MappedFileAllocator& getMappedFileAllocator()
+{
+    // never destroyed, mapped matrices may outlive static objects
+    static MappedFileAllocator* instance = new MappedFileAllocator();
+    return *instance;
+}
+
+}
+
+Mat mapImageFile( const String& filename, size_t offset, Size size, int type, size_t step )
+{
+    const size_t elem_size = CV_ELEM_SIZE(type);
+    if( size.width <= 0 || size.height <= 0 || step < size.width * elem_size ||
+        offset % CV_ELEM_SIZE1(type) != 0 || step % CV_ELEM_SIZE1(type) != 0 )
+        return Mat();
+    const size_t data_size = step * (size.height - 1) + size.width * elem_size;
+
+    uchar* base = NULL;
+    size_t base_offset = 0, length = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if( file == INVALID_HANDLE_VALUE )
+        return Mat();
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    if( GetFileSizeEx(file, &file_size) && offset + data_size <= (unsigned long long)file_size.QuadPart )
+        mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if( mapping )
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        base_offset = offset - offset % info.dwAllocationGranularity;
+        length = offset - base_offset + data_size;
+        base = (uchar*)MapViewOfFile(mapping, FILE_MAP_COPY, (DWORD)((unsigned long long)base_offset >> 32),
+                                     (DWORD)(base_offset & 0xffffffff), length);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if( !base )
+        return Mat();
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
+        return Mat();
+    struct stat st;
+    if( fstat(fd, &st) == 0 && offset + data_size <= (size_t)st.st_size )
+    {
+        const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+        base_offset = offset - offset % page_size;
+        length = offset - base_offset + data_size;
+        void* addr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)base_offset);
+        if( addr != MAP_FAILED )
+            base = (uchar*)addr;
+    }
+    close(fd);
+    if( !base )
+        return Mat();
+#endif
+
+    UMatData* u = new UMatData(&getMappedFileAllocator());
+    u->origdata = base;
+    u->data = base + (offset - base_offset);
+    u->size = length;
+
+    Mat m(size, type, u->data, step);
+    m.u = u;
+    m.addref();
+    return m;
+}
+
+#else
+
+Mat mapImageFile( const String&, size_t, Size, int, size_t )
+{
+    return Mat();
+}
+
+#endif
+
 }  // namespace
@@ -138,6 +138,11 @@ CV_INLINE bool  isBigEndian( void )
     return (((const int*)"\0\x1\x2\x3\x4\x5\x6\x7")[0] & 255) != 0;
 }
 
+/// Maps the image stored in the file from offset, with rows step bytes apart, into a Mat (see IMREAD_MMAP).
+/// The mapping is private (copy-on-write) and is released with the last reference to the Mat.
+/// Returns an empty Mat if the file is too short or can't be mapped.
+Mat mapImageFile( const String& filename, size_t offset, Size size, int type, size_t step );
+
 }  // namespace
 
 #endif/*_UTILS_H_*/
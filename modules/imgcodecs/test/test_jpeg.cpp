@@ -94,6 +94,41 @@ const string exif_files[] =
 INSTANTIATE_TEST_CASE_P(ExifFiles, Imgcodecs_Jpeg_Exif,
                         testing::ValuesIn(exif_files));
 
+typedef testing::TestWithParam<int> Imgcodecs_Jpeg_Exif_ROI;
+
+TEST_P(Imgcodecs_Jpeg_Exif_ROI, decode_region)
+{
+    const int orientation = GetParam();
+    Mat image(72, 120, CV_8UC3);
+    RNG rng(orientation);
+    rng.fill(image, RNG::UNIFORM, 0, 256);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", image, buf));
+
+    // insert APP1 segment with the orientation tag right after SOI
+    const uchar exif[] = {
+        0xFF, 0xE1, 0, 34, 'E', 'x', 'i', 'f', 0, 0,
+        'M', 'M', 0, 0x2A, 0, 0, 0, 8,
+        0, 1, 0x01, 0x12, 0, 3, 0, 0, 0, 1, 0, (uchar)orientation, 0, 0,
+        0, 0, 0, 0
+    };
+    buf.insert(buf.begin() + 2, exif, exif + sizeof(exif));
+
+    const Mat full = imdecode(buf, IMREAD_COLOR);
+    ASSERT_FALSE(full.empty());
+    ASSERT_EQ(orientation >= 5 ? Size(72, 120) : Size(120, 72), full.size());
+    const Rect rois[] = { Rect(0, 0, 1, 1), Rect(13, 21, 40, 33), Rect(50, 3, 22, 60), Rect(0, 0, 200, 200) };
+    for (size_t i = 0; i < sizeof(rois) / sizeof(rois[0]); i++)
+    {
+        const Rect roi = rois[i] & Rect(Point(), full.size());
+        const Mat region = imdecode(buf, rois[i], IMREAD_COLOR);
+        ASSERT_EQ(roi.size(), region.size()) << rois[i];
+        EXPECT_EQ(0, cvtest::norm(full(roi), region, NORM_INF)) << rois[i];
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Jpeg_Exif_ROI, testing::Range(1, 9));
+
 //==================================================================================================
 
 TEST(Imgcodecs_Jpeg, encode_empty)
@@ -178,6 +213,56 @@ TEST(Imgcodecs_Jpeg, encode_decode_rst_jpeg)
     EXPECT_EQ(0, remove(output_normal.c_str()));
 }
 
+TEST(Imgcodecs_Jpeg, reuse_codec)
+{
+    Mat color(48, 64, CV_8UC3), gray(40, 30, CV_8UC1);
+    RNG rng(17);
+    rng.fill(color, RNG::UNIFORM, 0, 256);
+    rng.fill(gray, RNG::UNIFORM, 0, 256);
+
+    // optimized Huffman tables, then the standard ones without DHT segments (as in MJPEG frames)
+    vector<int> optimize;
+    optimize.push_back(IMWRITE_JPEG_OPTIMIZE);
+    optimize.push_back(1);
+    vector<uchar> color_buf, gray_buf, mjpeg_buf;
+    ASSERT_TRUE(imencode(".jpg", color, color_buf, optimize));
+    ASSERT_TRUE(imencode(".jpg", gray, gray_buf));
+    ASSERT_TRUE(imencode(".jpg", color, mjpeg_buf));
+    const Mat mjpeg_expected = imdecode(mjpeg_buf, IMREAD_COLOR);
+    for (size_t i = 2; i + 4 < mjpeg_buf.size(); )
+    {
+        ASSERT_EQ(0xFF, mjpeg_buf[i]);
+        size_t length = 2 + (mjpeg_buf[i + 2] << 8) + mjpeg_buf[i + 3];
+        if (mjpeg_buf[i + 1] == 0xDA)
+            break;
+        if (mjpeg_buf[i + 1] == 0xC4)
+            mjpeg_buf.erase(mjpeg_buf.begin() + i, mjpeg_buf.begin() + i + length);
+        else
+            i += length;
+    }
+
+    const Mat color_expected = imdecode(color_buf, IMREAD_COLOR);
+    const Mat gray_expected = imdecode(gray_buf, IMREAD_UNCHANGED);
+    const string filename = cv::tempfile(".jpg");
+    ASSERT_TRUE(imwrite(filename, color, optimize));
+    for (int i = 0; i < 3; i++)
+    {
+        // files and buffers in turns
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), color_expected, imread(filename));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), gray_expected, imdecode(gray_buf, IMREAD_UNCHANGED));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), mjpeg_expected, imdecode(mjpeg_buf, IMREAD_COLOR));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), color_expected, imdecode(color_buf, IMREAD_COLOR));
+
+        vector<uchar> buf;
+        ASSERT_TRUE(imwrite(filename, color, optimize));
+        ASSERT_TRUE(imencode(".jpg", gray, buf));
+        EXPECT_TRUE(gray_buf == buf);
+        ASSERT_TRUE(imencode(".jpg", color, buf, optimize));
+        EXPECT_TRUE(color_buf == buf);
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 #endif // HAVE_JPEG
 
 }} // namespace
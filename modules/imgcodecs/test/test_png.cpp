@@ -35,6 +35,44 @@ TEST(Imgcodecs_Png, encode)
     EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, img_gt);
 }
 
+typedef testing::TestWithParam<perf::MatType> Imgcodecs_Png_Threads;
+
+TEST_P(Imgcodecs_Png_Threads, encode)
+{
+    const int type = GetParam();
+    Mat img(600, 700, type, Scalar::all(0));
+    RNG rng(12345);
+    for (int i = 0; i < 100; i++)
+        circle(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), rng.uniform(5, 60),
+               Scalar(rng.uniform(0, 65536), rng.uniform(0, 65536), rng.uniform(0, 65536), rng.uniform(0, 65536)), -1);
+    Mat noise(img.size(), type);
+    rng.fill(noise, RNG::UNIFORM, 0, 16);
+    img += noise;
+
+    const int compression[] = { -1 /* default: SUB filter */, 0, 6 /* adaptive filters */ };
+    for (size_t i = 0; i < sizeof(compression) / sizeof(compression[0]); i++)
+    {
+        SCOPED_TRACE(cv::format("compression=%d", compression[i]));
+        vector<int> params;
+        if (compression[i] >= 0)
+        {
+            params.push_back(IMWRITE_PNG_COMPRESSION);
+            params.push_back(compression[i]);
+        }
+        params.push_back(IMWRITE_PNG_THREADS);
+        params.push_back(4);
+
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(".png", img, buf, params));
+        Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+        ASSERT_FALSE(decoded.empty());
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, decoded);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Imgcodecs_Png_Threads,
+                        testing::Values(CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16UC4));
+
 TEST(Imgcodecs_Png, regression_ImreadVSCvtColor)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
@@ -211,6 +211,410 @@ const string exts[] = {
 
 INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image, testing::ValuesIn(exts));
 
+//==================================================================================================
+
+typedef testing::TestWithParam<string> Imgcodecs_Image_InMemory;
+
+TEST_P(Imgcodecs_Image_InMemory, encode_decode_without_files)
+{
+    const string ext = this->GetParam();
+    const bool isFloat = ext == "hdr" || ext == "pfm" || ext == "exr";
+    Mat image(48, 64, CV_8UC3, Scalar::all(0));
+    circle(image, Point(32, 24), 16, Scalar(40, 160, 240), -1);
+    rectangle(image, Rect(2, 2, 20, 10), Scalar(255, 255, 255), -1);
+    if (isFloat)
+        image.convertTo(image, CV_32FC3, 1. / 255);
+
+    const string full_name = cv::tempfile(("." + ext).c_str());
+    ASSERT_TRUE(imwrite(full_name, image));
+    vector<uchar> from_file;
+    {
+        FILE *f = fopen(full_name.c_str(), "rb");
+        ASSERT_TRUE(f != NULL);
+        fseek(f, 0, SEEK_END);
+        from_file.resize((size_t)ftell(f));
+        fseek(f, 0, SEEK_SET);
+        from_file.resize(fread(&from_file[0], 1, from_file.size(), f));
+        fclose(f);
+    }
+    EXPECT_EQ(0, remove(full_name.c_str()));
+
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode("." + ext, image, buf));
+    EXPECT_EQ(from_file, buf);
+
+    Mat decoded = imdecode(buf, IMREAD_UNCHANGED);
+    ASSERT_FALSE(decoded.empty());
+    ASSERT_EQ(image.size(), decoded.size());
+    ASSERT_EQ(image.type(), decoded.type());
+    if (ext == "hdr")
+        EXPECT_LE(cvtest::norm(image, decoded, NORM_INF), 1. / 64);
+    else
+        EXPECT_EQ(0, cvtest::norm(image, decoded, NORM_INF));
+}
+
+const string in_memory_exts[] = {
+#ifdef HAVE_IMGCODEC_SUNRASTER
+    "ras",
+#endif
+#ifdef HAVE_IMGCODEC_PFM
+    "pfm",
+#endif
+#ifdef HAVE_IMGCODEC_HDR
+    "hdr",
+#endif
+#ifdef HAVE_OPENEXR
+    "exr",
+#endif
+    "bmp",
+};
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_InMemory, testing::ValuesIn(in_memory_exts));
+
+//==================================================================================================
+
+typedef testing::TestWithParam<string> Imgcodecs_Image_ROI;
+
+TEST_P(Imgcodecs_Image_ROI, decode_region)
+{
+    const string ext = this->GetParam();
+    Mat image(150, 230, CV_8UC3);
+    RNG rng(12345);
+    rng.fill(image, RNG::UNIFORM, 0, 64);
+    for (int i = 0; i < 20; i++)
+        circle(image, Point(rng.uniform(0, image.cols), rng.uniform(0, image.rows)), rng.uniform(5, 40),
+               Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), -1);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, image, buf));
+
+    const int modes[] = { IMREAD_COLOR, IMREAD_GRAYSCALE, IMREAD_REDUCED_COLOR_2 };
+    const Rect rois[] = {
+        Rect(0, 0, 230, 150), Rect(17, 33, 61, 45), Rect(100, 0, 130, 1), Rect(0, 149, 230, 1),
+        Rect(5, 120, 300, 300) /* clipped */, Rect(-10, -10, 30, 20) /* clipped */
+    };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        const Mat full = imdecode(buf, modes[m]);
+        ASSERT_FALSE(full.empty());
+        for (size_t r = 0; r < sizeof(rois) / sizeof(rois[0]); r++)
+        {
+            SCOPED_TRACE(cv::format("mode=%d roi=%d", modes[m], (int)r));
+            const Rect expected_roi = rois[r] & Rect(Point(), full.size());
+            Mat region;
+            ASSERT_NO_THROW(region = imdecode(buf, rois[r], modes[m]));
+            if (expected_roi.empty())
+            {
+                EXPECT_TRUE(region.empty());
+                continue;
+            }
+            ASSERT_EQ(expected_roi.size(), region.size());
+            ASSERT_EQ(full.type(), region.type());
+            EXPECT_EQ(0, cvtest::norm(full(expected_roi), region, NORM_INF));
+        }
+    }
+    EXPECT_TRUE(imdecode(buf, Rect(300, 0, 10, 10), IMREAD_COLOR).empty());
+
+    const string filename = cv::tempfile(ext.c_str());
+    ASSERT_TRUE(imwrite(filename, image));
+    const Rect roi(40, 50, 100, 30);
+    Mat region = imread(filename, roi);
+    Mat full = imread(filename);
+    EXPECT_EQ(0, remove(filename.c_str()));
+    ASSERT_EQ(roi.size(), region.size());
+    EXPECT_EQ(0, cvtest::norm(full(roi), region, NORM_INF));
+}
+
+const string roi_exts[] = {
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+    ".bmp",
+};
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_ROI, testing::ValuesIn(roi_exts));
+
+//==================================================================================================
+
+static vector<uchar> readFileBytes(const string& filename)
+{
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    return vector<uchar>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+typedef testing::TestWithParam<string> Imgcodecs_Image_Bands;
+
+TEST_P(Imgcodecs_Image_Bands, write_read_rows)
+{
+    const string ext = this->GetParam();
+    const bool gray = ext == ".pgm" || ext == ".pbm";
+    Mat image(150, 230, gray ? CV_8UC1 : CV_8UC3);
+    RNG rng(12345);
+    rng.fill(image, RNG::UNIFORM, 0, 64);
+    for (int i = 0; i < 20; i++)
+        circle(image, Point(rng.uniform(0, image.cols), rng.uniform(0, image.rows)), rng.uniform(5, 40),
+               Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), -1);
+    if (ext == ".pbm")
+        image = image > 100;
+
+    const string band_filename = cv::tempfile(ext.c_str());
+    const string filename = cv::tempfile(ext.c_str());
+    {
+        ImageWriter writer;
+        ASSERT_TRUE(writer.open(band_filename, image.size(), image.type()));
+        for (int y = 0; y < image.rows; y += 37)
+        {
+            ASSERT_EQ(y, writer.position());
+            ASSERT_TRUE(writer.write(image.rowRange(y, std::min(y + 37, image.rows))));
+        }
+        EXPECT_FALSE(writer.write(image.rowRange(0, 1)));
+    }
+    ASSERT_TRUE(imwrite(filename, image));
+    EXPECT_TRUE(readFileBytes(filename) == readFileBytes(band_filename));
+
+    const int modes[] = { IMREAD_COLOR, IMREAD_GRAYSCALE, IMREAD_UNCHANGED, IMREAD_REDUCED_COLOR_2 };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        SCOPED_TRACE(cv::format("mode=%d", modes[m]));
+        const Mat full = imread(filename, modes[m]);
+        ASSERT_FALSE(full.empty());
+
+        ImageReader reader(band_filename, modes[m]);
+        ASSERT_TRUE(reader.isOpened());
+        ASSERT_EQ(full.size(), reader.size());
+        ASSERT_EQ(full.type(), reader.type());
+        Mat band, result;
+        while (reader.read(band, 37))
+        {
+            ASSERT_LE(band.rows, 37);
+            result.push_back(band);
+        }
+        EXPECT_EQ(full.rows, reader.position());
+        ASSERT_EQ(full.size(), result.size());
+        EXPECT_EQ(0, cvtest::norm(full, result, NORM_INF));
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+    EXPECT_EQ(0, remove(band_filename.c_str()));
+
+    EXPECT_FALSE(ImageReader(filename).isOpened());
+}
+
+const string band_exts[] = {
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+#ifdef HAVE_TIFF
+    ".tiff",
+#endif
+#ifdef HAVE_IMGCODEC_PXM
+    ".pbm",
+    ".pgm",
+    ".ppm",
+#endif
+    ".bmp",
+};
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_Bands, testing::ValuesIn(band_exts));
+
+//==================================================================================================
+
+static bool isMapped(const Mat& m)
+{
+    return m.u && m.u->currAllocator != Mat::getStdAllocator();
+}
+
+TEST(Imgcodecs_Image, imread_mmap)
+{
+    RNG rng(12345);
+    Mat gray(101, 67, CV_8UC1), color(101, 67, CV_8UC3), gray16(101, 67, CV_16UC1), gray32f(101, 67, CV_32FC1);
+    rng.fill(gray, RNG::UNIFORM, 0, 256);
+    rng.fill(color, RNG::UNIFORM, 0, 256);
+    rng.fill(gray16, RNG::UNIFORM, 0, 65536);
+    rng.fill(gray32f, RNG::UNIFORM, -1, 1);
+
+    struct Case { const char* ext; Mat image; int flags; bool mapped; };
+    const vector<int> tiff_raw(1, IMWRITE_TIFF_COMPRESSION), no_params;
+    const Case cases[] = {
+#ifdef HAVE_IMGCODEC_PXM
+        { ".pgm", gray, IMREAD_GRAYSCALE, true },
+        { ".pgm", gray, IMREAD_COLOR, false },
+        { ".ppm", color, IMREAD_COLOR, false },  // RGB order
+#endif
+#ifdef HAVE_TIFF
+        { ".tiff", gray, IMREAD_GRAYSCALE, true },
+        { ".tiff", gray16, IMREAD_ANYDEPTH, true },
+        { ".tiff", gray16, IMREAD_GRAYSCALE, false },
+        { ".tiff", gray32f, IMREAD_ANYDEPTH, true },
+#endif
+        { ".bmp", color, IMREAD_COLOR, true },
+        { ".bmp", gray, IMREAD_GRAYSCALE, true },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const Case& c = cases[i];
+        SCOPED_TRACE(cv::format("%s type=%d flags=%d", c.ext, c.image.type(), c.flags));
+        const string filename = cv::tempfile(c.ext);
+        vector<int> params = no_params;
+        if (string(c.ext) == ".tiff")
+        {
+            params = tiff_raw;
+            params.push_back(1);  // COMPRESSION_NONE
+        }
+        if (string(c.ext) == ".bmp")
+        {
+            // OpenCV writes bottom-up files, a negative height makes the rows of the flipped image top-down
+            Mat flipped;
+            flip(c.image, flipped, 0);
+            vector<uchar> buf;
+            ASSERT_TRUE(imencode(c.ext, flipped, buf));
+            int height = -c.image.rows;
+            memcpy(&buf[22], &height, sizeof(height));
+            FILE* f = fopen(filename.c_str(), "wb");
+            ASSERT_TRUE(f != NULL);
+            fwrite(&buf[0], 1, buf.size(), f);
+            fclose(f);
+        }
+        else
+        {
+            ASSERT_TRUE(imwrite(filename, c.image, params));
+        }
+
+        const Mat expected = imread(filename, c.flags);
+        Mat m = imread(filename, c.flags | IMREAD_MMAP);
+        ASSERT_FALSE(m.empty());
+        EXPECT_EQ(c.mapped, isMapped(m));
+        ASSERT_EQ(expected.size(), m.size());
+        ASSERT_EQ(expected.type(), m.type());
+        EXPECT_EQ(0, cvtest::norm(expected, m, NORM_INF));
+
+        // the mapping is private
+        m.setTo(Scalar::all(1));
+        m.release();
+        EXPECT_EQ(0, cvtest::norm(expected, imread(filename, c.flags | IMREAD_MMAP), NORM_INF));
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+}
+
+TEST(Imgcodecs_Image, imdecodeBatch)
+{
+    const string batch_exts[] = {
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+        ".bmp",
+    };
+    const int n_exts = (int)(sizeof(batch_exts) / sizeof(batch_exts[0]));
+
+    vector<Mat> bufs, expected;
+    for (int i = 0; i < 24; i++)
+    {
+        Mat image(32 + i, 48 + 2 * i, CV_8UC3, Scalar::all(0));
+        circle(image, Point(image.cols / 2, image.rows / 2), 10 + i / 4, Scalar(20 * i, 128, 255 - 10 * i), -1);
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(batch_exts[i % n_exts], image, buf));
+        bufs.push_back(Mat(buf, true));
+        expected.push_back(imdecode(buf, IMREAD_COLOR));
+    }
+    // invalid inputs are reported per item
+    const int bad_signature = 5, truncated = 11, empty = 17;
+    bufs[bad_signature] = Mat(1, 100, CV_8UC1, Scalar::all(7));
+    bufs[truncated] = bufs[truncated].colRange(0, bufs[truncated].cols / 2).clone();
+    bufs[empty] = Mat();
+
+    vector<Mat> dst;
+    vector<String> errors;
+    int count = 0;
+    ASSERT_NO_THROW(count = imdecodeBatch(bufs, IMREAD_COLOR, dst, &errors));
+    EXPECT_EQ((int)bufs.size() - 3, count);
+    ASSERT_EQ(bufs.size(), dst.size());
+    ASSERT_EQ(bufs.size(), errors.size());
+    for (size_t i = 0; i < bufs.size(); i++)
+    {
+        SCOPED_TRACE(cv::format("i=%d", (int)i));
+        if (i == bad_signature || i == truncated || i == empty)
+        {
+            EXPECT_TRUE(dst[i].empty());
+            EXPECT_FALSE(errors[i].empty());
+            continue;
+        }
+        EXPECT_TRUE(errors[i].empty()) << errors[i];
+        EXPECT_EQ(0, cvtest::norm(expected[i], dst[i], NORM_INF));
+    }
+
+    // output matrices of the same size and type are reused
+    const uchar* data = dst[0].data;
+    EXPECT_EQ(count, imdecodeBatch(bufs, IMREAD_COLOR, dst));
+    EXPECT_EQ(data, dst[0].data);
+}
+
+TEST(Imgcodecs_Image, imreadHeader)
+{
+    ImageHeader header;
+    EXPECT_FALSE(imreadHeader(cv::tempfile(".png"), header));
+    EXPECT_EQ(-1, header.depth);
+    EXPECT_FALSE(imdecodeHeader(Mat(1, 100, CV_8UC1, Scalar::all(7)), header));
+
+#ifdef HAVE_PNG
+    {
+        const string filename = cv::tempfile(".png");
+        ASSERT_TRUE(imwrite(filename, Mat(30, 70, CV_16UC4, Scalar::all(1000))));
+        ASSERT_TRUE(imreadHeader(filename, header));
+        EXPECT_EQ(Size(70, 30), header.size);
+        EXPECT_EQ(CV_16U, header.depth);
+        EXPECT_EQ(4, header.channels);
+        EXPECT_EQ(1, header.orientation);
+        EXPECT_EQ(1, header.pages);
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+#endif
+#ifdef HAVE_JPEG
+    {
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(".jpg", Mat(72, 120, CV_8UC1, Scalar::all(50)), buf));
+        // APP1 segment with orientation 6 (right-top)
+        const uchar exif[] = {
+            0xFF, 0xE1, 0, 34, 'E', 'x', 'i', 'f', 0, 0,
+            'M', 'M', 0, 0x2A, 0, 0, 0, 8,
+            0, 1, 0x01, 0x12, 0, 3, 0, 0, 0, 1, 0, 6, 0, 0,
+            0, 0, 0, 0
+        };
+        buf.insert(buf.begin() + 2, exif, exif + sizeof(exif));
+        ASSERT_TRUE(imdecodeHeader(buf, header));
+        EXPECT_EQ(Size(120, 72), header.size);
+        EXPECT_EQ(CV_8U, header.depth);
+        EXPECT_EQ(1, header.channels);
+        EXPECT_EQ(6, header.orientation);
+        EXPECT_EQ(1, header.pages);
+    }
+#endif
+#ifdef HAVE_TIFF
+    {
+        vector<Mat> pages;
+        for (int i = 0; i < 3; i++)
+            pages.push_back(Mat(40 + i, 60, CV_8UC3, Scalar::all(i)));
+        const string filename = cv::tempfile(".tiff");
+        ASSERT_TRUE(imwrite(filename, pages));
+        ASSERT_TRUE(imdecodeHeader(readFileBytes(filename), header));
+        EXPECT_EQ(Size(60, 40), header.size);
+        EXPECT_EQ(CV_8U, header.depth);
+        EXPECT_EQ(3, header.channels);
+        EXPECT_EQ(3, header.pages);
+        EXPECT_EQ(0, remove(filename.c_str()));
+    }
+#endif
+}
+
 TEST(Imgcodecs_Image, regression_9376)
 {
     String path = findDataFile("readwrite/regression_9376.bmp");
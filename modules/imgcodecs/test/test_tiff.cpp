@@ -333,6 +333,82 @@ TEST(Imgcodecs_Tiff, decode_black_and_write_image_pr12989_default)
     EXPECT_EQ(CV_8UC3, img.type()) << cv::typeToString(img.type());
 }
 
+TEST(Imgcodecs_Tiff, write_threads)
+{
+    Mat img(500, 300, CV_16UC3, Scalar::all(0));
+    RNG rng(12345);
+    for (int i = 0; i < 50; i++)
+        circle(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), rng.uniform(5, 60),
+               Scalar(rng.uniform(0, 65536), rng.uniform(0, 65536), rng.uniform(0, 65536)), -1);
+
+    const int compression[] = { COMPRESSION_LZW, COMPRESSION_ADOBE_DEFLATE };
+    for (size_t i = 0; i < sizeof(compression) / sizeof(compression[0]); i++)
+    {
+        SCOPED_TRACE(cv::format("compression=%d", compression[i]));
+        vector<int> params;
+        params.push_back(IMWRITE_TIFF_COMPRESSION);
+        params.push_back(compression[i]);
+        vector<uchar> expected, buf;
+        ASSERT_TRUE(imencode(".tiff", img, expected, params));
+
+        params.push_back(IMWRITE_TIFF_THREADS);
+        params.push_back(3);
+        ASSERT_TRUE(imencode(".tiff", img, buf, params));
+        EXPECT_TRUE(expected == buf);
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, imdecode(buf, IMREAD_UNCHANGED));
+    }
+}
+
+TEST(Imgcodecs_Tiff, read_pages)
+{
+    const int page_count = 6;
+    vector<Mat> pages;
+    for (int i = 0; i < page_count; i++)
+    {
+        Mat page(20 + i, 30 + 2 * i, i % 2 ? CV_8UC1 : CV_16UC3);
+        RNG rng(i);
+        rng.fill(page, RNG::UNIFORM, 0, 256);
+        pages.push_back(page);
+    }
+    const string filename = cv::tempfile(".tiff");
+    ASSERT_TRUE(imwrite(filename, pages));
+
+    ImageCollection collection(filename, IMREAD_UNCHANGED);
+    ASSERT_TRUE(collection.isOpened());
+    ASSERT_EQ(page_count, collection.size());
+    const int order[] = { 3, 0, 5, 5, 1, 2, 4, 0 };
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++)
+    {
+        SCOPED_TRACE(cv::format("page=%d", order[i]));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), pages[order[i]], collection.at(order[i]));
+    }
+    Mat page;
+    EXPECT_FALSE(collection.read(page_count, page));
+    EXPECT_TRUE(page.empty());
+
+    int index = 0;
+    for (ImageCollection::iterator it = collection.begin(); it != collection.end(); ++it, ++index)
+    {
+        ASSERT_EQ(index, it.index());
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), pages[index], *it);
+    }
+    EXPECT_EQ(page_count, index);
+
+    vector<Mat> range;
+    ASSERT_TRUE(imreadmulti(filename, range, 2, 3, IMREAD_UNCHANGED));
+    ASSERT_EQ(3u, range.size());
+    for (int i = 0; i < 3; i++)
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), pages[2 + i], range[i]);
+    range.clear();
+    ASSERT_TRUE(imreadmulti(filename, range, 4, 10, IMREAD_UNCHANGED));
+    EXPECT_EQ(2u, range.size());
+    range.clear();
+    EXPECT_FALSE(imreadmulti(filename, range, page_count, 1, IMREAD_UNCHANGED));
+    EXPECT_TRUE(range.empty());
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 #endif
 
 }} // namespace
@@ -590,6 +590,15 @@ enum { CAP_PROP_IMAGES_BASE = 18000,
 
 //! @} Images
 
+/** @name OpenCV built-in MJPEG backend
+    @{
+*/
+
+enum { CAP_PROP_MJPEG_READAHEAD = 19001 //!< Number of frames the @ref CAP_OPENCV_MJPEG backend reads ahead and decodes in parallel. 0 decodes each frame on retrieve(). The default is taken from the OPENCV_VIDEOIO_MJPEG_READAHEAD environment variable, 0 if it is not set.
+     };
+
+//! @} MJPEG
+
 //! @} videoio_flags_others
 
 
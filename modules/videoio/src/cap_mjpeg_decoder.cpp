@@ -62,6 +62,7 @@ public:
 protected:
 
     inline uint64_t getFramePos() const;
+    bool readAhead(size_t index);
 
     Ptr<AVIReadContainer> m_avi_container;
     bool             m_is_first_frame;
@@ -76,8 +77,56 @@ protected:
     uint32_t         m_frame_width;
     uint32_t         m_frame_height;
     double           m_fps;
+
+    //frames [m_decoded_first, m_decoded_first + m_decoded.size())
+    //are read and decoded together by readAhead()
+    size_t           m_readahead;
+    size_t           m_decoded_first;
+    std::vector<Mat> m_decoded;
+    std::vector<uchar> m_decoded_valid; //frame chunk wasn't empty
+};
+
+class MjpegDecodeBody : public ParallelLoopBody
+{
+public:
+    MjpegDecodeBody(const std::vector<std::vector<char> >& data, std::vector<Mat>& frames)
+        : m_data(data), m_frames(frames) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            if (m_data[i].size())
+                m_frames[i] = imdecode(m_data[i], IMREAD_ANYDEPTH | IMREAD_COLOR | IMREAD_IGNORE_ORIENTATION);
+        }
+    }
+
+private:
+    const std::vector<std::vector<char> >& m_data;
+    std::vector<Mat>& m_frames;
 };
 
+//reads the chunks of the next frames from the file, one after another,
+//and decodes them on the worker threads
+bool MotionJpegCapture::readAhead(size_t index)
+{
+    size_t count = std::min(m_readahead, m_mjpeg_frames.size() - index);
+    std::vector<std::vector<char> > data(count);
+    for (size_t i = 0; i < count; i++)
+        data[i] = m_avi_container->readFrame(m_mjpeg_frames.begin() + (index + i));
+
+    m_decoded.resize(count);
+    m_decoded_valid.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_decoded[i].release();
+        m_decoded_valid[i] = data[i].size() != 0;
+    }
+    m_decoded_first = index;
+    parallel_for_(Range(0, (int)count), MjpegDecodeBody(data, m_decoded));
+    return count > 0;
+}
+
 uint64_t MotionJpegCapture::getFramePos() const
 {
     if(m_is_first_frame)
@@ -91,6 +140,15 @@ uint64_t MotionJpegCapture::getFramePos() const
 
 bool MotionJpegCapture::setProperty(int property, double value)
 {
+    if(property == CAP_PROP_MJPEG_READAHEAD)
+    {
+        if(value < 0)
+            return false;
+        m_readahead = (size_t)value;
+        m_decoded.clear();
+        m_decoded_valid.clear();
+        return true;
+    }
     if(property == CAP_PROP_POS_FRAMES)
     {
         if(int(value) == 0)
@@ -130,6 +188,8 @@ double MotionJpegCapture::getProperty(int property) const
             return (double)m_mjpeg_frames.size();
         case CAP_PROP_FORMAT:
             return 0;
+        case CAP_PROP_MJPEG_READAHEAD:
+            return (double)m_readahead;
         default:
             return 0;
     }
@@ -160,11 +220,23 @@ bool MotionJpegCapture::retrieveFrame(int, OutputArray output_frame)
 {
     if(m_frame_iterator != m_mjpeg_frames.end())
     {
-        std::vector<char> data = m_avi_container->readFrame(m_frame_iterator);
+        if(m_readahead > 0)
+        {
+            size_t index = m_frame_iterator - m_mjpeg_frames.begin();
+            if(index < m_decoded_first || index >= m_decoded_first + m_decoded.size())
+                readAhead(index);
 
-        if(data.size())
+            if(m_decoded_valid[index - m_decoded_first])
+                m_current_frame = m_decoded[index - m_decoded_first];
+        }
+        else
         {
-            m_current_frame = imdecode(data, IMREAD_ANYDEPTH | IMREAD_COLOR | IMREAD_IGNORE_ORIENTATION);
+            std::vector<char> data = m_avi_container->readFrame(m_frame_iterator);
+
+            if(data.size())
+            {
+                m_current_frame = imdecode(data, IMREAD_ANYDEPTH | IMREAD_COLOR | IMREAD_IGNORE_ORIENTATION);
+            }
         }
 
         m_current_frame.copyTo(output_frame);
@@ -181,6 +253,8 @@ MotionJpegCapture::~MotionJpegCapture()
 }
 
 MotionJpegCapture::MotionJpegCapture(const String& filename)
+    : m_readahead(utils::getConfigurationParameterSizeT("OPENCV_VIDEOIO_MJPEG_READAHEAD", 0)),
+      m_decoded_first(0)
 {
     m_avi_container = makePtr<AVIReadContainer>();
     m_avi_container->initStream(filename);
@@ -207,6 +281,8 @@ bool MotionJpegCapture::open(const String& filename)
 
     m_frame_iterator = m_mjpeg_frames.end();
     m_is_first_frame = true;
+    m_decoded.clear();
+    m_decoded_valid.clear();
 
     if(!m_avi_container->parseRiff(m_mjpeg_frames))
     {
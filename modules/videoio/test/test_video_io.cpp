@@ -521,6 +521,55 @@ TEST(Videoio, exceptions)
 }
 
 
+TEST(Videoio, mjpeg_readahead)
+{
+    const string filename = cv::tempfile(".avi");
+    const Size size(96, 64);
+    const int count = 23;
+    {
+        VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, size, true);
+        ASSERT_TRUE(writer.isOpened());
+        for (int i = 0; i < count; i++)
+        {
+            Mat frame(size, CV_8UC3, Scalar::all(0));
+            rectangle(frame, Rect(i * 3, i * 2, 20, 10), Scalar(255, 128, 10 * i), FILLED);
+            writer.write(frame);
+        }
+    }
+
+    vector<Mat> expected;
+    {
+        VideoCapture cap(filename, CAP_OPENCV_MJPEG);
+        ASSERT_TRUE(cap.isOpened());
+        Mat frame;
+        while (cap.read(frame))
+            expected.push_back(frame.clone());
+    }
+    ASSERT_EQ((size_t)count, expected.size());
+
+    VideoCapture cap(filename, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_MJPEG_READAHEAD, 5));
+    EXPECT_EQ(5, cap.get(CAP_PROP_MJPEG_READAHEAD));
+    Mat frame;
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(cap.read(frame)) << i;
+        EXPECT_EQ(0, cvtest::norm(expected[i], frame, NORM_INF)) << i;
+    }
+    EXPECT_FALSE(cap.read(frame));
+
+    // seeking backwards reads the frames again
+    const int positions[] = { 3, 17, 1, 22 };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+        ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, positions[i]));
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(0, cvtest::norm(expected[positions[i]], frame, NORM_INF)) << positions[i];
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 typedef Videoio_Writer Videoio_Writer_bad_fourcc;
 
 TEST_P(Videoio_Writer_bad_fourcc, nocrash)